@@ -0,0 +1,172 @@
+/// This file is a part of media_kit (https://github.com/media-kit/media-kit).
+///
+/// Copyright © 2026 & onwards, Predidit.
+/// All rights reserved.
+/// Use of this source code is governed by MIT license that can be found in the LICENSE file.
+
+// Measures the throughput of libmpv commands & property sets (per second),
+// marshaled with `calloc` + `toNativeUtf8` per argument (as previously done by
+// `NativePlayer`) & with a reusable [NativeArena].
+//
+// Each configuration is measured marshaling only & submitted to an idle libmpv
+// instance with `mpv_command_async` / `mpv_set_property_async`.
+//
+// Usage:
+// dart run benchmark/command_marshaling.dart [--iterations=N] [--libmpv=PATH]
+
+import 'dart:ffi';
+
+import 'package:media_kit/ffi/ffi.dart';
+import 'package:media_kit/generated/libmpv/bindings.dart' as generated;
+import 'package:media_kit/src/player/native/core/native_library.dart';
+import 'package:media_kit/src/player/native/utils/native_arena.dart';
+
+/// Submits the marshaled command. Returns the result of the libmpv call.
+typedef Submit = int Function(Pointer<Pointer<Utf8>> args);
+
+// A seek, as fired while scrubbing & a property set, as fired by a volume
+// slider.
+const kCommand = ['seek', '42.000000', 'absolute', 'keyframes'];
+const kProperty = 'volume';
+
+int legacyCommand(Submit submit) {
+  final pointers =
+      kCommand.map<Pointer<Utf8>>((e) => e.toNativeUtf8()).toList();
+  final arr = calloc<Pointer<Utf8>>(128);
+  for (int i = 0; i < kCommand.length; i++) {
+    (arr + i).value = pointers[i];
+  }
+  final result = submit(arr);
+  calloc.free(arr);
+  pointers.forEach(calloc.free);
+  return result;
+}
+
+int arenaCommand(NativeArena arena, Submit submit) {
+  final result = submit(arena.toNativeUtf8Array(kCommand));
+  arena.reset();
+  return result;
+}
+
+int legacyProperty(generated.MPV mpv, Pointer<generated.mpv_handle> ctx) {
+  final name = kProperty.toNativeUtf8();
+  final data = calloc<Double>(1)..value = 50.0;
+  final result = ctx == nullptr
+      ? 0
+      : mpv.mpv_set_property_async(
+          ctx,
+          0,
+          name.cast(),
+          generated.mpv_format.MPV_FORMAT_DOUBLE,
+          data.cast(),
+        );
+  calloc.free(data);
+  calloc.free(name);
+  return result;
+}
+
+int arenaProperty(
+  NativeArena arena,
+  generated.MPV mpv,
+  Pointer<generated.mpv_handle> ctx,
+) {
+  final name = arena.toNativeUtf8(kProperty);
+  final data = arena<Double>()..value = 50.0;
+  final result = ctx == nullptr
+      ? 0
+      : mpv.mpv_set_property_async(
+          ctx,
+          0,
+          name.cast(),
+          generated.mpv_format.MPV_FORMAT_DOUBLE,
+          data.cast(),
+        );
+  arena.reset();
+  return result;
+}
+
+/// Drains the replies to the asynchronous requests, so that the event queue
+/// of libmpv never fills up.
+void drain(generated.MPV mpv, Pointer<generated.mpv_handle> ctx) {
+  if (ctx == nullptr) return;
+  while (mpv.mpv_wait_event(ctx, 0).ref.event_id !=
+      generated.mpv_event_id.MPV_EVENT_NONE) {}
+}
+
+void measure(
+  String name,
+  int iterations,
+  int Function() function,
+  void Function() drain,
+) {
+  // Warm up.
+  for (int i = 0; i < iterations ~/ 10; i++) {
+    function();
+    if (i % 64 == 0) drain();
+  }
+  drain();
+  final stopwatch = Stopwatch()..start();
+  int errors = 0;
+  for (int i = 0; i < iterations; i++) {
+    if (function() < 0) errors++;
+    if (i % 64 == 0) drain();
+  }
+  drain();
+  stopwatch.stop();
+  final rate = iterations / stopwatch.elapsedMicroseconds * 1e6;
+  print(
+    '  ${name.padRight(24)} ${rate.toStringAsFixed(0).padLeft(10)} /s'
+    '${errors > 0 ? ' ($errors errors)' : ''}',
+  );
+}
+
+void main(List<String> args) {
+  int iterations = 1000000;
+  String? libmpv;
+  for (final arg in args) {
+    if (arg.startsWith('--iterations=')) {
+      iterations = int.parse(arg.substring('--iterations='.length));
+    } else if (arg.startsWith('--libmpv=')) {
+      libmpv = arg.substring('--libmpv='.length);
+    }
+  }
+  NativeLibrary.ensureInitialized(libmpv: libmpv);
+  final mpv = generated.MPV(DynamicLibrary.open(NativeLibrary.path));
+  final ctx = mpv.mpv_create();
+  for (final option in {'vo': 'null', 'ao': 'null', 'idle': 'yes'}.entries) {
+    final name = option.key.toNativeUtf8();
+    final value = option.value.toNativeUtf8();
+    mpv.mpv_set_option_string(ctx, name.cast(), value.cast());
+    calloc.free(name);
+    calloc.free(value);
+  }
+  mpv.mpv_initialize(ctx);
+
+  final arena = NativeArena();
+  int marshal(Pointer<Pointer<Utf8>> args) => 0;
+  int submit(Pointer<Pointer<Utf8>> args) =>
+      mpv.mpv_command_async(ctx, 0, args.cast());
+
+  print('Commands (${kCommand.join(' ')}), $iterations iterations:');
+  measure('calloc, marshal only', iterations, () => legacyCommand(marshal),
+      () {});
+  measure('arena, marshal only', iterations, () => arenaCommand(arena, marshal),
+      () {});
+  measure('calloc, submitted', iterations, () => legacyCommand(submit),
+      () => drain(mpv, ctx));
+  measure('arena, submitted', iterations, () => arenaCommand(arena, submit),
+      () => drain(mpv, ctx));
+
+  print('Property sets ($kProperty), $iterations iterations:');
+  measure('calloc, marshal only', iterations,
+      () => legacyProperty(mpv, nullptr), () {});
+  measure('arena, marshal only', iterations,
+      () => arenaProperty(arena, mpv, nullptr), () {});
+  measure('calloc, submitted', iterations, () => legacyProperty(mpv, ctx),
+      () => drain(mpv, ctx));
+  measure('arena, submitted', iterations, () => arenaProperty(arena, mpv, ctx),
+      () => drain(mpv, ctx));
+
+  arena.release();
+  mpv.mpv_terminate_destroy(ctx);
+}
@@ -23,6 +23,7 @@ export 'package:media_kit/src/models/video_params.dart';
 export 'package:media_kit/src/legacy.dart';
 
 export 'package:media_kit/src/player/platform_player.dart';
+export 'package:media_kit/src/player/demuxer_cache_governor.dart';
 export 'package:media_kit/src/player/player.dart';
 
 export 'package:media_kit/src/player/native/player/player.dart';
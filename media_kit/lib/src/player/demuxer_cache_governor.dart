@@ -0,0 +1,298 @@
+/// This file is a part of media_kit (https://github.com/media-kit/media-kit).
+///
+/// Copyright © 2026 & onwards, Predidit.
+/// All rights reserved.
+/// Use of this source code is governed by MIT license that can be found in the LICENSE file.
+import 'dart:async';
+import 'dart:math';
+import 'package:collection/collection.dart';
+import 'package:meta/meta.dart';
+
+import 'package:media_kit/src/player/player.dart';
+
+/// Applies the forward & back demuxer cache sizes (in bytes) to a player.
+typedef DemuxerCacheApply = Future<void> Function(int forward, int back);
+
+/// Returns the number of bytes currently held in the demuxer cache of a player.
+typedef DemuxerCacheUsage = Future<int> Function();
+
+/// {@template demuxer_cache_governor}
+///
+/// DemuxerCacheGovernor
+/// --------------------
+/// Shares a process-wide demuxer cache [budget] between all [Player]s.
+///
+/// Each [Player] receives a share of the [budget] proportional to its weight:
+/// playing players weigh more than paused ones & hidden ones (see [setVisible]) less than visible ones.
+/// A share never exceeds what [PlayerConfiguration.bufferSize] allows; the excess goes to the other players.
+/// Shares are re-assigned whenever a [Player] is created, disposed, played, paused, shown, hidden, suspended or resumed.
+///
+/// The demuxer cache of a [Player] whose video output is suspended (see [setSuspended]) is trimmed, even while the governor is disabled; the rest of the [budget] goes to the other players.
+///
+/// ```dart
+/// DemuxerCacheGovernor.instance.budget = 256 * 1024 * 1024;
+/// ```
+///
+/// {@endtemplate}
+class DemuxerCacheGovernor {
+  /// Singleton instance.
+  static final DemuxerCacheGovernor instance = DemuxerCacheGovernor._();
+
+  /// Smallest share assigned to a [Player], unless the [budget] is too small for it.
+  static const int kMinimumShare = 512 * 1024;
+
+  /// Relative weight of a playing [Player] to a paused one.
+  static const double kPlayingWeight = 4.0;
+
+  /// Relative weight of a hidden [Player] to a visible one.
+  static const double kHiddenWeight = 0.25;
+
+  /// {@macro demuxer_cache_governor}
+  DemuxerCacheGovernor._();
+
+  /// Creates a separate instance for testing.
+  @visibleForTesting
+  factory DemuxerCacheGovernor.create() => DemuxerCacheGovernor._();
+
+  /// Process-wide budget in bytes, shared by the forward & back caches of all players.
+  ///
+  /// `null` (default) disables the governor; each [Player] uses [PlayerConfiguration.bufferSize].
+  int? get budget => _budget;
+
+  set budget(int? value) {
+    if (value == _budget) {
+      return;
+    }
+    _budget = value;
+    if (value == null) {
+      // Restore each player's own configuration.
+      for (final entry in _entries.values) {
+        entry.share = null;
+        _apply(entry, entry.suspendedShare ?? entry.maximum);
+      }
+    } else {
+      _rebalance();
+    }
+  }
+
+  /// Registers a player. Called by the [Player] implementation upon creation.
+  ///
+  /// [maximum] is the largest share (forward + back) the player may receive.
+  void register(
+    Object player, {
+    required int maximum,
+    required Stream<bool> playing,
+    required DemuxerCacheApply apply,
+    required DemuxerCacheUsage usage,
+  }) {
+    player = _key(player);
+    unregister(player);
+    final entry = _DemuxerCacheEntry(maximum, apply, usage);
+    entry.subscription = playing.listen((value) {
+      if (entry.playing != value) {
+        entry.playing = value;
+        _rebalance();
+      }
+    });
+    _entries[player] = entry;
+    _rebalance();
+  }
+
+  /// Unregisters a player. Called by the [Player] implementation upon disposal.
+  void unregister(Object player) {
+    final entry = _entries.remove(_key(player));
+    if (entry != null) {
+      entry.subscription?.cancel();
+      _rebalance();
+    }
+  }
+
+  /// Sets whether [player] is visible e.g. its video is on screen. Hidden players receive a smaller share.
+  ///
+  /// [player] is a [Player] or its [Player.platform].
+  void setVisible(Object player, bool visible) {
+    final entry = _entries[_key(player)];
+    if (entry != null && entry.visible != visible) {
+      entry.visible = visible;
+      _rebalance();
+    }
+  }
+
+  /// Sets whether the video output of [player] is suspended. While suspended, its demuxer cache is trimmed to [cacheBytes] of forward cache & no back cache. Called by the video output.
+  ///
+  /// [player] is a [Player] or its [Player.platform].
+  void setSuspended(Object player, bool suspended, {int cacheBytes = 0}) {
+    final entry = _entries[_key(player)];
+    final bytes = suspended ? max(cacheBytes, 0) : null;
+    if (entry == null || entry.suspended == bytes) {
+      return;
+    }
+    entry.suspended = bytes;
+    if (_budget == null) {
+      _apply(entry, entry.suspendedShare ?? entry.maximum);
+    } else {
+      // Re-applied even if the share is unchanged: its split is not.
+      entry.share = null;
+      _rebalance();
+    }
+  }
+
+  /// Currently assigned share (forward + back, in bytes) of [player], or `null` if the governor is disabled.
+  ///
+  /// [player] is a [Player] or its [Player.platform].
+  int? shareOf(Object player) => _entries[_key(player)]?.share;
+
+  /// Returns the current budget, assigned & used bytes.
+  Future<DemuxerCacheUtilization> utilization() async {
+    final entries = _entries.values.toList();
+    final used = await Future.wait(
+      entries.map((entry) => entry.usage().catchError((_) => 0)),
+    );
+    return DemuxerCacheUtilization(
+      budget: _budget,
+      assigned: entries.fold(
+        0,
+        (sum, entry) =>
+            sum + (entry.share ?? entry.suspendedShare ?? entry.maximum),
+      ),
+      used: used.fold(0, (sum, value) => sum + value),
+      players: entries.length,
+    );
+  }
+
+  Object _key(Object player) {
+    if (player is Player) {
+      return player.platform ?? player;
+    }
+    return player;
+  }
+
+  /// Assigns the [budget] proportionally to the weights, raising each share to [kMinimumShare] & capping it at its maximum, redistributing the difference. The shares never add up to more than the [budget].
+  void _rebalance() {
+    final budget = _budget;
+    if (budget == null || _entries.isEmpty) {
+      return;
+    }
+    final shares = <_DemuxerCacheEntry, int>{};
+    final pending = <_DemuxerCacheEntry>[];
+    // Suspended players only keep their trimmed cache, scaled down if even that exceeds the budget.
+    final suspended = _entries.values.where((entry) => entry.suspended != null);
+    final trimmed = suspended.fold<int>(
+      0,
+      (sum, entry) => sum + entry.suspendedShare!,
+    );
+    for (final entry in suspended) {
+      shares[entry] = trimmed <= budget
+          ? entry.suspendedShare!
+          : entry.suspendedShare! * budget ~/ trimmed;
+    }
+    pending.addAll(_entries.values.where((entry) => entry.suspended == null));
+    var remaining = max(budget - min(trimmed, budget), 0);
+    final minimum = pending.isEmpty
+        ? 0
+        : min(kMinimumShare, remaining ~/ pending.length);
+    // Raising the shares below the minimum first keeps enough for the others' minimum.
+    var fixed = true;
+    while (fixed && pending.isNotEmpty) {
+      fixed = false;
+      final total = pending.fold(0.0, (sum, entry) => sum + entry.weight);
+      int shareOf(_DemuxerCacheEntry entry) =>
+          (remaining * entry.weight / total).floor();
+      final entry = pending.firstWhereOrNull(
+            (entry) => shareOf(entry) < min(minimum, entry.maximum),
+          ) ??
+          pending.firstWhereOrNull(
+            (entry) => shareOf(entry) >= entry.maximum,
+          );
+      if (entry != null) {
+        final share = min(max(shareOf(entry), minimum), entry.maximum);
+        shares[entry] = share;
+        remaining -= share;
+        pending.remove(entry);
+        fixed = true;
+      }
+    }
+    final total = pending.fold(0.0, (sum, entry) => sum + entry.weight);
+    for (final entry in pending) {
+      shares[entry] = (remaining * entry.weight / total).floor();
+    }
+    shares.forEach((entry, share) {
+      if (entry.share != share) {
+        entry.share = share;
+        _apply(entry, share);
+      }
+    });
+  }
+
+  void _apply(_DemuxerCacheEntry entry, int share) {
+    // Forward cache is more useful than back cache; 3:1 until the forward cache is full.
+    var forward = min((share * 3) ~/ 4, entry.maximum ~/ 2);
+    var back = min(share - forward, entry.maximum ~/ 2);
+    if (entry.suspended != null) {
+      forward = share;
+      back = 0;
+    }
+    unawaited(entry.apply(forward, back).catchError((_) {}));
+  }
+
+  int? _budget;
+  final Map<Object, _DemuxerCacheEntry> _entries = {};
+}
+
+/// {@template demuxer_cache_utilization}
+///
+/// DemuxerCacheUtilization
+/// -----------------------
+/// Utilization of the [DemuxerCacheGovernor.budget].
+///
+/// {@endtemplate}
+class DemuxerCacheUtilization {
+  /// Process-wide budget in bytes, `null` if the governor is disabled.
+  final int? budget;
+
+  /// Sum of the shares (or configured sizes) of all players in bytes.
+  final int assigned;
+
+  /// Sum of the bytes currently held in the demuxer caches of all players.
+  final int used;
+
+  /// Number of players.
+  final int players;
+
+  /// {@macro demuxer_cache_utilization}
+  const DemuxerCacheUtilization({
+    required this.budget,
+    required this.assigned,
+    required this.used,
+    required this.players,
+  });
+
+  @override
+  String toString() =>
+      'DemuxerCacheUtilization(budget: $budget, assigned: $assigned, used: $used, players: $players)';
+}
+
+class _DemuxerCacheEntry {
+  final int maximum;
+  final DemuxerCacheApply apply;
+  final DemuxerCacheUsage usage;
+  StreamSubscription<bool>? subscription;
+  bool playing = false;
+  bool visible = true;
+  int? share;
+
+  /// Requested cache size while the video output is suspended, `null` otherwise.
+  int? suspended;
+
+  _DemuxerCacheEntry(this.maximum, this.apply, this.usage);
+
+  /// Share while suspended: forward cache only, within the configured size.
+  int? get suspendedShare {
+    final bytes = suspended;
+    return bytes == null ? null : min(bytes, maximum ~/ 2);
+  }
+
+  double get weight =>
+      (playing ? DemuxerCacheGovernor.kPlayingWeight : 1.0) *
+      (visible ? 1.0 : DemuxerCacheGovernor.kHiddenWeight);
+}
@@ -6,6 +6,7 @@
 import 'dart:io';
 import 'dart:ffi';
 import 'dart:async';
+import 'dart:convert';
 import 'dart:collection';
 import 'dart:typed_data';
 import 'package:path/path.dart';
@@ -32,9 +33,11 @@ import 'package:media_kit/src/player/native/core/native_library.dart';
 import 'package:media_kit/src/player/native/utils/android_asset_loader.dart';
 import 'package:media_kit/src/player/native/utils/android_helper.dart';
 import 'package:media_kit/src/player/native/utils/isolates.dart';
+import 'package:media_kit/src/player/native/utils/native_arena.dart';
 import 'package:media_kit/src/player/native/utils/native_reference_holder.dart';
 import 'package:media_kit/src/player/native/utils/temp_file.dart';
 import 'package:media_kit/src/player/platform_player.dart';
+import 'package:media_kit/src/player/demuxer_cache_governor.dart';
 
 import 'package:media_kit/generated/libmpv/bindings.dart' as generated;
 
@@ -94,6 +97,7 @@ class NativePlayer extends PlatformPlayer {
       await waitForVideoControllerInitializationIfAttached;
 
       await NativeReferenceHolder.instance.remove(ctx);
+      DemuxerCacheGovernor.instance.unregister(this);
       await stop(notify: false, synchronized: false);
 
       disposed = true;
@@ -101,6 +105,7 @@ class NativePlayer extends PlatformPlayer {
       await super.dispose();
 
       Initializer(mpv).dispose(ctx);
+      _arena.release();
 
       Future.delayed(const Duration(seconds: 5), () {
         mpv.mpv_terminate_destroy(ctx);
@@ -738,20 +743,26 @@ class NativePlayer extends PlatformPlayer {
       switch (playlistMode) {
         case PlaylistMode.none:
           {
-            await _setPropertyString('loop-file', 'no');
-            await _setPropertyString('loop-playlist', 'no');
+            await _setProperties({
+              'loop-file': 'no',
+              'loop-playlist': 'no',
+            });
             break;
           }
         case PlaylistMode.single:
           {
-            await _setPropertyString('loop-file', 'yes');
-            await _setPropertyString('loop-playlist', 'no');
+            await _setProperties({
+              'loop-file': 'yes',
+              'loop-playlist': 'no',
+            });
             break;
           }
         case PlaylistMode.loop:
           {
-            await _setPropertyString('loop-file', 'no');
-            await _setPropertyString('loop-playlist', 'yes');
+            await _setProperties({
+              'loop-file': 'no',
+              'loop-playlist': 'yes',
+            });
             break;
           }
         default:
@@ -809,6 +820,8 @@ class NativePlayer extends PlatformPlayer {
         );
       }
 
+      await _setTrickPlay(rate);
+
       if (configuration.pitch) {
         // Pitch shift control is enabled.
 
@@ -819,10 +832,12 @@ class NativePlayer extends PlatformPlayer {
         // Apparently, using scaletempo:scale actually controls the playback rate as intended after setting audio-pitch-correction as FALSE.
         // speed on the other hand, changes the pitch when audio-pitch-correction is set to FALSE.
         // Since, it also alters the actual [speed], the scaletempo:scale is divided by the same value of [pitch] to compensate the speed change.
-        await _setPropertyFlag('audio-pitch-correction', false);
-        // Divide by [state.pitch] to compensate the speed change caused by pitch shift.
-        await _setPropertyString('af',
-            'scaletempo:scale=${(state.rate / state.pitch).toStringAsFixed(8)}');
+        await _setProperties({
+          'audio-pitch-correction': false,
+          // Divide by [state.pitch] to compensate the speed change caused by pitch shift.
+          'af':
+              'scaletempo:scale=${(state.rate / state.pitch).toStringAsFixed(8)}',
+        });
       } else {
         // Pitch shift control is disabled.
 
@@ -869,11 +884,13 @@ class NativePlayer extends PlatformPlayer {
         // Apparently, using scaletempo:scale actually controls the playback rate as intended after setting audio-pitch-correction as FALSE.
         // speed on the other hand, changes the pitch when audio-pitch-correction is set to FALSE.
         // Since, it also alters the actual [speed], the scaletempo:scale is divided by the same value of [pitch] to compensate the speed change.
-        await _setPropertyFlag('audio-pitch-correction', false);
-        await _setPropertyDouble('speed', pitch);
-        // Divide by [state.pitch] to compensate the speed change caused by pitch shift.
-        await _setPropertyString('af',
-            'scaletempo:scale=${(state.rate / state.pitch).toStringAsFixed(8)}');
+        await _setProperties({
+          'audio-pitch-correction': false,
+          'speed': pitch,
+          // Divide by [state.pitch] to compensate the speed change caused by pitch shift.
+          'af':
+              'scaletempo:scale=${(state.rate / state.pitch).toStringAsFixed(8)}',
+        });
       } else {
         // Pitch shift control is disabled.
         throw ArgumentError('[PlayerConfiguration.pitch] is false');
@@ -1006,6 +1023,12 @@ class NativePlayer extends PlatformPlayer {
             track.language ?? 'auto',
           ],
         );
+        if (_trickPlayRestore != null) {
+          // Selected upon leaving trick play.
+          _trickPlayRestore!['aid'] =
+              await getProperty('aid', waitForInitialization: false);
+          await _setPropertyString('aid', 'no');
+        }
         state = state.copyWith(
           track: state.track.copyWith(
             audio: track,
@@ -1015,7 +1038,12 @@ class NativePlayer extends PlatformPlayer {
           trackController.add(state.track);
         }
       } else {
-        await _setPropertyString('aid', track.id);
+        if (_trickPlayRestore != null) {
+          // Selected upon leaving trick play.
+          _trickPlayRestore!['aid'] = track.id;
+        } else {
+          await _setPropertyString('aid', track.id);
+        }
         state = state.copyWith(
           track: state.track.copyWith(
             audio: track,
@@ -1435,11 +1463,21 @@ class NativePlayer extends PlatformPlayer {
     }
     if (event.ref.event_id ==
         generated.mpv_event_id.MPV_EVENT_SET_PROPERTY_REPLY) {
-      final completer = _setPropertyRequests.remove(event.ref.reply_userdata);
+      final id = event.ref.reply_userdata;
+      final remaining = (_setPropertyBatchReplies.remove(id) ?? 1) - 1;
+      if (remaining > 0) {
+        // More replies to the same [_setProperties] batch are pending.
+        _setPropertyBatchReplies[id] = remaining;
+      }
+      final completer = remaining > 0
+          ? _setPropertyRequests[id]
+          : _setPropertyRequests.remove(id);
       if (completer == null) {
         print(
             'Warning: Received MPV_EVENT_SET_PROPERTY_REPLY with unregistered ID ${event.ref.reply_userdata}');
-      } else {
+      } else if (!completer.isCompleted &&
+          (remaining == 0 || event.ref.error < 0)) {
+        // A batch completes with its first error, if any.
         completer.complete(event.ref.error);
       }
     }
@@ -2428,18 +2466,35 @@ class NativePlayer extends PlatformPlayer {
           },
           'title': configuration.title,
           'demuxer-max-bytes': configuration.bufferSize.toString(),
-          'demuxer-max-back-bytes': configuration.bufferSize.toString(),
+          'demuxer-max-back-bytes': configuration.lowLatency
+              ? '0'
+              : configuration.bufferSize.toString(),
           if (configuration.vo != null) 'vo': '${configuration.vo}',
           'demuxer-lavf-o': [
             'seg_max_retry=5',
             'strict=experimental',
             'allowed_extensions=ALL',
             'hls_ad_filter=${configuration.adBlocker ? 1 : 0}',
-            'protocol_whitelist=[${configuration.protocolWhitelist.join(',')}]'
+            'protocol_whitelist=[${configuration.protocolWhitelist.join(',')}]',
+            if (configuration.lowLatency) 'fflags=+nobuffer',
           ].join(','),
           'sub-ass': configuration.libass ? 'yes' : 'no',
           'sub-visibility': configuration.libass ? 'yes' : 'no',
           'secondary-sub-visibility': configuration.libass ? 'yes' : 'no',
+          // mpv's `low-latency` profile, spelled out: set in the same [_setProperties] batch as the rest, in order.
+          if (configuration.lowLatency) ...{
+            'audio-buffer': '0',
+            'vd-lavc-threads': '1',
+            'cache': 'no',
+            'cache-pause': 'no',
+            'demuxer-lavf-probe-info': 'nostreams',
+            'demuxer-lavf-analyzeduration': '0.1',
+            'demuxer-readahead-secs': '0',
+            'interpolation': 'no',
+            'video-latency-hacks': 'yes',
+            'stream-buffer-size': '4k',
+            'untimed': 'yes',
+          },
         },
       );
 
@@ -2448,12 +2503,12 @@ class NativePlayer extends PlatformPlayer {
         properties['ao'] = 'null';
       }
 
-      await Future.wait(properties.entries
-          .map((entry) => _setPropertyString(entry.key, entry.value)));
+      await _setProperties({
+        ...properties,
+        if (configuration.muted) 'volume': 0.0,
+      });
 
       if (configuration.muted) {
-        await _setPropertyDouble('volume', 0);
-
         state = state.copyWith(volume: 0.0);
         if (!volumeController.isClosed) {
           volumeController.add(0.0);
@@ -2521,10 +2576,75 @@ class NativePlayer extends PlatformPlayer {
       calloc.free(load);
       calloc.free(unload);
 
+      DemuxerCacheGovernor.instance.register(
+        this,
+        maximum: configuration.bufferSize * 2,
+        playing: stream.playing,
+        apply: (forward, back) async {
+          if (disposed) {
+            return;
+          }
+          await _setProperties({
+            'demuxer-max-bytes': forward.toString(),
+            'demuxer-max-back-bytes':
+                configuration.lowLatency ? '0' : back.toString(),
+          });
+        },
+        usage: () async {
+          if (disposed) {
+            return 0;
+          }
+          final state = await getProperty(
+            'demuxer-cache-state',
+            waitForInitialization: false,
+          );
+          if (state.isEmpty) {
+            return 0;
+          }
+          // Node properties are returned as JSON.
+          final value = json.decode(state);
+          return value is Map ? (value['total-bytes'] as num? ?? 0).toInt() : 0;
+        },
+      );
+
       await NativeReferenceHolder.instance.add(ctx);
     });
   }
 
+  /// Enters or leaves trick play for playback [rate], see [PlayerConfiguration.trickPlayRate].
+  Future<void> _setTrickPlay(double rate) async {
+    final threshold = configuration.trickPlayRate;
+    final enabled = threshold != null && rate >= threshold;
+    if (enabled == (_trickPlayRestore != null)) {
+      return;
+    }
+    if (enabled) {
+      final overrides = <String, String>{
+        // Decode keyframes only.
+        'vd-lavc-skipframe': 'nonkey',
+        // Drop late frames before decoding them too, not only before display.
+        'framedrop': 'decoder+vo',
+        // Do not decode audio at all.
+        'aid': 'no',
+      };
+      final restore = <String, String>{};
+      for (final name in overrides.keys) {
+        final value = await getProperty(name, waitForInitialization: false);
+        if (value.isNotEmpty) {
+          restore[name] = value;
+        }
+      }
+      _trickPlayRestore = restore;
+      await _setProperties(overrides);
+    } else {
+      final restore = _trickPlayRestore!;
+      _trickPlayRestore = null;
+      if (restore.isNotEmpty) {
+        await _setProperties(restore);
+      }
+    }
+  }
+
   /// Adds an error to the [Player.stream.error].
   void _logError(int code, String? text) {
     if (code < 0 && !logController.isClosed) {
@@ -2543,11 +2663,22 @@ class NativePlayer extends PlatformPlayer {
   final Map<int, Completer<int>> _setPropertyRequests = {};
   final Map<int, Completer<int>> _commandRequests = {};
 
+  /// Number of pending replies to the [_setProperties] batches in [_setPropertyRequests].
+  final Map<int, int> _setPropertyBatchReplies = {};
+
+  /// Values of the properties overridden by [_setTrickPlay], restored upon leaving trick play. `null` outside trick play.
+  Map<String, String>? _trickPlayRestore;
+
+  /// Scratch memory for the arguments of [_setProperty] & [_command].
+  /// libmpv copies them before returning, so it is reset right after each call.
+  final NativeArena _arena = NativeArena();
+
+  /// Sets property [name] to [data], which must be allocated from [_arena].
   Future<void> _setProperty(String name, int format, Pointer<Void> data) async {
-    final requestNumber = _asyncRequestNumber++;
-    final completer = _setPropertyRequests[requestNumber] = Completer<int>();
-    final namePtr = name.toNativeUtf8();
+    final namePtr = _arena.toNativeUtf8(name);
     if (configuration.async) {
+      final requestNumber = _asyncRequestNumber++;
+      final completer = _setPropertyRequests[requestNumber] = Completer<int>();
       final immediate = mpv.mpv_set_property_async(
         ctx,
         requestNumber,
@@ -2555,9 +2686,11 @@ class NativePlayer extends PlatformPlayer {
         format,
         data,
       );
+      _arena.reset();
       final text = '_setProperty($name, $format)';
       if (immediate < 0) {
         // Sending failed.
+        _setPropertyRequests.remove(requestNumber);
         _logError(immediate, text);
         return;
       }
@@ -2569,78 +2702,141 @@ class NativePlayer extends PlatformPlayer {
         format,
         data,
       );
+      _arena.reset();
     }
-    calloc.free(namePtr);
   }
 
-  Future<void> _setPropertyFlag(String name, bool value) async {
-    final ptr = calloc<Bool>(1)..value = value;
-    await _setProperty(
+  Future<void> _setPropertyFlag(String name, bool value) {
+    return _setProperty(
       name,
       generated.mpv_format.MPV_FORMAT_FLAG,
-      ptr.cast(),
+      // API requires int; the arena is not zeroed.
+      (_arena<Int32>()..value = value ? 1 : 0).cast(),
     );
-    calloc.free(ptr);
   }
 
-  Future<void> _setPropertyDouble(String name, double value) async {
-    final ptr = calloc<Double>(1)..value = value;
-    await _setProperty(
+  Future<void> _setPropertyDouble(String name, double value) {
+    return _setProperty(
       name,
       generated.mpv_format.MPV_FORMAT_DOUBLE,
-      ptr.cast(),
+      (_arena<Double>()..value = value).cast(),
     );
-    calloc.free(ptr);
   }
 
-  Future<void> _setPropertyInt64(String name, int value) async {
-    final ptr = calloc<Int64>(1)..value = value;
-    await _setProperty(
+  Future<void> _setPropertyInt64(String name, int value) {
+    return _setProperty(
       name,
       generated.mpv_format.MPV_FORMAT_INT64,
-      ptr.cast(),
+      (_arena<Int64>()..value = value).cast(),
     );
-    calloc.free(ptr);
   }
 
-  Future<void> _setPropertyString(String name, String value) async {
-    final string = value.toNativeUtf8();
+  Future<void> _setPropertyString(String name, String value) {
     // API requires char**.
-    final ptr = calloc<Pointer<Void>>(1);
-    ptr.value = Pointer.fromAddress(string.address);
-    await _setProperty(
+    final string = _arena.toNativeUtf8(value);
+    return _setProperty(
       name,
       generated.mpv_format.MPV_FORMAT_STRING,
-      ptr.cast(),
+      (_arena<Pointer<Utf8>>()..value = string).cast(),
     );
-    calloc.free(ptr);
-    calloc.free(string);
   }
 
-  Future<void> _command(List<String> args) async {
-    final pointers = args.map<Pointer<Utf8>>((e) => e.toNativeUtf8()).toList();
-    final arr = calloc<Pointer<Utf8>>(128);
-    for (int i = 0; i < args.length; i++) {
-      (arr + i).value = pointers[i];
+  /// Sets all [properties] in one go. The values may be [bool], [int], [double] or [String].
+  ///
+  /// The values are marshaled together & submitted back to back under a single request number, so the returned [Future] completes after one round trip to the mpv core instead of one per property.
+  /// libmpv applies the asynchronous requests of a client in order.
+  Future<void> _setProperties(Map<String, Object> properties) async {
+    final names = <Pointer<Utf8>>[];
+    final formats = <int>[];
+    final values = <Pointer<Void>>[];
+    try {
+      for (final entry in properties.entries) {
+        final value = entry.value;
+        if (value is bool) {
+          formats.add(generated.mpv_format.MPV_FORMAT_FLAG);
+          values.add((_arena<Int32>()..value = value ? 1 : 0).cast());
+        } else if (value is int) {
+          formats.add(generated.mpv_format.MPV_FORMAT_INT64);
+          values.add((_arena<Int64>()..value = value).cast());
+        } else if (value is double) {
+          formats.add(generated.mpv_format.MPV_FORMAT_DOUBLE);
+          values.add((_arena<Double>()..value = value).cast());
+        } else if (value is String) {
+          // API requires char**.
+          final string = _arena.toNativeUtf8(value);
+          formats.add(generated.mpv_format.MPV_FORMAT_STRING);
+          values.add((_arena<Pointer<Utf8>>()..value = string).cast());
+        } else {
+          throw ArgumentError.value(value, entry.key, 'Unsupported type');
+        }
+        names.add(_arena.toNativeUtf8(entry.key));
+      }
+    } catch (_) {
+      _arena.reset();
+      rethrow;
     }
 
+    final requestNumber = _asyncRequestNumber++;
+    int submitted = 0;
+    for (int i = 0; i < names.length; i++) {
+      if (configuration.async) {
+        final immediate = mpv.mpv_set_property_async(
+          ctx,
+          requestNumber,
+          names[i].cast(),
+          formats[i],
+          values[i],
+        );
+        if (immediate < 0) {
+          // Sending failed.
+          _logError(immediate, '_setProperties(${names[i].toDartString()})');
+        } else {
+          submitted++;
+        }
+      } else {
+        mpv.mpv_set_property(
+          ctx,
+          names[i].cast(),
+          formats[i],
+          values[i],
+        );
+      }
+    }
+    _arena.reset();
+
+    if (submitted == 0) {
+      return;
+    }
+    // Replies are handled from the event loop, after the registration.
+    final completer = _setPropertyRequests[requestNumber] = Completer<int>();
+    if (submitted > 1) {
+      _setPropertyBatchReplies[requestNumber] = submitted;
+    }
+    _logError(
+      await completer.future,
+      '_setProperties(${properties.keys.join(', ')})',
+    );
+  }
+
+  Future<void> _command(List<String> args) async {
+    final arr = _arena.toNativeUtf8Array(args);
     if (configuration.async) {
       final requestNumber = _asyncRequestNumber++;
       final completer = _commandRequests[requestNumber] = Completer<int>();
       final immediate = mpv.mpv_command_async(ctx, requestNumber, arr.cast());
+      _arena.reset();
       final text = '_command(${args.join(', ')})';
       if (immediate < 0) {
         // Sending failed.
+        _commandRequests.remove(requestNumber);
         _logError(immediate, text);
         return;
       }
       _logError(await completer.future, text);
     } else {
       mpv.mpv_command(ctx, arr.cast());
+      _arena.reset();
     }
-
-    calloc.free(arr);
-    pointers.forEach(calloc.free);
   }
 
   /// Generated libmpv C API bindings.
@@ -0,0 +1,132 @@
+/// This file is a part of media_kit (https://github.com/media-kit/media-kit).
+///
+/// Copyright © 2026 & onwards, Predidit.
+/// All rights reserved.
+/// Use of this source code is governed by MIT license that can be found in the LICENSE file.
+import 'dart:ffi';
+import 'dart:convert';
+import 'dart:typed_data';
+
+import 'package:media_kit/ffi/src/allocation.dart';
+import 'package:media_kit/ffi/src/utf8.dart';
+
+/// {@template native_arena}
+///
+/// NativeArena
+/// -----------
+/// A reusable bump allocator for marshaling the arguments of libmpv calls.
+///
+/// Allocations are carved out of a single native buffer & released all at once by [reset], instead of a `calloc` + `free` per argument.
+/// libmpv copies the arguments of `mpv_command_async`, `mpv_set_property_async` & their synchronous variants before returning, so the arena may be [reset] right after the call, without waiting for the reply.
+///
+/// Not thread-safe. Dart isolates are single-threaded, so each [NativeArena] belongs to the isolate that created it.
+///
+/// {@endtemplate}
+class NativeArena implements Allocator {
+  /// Default capacity of the buffer, in bytes. Enough for any usual command.
+  static const int kDefaultCapacity = 4096;
+
+  /// {@macro native_arena}
+  NativeArena([this._capacity = kDefaultCapacity]);
+
+  /// Current capacity of the buffer, in bytes.
+  int get capacity => _capacity;
+
+  /// Number of bytes allocated since the last [reset].
+  int get used => _offset;
+
+  /// Allocates [byteCount] bytes, aligned to [alignment] (defaults to 8) bytes.
+  ///
+  /// The memory is valid until the next [reset] & is NOT zero-initialized.
+  @override
+  Pointer<T> allocate<T extends NativeType>(int byteCount, {int? alignment}) {
+    final mask = (alignment ?? 8) - 1;
+    int offset = (_offset + mask) & ~mask;
+    if (_buffer == nullptr || offset + byteCount > _capacity) {
+      _grow(byteCount + mask);
+      offset = (_offset + mask) & ~mask;
+    }
+    _offset = offset + byteCount;
+    return Pointer<T>.fromAddress(_buffer.address + offset);
+  }
+
+  /// No-op: memory is released by [reset].
+  @override
+  void free(Pointer pointer) {}
+
+  /// Writes [value] as a NUL-terminated UTF-8 string.
+  Pointer<Utf8> toNativeUtf8(String value) {
+    final units = value.codeUnits;
+    final length = units.length;
+    // Fast path: ASCII is copied as is, without an intermediate [Uint8List].
+    final result = allocate<Uint8>(length + 1, alignment: 1);
+    final start = result.address - _buffer.address;
+    for (int i = 0; i < length; i++) {
+      final unit = units[i];
+      if (unit >= 0x80) {
+        // Slow path: give back the allocation & encode.
+        _offset = start;
+        final bytes = utf8.encode(value);
+        final encoded = allocate<Uint8>(bytes.length + 1, alignment: 1);
+        final offset = encoded.address - _buffer.address;
+        _bytes.setRange(offset, offset + bytes.length, bytes);
+        _bytes[offset + bytes.length] = 0;
+        return encoded.cast();
+      }
+      _bytes[start + i] = unit;
+    }
+    _bytes[start + length] = 0;
+    return result.cast();
+  }
+
+  /// Writes [values] as a NULL-terminated array of NUL-terminated UTF-8 strings i.e. `const char**` expected by `mpv_command`.
+  Pointer<Pointer<Utf8>> toNativeUtf8Array(List<String> values) {
+    final result = allocate<Pointer<Utf8>>(
+      (values.length + 1) * sizeOf<Pointer>(),
+      alignment: sizeOf<Pointer>(),
+    );
+    for (int i = 0; i < values.length; i++) {
+      result[i] = toNativeUtf8(values[i]);
+    }
+    result[values.length] = nullptr;
+    return result;
+  }
+
+  /// Releases all allocations. Buffers retired by a growth are freed; the largest one is kept for reuse.
+  void reset() {
+    _offset = 0;
+    for (final buffer in _retired) {
+      calloc.free(buffer);
+    }
+    _retired.clear();
+  }
+
+  /// Frees the native memory. The [NativeArena] may still be used afterwards, it allocates a new buffer lazily.
+  void release() {
+    reset();
+    if (_buffer != nullptr) {
+      calloc.free(_buffer);
+      _buffer = nullptr;
+    }
+  }
+
+  void _grow(int minimum) {
+    if (_buffer != nullptr) {
+      // Pointers handed out since the last [reset] must remain valid.
+      _retired.add(_buffer);
+      _capacity *= 2;
+    }
+    while (_capacity < minimum) {
+      _capacity *= 2;
+    }
+    _buffer = calloc<Uint8>(_capacity);
+    _bytes = _buffer.asTypedList(_capacity);
+    _offset = 0;
+  }
+
+  int _capacity;
+  int _offset = 0;
+  Pointer<Uint8> _buffer = nullptr;
+  Uint8List _bytes = Uint8List(0);
+  final List<Pointer<Uint8>> _retired = [];
+}
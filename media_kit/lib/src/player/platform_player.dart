@@ -528,6 +528,22 @@ class PlayerConfiguration {
   /// When set to `true`, `hls_ad_filter=1` is passed to disable ads.
   final bool adBlocker;
 
+  /// Whether to minimize latency for live sources e.g. camera feeds, at the expense of smoothness & resilience to network jitter.
+  ///
+  /// Applies the options of mpv's `low-latency` profile, renders video untimed (each frame is displayed as soon as it is decoded) & disables the demuxer cache & read-ahead.
+  /// On GNU/Linux, video frames are also published without waiting for their display time. Not suitable for regular (non-live) playback.
+  ///
+  /// Default: `false`.
+  final bool lowLatency;
+
+  /// Playback rate at & above which [Player] switches to trick play e.g. for reviewing surveillance footage at `16×` or `32×`.
+  ///
+  /// In trick play, only keyframes are decoded, late frames are also dropped by the decoder & audio is not decoded at all. On GNU/Linux, video frames are also rendered at most at the display refresh rate.
+  /// Normal decoding (& the selected audio track) is restored once the rate is set below it again.
+  ///
+  /// Default: `null` (disabled).
+  final double? trickPlayRate;
+
   /// {@macro player_configuration}
   const PlayerConfiguration({
     this.vo = 'null',
@@ -555,6 +571,8 @@ class PlayerConfiguration {
       'crypto',
     ],
     this.adBlocker = false,
+    this.lowLatency = false,
+    this.trickPlayRate,
   });
 }
 
@@ -0,0 +1,189 @@
+/// This file is a part of media_kit (https://github.com/media-kit/media-kit).
+///
+/// Copyright © 2026 & onwards, Predidit.
+/// All rights reserved.
+/// Use of this source code is governed by MIT license that can be found in the LICENSE file.
+import 'dart:async';
+import 'package:test/test.dart';
+
+import 'package:media_kit/src/player/demuxer_cache_governor.dart';
+
+const kMiB = 1024 * 1024;
+
+class FakePlayer {
+  final playing = StreamController<bool>.broadcast();
+  int forward = 0;
+  int back = 0;
+
+  void register(DemuxerCacheGovernor governor, {int maximum = 64 * kMiB}) {
+    governor.register(
+      this,
+      maximum: maximum,
+      playing: playing.stream,
+      apply: (forward, back) async {
+        this.forward = forward;
+        this.back = back;
+      },
+      usage: () async => forward ~/ 2,
+    );
+  }
+}
+
+void main() {
+  test(
+    'demuxer-cache-governor-disabled',
+    () {
+      final governor = DemuxerCacheGovernor.create();
+      final player = FakePlayer()..register(governor);
+      expect(governor.shareOf(player), isNull);
+      expect(player.forward, equals(0));
+    },
+  );
+  test(
+    'demuxer-cache-governor-equal-shares',
+    () {
+      final governor = DemuxerCacheGovernor.create();
+      final players = List.generate(4, (_) => FakePlayer());
+      for (final player in players) {
+        player.register(governor);
+      }
+      governor.budget = 64 * kMiB;
+      for (final player in players) {
+        expect(governor.shareOf(player), equals(16 * kMiB));
+        expect(player.forward, equals(12 * kMiB));
+        expect(player.back, equals(4 * kMiB));
+      }
+    },
+  );
+  test(
+    'demuxer-cache-governor-bounded-regardless-of-player-count',
+    () {
+      final governor = DemuxerCacheGovernor.create();
+      governor.budget = 64 * kMiB;
+      final players = List.generate(100, (_) => FakePlayer());
+      for (final player in players) {
+        player.register(governor);
+      }
+      final total = players.fold<int>(
+        0,
+        (sum, player) => sum + governor.shareOf(player)!,
+      );
+      expect(total, lessThanOrEqualTo(64 * kMiB));
+    },
+  );
+  test(
+    'demuxer-cache-governor-weights',
+    () async {
+      final governor = DemuxerCacheGovernor.create();
+      governor.budget = 60 * kMiB;
+      final playing = FakePlayer()..register(governor);
+      final paused = FakePlayer()..register(governor);
+      final hidden = FakePlayer()..register(governor);
+      governor.setVisible(hidden, false);
+      playing.playing.add(true);
+      await Future.delayed(Duration.zero);
+      // Weights: 4 : 1 : 0.25.
+      expect(governor.shareOf(playing), greaterThan(governor.shareOf(paused)!));
+      expect(governor.shareOf(paused), greaterThan(governor.shareOf(hidden)!));
+      expect(
+        governor.shareOf(playing)! +
+            governor.shareOf(paused)! +
+            governor.shareOf(hidden)!,
+        lessThanOrEqualTo(60 * kMiB),
+      );
+    },
+  );
+  test(
+    'demuxer-cache-governor-maximum-redistributed',
+    () {
+      final governor = DemuxerCacheGovernor.create();
+      governor.budget = 100 * kMiB;
+      final small = FakePlayer()..register(governor, maximum: 10 * kMiB);
+      final large = FakePlayer()..register(governor, maximum: 200 * kMiB);
+      expect(governor.shareOf(small), equals(10 * kMiB));
+      expect(governor.shareOf(large), equals(90 * kMiB));
+      // Never more than configured per direction.
+      expect(small.forward, equals(5 * kMiB));
+      expect(small.back, equals(5 * kMiB));
+    },
+  );
+  test(
+    'demuxer-cache-governor-rebalance-on-unregister',
+    () async {
+      final governor = DemuxerCacheGovernor.create();
+      governor.budget = 32 * kMiB;
+      final a = FakePlayer()..register(governor);
+      final b = FakePlayer()..register(governor);
+      expect(governor.shareOf(a), equals(16 * kMiB));
+      governor.unregister(b);
+      expect(governor.shareOf(a), equals(32 * kMiB));
+      final utilization = await governor.utilization();
+      expect(utilization.players, equals(1));
+      expect(utilization.assigned, equals(32 * kMiB));
+      expect(utilization.used, equals(12 * kMiB));
+    },
+  );
+  test(
+    'demuxer-cache-governor-disable-restores-configuration',
+    () {
+      final governor = DemuxerCacheGovernor.create();
+      governor.budget = 8 * kMiB;
+      final player = FakePlayer()..register(governor, maximum: 64 * kMiB);
+      governor.budget = null;
+      expect(governor.shareOf(player), isNull);
+      expect(player.forward, equals(32 * kMiB));
+      expect(player.back, equals(32 * kMiB));
+    },
+  );
+  test(
+    'demuxer-cache-governor-minimum-within-budget',
+    () async {
+      final governor = DemuxerCacheGovernor.create();
+      governor.budget = 4 * kMiB;
+      final playing = FakePlayer()..register(governor);
+      final hidden = List.generate(4, (_) => FakePlayer()..register(governor));
+      for (final player in hidden) {
+        governor.setVisible(player, false);
+      }
+      playing.playing.add(true);
+      await Future.delayed(Duration.zero);
+      // Proportionally, the hidden players would get less than the minimum.
+      for (final player in hidden) {
+        expect(
+          governor.shareOf(player),
+          equals(DemuxerCacheGovernor.kMinimumShare),
+        );
+      }
+      final total = [playing, ...hidden].fold<int>(
+        0,
+        (sum, player) => sum + governor.shareOf(player)!,
+      );
+      expect(total, lessThanOrEqualTo(4 * kMiB));
+      expect(governor.shareOf(playing), equals(2 * kMiB));
+    },
+  );
+  test(
+    'demuxer-cache-governor-suspended',
+    () {
+      final governor = DemuxerCacheGovernor.create();
+      final suspended = FakePlayer()..register(governor);
+      final other = FakePlayer()..register(governor);
+      // Trimmed while the governor is disabled too.
+      governor.setSuspended(suspended, true, cacheBytes: 4 * kMiB);
+      expect(suspended.forward, equals(4 * kMiB));
+      expect(suspended.back, equals(0));
+      governor.budget = 64 * kMiB;
+      expect(governor.shareOf(suspended), equals(4 * kMiB));
+      expect(suspended.forward, equals(4 * kMiB));
+      expect(suspended.back, equals(0));
+      expect(governor.shareOf(other), equals(60 * kMiB));
+      governor.setSuspended(suspended, false);
+      expect(governor.shareOf(suspended), equals(32 * kMiB));
+      expect(suspended.forward, equals(24 * kMiB));
+      expect(suspended.back, equals(8 * kMiB));
+      governor.budget = null;
+      expect(suspended.forward, equals(32 * kMiB));
+      expect(suspended.back, equals(32 * kMiB));
+    },
+  );
+}
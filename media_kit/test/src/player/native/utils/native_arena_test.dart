@@ -0,0 +1,77 @@
+import 'dart:ffi';
+import 'package:test/test.dart';
+
+import 'package:media_kit/ffi/ffi.dart';
+import 'package:media_kit/src/player/native/utils/native_arena.dart';
+
+void main() {
+  test(
+    'native-arena-utf8',
+    () {
+      final arena = NativeArena();
+      expect(arena.toNativeUtf8('').toDartString(), equals(''));
+      expect(arena.toNativeUtf8('seek').toDartString(), equals('seek'));
+      // Non ASCII characters.
+      final string = arena.toNativeUtf8('audios/う.wav');
+      expect(string.length, equals(14));
+      expect(string.toDartString(), equals('audios/う.wav'));
+      arena.release();
+    },
+  );
+  test(
+    'native-arena-utf8-array',
+    () {
+      final arena = NativeArena();
+      final args = ['loadfile', 'https://example.com/ビデオ.mp4', 'append'];
+      final arr = arena.toNativeUtf8Array(args);
+      expect(arr.address % sizeOf<Pointer>(), equals(0));
+      for (int i = 0; i < args.length; i++) {
+        expect(arr[i].toDartString(), equals(args[i]));
+      }
+      expect(arr[args.length], equals(nullptr));
+      arena.release();
+    },
+  );
+  test(
+    'native-arena-alignment',
+    () {
+      final arena = NativeArena();
+      arena.toNativeUtf8('a');
+      final value = arena<Int64>()..value = -1;
+      expect(value.address % 8, equals(0));
+      expect(value.value, equals(-1));
+      arena.release();
+    },
+  );
+  test(
+    'native-arena-reset',
+    () {
+      final arena = NativeArena();
+      final first = arena.toNativeUtf8('pause');
+      expect(arena.used, greaterThan(0));
+      arena.reset();
+      expect(arena.used, equals(0));
+      final second = arena.toNativeUtf8('volume');
+      expect(second.address, equals(first.address));
+      arena.release();
+    },
+  );
+  test(
+    'native-arena-grow',
+    () {
+      final arena = NativeArena(16);
+      final first = arena.toNativeUtf8('playlist-pos');
+      final long = 'x' * 1000;
+      final second = arena.toNativeUtf8(long);
+      expect(arena.capacity, greaterThanOrEqualTo(1001));
+      // Allocations made before the growth remain valid until [reset].
+      expect(first.toDartString(), equals('playlist-pos'));
+      expect(second.toDartString(), equals(long));
+      arena.reset();
+      final capacity = arena.capacity;
+      arena.toNativeUtf8(long);
+      expect(arena.capacity, equals(capacity));
+      arena.release();
+    },
+  );
+}
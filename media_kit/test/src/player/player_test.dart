@@ -1335,6 +1335,32 @@ void main() {
       addTearDown(player.dispose);
     },
   );
+  test(
+    'player-trick-play',
+    () async {
+      final player = Player(
+        configuration: const PlayerConfiguration(trickPlayRate: 4.0),
+      );
+      final native = player.platform as NativePlayer;
+
+      await player.setRate(2.0);
+      expect(await native.getProperty('vd-lavc-skipframe'), equals('default'));
+
+      final aid = await native.getProperty('aid');
+      await player.setRate(32.0);
+      expect(await native.getProperty('vd-lavc-skipframe'), equals('nonkey'));
+      expect(await native.getProperty('framedrop'), equals('decoder+vo'));
+      expect(await native.getProperty('aid'), equals('no'));
+
+      await player.setRate(1.0);
+      expect(await native.getProperty('vd-lavc-skipframe'), equals('default'));
+      expect(await native.getProperty('framedrop'), equals('vo'));
+      expect(await native.getProperty('aid'), equals(aid));
+
+      addTearDown(player.dispose);
+    },
+    skip: UniversalPlatform.isWeb,
+  );
   test(
     'player-set-pitch-disabled',
     () async {
@@ -6,9 +6,18 @@
 
 export 'package:media_kit_video/src/video_controller/platform_video_controller.dart';
 export 'package:media_kit_video/src/video_controller/video_controller.dart';
+export 'package:media_kit_video/src/video_controller/native_allocator_stats.dart';
+export 'package:media_kit_video/src/video_controller/video_memory_usage.dart';
+export 'package:media_kit_video/src/video_controller/video_visibility.dart';
 export 'package:media_kit_video/src/video_view_parameters.dart';
 export 'package:media_kit_video/src/video/video.dart';
 
 export 'package:media_kit_video/src/subtitle/subtitle_view.dart';
+export 'package:media_kit_video/src/subtitle/subtitle_index/subtitle_index.dart';
+export 'package:media_kit_video/src/keyframe_index/keyframe_index.dart';
+export 'package:media_kit_video/src/frame_tap/frame_tap.dart';
+export 'package:media_kit_video/src/remote_player/remote_player.dart';
+export 'package:media_kit_video/src/http_cache/http_cache.dart';
+export 'package:media_kit_video/src/thumbnail_store/thumbnail_store.dart';
 
 export 'package:media_kit_video/media_kit_video_controls/media_kit_video_controls.dart';
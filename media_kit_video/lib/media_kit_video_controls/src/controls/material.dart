@@ -1328,7 +1328,7 @@ class MaterialSeekBarState extends State<MaterialSeekBar> {
       tapped = true;
       slider = percent.clamp(0.0, 1.0);
     });
-    controller(context).player.seek(duration * slider);
+    controller(context).scrub(duration * slider);
   }
 
   void onPointerDown() {
@@ -1345,7 +1345,7 @@ class MaterialSeekBarState extends State<MaterialSeekBar> {
       tapped = false;
       position = duration * slider;
     });
-    controller(context).player.seek(duration * slider);
+    controller(context).endScrub(duration * slider);
   }
 
   void onPanStart(DragStartDetails e, BoxConstraints constraints) {
@@ -955,7 +955,7 @@ class MaterialDesktopSeekBarState extends State<MaterialDesktopSeekBar> {
       hover = true;
       slider = percent.clamp(0.0, 1.0);
     });
-    controller(context).player.seek(duration * slider);
+    controller(context).scrub(duration * slider);
   }
 
   void onPointerDown() {
@@ -972,7 +972,7 @@ class MaterialDesktopSeekBarState extends State<MaterialDesktopSeekBar> {
       click = false;
       position = duration * slider;
     });
-    controller(context).player.seek(duration * slider);
+    controller(context).endScrub(duration * slider);
   }
 
   void onHover(PointerHoverEvent e, BoxConstraints constraints) {
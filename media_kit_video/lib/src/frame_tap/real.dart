@@ -0,0 +1,176 @@
+/// This file is a part of media_kit (https://github.com/media-kit/media-kit).
+///
+/// Copyright © 2026 & onwards, Predidit.
+/// All rights reserved.
+/// Use of this source code is governed by MIT license that can be found in the LICENSE file.
+import 'dart:io';
+import 'dart:ffi';
+import 'dart:typed_data';
+
+/// Pixel format of the frames of a [FrameTap].
+///
+/// The YUV formats are BT.601 limited range, with 4:2:0 chroma averaged over 2x2 pixels.
+enum FrameTapFormat {
+  /// A single plane, 4 bytes per pixel. Alpha is always 255.
+  rgba,
+
+  /// A Y plane & an interleaved UV plane.
+  nv12,
+
+  /// Y, U & V planes.
+  i420,
+}
+
+/// Mirrors the native `FrameTapFrame`.
+final class _FrameTapFrame extends Struct {
+  @Array(3)
+  external Array<Pointer<Uint8>> planes;
+  @Array(3)
+  external Array<Int32> strides;
+  @Int32()
+  external int width;
+  @Int32()
+  external int height;
+  @Int32()
+  external int format;
+  @Int32()
+  external int index;
+  @Int64()
+  external int time;
+  @Uint64()
+  external int sequence;
+}
+
+typedef _AcquireNative = Pointer<_FrameTapFrame> Function(Pointer<Void>);
+typedef _AcquireDart = Pointer<_FrameTapFrame> Function(Pointer<Void>);
+typedef _ReleaseNative = Void Function(Pointer<Void>, Pointer<_FrameTapFrame>);
+typedef _ReleaseDart = void Function(Pointer<Void>, Pointer<_FrameTapFrame>);
+typedef _GetCountNative = Uint64 Function(Pointer<Void>);
+typedef _GetCountDart = int Function(Pointer<Void>);
+
+/// {@template frame_tap_frame}
+///
+/// FrameTapFrame
+/// -------------
+///
+/// A frame acquired from a [FrameTap]. Its planes are views of the tap's native buffer, without any copy; they are valid until [FrameTap.release].
+///
+/// {@endtemplate}
+class FrameTapFrame {
+  /// {@macro frame_tap_frame}
+  FrameTapFrame._(this._frame)
+      : width = _frame.ref.width,
+        height = _frame.ref.height,
+        format = FrameTapFormat.values[_frame.ref.format],
+        time = Duration(microseconds: _frame.ref.time),
+        sequence = _frame.ref.sequence;
+
+  /// Width of the frame, in pixels.
+  final int width;
+
+  /// Height of the frame, in pixels.
+  final int height;
+
+  /// Pixel format of the frame.
+  final FrameTapFormat format;
+
+  /// Monotonic time the frame was rendered at.
+  final Duration time;
+
+  /// Number of the frame among the frames tapped. Gaps are frames dropped because the consumer was too slow.
+  final int sequence;
+
+  /// Number of planes of [format].
+  int get planeCount => const [1, 2, 3][format.index];
+
+  /// Bytes per row of the plane at [index].
+  int stride(int index) {
+    RangeError.checkValidIndex(index, null, 'index', planeCount);
+    return _frame.ref.strides[index];
+  }
+
+  /// Native address of the plane at [index] e.g. for passing to a computer vision library through `dart:ffi`.
+  int planeAddress(int index) {
+    RangeError.checkValidIndex(index, null, 'index', planeCount);
+    return _frame.ref.planes[index].address;
+  }
+
+  /// View of the plane at [index].
+  Uint8List plane(int index) {
+    RangeError.checkValidIndex(index, null, 'index', planeCount);
+    final rows = index == 0 || format == FrameTapFormat.rgba
+        ? height
+        : height ~/ 2;
+    return _frame.ref.planes[index].asTypedList(stride(index) * rows);
+  }
+
+  final Pointer<_FrameTapFrame> _frame;
+}
+
+/// {@template frame_tap}
+///
+/// FrameTap
+/// --------
+///
+/// Copies the frames rendered by a video output into a small pool of native buffers, at a limited rate & resolution, for consumers such as computer vision. Created by `NativeVideoController.createFrameTap`.
+///
+/// Rendering never waits for the consumer: while it holds every buffer, the frames are dropped (see [dropped]). Buffers are reused, so steady-state tapping does not allocate.
+///
+/// Currently only supported on GNU/Linux.
+///
+/// {@endtemplate}
+class FrameTap {
+  /// Whether [FrameTap] is supported on the current platform or not.
+  static bool get supported => Platform.isLinux;
+
+  /// {@macro frame_tap}
+  FrameTap(int address, this._onDispose) : _handle = Pointer.fromAddress(address);
+
+  /// Returns the latest frame since the previous call, or `null`. Must be passed to [release] once consumed.
+  FrameTapFrame? acquire() {
+    if (_disposed) {
+      return null;
+    }
+    final frame = _acquire(_handle);
+    return frame == nullptr ? null : FrameTapFrame._(frame);
+  }
+
+  /// Returns the buffer of [frame] to the pool. [frame] must not be used afterwards.
+  void release(FrameTapFrame frame) {
+    if (_disposed) {
+      return;
+    }
+    _release(_handle, frame._frame);
+  }
+
+  /// Number of frames delivered to the consumer.
+  int get delivered => _disposed ? 0 : _getDelivered(_handle);
+
+  /// Number of frames dropped because the consumer was too slow.
+  int get dropped => _disposed ? 0 : _getDropped(_handle);
+
+  /// Detaches the tap from its video output & releases its buffers. The frames acquired must not be used afterwards.
+  Future<void> dispose() async {
+    if (_disposed) {
+      return;
+    }
+    _disposed = true;
+    await _onDispose();
+  }
+
+  final Pointer<Void> _handle;
+  final Future<void> Function() _onDispose;
+  bool _disposed = false;
+
+  static final DynamicLibrary _library =
+      DynamicLibrary.open('libmedia_kit_video_plugin.so');
+
+  static final _acquire =
+      _library.lookupFunction<_AcquireNative, _AcquireDart>('frame_tap_acquire');
+  static final _release =
+      _library.lookupFunction<_ReleaseNative, _ReleaseDart>('frame_tap_release');
+  static final _getDelivered = _library
+      .lookupFunction<_GetCountNative, _GetCountDart>('frame_tap_get_delivered');
+  static final _getDropped = _library
+      .lookupFunction<_GetCountNative, _GetCountDart>('frame_tap_get_dropped');
+}
@@ -0,0 +1,52 @@
+/// This file is a part of media_kit (https://github.com/media-kit/media-kit).
+///
+/// Copyright © 2026 & onwards, Predidit.
+/// All rights reserved.
+/// Use of this source code is governed by MIT license that can be found in the LICENSE file.
+import 'dart:typed_data';
+
+// Stub declaration for avoiding compilation errors on Dart JS using conditional imports.
+
+enum FrameTapFormat {
+  rgba,
+  nv12,
+  i420,
+}
+
+class FrameTapFrame {
+  FrameTapFrame._();
+
+  int get width => throw UnimplementedError();
+
+  int get height => throw UnimplementedError();
+
+  FrameTapFormat get format => throw UnimplementedError();
+
+  Duration get time => throw UnimplementedError();
+
+  int get sequence => throw UnimplementedError();
+
+  int get planeCount => throw UnimplementedError();
+
+  int stride(int index) => throw UnimplementedError();
+
+  int planeAddress(int index) => throw UnimplementedError();
+
+  Uint8List plane(int index) => throw UnimplementedError();
+}
+
+class FrameTap {
+  static const bool supported = false;
+
+  FrameTap(int address, Future<void> Function() onDispose);
+
+  FrameTapFrame? acquire() => throw UnimplementedError();
+
+  void release(FrameTapFrame frame) => throw UnimplementedError();
+
+  int get delivered => throw UnimplementedError();
+
+  int get dropped => throw UnimplementedError();
+
+  Future<void> dispose() => throw UnimplementedError();
+}
@@ -0,0 +1,186 @@
+/// This file is a part of media_kit (https://github.com/media-kit/media-kit).
+///
+/// Copyright © 2026 & onwards, Predidit.
+/// All rights reserved.
+/// Use of this source code is governed by MIT license that can be found in the LICENSE file.
+import 'dart:io';
+import 'dart:ffi';
+import 'package:flutter/foundation.dart';
+// ignore_for_file: implementation_imports
+import 'package:media_kit/ffi/ffi.dart';
+
+typedef _StartNative = Pointer<Void> Function(Pointer<Utf8>, Int64);
+typedef _StartDart = Pointer<Void> Function(Pointer<Utf8>, int);
+typedef _StopNative = Void Function(Pointer<Void>);
+typedef _StopDart = void Function(Pointer<Void>);
+typedef _GetPortNative = Int32 Function(Pointer<Void>);
+typedef _GetPortDart = int Function(Pointer<Void>);
+typedef _GetPrefixNative = Pointer<Utf8> Function(Pointer<Void>);
+typedef _GetPrefixDart = Pointer<Utf8> Function(Pointer<Void>);
+typedef _GetStatsNative = Void Function(Pointer<Void>, Pointer<Int64>);
+typedef _GetStatsDart = void Function(Pointer<Void>, Pointer<Int64>);
+
+/// Statistics of a [HttpCache].
+class HttpCacheStats {
+  /// Requests served since [HttpCache.start].
+  final int requests;
+
+  /// Bytes served from the disk since [HttpCache.start].
+  final int hitBytes;
+
+  /// Bytes fetched from the origin since [HttpCache.start].
+  final int missBytes;
+
+  /// Bytes currently stored on the disk.
+  final int cachedBytes;
+
+  /// Resources currently stored on the disk.
+  final int resources;
+
+  /// Resources evicted to stay within the maximum size since [HttpCache.start].
+  final int evictions;
+
+  const HttpCacheStats({
+    required this.requests,
+    required this.hitBytes,
+    required this.missBytes,
+    required this.cachedBytes,
+    required this.resources,
+    required this.evictions,
+  });
+
+  /// Fraction of the bytes served from the disk.
+  double get hitRate {
+    final total = hitBytes + missBytes;
+    return total == 0 ? 0.0 : hitBytes / total;
+  }
+
+  @override
+  String toString() => 'HttpCacheStats('
+      'requests: $requests, '
+      'hitBytes: $hitBytes, '
+      'missBytes: $missBytes, '
+      'cachedBytes: $cachedBytes, '
+      'resources: $resources, '
+      'evictions: $evictions'
+      ')';
+}
+
+/// {@template http_cache}
+///
+/// HttpCache
+/// ---------
+///
+/// Persistent disk cache of the byte ranges of network media, implemented natively by `package:media_kit_video`.
+///
+/// A proxy listening on `127.0.0.1` relays the requests of mpv to the origin & stores the ranges it fetches, so that media watched again (or seeked back into) is read from the disk. Open the URL returned by [url] instead of the original one:
+///
+/// ```dart
+/// final cache = await HttpCache.start();
+/// await player.open(Media(cache?.url(uri) ?? uri));
+/// ```
+///
+/// The URLs carry a random token of this proxy, so that no other client can use it: URLs returned by a previous [HttpCache] are not served.
+///
+/// Only resources served with range support, a known length & an `ETag` or `Last-Modified` are stored; the validator is checked with the origin once per run. The least recently used resources are evicted beyond `maxSize` bytes.
+///
+/// Currently only supported on GNU/Linux.
+///
+/// {@endtemplate}
+class HttpCache {
+  /// Whether [HttpCache] is supported on the current platform or not.
+  static bool get supported => Platform.isLinux;
+
+  /// {@macro http_cache}
+  HttpCache._(this._handle)
+      : port = _getPort(_handle),
+        _prefix = _getPrefix(_handle).toDartString();
+
+  /// Starts a proxy storing at most [maxSize] bytes in [directory], on a background isolate.
+  /// Returns `null` if it could not be started e.g. [directory] is not writable.
+  ///
+  /// Default [directory]: `$XDG_CACHE_HOME/media_kit/http`.
+  static Future<HttpCache?> start({
+    String? directory,
+    int maxSize = 1024 * 1024 * 1024,
+  }) async {
+    final address = await compute(
+      _startOnIsolate,
+      <Object?>[directory, maxSize],
+    );
+    if (address == 0) {
+      return null;
+    }
+    return HttpCache._(Pointer.fromAddress(address));
+  }
+
+  /// Port of the proxy on `127.0.0.1`.
+  final int port;
+
+  /// Returns the URL of [uri] through the proxy, or [uri] itself if it is not an http:// or https:// URL.
+  String url(String uri) {
+    final scheme = Uri.tryParse(uri)?.scheme.toLowerCase();
+    if (scheme != 'http' && scheme != 'https') {
+      return uri;
+    }
+    return '$_prefix${Uri.encodeComponent(uri)}';
+  }
+
+  /// Current statistics.
+  HttpCacheStats get stats {
+    final values = calloc<Int64>(6);
+    _getStats(_handle, values);
+    final result = HttpCacheStats(
+      requests: values[0],
+      hitBytes: values[1],
+      missBytes: values[2],
+      cachedBytes: values[3],
+      resources: values[4],
+      evictions: values[5],
+    );
+    calloc.free(values);
+    return result;
+  }
+
+  /// Deletes every stored resource.
+  void clear() => _clear(_handle);
+
+  /// Stops the proxy, aborting the requests being served. The instance must not be used afterwards.
+  void dispose() {
+    if (_disposed) {
+      return;
+    }
+    _disposed = true;
+    _stop(_handle);
+  }
+
+  final Pointer<Void> _handle;
+  final String _prefix;
+  bool _disposed = false;
+
+  static int _startOnIsolate(List<Object?> arguments) {
+    final directory = (arguments[0] as String?)?.toNativeUtf8() ?? nullptr;
+    final result = _start(directory, arguments[1] as int);
+    if (directory != nullptr) {
+      calloc.free(directory);
+    }
+    return result.address;
+  }
+
+  static final DynamicLibrary _library =
+      DynamicLibrary.open('libmedia_kit_video_plugin.so');
+
+  static final _start =
+      _library.lookupFunction<_StartNative, _StartDart>('http_cache_proxy_start');
+  static final _stop =
+      _library.lookupFunction<_StopNative, _StopDart>('http_cache_proxy_stop');
+  static final _clear =
+      _library.lookupFunction<_StopNative, _StopDart>('http_cache_proxy_clear');
+  static final _getPort = _library
+      .lookupFunction<_GetPortNative, _GetPortDart>('http_cache_proxy_get_port');
+  static final _getPrefix =
+      _library.lookupFunction<_GetPrefixNative, _GetPrefixDart>(
+          'http_cache_proxy_get_prefix');
+  static final _getStats = _library.lookupFunction<_GetStatsNative,
+      _GetStatsDart>('http_cache_proxy_get_stats');
+}
@@ -0,0 +1,49 @@
+/// This file is a part of media_kit (https://github.com/media-kit/media-kit).
+///
+/// Copyright © 2026 & onwards, Predidit.
+/// All rights reserved.
+/// Use of this source code is governed by MIT license that can be found in the LICENSE file.
+
+// Stub declaration for avoiding compilation errors on Dart JS using conditional imports.
+
+class HttpCacheStats {
+  final int requests;
+  final int hitBytes;
+  final int missBytes;
+  final int cachedBytes;
+  final int resources;
+  final int evictions;
+
+  const HttpCacheStats({
+    required this.requests,
+    required this.hitBytes,
+    required this.missBytes,
+    required this.cachedBytes,
+    required this.resources,
+    required this.evictions,
+  });
+
+  double get hitRate => throw UnimplementedError();
+}
+
+class HttpCache {
+  static const bool supported = false;
+
+  HttpCache._();
+
+  static Future<HttpCache?> start({
+    String? directory,
+    int maxSize = 1024 * 1024 * 1024,
+  }) =>
+      throw UnimplementedError();
+
+  int get port => throw UnimplementedError();
+
+  String url(String uri) => throw UnimplementedError();
+
+  HttpCacheStats get stats => throw UnimplementedError();
+
+  void clear() => throw UnimplementedError();
+
+  void dispose() => throw UnimplementedError();
+}
@@ -0,0 +1,120 @@
+/// This file is a part of media_kit (https://github.com/media-kit/media-kit).
+///
+/// Copyright © 2026 & onwards, Predidit.
+/// All rights reserved.
+/// Use of this source code is governed by MIT license that can be found in the LICENSE file.
+import 'dart:io';
+import 'dart:ffi';
+import 'package:flutter/foundation.dart';
+// ignore_for_file: implementation_imports
+import 'package:media_kit/ffi/ffi.dart';
+
+typedef _LoadFileNative = Pointer<Void> Function(Pointer<Utf8>, Pointer<Utf8>);
+typedef _LoadFileDart = Pointer<Void> Function(Pointer<Utf8>, Pointer<Utf8>);
+typedef _FreeNative = Void Function(Pointer<Void>);
+typedef _FreeDart = void Function(Pointer<Void>);
+typedef _SnapNative = Int64 Function(Pointer<Void>, Int64);
+typedef _SnapDart = int Function(Pointer<Void>, int);
+typedef _GetTimesNative = Pointer<Int64> Function(Pointer<Void>);
+typedef _GetTimesDart = Pointer<Int64> Function(Pointer<Void>);
+typedef _GetCountNative = Size Function(Pointer<Void>);
+typedef _GetCountDart = int Function(Pointer<Void>);
+
+/// {@template keyframe_index}
+///
+/// KeyframeIndex
+/// -------------
+///
+/// Sorted video keyframe times of a local MP4/MOV or Matroska/WebM file, built natively by `package:media_kit_video`.
+///
+/// The container's own index (`stss` or `Cues`) is used where present, otherwise the file is scanned once. The result is persisted in [cacheDirectory], so subsequent loads of an unchanged file are instant.
+///
+/// Used by [VideoController.scrub] to snap scrubbing seeks to keyframes.
+///
+/// Currently only supported on GNU/Linux.
+///
+/// {@endtemplate}
+class KeyframeIndex {
+  /// Whether [KeyframeIndex] is supported on the current platform or not.
+  static bool get supported => Platform.isLinux;
+
+  /// Directory the keyframe tables are persisted in.
+  ///
+  /// Default: `$XDG_CACHE_HOME/media_kit/keyframes`.
+  static String? cacheDirectory;
+
+  /// {@macro keyframe_index}
+  KeyframeIndex._(this._handle)
+      : _times = _getTimes(_handle),
+        length = _getCount(_handle);
+
+  /// Loads the persisted keyframe table of the file at [path] or indexes the file, on a background isolate.
+  /// Returns `null` if the file could not be indexed e.g. unsupported container.
+  static Future<KeyframeIndex?> load(String path) async {
+    final address = await compute(
+      _loadFileOnIsolate,
+      <String?>[path, cacheDirectory],
+    );
+    if (address == 0) {
+      return null;
+    }
+    return KeyframeIndex._(Pointer.fromAddress(address));
+  }
+
+  /// Number of keyframes.
+  final int length;
+
+  /// Time of the keyframe at [index].
+  Duration timeAt(int index) {
+    RangeError.checkValidIndex(index, this, 'index', length);
+    return Duration(milliseconds: _times[index]);
+  }
+
+  /// Returns the keyframe closest to [time].
+  Duration snap(Duration time) =>
+      Duration(milliseconds: _snap(_handle, time.inMilliseconds));
+
+  /// Returns the last keyframe at or before [time].
+  Duration floor(Duration time) =>
+      Duration(milliseconds: _floor(_handle, time.inMilliseconds));
+
+  /// Releases the native index. The instance must not be used afterwards.
+  void dispose() {
+    if (_disposed) {
+      return;
+    }
+    _disposed = true;
+    _free(_handle);
+  }
+
+  final Pointer<Void> _handle;
+  final Pointer<Int64> _times;
+  bool _disposed = false;
+
+  static int _loadFileOnIsolate(List<String?> arguments) {
+    final path = arguments[0]!.toNativeUtf8();
+    final directory = arguments[1]?.toNativeUtf8() ?? nullptr;
+    final result = _loadFile(path, directory);
+    calloc.free(path);
+    if (directory != nullptr) {
+      calloc.free(directory);
+    }
+    return result.address;
+  }
+
+  static final DynamicLibrary _library =
+      DynamicLibrary.open('libmedia_kit_video_plugin.so');
+
+  static final _loadFile = _library
+      .lookupFunction<_LoadFileNative, _LoadFileDart>('keyframe_index_load_file');
+  static final _free =
+      _library.lookupFunction<_FreeNative, _FreeDart>('keyframe_index_free');
+  static final _snap =
+      _library.lookupFunction<_SnapNative, _SnapDart>('keyframe_index_snap');
+  static final _floor =
+      _library.lookupFunction<_SnapNative, _SnapDart>('keyframe_index_floor');
+  static final _getTimes = _library
+      .lookupFunction<_GetTimesNative, _GetTimesDart>('keyframe_index_get_times');
+  static final _getCount = _library.lookupFunction<_GetCountNative,
+      _GetCountDart>('keyframe_index_get_count');
+}
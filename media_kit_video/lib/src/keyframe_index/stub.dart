@@ -0,0 +1,27 @@
+/// This file is a part of media_kit (https://github.com/media-kit/media-kit).
+///
+/// Copyright © 2026 & onwards, Predidit.
+/// All rights reserved.
+/// Use of this source code is governed by MIT license that can be found in the LICENSE file.
+
+// Stub declaration for avoiding compilation errors on Dart JS using conditional imports.
+
+class KeyframeIndex {
+  static const bool supported = false;
+
+  static String? cacheDirectory;
+
+  KeyframeIndex._();
+
+  static Future<KeyframeIndex?> load(String path) => throw UnimplementedError();
+
+  int get length => throw UnimplementedError();
+
+  Duration timeAt(int index) => throw UnimplementedError();
+
+  Duration snap(Duration time) => throw UnimplementedError();
+
+  Duration floor(Duration time) => throw UnimplementedError();
+
+  void dispose() => throw UnimplementedError();
+}
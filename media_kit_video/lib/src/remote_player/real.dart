@@ -0,0 +1,222 @@
+/// This file is a part of media_kit (https://github.com/media-kit/media-kit).
+///
+/// Copyright © 2026 & onwards, Predidit.
+/// All rights reserved.
+/// Use of this source code is governed by MIT license that can be found in the LICENSE file.
+import 'dart:io';
+import 'dart:async';
+import 'dart:collection';
+import 'package:flutter/services.dart';
+import 'package:flutter/widgets.dart';
+
+/// {@template remote_player}
+///
+/// RemotePlayer
+/// ------------
+///
+/// A player running in a helper process (`media_kit_video_player_host`) instead of the application's process. Up to `playersPerHost` players share a process & more processes are spawned as needed, so decoding scales over several processes & a crashing demuxer or decoder takes down its own process only: the players of that process complete [exited] & must be re-created, while the application keeps running.
+///
+/// Controlled through mpv commands & properties. The video is rendered in S/W (at most 1920x1080) into buffers shared with the application, & displayed with Flutter's [Texture] widget:
+///
+/// ```dart
+/// final player = await RemotePlayer.create();
+/// await player?.open('https://user-images.githubusercontent.com/28951144/229373695-22f88f13-d18f-4288-9bf1-c3e078d83722.mp4');
+/// // ...
+/// Texture(textureId: player.textureId);
+/// ```
+///
+/// Currently only supported on GNU/Linux.
+///
+/// {@endtemplate}
+class RemotePlayer {
+  /// Whether [RemotePlayer] is supported on the current platform or not.
+  static bool get supported => Platform.isLinux;
+
+  RemotePlayer._(this.id, this.textureId);
+
+  /// {@macro remote_player}
+  ///
+  /// Returns `null` if the helper process could not be spawned.
+  static Future<RemotePlayer?> create({int playersPerHost = 8}) async {
+    final result = await _channel.invokeMethod(
+      'PlayerHost.Create',
+      {
+        'playersPerHost': playersPerHost.toString(),
+      },
+    );
+    if (result == null) {
+      return null;
+    }
+    final player = RemotePlayer._(result['id'], result['textureId']);
+    _players[player.id] = player;
+    return player;
+  }
+
+  /// Unique ID of the player.
+  final int id;
+
+  /// ID of the texture the video is displayed through, for Flutter's [Texture] widget.
+  final int textureId;
+
+  /// Size of the video frames; `null` until the first frame.
+  final ValueNotifier<Rect?> rect = ValueNotifier<Rect?>(null);
+
+  /// mpv events of the player e.g. `file-loaded` or `end-file`.
+  Stream<String> get events => _events.stream;
+
+  /// Completes with the `waitpid` status of the helper process once it is gone e.g. after a crash. The player is unusable afterwards & must be disposed.
+  Future<int> get exited => _exited.future;
+
+  /// Loads [uri].
+  Future<bool> open(String uri) => command(['loadfile', uri]);
+
+  /// Runs the mpv command [arguments]. Returns `false` if the player is gone.
+  Future<bool> command(List<String> arguments) => _invoke(
+        'PlayerHost.Command',
+        {
+          'arguments': arguments,
+        },
+      );
+
+  /// Sets the mpv property [name]. Returns `false` if the player is gone.
+  Future<bool> setProperty(String name, String value) => _invoke(
+        'PlayerHost.SetProperty',
+        {
+          'name': name,
+          'value': value,
+        },
+      );
+
+  /// Returns the mpv property [name], or `null` if it is unavailable or the player is gone.
+  Future<String?> getProperty(String name) async {
+    if (_disposed) {
+      return null;
+    }
+    return await _channel.invokeMethod(
+      'PlayerHost.GetProperty',
+      {
+        'id': id.toString(),
+        'name': name,
+      },
+    );
+  }
+
+  /// Observes the mpv property [name]: its value, then every change. Values are empty while unavailable.
+  Stream<String> observeProperty(String name) {
+    _invoke(
+      'PlayerHost.ObserveProperty',
+      {
+        'name': name,
+      },
+    );
+    return _properties.stream
+        .where((property) => property.key == name)
+        .map((property) => property.value);
+  }
+
+  /// Sets the size of the video frames; by default, the size of the video (at most 1920x1080).
+  Future<bool> setSize({int? width, int? height}) => _invoke(
+        'PlayerHost.SetSize',
+        {
+          'width': width.toString(),
+          'height': height.toString(),
+        },
+      );
+
+  /// Destroys the player. Its helper process exits once it has no players left.
+  Future<void> dispose() async {
+    if (_disposed) {
+      return;
+    }
+    _disposed = true;
+    _players.remove(id);
+    await _channel.invokeMethod(
+      'PlayerHost.Dispose',
+      {
+        'id': id.toString(),
+      },
+    );
+    await _events.close();
+    await _properties.close();
+  }
+
+  Future<bool> _invoke(String method, Map<String, dynamic> arguments) async {
+    if (_disposed) {
+      return false;
+    }
+    final result = await _channel.invokeMethod(
+      method,
+      {
+        'id': id.toString(),
+        ...arguments,
+      },
+    );
+    return result == true;
+  }
+
+  bool _disposed = false;
+
+  final _events = StreamController<String>.broadcast();
+
+  final _properties = StreamController<MapEntry<String, String>>.broadcast();
+
+  final _exited = Completer<int>();
+
+  /// Currently created [RemotePlayer]s, notified through [_channel].
+  static final _players = HashMap<int, RemotePlayer>();
+
+  /// [MethodChannel] for invoking platform specific native implementation.
+  static final _channel =
+      const MethodChannel('com.alexmercerind/media_kit_video/player_host')
+        ..setMethodCallHandler(
+          (MethodCall call) async {
+            try {
+              final player = _players[call.arguments['id']];
+              if (player == null) {
+                return;
+              }
+              switch (call.method) {
+                case 'PlayerHost.Resize':
+                  {
+                    player.rect.value = Rect.fromLTWH(
+                      0.0,
+                      0.0,
+                      call.arguments['width'] * 1.0,
+                      call.arguments['height'] * 1.0,
+                    );
+                    break;
+                  }
+                case 'PlayerHost.PropertyChange':
+                  {
+                    player._properties.add(
+                      MapEntry(
+                        call.arguments['name'],
+                        call.arguments['value'],
+                      ),
+                    );
+                    break;
+                  }
+                case 'PlayerHost.Event':
+                  {
+                    player._events.add(call.arguments['name']);
+                    break;
+                  }
+                case 'PlayerHost.Exit':
+                  {
+                    if (!player._exited.isCompleted) {
+                      player._exited.complete(call.arguments['status']);
+                    }
+                    break;
+                  }
+                default:
+                  {
+                    break;
+                  }
+              }
+            } catch (exception, stacktrace) {
+              debugPrint(exception.toString());
+              debugPrint(stacktrace.toString());
+            }
+          },
+        );
+}
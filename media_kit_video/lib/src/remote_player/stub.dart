@@ -0,0 +1,43 @@
+/// This file is a part of media_kit (https://github.com/media-kit/media-kit).
+///
+/// Copyright © 2026 & onwards, Predidit.
+/// All rights reserved.
+/// Use of this source code is governed by MIT license that can be found in the LICENSE file.
+import 'package:flutter/widgets.dart';
+
+// Stub declaration for avoiding compilation errors on Dart JS using conditional imports.
+
+class RemotePlayer {
+  static const bool supported = false;
+
+  RemotePlayer._();
+
+  static Future<RemotePlayer?> create({int playersPerHost = 8}) =>
+      throw UnimplementedError();
+
+  int get id => throw UnimplementedError();
+
+  int get textureId => throw UnimplementedError();
+
+  ValueNotifier<Rect?> get rect => throw UnimplementedError();
+
+  Stream<String> get events => throw UnimplementedError();
+
+  Future<int> get exited => throw UnimplementedError();
+
+  Future<bool> open(String uri) => throw UnimplementedError();
+
+  Future<bool> command(List<String> arguments) => throw UnimplementedError();
+
+  Future<bool> setProperty(String name, String value) =>
+      throw UnimplementedError();
+
+  Future<String?> getProperty(String name) => throw UnimplementedError();
+
+  Stream<String> observeProperty(String name) => throw UnimplementedError();
+
+  Future<bool> setSize({int? width, int? height}) =>
+      throw UnimplementedError();
+
+  Future<void> dispose() => throw UnimplementedError();
+}
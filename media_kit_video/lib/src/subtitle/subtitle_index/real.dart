@@ -0,0 +1,189 @@
+/// This file is a part of media_kit (https://github.com/media-kit/media-kit).
+///
+/// Copyright © 2026 & onwards, Predidit.
+/// All rights reserved.
+/// Use of this source code is governed by MIT license that can be found in the LICENSE file.
+import 'dart:io';
+import 'dart:ffi';
+import 'dart:convert';
+import 'dart:typed_data';
+import 'package:flutter/foundation.dart';
+// ignore_for_file: implementation_imports
+import 'package:media_kit/ffi/ffi.dart';
+
+/// Layout of `SubtitleCue` in `subtitle_index.h`.
+final class _SubtitleCue extends Struct {
+  @Int32()
+  external int start;
+  @Int32()
+  external int end;
+  @Uint32()
+  external int textOffset;
+  @Uint32()
+  external int textLength;
+}
+
+typedef _LoadFileNative = Pointer<Void> Function(Pointer<Utf8>);
+typedef _LoadFileDart = Pointer<Void> Function(Pointer<Utf8>);
+typedef _FreeNative = Void Function(Pointer<Void>);
+typedef _FreeDart = void Function(Pointer<Void>);
+typedef _QueryNative = Size Function(
+    Pointer<Void>, Int32, Int32, Pointer<Uint32>, Size);
+typedef _QueryDart = int Function(Pointer<Void>, int, int, Pointer<Uint32>, int);
+typedef _SearchNative = Size Function(
+    Pointer<Void>, Pointer<Utf8>, Uint32, Pointer<Uint32>, Size);
+typedef _SearchDart = int Function(
+    Pointer<Void>, Pointer<Utf8>, int, Pointer<Uint32>, int);
+typedef _LowerBoundNative = Uint32 Function(Pointer<Void>, Int32);
+typedef _LowerBoundDart = int Function(Pointer<Void>, int);
+typedef _GetCuesNative = Pointer<_SubtitleCue> Function(Pointer<Void>);
+typedef _GetCuesDart = Pointer<_SubtitleCue> Function(Pointer<Void>);
+typedef _GetCountNative = Size Function(Pointer<Void>);
+typedef _GetCountDart = int Function(Pointer<Void>);
+typedef _GetTextNative = Pointer<Uint8> Function(Pointer<Void>);
+typedef _GetTextDart = Pointer<Uint8> Function(Pointer<Void>);
+
+/// {@template subtitle_index}
+///
+/// SubtitleIndex
+/// -------------
+///
+/// Time-sorted index of an external SRT, WebVTT or ASS/SSA subtitle file, built natively by `package:media_kit_video`.
+///
+/// Cue timings & text are read directly from native memory, without copying the whole file into the Dart heap. Lookups by time are O(log n).
+///
+/// Currently only supported on GNU/Linux.
+///
+/// {@endtemplate}
+class SubtitleIndex {
+  /// Whether [SubtitleIndex] is supported on the current platform or not.
+  static bool get supported => Platform.isLinux;
+
+  /// {@macro subtitle_index}
+  SubtitleIndex._(this._handle)
+      : _cues = _getCues(_handle),
+        _text = _getText(_handle),
+        length = _getCount(_handle);
+
+  /// Parses the subtitle file at [path] on a background isolate.
+  /// Returns `null` if the file could not be read.
+  static Future<SubtitleIndex?> load(String path) async {
+    final address = await compute(_loadFileOnIsolate, path);
+    if (address == 0) {
+      return null;
+    }
+    return SubtitleIndex._(Pointer.fromAddress(address));
+  }
+
+  /// Number of cues.
+  final int length;
+
+  /// Start time of the cue at [index].
+  Duration startAt(int index) => Duration(milliseconds: _cue(index).start);
+
+  /// End time of the cue at [index].
+  Duration endAt(int index) => Duration(milliseconds: _cue(index).end);
+
+  /// UTF-8 text of the cue at [index], as a view of the native text blob.
+  Uint8List textBytesAt(int index) {
+    final cue = _cue(index);
+    return Pointer<Uint8>.fromAddress(_text.address + cue.textOffset)
+        .asTypedList(cue.textLength);
+  }
+
+  /// Text of the cue at [index], without any markup.
+  String textAt(int index) =>
+      utf8.decode(textBytesAt(index), allowMalformed: true);
+
+  /// Returns indices of the cues overlapping [start] to [end], in start order.
+  List<int> query(Duration start, Duration end) {
+    final count = _query(
+      _handle,
+      start.inMilliseconds,
+      end.inMilliseconds,
+      _result,
+      _capacity,
+    );
+    if (count > _capacity) {
+      _reserve(count);
+      _query(
+        _handle,
+        start.inMilliseconds,
+        end.inMilliseconds,
+        _result,
+        _capacity,
+      );
+    }
+    return List<int>.of(_result.asTypedList(count));
+  }
+
+  /// Returns indices of up to [limit] cues containing [needle] (ASCII case-insensitive), starting from cue [from].
+  List<int> search(String needle, {int from = 0, int limit = 100}) {
+    _reserve(limit);
+    final pattern = needle.toNativeUtf8();
+    final count = _search(_handle, pattern, from, _result, limit);
+    calloc.free(pattern);
+    return List<int>.of(_result.asTypedList(count));
+  }
+
+  /// Returns the index of the first cue starting at or after [time].
+  int lowerBound(Duration time) => _lowerBound(_handle, time.inMilliseconds);
+
+  /// Releases the native index. The instance must not be used afterwards.
+  void dispose() {
+    if (_disposed) {
+      return;
+    }
+    _disposed = true;
+    _free(_handle);
+    calloc.free(_result);
+  }
+
+  _SubtitleCue _cue(int index) {
+    RangeError.checkValidIndex(index, this, 'index', length);
+    return _cues[index];
+  }
+
+  void _reserve(int capacity) {
+    if (capacity <= _capacity) {
+      return;
+    }
+    calloc.free(_result);
+    _capacity = capacity;
+    _result = calloc<Uint32>(_capacity);
+  }
+
+  final Pointer<Void> _handle;
+  final Pointer<_SubtitleCue> _cues;
+  final Pointer<Uint8> _text;
+  int _capacity = 16;
+  late Pointer<Uint32> _result = calloc<Uint32>(_capacity);
+  bool _disposed = false;
+
+  static int _loadFileOnIsolate(String path) {
+    final name = path.toNativeUtf8();
+    final result = _loadFile(name);
+    calloc.free(name);
+    return result.address;
+  }
+
+  static final DynamicLibrary _library =
+      DynamicLibrary.open('libmedia_kit_video_plugin.so');
+
+  static final _loadFile = _library
+      .lookupFunction<_LoadFileNative, _LoadFileDart>('subtitle_index_load_file');
+  static final _free =
+      _library.lookupFunction<_FreeNative, _FreeDart>('subtitle_index_free');
+  static final _query =
+      _library.lookupFunction<_QueryNative, _QueryDart>('subtitle_index_query');
+  static final _search = _library
+      .lookupFunction<_SearchNative, _SearchDart>('subtitle_index_search');
+  static final _lowerBound = _library.lookupFunction<_LowerBoundNative,
+      _LowerBoundDart>('subtitle_index_lower_bound');
+  static final _getCues = _library
+      .lookupFunction<_GetCuesNative, _GetCuesDart>('subtitle_index_get_cues');
+  static final _getCount = _library.lookupFunction<_GetCountNative,
+      _GetCountDart>('subtitle_index_get_count');
+  static final _getText = _library
+      .lookupFunction<_GetTextNative, _GetTextDart>('subtitle_index_get_text');
+}
@@ -0,0 +1,34 @@
+/// This file is a part of media_kit (https://github.com/media-kit/media-kit).
+///
+/// Copyright © 2026 & onwards, Predidit.
+/// All rights reserved.
+/// Use of this source code is governed by MIT license that can be found in the LICENSE file.
+
+// Stub declaration for avoiding compilation errors on Dart JS using conditional imports.
+
+class SubtitleIndex {
+  static const bool supported = false;
+
+  SubtitleIndex._();
+
+  static Future<SubtitleIndex?> load(String path) => throw UnimplementedError();
+
+  int get length => throw UnimplementedError();
+
+  Duration startAt(int index) => throw UnimplementedError();
+
+  Duration endAt(int index) => throw UnimplementedError();
+
+  List<int> textBytesAt(int index) => throw UnimplementedError();
+
+  String textAt(int index) => throw UnimplementedError();
+
+  List<int> query(Duration start, Duration end) => throw UnimplementedError();
+
+  List<int> search(String needle, {int from = 0, int limit = 100}) =>
+      throw UnimplementedError();
+
+  int lowerBound(Duration time) => throw UnimplementedError();
+
+  void dispose() => throw UnimplementedError();
+}
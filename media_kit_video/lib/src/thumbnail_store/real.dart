@@ -0,0 +1,316 @@
+/// This file is a part of media_kit (https://github.com/media-kit/media-kit).
+///
+/// Copyright © 2026 & onwards, Predidit.
+/// All rights reserved.
+/// Use of this source code is governed by MIT license that can be found in the LICENSE file.
+import 'dart:io';
+import 'dart:ffi';
+import 'dart:typed_data';
+import 'package:flutter/foundation.dart';
+// ignore_for_file: implementation_imports
+import 'package:media_kit/ffi/ffi.dart';
+
+/// Encoding of the bytes of a [Thumbnail], matching the formats of `Player.screenshot`.
+enum ThumbnailFormat {
+  /// Raw pixels, 4 bytes each, without padding e.g. for `decodeImageFromPixels` with `PixelFormat.bgra8888`.
+  bgra,
+
+  /// JPEG e.g. for `Image.memory`.
+  jpeg,
+
+  /// PNG e.g. for `Image.memory`.
+  png,
+}
+
+/// Mirrors the native `ThumbnailTile`.
+final class _ThumbnailTile extends Struct {
+  external Pointer<Uint8> data;
+  @Int64()
+  external int length;
+  @Int32()
+  external int width;
+  @Int32()
+  external int height;
+  @Int32()
+  external int format;
+  @Int32()
+  external int reserved;
+}
+
+typedef _OpenNative = Pointer<Void> Function(Pointer<Utf8>, Int64);
+typedef _OpenDart = Pointer<Void> Function(Pointer<Utf8>, int);
+typedef _CloseNative = Void Function(Pointer<Void>);
+typedef _CloseDart = void Function(Pointer<Void>);
+typedef _LookupNative = Pointer<_ThumbnailTile> Function(
+    Pointer<Void>, Pointer<Utf8>, Int64, Int32);
+typedef _LookupDart = Pointer<_ThumbnailTile> Function(
+    Pointer<Void>, Pointer<Utf8>, int, int);
+typedef _ReleaseNative = Void Function(Pointer<_ThumbnailTile>);
+typedef _ReleaseDart = void Function(Pointer<_ThumbnailTile>);
+typedef _InsertNative = Bool Function(Pointer<Void>, Pointer<Utf8>, Int64,
+    Int32, Int32, Int32, Int32, Pointer<Uint8>, Int64);
+typedef _InsertDart = bool Function(
+    Pointer<Void>, Pointer<Utf8>, int, int, int, int, int, Pointer<Uint8>, int);
+typedef _RemoveNative = Bool Function(
+    Pointer<Void>, Pointer<Utf8>, Int64, Int32);
+typedef _RemoveDart = bool Function(Pointer<Void>, Pointer<Utf8>, int, int);
+typedef _RemoveMediaNative = Void Function(Pointer<Void>, Pointer<Utf8>);
+typedef _RemoveMediaDart = void Function(Pointer<Void>, Pointer<Utf8>);
+typedef _GetStatsNative = Void Function(Pointer<Void>, Pointer<Int64>);
+typedef _GetStatsDart = void Function(Pointer<Void>, Pointer<Int64>);
+
+/// {@template thumbnail}
+///
+/// Thumbnail
+/// ---------
+///
+/// A tile looked up in a [ThumbnailStore]. [bytes] is a view of the store's memory-mapped file, without any copy; it is valid until [release], even if the tile is replaced or the store disposed in the meantime.
+///
+/// {@endtemplate}
+class Thumbnail {
+  /// {@macro thumbnail}
+  Thumbnail._(this._tile)
+      : width = _tile.ref.width,
+        height = _tile.ref.height,
+        format = ThumbnailFormat.values[_tile.ref.format],
+        bytes = _tile.ref.data.asTypedList(_tile.ref.length);
+
+  /// Width of the thumbnail, in pixels.
+  final int width;
+
+  /// Height of the thumbnail, in pixels.
+  final int height;
+
+  /// Encoding of [bytes].
+  final ThumbnailFormat format;
+
+  /// Bytes of the thumbnail.
+  final Uint8List bytes;
+
+  /// Releases the thumbnail. [bytes] must not be used afterwards.
+  void release() {
+    if (_released) {
+      return;
+    }
+    _released = true;
+    ThumbnailStore._release(_tile);
+  }
+
+  final Pointer<_ThumbnailTile> _tile;
+  bool _released = false;
+}
+
+/// Statistics of a [ThumbnailStore].
+class ThumbnailStoreStats {
+  /// Thumbnails stored.
+  final int tiles;
+
+  /// Bytes of the thumbnails stored.
+  final int size;
+
+  /// Bytes of the data file, including the space of replaced & evicted thumbnails not compacted yet.
+  final int fileSize;
+
+  /// Thumbnails evicted to stay within the maximum size since [ThumbnailStore.open].
+  final int evictions;
+
+  /// Compactions of the data file since [ThumbnailStore.open].
+  final int compactions;
+
+  const ThumbnailStoreStats({
+    required this.tiles,
+    required this.size,
+    required this.fileSize,
+    required this.evictions,
+    required this.compactions,
+  });
+
+  @override
+  String toString() => 'ThumbnailStoreStats('
+      'tiles: $tiles, '
+      'size: $size, '
+      'fileSize: $fileSize, '
+      'evictions: $evictions, '
+      'compactions: $compactions'
+      ')';
+}
+
+/// {@template thumbnail_store}
+///
+/// ThumbnailStore
+/// --------------
+///
+/// Persistent store of preview thumbnails, implemented natively by `package:media_kit_video`, so that e.g. a media library shows its previews without decoding any video once they were generated (typically with `Player.screenshot`).
+///
+/// Thumbnails are keyed by media (any string, e.g. a path or URL), time & requested size. They are appended to a memory-mapped file & found through a memory-mapped hash table: [lookup] is synchronous & returns a view of the bytes without any copy.
+///
+/// ```dart
+/// final thumbnail = store.lookup(path, Duration.zero, 320);
+/// if (thumbnail != null) {
+///   final image = await decodeImageFromList(thumbnail.bytes);
+///   thumbnail.release();
+/// }
+/// ```
+///
+/// The least recently used thumbnails are evicted beyond `maxSize` bytes. The space of replaced & evicted ones is reclaimed by compacting the file in the background.
+///
+/// Currently only supported on GNU/Linux.
+///
+/// {@endtemplate}
+class ThumbnailStore {
+  /// Whether [ThumbnailStore] is supported on the current platform or not.
+  static bool get supported => Platform.isLinux;
+
+  /// {@macro thumbnail_store}
+  ThumbnailStore._(this._handle);
+
+  /// Opens the store of at most [maxSize] bytes of thumbnails in [directory], on a background isolate.
+  /// Returns `null` if it could not be opened e.g. [directory] is not writable or used by another process.
+  ///
+  /// Default [directory]: `$XDG_CACHE_HOME/media_kit/thumbnails`.
+  static Future<ThumbnailStore?> open({
+    String? directory,
+    int maxSize = 256 * 1024 * 1024,
+  }) async {
+    final address = await compute(
+      _openOnIsolate,
+      <Object?>[directory, maxSize],
+    );
+    if (address == 0) {
+      return null;
+    }
+    return ThumbnailStore._(Pointer.fromAddress(address));
+  }
+
+  /// Returns the thumbnail of [media] at [time] (millisecond precision) for [size], or `null`. Must be passed to [Thumbnail.release] once consumed.
+  Thumbnail? lookup(String media, Duration time, int size) {
+    if (_disposed) {
+      return null;
+    }
+    final native = media.toNativeUtf8();
+    final tile = _lookup(_handle, native, time.inMilliseconds, size);
+    calloc.free(native);
+    return tile == nullptr ? null : Thumbnail._(tile);
+  }
+
+  /// Stores [bytes] as the thumbnail of [media] at [time] (millisecond precision) for [size], replacing the previous one.
+  /// Returns `false` on I/O error or if [bytes] are too large.
+  bool insert(
+    String media,
+    Duration time,
+    int size,
+    Uint8List bytes, {
+    required ThumbnailFormat format,
+    required int width,
+    required int height,
+  }) {
+    if (_disposed || bytes.isEmpty) {
+      return false;
+    }
+    final native = media.toNativeUtf8();
+    final data = calloc<Uint8>(bytes.length);
+    data.asTypedList(bytes.length).setAll(0, bytes);
+    final result = _insert(
+      _handle,
+      native,
+      time.inMilliseconds,
+      size,
+      format.index,
+      width,
+      height,
+      data,
+      bytes.length,
+    );
+    calloc.free(data);
+    calloc.free(native);
+    return result;
+  }
+
+  /// Removes the thumbnail of [media] at [time] for [size]. Returns `false` if there is none.
+  bool remove(String media, Duration time, int size) {
+    if (_disposed) {
+      return false;
+    }
+    final native = media.toNativeUtf8();
+    final result = _remove(_handle, native, time.inMilliseconds, size);
+    calloc.free(native);
+    return result;
+  }
+
+  /// Removes every thumbnail of [media] e.g. once the file changed.
+  void removeMedia(String media) {
+    if (_disposed) {
+      return;
+    }
+    final native = media.toNativeUtf8();
+    _removeMedia(_handle, native);
+    calloc.free(native);
+  }
+
+  /// Current statistics.
+  ThumbnailStoreStats get stats {
+    final values = calloc<Int64>(5);
+    if (!_disposed) {
+      _getStats(_handle, values);
+    }
+    final result = ThumbnailStoreStats(
+      tiles: values[0],
+      size: values[1],
+      fileSize: values[2],
+      evictions: values[3],
+      compactions: values[4],
+    );
+    calloc.free(values);
+    return result;
+  }
+
+  /// Deletes every thumbnail. Those looked up & not released yet stay valid.
+  void clear() {
+    if (!_disposed) {
+      _clear(_handle);
+    }
+  }
+
+  /// Closes the store. Thumbnails looked up & not released yet stay valid. The instance must not be used afterwards.
+  void dispose() {
+    if (_disposed) {
+      return;
+    }
+    _disposed = true;
+    _close(_handle);
+  }
+
+  final Pointer<Void> _handle;
+  bool _disposed = false;
+
+  static int _openOnIsolate(List<Object?> arguments) {
+    final directory = (arguments[0] as String?)?.toNativeUtf8() ?? nullptr;
+    final result = _open(directory, arguments[1] as int);
+    if (directory != nullptr) {
+      calloc.free(directory);
+    }
+    return result.address;
+  }
+
+  static final DynamicLibrary _library =
+      DynamicLibrary.open('libmedia_kit_video_plugin.so');
+
+  static final _open =
+      _library.lookupFunction<_OpenNative, _OpenDart>('thumbnail_store_open');
+  static final _close =
+      _library.lookupFunction<_CloseNative, _CloseDart>('thumbnail_store_close');
+  static final _clear =
+      _library.lookupFunction<_CloseNative, _CloseDart>('thumbnail_store_clear');
+  static final _lookup = _library
+      .lookupFunction<_LookupNative, _LookupDart>('thumbnail_store_lookup');
+  static final _release = _library
+      .lookupFunction<_ReleaseNative, _ReleaseDart>('thumbnail_store_release');
+  static final _insert = _library
+      .lookupFunction<_InsertNative, _InsertDart>('thumbnail_store_insert');
+  static final _remove = _library
+      .lookupFunction<_RemoveNative, _RemoveDart>('thumbnail_store_remove');
+  static final _removeMedia = _library.lookupFunction<_RemoveMediaNative,
+      _RemoveMediaDart>('thumbnail_store_remove_media');
+  static final _getStats = _library.lookupFunction<_GetStatsNative,
+      _GetStatsDart>('thumbnail_store_get_stats');
+}
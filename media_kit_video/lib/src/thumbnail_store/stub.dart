@@ -0,0 +1,81 @@
+/// This file is a part of media_kit (https://github.com/media-kit/media-kit).
+///
+/// Copyright © 2026 & onwards, Predidit.
+/// All rights reserved.
+/// Use of this source code is governed by MIT license that can be found in the LICENSE file.
+import 'dart:typed_data';
+
+// Stub declaration for avoiding compilation errors on Dart JS using conditional imports.
+
+enum ThumbnailFormat {
+  bgra,
+  jpeg,
+  png,
+}
+
+class Thumbnail {
+  Thumbnail._();
+
+  int get width => throw UnimplementedError();
+
+  int get height => throw UnimplementedError();
+
+  ThumbnailFormat get format => throw UnimplementedError();
+
+  Uint8List get bytes => throw UnimplementedError();
+
+  void release() => throw UnimplementedError();
+}
+
+class ThumbnailStoreStats {
+  final int tiles;
+  final int size;
+  final int fileSize;
+  final int evictions;
+  final int compactions;
+
+  const ThumbnailStoreStats({
+    required this.tiles,
+    required this.size,
+    required this.fileSize,
+    required this.evictions,
+    required this.compactions,
+  });
+}
+
+class ThumbnailStore {
+  static const bool supported = false;
+
+  ThumbnailStore._();
+
+  static Future<ThumbnailStore?> open({
+    String? directory,
+    int maxSize = 256 * 1024 * 1024,
+  }) =>
+      throw UnimplementedError();
+
+  Thumbnail? lookup(String media, Duration time, int size) =>
+      throw UnimplementedError();
+
+  bool insert(
+    String media,
+    Duration time,
+    int size,
+    Uint8List bytes, {
+    required ThumbnailFormat format,
+    required int width,
+    required int height,
+  }) =>
+      throw UnimplementedError();
+
+  bool remove(String media, Duration time, int size) =>
+      throw UnimplementedError();
+
+  void removeMedia(String media) => throw UnimplementedError();
+
+  ThumbnailStoreStats get stats => throw UnimplementedError();
+
+  void clear() => throw UnimplementedError();
+
+  void dispose() => throw UnimplementedError();
+}
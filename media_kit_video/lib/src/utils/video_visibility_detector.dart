@@ -0,0 +1,116 @@
+/// This file is a part of media_kit (https://github.com/media-kit/media-kit).
+///
+/// Copyright © 2026 & onwards, Predidit.
+/// All rights reserved.
+/// Use of this source code is governed by MIT license that can be found in the LICENSE file.
+import 'package:flutter/rendering.dart';
+import 'package:flutter/scheduler.dart';
+import 'package:flutter/widgets.dart';
+
+import 'package:media_kit_video/src/video_controller/video_visibility.dart';
+
+/// {@template video_visibility_detector}
+///
+/// VideoVisibilityDetector
+/// -----------------------
+/// Invokes [onVisibilityChanged] when the visibility of [child] on screen changes.
+///
+/// After each frame, the bounds of [child] are clipped by the paint clips of its ancestors (e.g. [Scrollable]s) & the screen. [TickerMode] being disabled (e.g. covered by an opaque route or in an inactive tab) is reported as [VideoVisibility.occluded].
+///
+/// {@endtemplate}
+class VideoVisibilityDetector extends StatefulWidget {
+  /// Invoked with the new [VideoVisibility] after the frame it changed in.
+  final ValueChanged<VideoVisibility> onVisibilityChanged;
+
+  /// The widget below this widget in the tree.
+  final Widget child;
+
+  /// {@macro video_visibility_detector}
+  const VideoVisibilityDetector({
+    Key? key,
+    required this.onVisibilityChanged,
+    required this.child,
+  }) : super(key: key);
+
+  @override
+  State<VideoVisibilityDetector> createState() =>
+      VideoVisibilityDetectorState();
+}
+
+class VideoVisibilityDetectorState extends State<VideoVisibilityDetector> {
+  VideoVisibility? _visibility;
+  bool _enabled = true;
+  bool _scheduled = false;
+
+  /// Reports the current visibility again after the next frame, even if it did not change.
+  void invalidate() {
+    _visibility = null;
+    _schedule();
+  }
+
+  @override
+  Widget build(BuildContext context) {
+    _enabled = TickerMode.of(context);
+    _schedule();
+    return widget.child;
+  }
+
+  // Post-frame callbacks do not schedule frames by themselves; nothing is done while the UI is idle.
+  void _schedule() {
+    if (_scheduled) {
+      return;
+    }
+    _scheduled = true;
+    SchedulerBinding.instance.addPostFrameCallback((_) {
+      _scheduled = false;
+      if (!mounted) {
+        return;
+      }
+      final visibility = _compute();
+      if (_visibility != visibility) {
+        _visibility = visibility;
+        widget.onVisibilityChanged(visibility);
+      }
+      _schedule();
+    });
+  }
+
+  VideoVisibility _compute() {
+    if (!_enabled) {
+      return VideoVisibility.occluded;
+    }
+    final box = context.findRenderObject();
+    if (box is! RenderBox || !box.attached || !box.hasSize) {
+      return VideoVisibility.offscreen;
+    }
+    // The child of [RenderView]; its coordinate space is the screen in logical pixels.
+    RenderObject root = box;
+    while (root.parent is RenderObject && root.parent is! RenderView) {
+      root = root.parent as RenderObject;
+    }
+    if (root is! RenderBox) {
+      return VideoVisibility.visible;
+    }
+    var bounds = MatrixUtils.transformRect(
+      box.getTransformTo(root),
+      Offset.zero & box.size,
+    );
+    for (RenderObject child = box;
+        child != root && !bounds.isEmpty;
+        child = child.parent as RenderObject) {
+      final parent = child.parent as RenderObject;
+      if ((parent is RenderOffstage && parent.offstage) ||
+          (parent is RenderOpacity && parent.opacity == 0.0)) {
+        return VideoVisibility.offscreen;
+      }
+      final clip = parent.describeApproximatePaintClip(child);
+      if (clip != null) {
+        bounds = bounds.intersect(
+          MatrixUtils.transformRect(parent.getTransformTo(root), clip),
+        );
+      }
+    }
+    bounds = bounds.intersect(Offset.zero & root.size);
+    return bounds.isEmpty ? VideoVisibility.offscreen : VideoVisibility.visible;
+  }
+}
@@ -15,9 +15,11 @@ import 'package:media_kit_video/media_kit_video_controls/media_kit_video_control
 import 'package:media_kit_video/src/utils/dispose_safe_notifer.dart';
 
 import 'package:media_kit_video/src/utils/wakelock.dart';
+import 'package:media_kit_video/src/utils/video_visibility_detector.dart';
 import 'package:media_kit_video/src/video_view_parameters.dart';
 import 'package:media_kit_video/src/video_controller/video_controller.dart';
 import 'package:media_kit_video/src/video_controller/platform_video_controller.dart';
+import 'package:media_kit_video/src/video_controller/video_visibility.dart';
 
 /// {@template video}
 ///
@@ -104,6 +106,12 @@ class Video extends StatefulWidget {
   ///
   final bool resumeUponEnteringForegroundMode;
 
+  /// Whether to skip rendering video frames while this [Video] is scrolled out of view, covered by an opaque route, in an inactive tab or the application is in background.
+  /// Audio playback & the player's clock continue; the current frame is rendered once visible again. See [VideoController.reportVisibility].
+  ///
+  /// Default: `false`, i.e. frames are rendered regardless of visibility.
+  final bool skipRenderingWhenInvisible;
+
   /// The configuration for subtitles e.g. [TextStyle] & padding etc.
   final SubtitleViewConfiguration subtitleViewConfiguration;
 
@@ -128,6 +136,7 @@ class Video extends StatefulWidget {
     this.wakelock = true,
     this.pauseUponEnteringBackgroundMode = true,
     this.resumeUponEnteringForegroundMode = false,
+    this.skipRenderingWhenInvisible = false,
     this.subtitleViewConfiguration = const SubtitleViewConfiguration(),
     this.onEnterFullscreen = defaultEnterNativeFullscreen,
     this.onExitFullscreen = defaultExitNativeFullscreen,
@@ -142,6 +151,7 @@ class VideoState extends State<Video> with WidgetsBindingObserver {
   late ValueNotifier<VideoViewParameters> videoViewParametersNotifier;
   late bool _disposeNotifiers;
   final _subtitleViewKey = GlobalKey<SubtitleViewState>();
+  final _visibilityDetectorKey = GlobalKey<VideoVisibilityDetectorState>();
   final _wakelock = Wakelock();
   final _subscriptions = <StreamSubscription>[];
   late int? _width = widget.controller.player.state.width;
@@ -150,6 +160,12 @@ class VideoState extends State<Video> with WidgetsBindingObserver {
 
   bool _pauseDueToPauseUponEnteringBackgroundMode = false;
 
+  // Video decoding may be suspended while not visible (see [VideoControllerConfiguration.decodeSuspensionDelay]); the last frame remains displayed meanwhile.
+  bool get _decodingMayBeSuspended =>
+      widget.controller.visibility != VideoVisibility.visible &&
+      widget.controller.notifier.value?.configuration.decodeSuspensionDelay !=
+          null;
+
   // Public API:
   bool isFullscreen() {
     return media_kit_video_controls.isFullscreen(_contextNotifier.value!);
@@ -287,6 +303,17 @@ class VideoState extends State<Video> with WidgetsBindingObserver {
         }
       }
     }
+    if (widget.skipRenderingWhenInvisible) {
+      if ([
+        AppLifecycleState.paused,
+        AppLifecycleState.detached,
+      ].contains(state)) {
+        // No frames are drawn in background; [VideoVisibilityDetector] does not run.
+        widget.controller.reportVisibility(this, VideoVisibility.offscreen);
+      } else if (state == AppLifecycleState.resumed) {
+        _visibilityDetectorKey.currentState?.invalidate();
+      }
+    }
     super.didChangeAppLifecycleState(state);
   }
 
@@ -302,7 +329,8 @@ class VideoState extends State<Video> with WidgetsBindingObserver {
         widget.controller.player.stream.width.listen(
           (value) {
             _width = value;
-            final visible = (_width ?? 0) > 0 && (_height ?? 0) > 0;
+            final visible = ((_width ?? 0) > 0 && (_height ?? 0) > 0) ||
+                (_visible && _decodingMayBeSuspended);
             if (_visible != visible) {
               setState(() {
                 _visible = visible;
@@ -313,7 +341,8 @@ class VideoState extends State<Video> with WidgetsBindingObserver {
         widget.controller.player.stream.height.listen(
           (value) {
             _height = value;
-            final visible = (_width ?? 0) > 0 && (_height ?? 0) > 0;
+            final visible = ((_width ?? 0) > 0 && (_height ?? 0) > 0) ||
+                (_visible && _decodingMayBeSuspended);
             if (_visible != visible) {
               setState(() {
                 _visible = visible;
@@ -345,6 +374,7 @@ class VideoState extends State<Video> with WidgetsBindingObserver {
   @override
   void dispose() {
     WidgetsBinding.instance.removeObserver(this);
+    widget.controller.reportVisibility(this, null);
     _wakelock.disable();
     for (final subscription in _subscriptions) {
       subscription.cancel();
@@ -369,7 +399,7 @@ class VideoState extends State<Video> with WidgetsBindingObserver {
       child: ValueListenableBuilder<VideoViewParameters>(
         valueListenable: videoViewParametersNotifier,
         builder: (context, videoViewParameters, _) {
-          return Container(
+          final child = Container(
             clipBehavior: Clip.none,
             width: videoViewParameters.width,
             height: videoViewParameters.height,
@@ -415,6 +445,42 @@ class VideoState extends State<Video> with WidgetsBindingObserver {
                                                         .filterQuality,
                                               ),
                                             ),
+                                            // Natively rasterized subtitles, anchored at the bottom of the video output. The overlay is laid out in video output pixels, same as [rect].
+                                            if (videoViewParameters
+                                                .subtitleViewConfiguration
+                                                .visible)
+                                              ValueListenableBuilder<int?>(
+                                                valueListenable:
+                                                    notifier.subtitleOverlayId,
+                                                builder: (context, overlay, _) {
+                                                  return ValueListenableBuilder<
+                                                      Rect?>(
+                                                    valueListenable: notifier
+                                                        .subtitleOverlayRect,
+                                                    builder: (context,
+                                                        overlayRect, _) {
+                                                      if (overlay == null ||
+                                                          overlayRect == null) {
+                                                        return const SizedBox
+                                                            .shrink();
+                                                      }
+                                                      return Positioned(
+                                                        left: 0.0,
+                                                        right: 0.0,
+                                                        bottom: 0.0,
+                                                        height:
+                                                            overlayRect.height,
+                                                        child: Texture(
+                                                          textureId: overlay,
+                                                          filterQuality:
+                                                              videoViewParameters
+                                                                  .filterQuality,
+                                                        ),
+                                                      );
+                                                    },
+                                                  );
+                                                },
+                                              ),
                                             // Keep the |Texture| hidden before the first frame renders. In native implementation, if no default frame size is passed (through VideoController), a starting 1 pixel sized texture/surface is created to initialize the render context & check for H/W support.
                                             // This is then resized based on the video dimensions & accordingly texture ID, texture, EGLDisplay, EGLSurface etc. (depending upon platform) are also changed. Just don't show that 1 pixel texture to the UI.
                                             // NOTE: Unmounting |Texture| causes the |MarkTextureFrameAvailable| to not do anything on GNU/Linux.
@@ -441,12 +507,26 @@ class VideoState extends State<Video> with WidgetsBindingObserver {
                 if (videoViewParameters.subtitleViewConfiguration.visible &&
                     !(widget.controller.player.platform?.configuration.libass ??
                         false))
-                  Positioned.fill(
-                    child: SubtitleView(
-                      controller: widget.controller,
-                      key: _subtitleViewKey,
-                      configuration:
-                          videoViewParameters.subtitleViewConfiguration,
+                  // Replaced by the natively rasterized subtitles once their overlay is registered.
+                  ValueListenableBuilder<PlatformVideoController?>(
+                    valueListenable: widget.controller.notifier,
+                    builder: (context, notifier, subtitleView) =>
+                        notifier == null
+                            ? subtitleView!
+                            : ValueListenableBuilder<int?>(
+                                valueListenable: notifier.subtitleOverlayId,
+                                builder: (context, overlay, _) =>
+                                    overlay == null
+                                        ? subtitleView!
+                                        : const SizedBox.shrink(),
+                              ),
+                    child: Positioned.fill(
+                      child: SubtitleView(
+                        controller: widget.controller,
+                        key: _subtitleViewKey,
+                        configuration:
+                            videoViewParameters.subtitleViewConfiguration,
+                      ),
                     ),
                   ),
                 if (videoViewParameters.controls != null)
@@ -456,6 +536,16 @@ class VideoState extends State<Video> with WidgetsBindingObserver {
               ],
             ),
           );
+          if (!widget.skipRenderingWhenInvisible) {
+            return child;
+          }
+          return VideoVisibilityDetector(
+            key: _visibilityDetectorKey,
+            onVisibilityChanged: (visibility) {
+              widget.controller.reportVisibility(this, visibility);
+            },
+            child: child,
+          );
         },
       ),
     );
@@ -100,6 +100,9 @@ class Video extends StatefulWidget {
   ///
   final bool resumeUponEnteringForegroundMode;
 
+  /// Whether to skip rendering video frames while this [Video] is not visible. Has no effect on web.
+  final bool skipRenderingWhenInvisible;
+
   /// The configuration for subtitles e.g. [TextStyle] & padding etc.
   final SubtitleViewConfiguration subtitleViewConfiguration;
 
@@ -124,6 +127,7 @@ class Video extends StatefulWidget {
     this.wakelock = true,
     this.pauseUponEnteringBackgroundMode = true,
     this.resumeUponEnteringForegroundMode = false,
+    this.skipRenderingWhenInvisible = false,
     this.subtitleViewConfiguration = const SubtitleViewConfiguration(),
     this.onEnterFullscreen = defaultEnterNativeFullscreen,
     this.onExitFullscreen = defaultExitNativeFullscreen,
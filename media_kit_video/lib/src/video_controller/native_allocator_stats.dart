@@ -0,0 +1,107 @@
+/// This file is a part of media_kit (https://github.com/media-kit/media-kit).
+///
+/// Copyright © 2026 & onwards, Predidit.
+/// All rights reserved.
+/// Use of this source code is governed by MIT license that can be found in the LICENSE file.
+
+/// {@template native_allocator_stats}
+///
+/// NativeAllocatorStats
+/// --------------------
+///
+/// Statistics of the native memory allocator shared by libmpv & the plugin, in bytes.
+///
+/// {@endtemplate}
+class NativeAllocatorStats {
+  /// Allocator in use: `mimalloc` or `glibc`.
+  final String allocator;
+
+  /// Resident set size of the process.
+  final int currentRss;
+
+  /// Peak resident set size of the process. mimalloc only.
+  final int peakRss;
+
+  /// Memory committed by mimalloc.
+  final int currentCommit;
+
+  /// Peak memory committed by mimalloc.
+  final int peakCommit;
+
+  /// Number of page faults. mimalloc only.
+  final int pageFaults;
+
+  /// Bytes in use in glibc's heap (`mallinfo2().uordblks`).
+  final int heapAllocated;
+
+  /// Free bytes retained by glibc's heap (`mallinfo2().fordblks`).
+  final int heapFree;
+
+  /// Memory reserved by the dedicated heap of the render thread. mimalloc only.
+  final int renderHeapReserved;
+
+  /// Memory committed by the dedicated heap of the render thread. mimalloc only.
+  final int renderHeapCommitted;
+
+  /// Bytes in live blocks of the dedicated heap of the render thread. mimalloc only.
+  final int renderHeapUsed;
+
+  /// Number of live blocks of the dedicated heap of the render thread. mimalloc only.
+  final int renderHeapBlocks;
+
+  /// Output of `mi_stats_print`; empty without mimalloc.
+  final String text;
+
+  /// {@macro native_allocator_stats}
+  const NativeAllocatorStats({
+    this.allocator = 'glibc',
+    this.currentRss = 0,
+    this.peakRss = 0,
+    this.currentCommit = 0,
+    this.peakCommit = 0,
+    this.pageFaults = 0,
+    this.heapAllocated = 0,
+    this.heapFree = 0,
+    this.renderHeapReserved = 0,
+    this.renderHeapCommitted = 0,
+    this.renderHeapUsed = 0,
+    this.renderHeapBlocks = 0,
+    this.text = '',
+  });
+
+  factory NativeAllocatorStats.fromMap(Map<dynamic, dynamic> map) =>
+      NativeAllocatorStats(
+        allocator: map['allocator'] ?? 'glibc',
+        currentRss: map['currentRss'] ?? 0,
+        peakRss: map['peakRss'] ?? 0,
+        currentCommit: map['currentCommit'] ?? 0,
+        peakCommit: map['peakCommit'] ?? 0,
+        pageFaults: map['pageFaults'] ?? 0,
+        heapAllocated: map['heapAllocated'] ?? 0,
+        heapFree: map['heapFree'] ?? 0,
+        renderHeapReserved: map['renderHeapReserved'] ?? 0,
+        renderHeapCommitted: map['renderHeapCommitted'] ?? 0,
+        renderHeapUsed: map['renderHeapUsed'] ?? 0,
+        renderHeapBlocks: map['renderHeapBlocks'] ?? 0,
+        text: map['text'] ?? '',
+      );
+
+  /// Whether mimalloc is in use.
+  bool get isMimalloc => allocator == 'mimalloc';
+
+  @override
+  String toString() => 'NativeAllocatorStats('
+      'allocator: $allocator, '
+      'currentRss: $currentRss, '
+      'peakRss: $peakRss, '
+      'currentCommit: $currentCommit, '
+      'peakCommit: $peakCommit, '
+      'pageFaults: $pageFaults, '
+      'heapAllocated: $heapAllocated, '
+      'heapFree: $heapFree, '
+      'renderHeapReserved: $renderHeapReserved, '
+      'renderHeapCommitted: $renderHeapCommitted, '
+      'renderHeapUsed: $renderHeapUsed, '
+      'renderHeapBlocks: $renderHeapBlocks'
+      ')';
+}
@@ -12,8 +12,13 @@ import 'package:synchronized/synchronized.dart';
 
 import 'package:media_kit/media_kit.dart';
 
+import 'package:media_kit_video/src/frame_tap/frame_tap.dart';
+import 'package:media_kit_video/src/keyframe_index/keyframe_index.dart';
 import 'package:media_kit_video/src/utils/query_decoders.dart';
+import 'package:media_kit_video/src/video_controller/native_allocator_stats.dart';
 import 'package:media_kit_video/src/video_controller/platform_video_controller.dart';
+import 'package:media_kit_video/src/video_controller/video_memory_usage.dart';
+import 'package:media_kit_video/src/video_controller/video_visibility.dart';
 
 /// {@template native_video_controller}
 ///
@@ -66,6 +71,9 @@ class NativeVideoController extends PlatformVideoController {
   /// [StreamSubscription] for listening to video [Rect].
   StreamSubscription<VideoParams>? videoParamsSubscription;
 
+  /// [StreamSubscription] for indexing the keyframes of the current [Media].
+  StreamSubscription<Playlist>? playlistSubscription;
+
   /// {@macro native_video_controller}
   NativeVideoController._(
     super.player,
@@ -108,6 +116,10 @@ class NativeVideoController extends PlatformVideoController {
         );
       }),
     );
+    if (KeyframeIndex.supported) {
+      _loadKeyframeIndex(player.state.playlist);
+      playlistSubscription = player.stream.playlist.listen(_loadKeyframeIndex);
+    }
   }
 
   /// {@macro native_video_controller}
@@ -115,6 +127,9 @@ class NativeVideoController extends PlatformVideoController {
     Player player,
     VideoControllerConfiguration configuration,
   ) async {
+    // `auto` is refined by the calibrated choice of the plugin, if enabled & unless set by the user.
+    final hwdecCalibration =
+        configuration.enableHwdecCalibration && configuration.hwdec == null;
     // Update [configuration] to have default values.
     configuration = configuration.copyWith(
       vo: configuration.vo ?? 'libmpv',
@@ -183,6 +198,12 @@ class NativeVideoController extends PlatformVideoController {
           'height': configuration.height.toString(),
           'enableHardwareAcceleration':
               configuration.enableHardwareAcceleration,
+          'enableSubtitleOverlay': configuration.enableSubtitleOverlay,
+          'decodeSuspensionDelay':
+              configuration.decodeSuspensionDelay?.inMilliseconds.toString() ??
+                  'null',
+          'lowLatency': player.platform?.configuration.lowLatency ?? false,
+          'hwdecCalibration': hwdecCalibration,
         },
       },
     );
@@ -235,10 +256,355 @@ class NativeVideoController extends PlatformVideoController {
     }
   }
 
+  @override
+  Future<void> suspend({int? demuxerCacheBytes}) async {
+    if (!Platform.isLinux) {
+      return;
+    }
+    final handle = await player.handle;
+    await _channel.invokeMethod(
+      'VideoOutputManager.Suspend',
+      {
+        'handle': handle.toString(),
+        'demuxerCacheBytes': demuxerCacheBytes?.toString() ?? 'null',
+      },
+    );
+  }
+
+  @override
+  Future<void> resume() async {
+    if (!Platform.isLinux) {
+      return;
+    }
+    final handle = await player.handle;
+    await _channel.invokeMethod(
+      'VideoOutputManager.Resume',
+      {
+        'handle': handle.toString(),
+      },
+    );
+  }
+
+  @override
+  Future<void> setVisibility(VideoVisibility visibility) async {
+    if (!Platform.isLinux) {
+      return;
+    }
+    final handle = await player.handle;
+    await _channel.invokeMethod(
+      'VideoOutputManager.SetVisibility',
+      {
+        'handle': handle.toString(),
+        'visibility': visibility.name,
+      },
+    );
+  }
+
+  /// Seeks to the keyframe nearest to [position]. While a seek is in flight, only the latest position is kept.
+  ///
+  /// On GNU/Linux, [position] is snapped through the [KeyframeIndex] of the current [Media] once available; elsewhere, mpv picks the keyframe. With [VideoControllerConfiguration.enableScrubPreview], the preview player of the video output is seeked instead, on GNU/Linux only.
+  @override
+  Future<void> scrub(Duration position) async {
+    if (configuration.enableScrubPreview && Platform.isLinux) {
+      final handle = await player.handle;
+      final previewing = await _channel.invokeMethod<bool>(
+        'VideoOutputManager.Preview',
+        {
+          'handle': handle.toString(),
+          'position': (position.inMilliseconds / 1000).toStringAsFixed(4),
+        },
+      );
+      if (previewing == true) {
+        _previewing = true;
+        return;
+      }
+    }
+    final target = _keyframeIndex?.snap(position) ?? position;
+    // Positions snapping to the keyframe just seeked to are no-ops; after a pause in scrubbing, playback may have moved on.
+    if (target == _scrubSeeked && _scrubStopwatch.elapsed < _kScrubTimeout) {
+      _scrubStopwatch.reset();
+      return;
+    }
+    _scrubTarget = target;
+    _scrubStopwatch.reset();
+    if (_scrubbing != null) {
+      return;
+    }
+    final scrubbing = _seekToScrubTargets();
+    _scrubbing = scrubbing;
+    try {
+      await scrubbing;
+    } finally {
+      if (identical(_scrubbing, scrubbing)) {
+        _scrubbing = null;
+      }
+    }
+  }
+
+  /// Seeks to [_scrubTarget] until no newer position is left.
+  Future<void> _seekToScrubTargets() async {
+    while (_scrubTarget != null) {
+      final next = _scrubTarget!;
+      _scrubTarget = null;
+      _scrubSeeked = next;
+      await platform.command(
+        [
+          'seek',
+          (next.inMilliseconds / 1000).toStringAsFixed(4),
+          'absolute+keyframes',
+        ],
+      );
+    }
+  }
+
+  /// Hands the video output back to the [Player] with an exact seek to [position], if [scrub] previewed.
+  @override
+  Future<void> endScrub(Duration position) async {
+    if (!_previewing) {
+      // Pending positions are dropped & the keyframe seek in flight is awaited, so that the exact seek lands last.
+      _scrubTarget = null;
+      await _scrubbing?.catchError((_) {});
+      _scrubSeeked = null;
+      return player.seek(position);
+    }
+    _previewing = false;
+    final handle = await player.handle;
+    await _channel.invokeMethod(
+      'VideoOutputManager.EndPreview',
+      {
+        'handle': handle.toString(),
+        'position': (position.inMilliseconds / 1000).toStringAsFixed(4),
+      },
+    );
+  }
+
+  /// Loads the [KeyframeIndex] of the current [Media] in the background. Only local files are indexed.
+  void _loadKeyframeIndex(Playlist playlist) {
+    String? path;
+    if (playlist.index >= 0 && playlist.index < playlist.medias.length) {
+      // Local files are normalized to absolute paths by [Media].
+      final uri = playlist.medias[playlist.index].uri;
+      if (uri.startsWith('/')) {
+        path = uri;
+      }
+    }
+    if (path == _keyframeIndexPath) {
+      return;
+    }
+    _keyframeIndexPath = path;
+    _keyframeIndex?.dispose();
+    _keyframeIndex = null;
+    if (path == null) {
+      return;
+    }
+    KeyframeIndex.load(path).then(
+      (index) {
+        if (_keyframeIndexPath == path && !_disposed) {
+          _keyframeIndex = index;
+        } else {
+          index?.dispose();
+        }
+      },
+      onError: (_) {},
+    );
+  }
+
+  /// Configures the response to system memory pressure (`GMemoryMonitor` & `/proc/pressure/memory`). When [enabled] (default), paused video outputs are suspended & resume by themselves once played or seeked.
+  ///
+  /// [demuxerCacheBytes] is the size the demuxer cache of suspended video outputs is trimmed to (default: 4 MiB).
+  ///
+  /// Only supported on GNU/Linux; no-op elsewhere.
+  static Future<void> setAutoSuspend(
+    bool enabled, {
+    int? demuxerCacheBytes,
+  }) async {
+    if (!Platform.isLinux) {
+      return;
+    }
+    await _channel.invokeMethod(
+      'VideoOutputManager.SetAutoSuspend',
+      {
+        'enabled': enabled,
+        'demuxerCacheBytes': demuxerCacheBytes?.toString() ?? 'null',
+      },
+    );
+  }
+
+  /// Returns the memory currently held by this video output & its player.
+  ///
+  /// Only supported on GNU/Linux; returns `null` elsewhere.
+  Future<VideoMemoryUsage?> getMemoryUsage() async {
+    if (!Platform.isLinux) {
+      return null;
+    }
+    final handle = await player.handle;
+    final result = await _channel.invokeMethod(
+      'VideoOutputManager.GetMemoryUsage',
+      {
+        'handle': handle.toString(),
+      },
+    );
+    return result == null ? null : VideoMemoryUsage.fromMap(result);
+  }
+
+  /// Sets a soft limit for the GPU texture buffers of this video output. When exceeded, the video is rendered at a proportionally lower resolution.
+  /// Pass `null` to remove the limit.
+  ///
+  /// Only supported on GNU/Linux; no-op elsewhere.
+  Future<void> setMemoryLimit(int? bytes) async {
+    if (!Platform.isLinux) {
+      return;
+    }
+    final handle = await player.handle;
+    await _channel.invokeMethod(
+      'VideoOutputManager.SetMemoryLimit',
+      {
+        'handle': handle.toString(),
+        'bytes': bytes?.toString() ?? 'null',
+      },
+    );
+  }
+
+  /// Sets the priority of this video output for [setAdaptiveResolution]; lower priorities are rendered at a lower resolution first.
+  ///
+  /// Default: `0`.
+  ///
+  /// Only supported on GNU/Linux; no-op elsewhere.
+  Future<void> setRenderPriority(int priority) async {
+    if (!Platform.isLinux) {
+      return;
+    }
+    final handle = await player.handle;
+    await _channel.invokeMethod(
+      'VideoOutputManager.SetPriority',
+      {
+        'handle': handle.toString(),
+        'priority': priority.toString(),
+      },
+    );
+  }
+
+  /// Enables adaptive render resolution. The time spent rendering each video output is measured (on the GPU, where supported) & when all of them together cannot keep up, the render resolution of the least important output (see [setRenderPriority]) is lowered step by step; it is raised again once there is headroom.
+  ///
+  /// The video outputs are scaled to their widgets as usual; only the sharpness is affected. Disabling restores the full resolution.
+  ///
+  /// Only supported on GNU/Linux & hardware acceleration; no-op elsewhere.
+  static Future<void> setAdaptiveResolution(bool enabled) async {
+    if (!Platform.isLinux) {
+      return;
+    }
+    await _channel.invokeMethod(
+      'VideoOutputManager.SetAdaptiveResolution',
+      {
+        'enabled': enabled,
+      },
+    );
+  }
+
+  /// Returns the memory currently held by all video outputs & their players.
+  ///
+  /// Only supported on GNU/Linux; returns `null` elsewhere.
+  static Future<VideoMemoryUsage?> getTotalMemoryUsage() async {
+    if (!Platform.isLinux) {
+      return null;
+    }
+    final result = await _channel.invokeMethod(
+      'VideoOutputManager.GetMemoryUsage',
+      {
+        'handle': null,
+      },
+    );
+    return VideoMemoryUsage.fromMap(result);
+  }
+
+  /// Sets a soft limit for the GPU texture buffers shared equally by all video outputs. Combined with [setMemoryLimit]; the lower limit applies.
+  /// Pass `null` to remove the limit.
+  ///
+  /// Only supported on GNU/Linux; no-op elsewhere.
+  static Future<void> setTotalMemoryLimit(int? bytes) async {
+    if (!Platform.isLinux) {
+      return;
+    }
+    await _channel.invokeMethod(
+      'VideoOutputManager.SetMemoryLimit',
+      {
+        'handle': null,
+        'bytes': bytes?.toString() ?? 'null',
+      },
+    );
+  }
+
+  /// Returns the statistics of the native memory allocator used by libmpv & the plugin.
+  ///
+  /// Only supported on GNU/Linux; returns `null` elsewhere.
+  static Future<NativeAllocatorStats?> getAllocatorStats() async {
+    if (!Platform.isLinux) {
+      return null;
+    }
+    final result = await _channel.invokeMethod(
+      'VideoOutputManager.GetAllocatorStats',
+    );
+    return NativeAllocatorStats.fromMap(result);
+  }
+
+  /// Creates a [FrameTap], copying the frames rendered by this video output into native buffers for consumers such as computer vision. Replaces the previous [FrameTap], if any.
+  ///
+  /// The frames are scaled to [width] x [height]; if only one of them is specified, the aspect ratio of the video is preserved, if neither, the video's size is used. At most [rate] frames are tapped per second (`null` for every rendered frame), into a pool of [bufferCount] buffers.
+  ///
+  /// Returns `null` if the video output does not exist.
+  ///
+  /// Only supported on GNU/Linux; returns `null` elsewhere.
+  Future<FrameTap?> createFrameTap({
+    FrameTapFormat format = FrameTapFormat.rgba,
+    int? width,
+    int? height,
+    double? rate,
+    int bufferCount = 3,
+  }) async {
+    if (!Platform.isLinux) {
+      return null;
+    }
+    await _frameTap?.dispose();
+    final handle = await player.handle;
+    final address = await _channel.invokeMethod<int>(
+      'VideoOutputManager.CreateFrameTap',
+      {
+        'handle': handle.toString(),
+        'format': format.index.toString(),
+        'width': (width ?? 0).toString(),
+        'height': (height ?? 0).toString(),
+        'rate': (rate ?? 0.0).toString(),
+        'bufferCount': bufferCount.toString(),
+      },
+    );
+    if (address == null) {
+      return null;
+    }
+    late final FrameTap tap;
+    tap = FrameTap(address, () async {
+      if (identical(_frameTap, tap)) {
+        _frameTap = null;
+      }
+      await _channel.invokeMethod(
+        'VideoOutputManager.DisposeFrameTap',
+        {
+          'handle': handle.toString(),
+        },
+      );
+    });
+    _frameTap = tap;
+    return tap;
+  }
+
   /// Disposes the instance. Releases allocated resources back to the system.
   Future<void> _dispose() async {
     super.dispose();
+    _disposed = true;
     await videoParamsSubscription?.cancel();
+    await playlistSubscription?.cancel();
+    _keyframeIndex?.dispose();
+    _keyframeIndex = null;
+    await _frameTap?.dispose();
     final handle = await player.handle;
     _controllers.remove(handle);
     await _channel.invokeMethod(
@@ -249,6 +615,66 @@ class NativeVideoController extends PlatformVideoController {
     );
   }
 
+  /// Enables or disables recording of the native render & event pipeline timeline.
+  ///
+  /// Only supported on GNU/Linux; no-op elsewhere. Tracing may also be enabled at startup with the `MEDIA_KIT_VIDEO_TRACE=1` environment variable.
+  static Future<void> setTraceEnabled(bool enabled) async {
+    if (!Platform.isLinux) {
+      return;
+    }
+    await _channel.invokeMethod(
+      'VideoOutputManager.SetTraceEnabled',
+      {
+        'enabled': enabled,
+      },
+    );
+  }
+
+  /// Returns the recorded native timeline in Chrome's JSON trace event format, which can be opened in `chrome://tracing` or https://ui.perfetto.dev.
+  /// If [path] is specified, the trace is written to the file at [path] instead & [path] is returned.
+  ///
+  /// Only supported on GNU/Linux; returns `null` elsewhere.
+  static Future<String?> dumpTrace({String? path}) async {
+    if (!Platform.isLinux) {
+      return null;
+    }
+    return _channel.invokeMethod<String>(
+      'VideoOutputManager.DumpTrace',
+      {
+        'path': path,
+      },
+    );
+  }
+
+  /// [FrameTap] created by [createFrameTap], `null` once disposed.
+  FrameTap? _frameTap;
+
+  /// [KeyframeIndex] of the current [Media], `null` until loaded or if not indexable.
+  KeyframeIndex? _keyframeIndex;
+
+  /// Path [_keyframeIndex] is (being) loaded for.
+  String? _keyframeIndexPath;
+
+  /// Latest position passed to [scrub], not seeked to yet.
+  Duration? _scrubTarget;
+
+  /// Position [scrub] last seeked to.
+  Duration? _scrubSeeked;
+
+  /// [scrub] seeks in flight, `null` if none.
+  Future<void>? _scrubbing;
+
+  /// Time since the last [scrub].
+  final _scrubStopwatch = Stopwatch()..start();
+
+  /// Whether [scrub] showed the preview of the video output, ended by [endScrub].
+  bool _previewing = false;
+
+  bool _disposed = false;
+
+  /// Time after which a [scrub] to [_scrubSeeked] is seeked again.
+  static const _kScrubTimeout = Duration(seconds: 1);
+
   /// Currently created [NativeVideoController]s.
   /// This is used to notify about updated texture IDs & [Rect]s through [_channel].
   static final _controllers = HashMap<int, NativeVideoController>();
@@ -285,6 +711,35 @@ class NativeVideoController extends PlatformVideoController {
                     }
                     break;
                   }
+                case 'VideoOutput.SubtitleOverlay':
+                  {
+                    // Notify about the subtitle overlay texture ID & [Rect].
+                    final int handle = call.arguments['handle'];
+                    final Rect rect = Rect.fromLTWH(
+                      call.arguments['rect']['left'] * 1.0,
+                      call.arguments['rect']['top'] * 1.0,
+                      call.arguments['rect']['width'] * 1.0,
+                      call.arguments['rect']['height'] * 1.0,
+                    );
+                    final int id = call.arguments['id'];
+                    _controllers[handle]?.subtitleOverlayRect.value = rect;
+                    _controllers[handle]?.subtitleOverlayId.value = id;
+                    break;
+                  }
+                case 'VideoOutput.Suspension':
+                  {
+                    // Trim the demuxer cache while suspended, also when suspended under memory pressure.
+                    final int handle = call.arguments['handle'];
+                    final controller = _controllers[handle];
+                    if (controller != null) {
+                      DemuxerCacheGovernor.instance.setSuspended(
+                        controller.player,
+                        call.arguments['suspended'],
+                        cacheBytes: call.arguments['demuxerCacheBytes'],
+                      );
+                    }
+                    break;
+                  }
                 default:
                   {
                     break;
@@ -5,7 +5,10 @@
 /// Use of this source code is governed by MIT license that can be found in the LICENSE file.
 import 'package:media_kit/media_kit.dart';
 
+import 'package:media_kit_video/src/frame_tap/frame_tap.dart';
+import 'package:media_kit_video/src/video_controller/native_allocator_stats.dart';
 import 'package:media_kit_video/src/video_controller/platform_video_controller.dart';
+import 'package:media_kit_video/src/video_controller/video_memory_usage.dart';
 
 // Stub declaration for avoiding compilation errors on Dart JS using conditional imports.
 
@@ -23,6 +26,45 @@ class NativeVideoController extends PlatformVideoController {
   ) =>
       throw UnimplementedError();
 
+  static Future<void> setAutoSuspend(
+    bool enabled, {
+    int? demuxerCacheBytes,
+  }) =>
+      throw UnimplementedError();
+
+  Future<VideoMemoryUsage?> getMemoryUsage() => throw UnimplementedError();
+
+  Future<void> setMemoryLimit(int? bytes) => throw UnimplementedError();
+
+  Future<void> setRenderPriority(int priority) => throw UnimplementedError();
+
+  static Future<void> setAdaptiveResolution(bool enabled) =>
+      throw UnimplementedError();
+
+  static Future<VideoMemoryUsage?> getTotalMemoryUsage() =>
+      throw UnimplementedError();
+
+  static Future<void> setTotalMemoryLimit(int? bytes) =>
+      throw UnimplementedError();
+
+  static Future<NativeAllocatorStats?> getAllocatorStats() =>
+      throw UnimplementedError();
+
+  Future<FrameTap?> createFrameTap({
+    FrameTapFormat format = FrameTapFormat.rgba,
+    int? width,
+    int? height,
+    double? rate,
+    int bufferCount = 3,
+  }) =>
+      throw UnimplementedError();
+
+  static Future<void> setTraceEnabled(bool enabled) =>
+      throw UnimplementedError();
+
+  static Future<String?> dumpTrace({String? path}) =>
+      throw UnimplementedError();
+
   @override
   Future<void> setSize({int? width, int? height}) => throw UnimplementedError();
 }
@@ -9,6 +9,7 @@ import 'package:flutter/widgets.dart';
 import 'package:media_kit/media_kit.dart';
 
 import 'package:media_kit_video/src/video_controller/video_controller.dart';
+import 'package:media_kit_video/src/video_controller/video_visibility.dart';
 
 /// {@template platform_video_controller}
 ///
@@ -34,6 +35,14 @@ abstract class PlatformVideoController {
   /// [Rect] of the video output, received from the native implementation.
   final ValueNotifier<Rect?> rect = ValueNotifier<Rect?>(null);
 
+  /// Texture ID of the subtitle overlay, registered with Flutter engine by the native implementation.
+  ///
+  /// Only available if [VideoControllerConfiguration.enableSubtitleOverlay] is `true` & supported by the platform.
+  final ValueNotifier<int?> subtitleOverlayId = ValueNotifier<int?>(null);
+
+  /// [Rect] of the subtitle overlay (in video output pixels), received from the native implementation.
+  final ValueNotifier<Rect?> subtitleOverlayRect = ValueNotifier<Rect?>(null);
+
   /// {@macro platform_video_controller}
   PlatformVideoController(
     this.player,
@@ -51,6 +60,33 @@ abstract class PlatformVideoController {
     int? height,
   });
 
+  /// Suspends the video output e.g. while it is not visible. The video decoder & GPU buffers are released, while the last rendered frame remains displayed. Audio playback continues.
+  ///
+  /// [demuxerCacheBytes] is the size the demuxer cache is trimmed to while suspended.
+  ///
+  /// No-op on platforms where this is not supported.
+  Future<void> suspend({int? demuxerCacheBytes}) async {}
+
+  /// Resumes the video output suspended with [suspend].
+  ///
+  /// No-op on platforms where this is not supported.
+  Future<void> resume() async {}
+
+  /// Sets the visibility of the video output. Video frames are consumed without being rendered unless [VideoVisibility.visible]; the current frame is rendered once visible again.
+  ///
+  /// No-op on platforms where this is not supported.
+  Future<void> setVisibility(VideoVisibility visibility) async {}
+
+  /// Seeks to [position] while a seek bar is being dragged. Implementations may trade accuracy for latency.
+  ///
+  /// Default: [Player.seek].
+  Future<void> scrub(Duration position) => player.seek(position);
+
+  /// Ends scrubbing at [position], once the seek bar is released.
+  ///
+  /// Default: [Player.seek].
+  Future<void> endScrub(Duration position) => player.seek(position);
+
   /// A [Future] that completes when the first video frame has been rendered.
   Future<void> get waitUntilFirstFrameRendered =>
       waitUntilFirstFrameRenderedCompleter.future;
@@ -63,6 +99,8 @@ abstract class PlatformVideoController {
   void dispose() {
     id.dispose();
     rect.dispose();
+    subtitleOverlayId.dispose();
+    subtitleOverlayRect.dispose();
   }
 }
 
@@ -131,6 +169,46 @@ class VideoControllerConfiguration {
   /// * [vo] != gpu : `false`
   final bool? androidAttachSurfaceAfterVideoParameters;
 
+  /// Whether to rasterize subtitles natively into a separate texture, composited on top of the video output.
+  ///
+  /// Subtitle changes then only update the small overlay texture & never cause the video frame to be rendered again (e.g. while paused).
+  /// [SubtitleView] is not used while the overlay is active. With [PlayerConfiguration.libass], libass output is rendered into the overlay instead of the video frame: `sub-visibility` is turned off while the video output exists & turned on again once disposed. Events are rendered with the track's default style & secondary subtitles are still rendered into the video frame. Without libass loaded in the process, mpv renders the subtitles into the video frame & the overlay stays empty.
+  ///
+  /// This option only has effect on GNU/Linux.
+  ///
+  /// Default: `false`
+  final bool enableSubtitleOverlay;
+
+  /// How long the video output may stay invisible (see [VideoController.reportVisibility]) before video decoding is suspended. `null` keeps decoding.
+  /// [Video] only reports its visibility with [Video.skipRenderingWhenInvisible].
+  ///
+  /// Once visible again, decoding resumes with a seek to the keyframe at the current position (exact while paused), so that only a few frames are decoded; the last frame stays displayed until then.
+  /// The audio position may jump by up to one keyframe interval. Useful for feeds with many autoplaying previews.
+  ///
+  /// This option only has effect on GNU/Linux.
+  ///
+  /// Default: `null`
+  final Duration? decodeSuspensionDelay;
+
+  /// Whether [VideoController.scrub] shows a preview decoded by a secondary player instance while the seek bar is dragged, instead of seeking the [Player].
+  ///
+  /// The preview only decodes keyframes, skipping the loop filter, & every new position replaces the one still pending. The [Player] is paused meanwhile & seeked exactly by [VideoController.endScrub], keeping the preview displayed until its first frame.
+  /// The secondary instance is released a few seconds after scrubbing ends. Falls back to keyframe seeks where not supported (e.g. S/W rendering).
+  ///
+  /// This option only has effect on GNU/Linux.
+  ///
+  /// Default: `false`
+  final bool enableScrubPreview;
+
+  /// Whether to benchmark the decoding APIs of the system & apply the one measured best for the codec & resolution of each file in place of `auto`.
+  ///
+  /// The benchmark runs once in the background, on first run & whenever libmpv or the GPUs change; the results are cached. Ignored when [hwdec] is set.
+  ///
+  /// This option only has effect on GNU/Linux.
+  ///
+  /// Default: `false`
+  final bool enableHwdecCalibration;
+
   /// {@macro video_controller_configuration}
   const VideoControllerConfiguration({
     this.vo,
@@ -141,6 +219,10 @@ class VideoControllerConfiguration {
     this.enableHardwareAcceleration = true,
     this.enableAndroidSurfaceProducer = true,
     this.androidAttachSurfaceAfterVideoParameters,
+    this.enableSubtitleOverlay = false,
+    this.decodeSuspensionDelay,
+    this.enableScrubPreview = false,
+    this.enableHwdecCalibration = false,
   });
 
   /// Returns a copy of this class with the given fields replaced by the new values.
@@ -153,6 +235,10 @@ class VideoControllerConfiguration {
     bool? enableHardwareAcceleration,
     bool? enableAndroidSurfaceProducer,
     bool? androidAttachSurfaceAfterVideoParameters,
+    bool? enableSubtitleOverlay,
+    Duration? decodeSuspensionDelay,
+    bool? enableScrubPreview,
+    bool? enableHwdecCalibration,
   }) =>
       VideoControllerConfiguration(
         vo: vo ?? this.vo,
@@ -167,5 +253,12 @@ class VideoControllerConfiguration {
         androidAttachSurfaceAfterVideoParameters:
             androidAttachSurfaceAfterVideoParameters ??
                 this.androidAttachSurfaceAfterVideoParameters,
+        enableSubtitleOverlay:
+            enableSubtitleOverlay ?? this.enableSubtitleOverlay,
+        decodeSuspensionDelay:
+            decodeSuspensionDelay ?? this.decodeSuspensionDelay,
+        enableScrubPreview: enableScrubPreview ?? this.enableScrubPreview,
+        enableHwdecCalibration:
+            enableHwdecCalibration ?? this.enableHwdecCalibration,
       );
 }
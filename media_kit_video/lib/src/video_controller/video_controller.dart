@@ -7,6 +7,7 @@ import 'dart:async';
 import 'package:flutter/widgets.dart';
 import 'package:media_kit/media_kit.dart';
 
+import 'package:media_kit_video/src/video_controller/video_visibility.dart';
 import 'package:media_kit_video/src/video_controller/platform_video_controller.dart';
 
 import 'package:media_kit_video/src/video_controller/native_video_controller/native_video_controller.dart';
@@ -164,9 +165,81 @@ class VideoController {
     );
   }
 
+  /// Suspends the video output e.g. while it is in a hidden tab. The video decoder & GPU buffers are released, while the last rendered frame remains displayed. Audio playback continues.
+  ///
+  /// [demuxerCacheBytes] is the size the demuxer cache is trimmed to while suspended, by the [DemuxerCacheGovernor].
+  ///
+  /// Only supported on GNU/Linux.
+  Future<void> suspend({int? demuxerCacheBytes}) async {
+    final instance = await platform.future;
+    return instance.suspend(demuxerCacheBytes: demuxerCacheBytes);
+  }
+
+  /// Resumes the video output suspended with [suspend].
+  ///
+  /// Only supported on GNU/Linux.
+  Future<void> resume() async {
+    final instance = await platform.future;
+    return instance.resume();
+  }
+
+  /// Reports the [visibility] of a [source] displaying this [VideoController] e.g. a [Video] widget, which does so by itself.
+  ///
+  /// The video output is as visible as the most visible [source]: video frames are only rendered if any of them is [VideoVisibility.visible]. Pass `null` to remove [source]; without any source, the video output is visible.
+  /// Hidden players also receive a smaller share of the [DemuxerCacheGovernor] budget.
+  ///
+  /// Only supported on GNU/Linux.
+  void reportVisibility(Object source, VideoVisibility? visibility) {
+    if (visibility == null) {
+      _visibilities.remove(source);
+    } else {
+      _visibilities[source] = visibility;
+    }
+    final current = _visibilities.values.fold<VideoVisibility>(
+      _visibilities.isEmpty ? VideoVisibility.visible : VideoVisibility.offscreen,
+      (result, value) => value.index < result.index ? value : result,
+    );
+    if (current == _visibility) {
+      return;
+    }
+    _visibility = current;
+    DemuxerCacheGovernor.instance.setVisible(
+      player,
+      current == VideoVisibility.visible,
+    );
+    platform.future.then(
+      (instance) => instance.setVisibility(current),
+      onError: (_) {},
+    );
+  }
+
+  /// Seeks to [position] while a seek bar is being dragged.
+  ///
+  /// On Windows, GNU/Linux, macOS & iOS, the seek lands on a video keyframe, which is much faster than an exact seek. Call [endScrub] once the seek bar is released, for an exact seek.
+  ///
+  /// Only on GNU/Linux, positions are snapped to the nearest keyframe through a [KeyframeIndex] of local files, so positions snapping to the same keyframe are not seeked again; elsewhere, every position is seeked. Likewise, [VideoControllerConfiguration.enableScrubPreview] only has effect on GNU/Linux, where a secondary player decodes the preview instead.
+  ///
+  /// Same as [Player.seek] on other platforms.
+  Future<void> scrub(Duration position) async {
+    final instance = await platform.future;
+    return instance.scrub(position);
+  }
+
+  /// Ends [scrub] with an exact seek to [position], once the seek bar is released.
+  Future<void> endScrub(Duration position) async {
+    final instance = await platform.future;
+    return instance.endScrub(position);
+  }
+
+  /// Current visibility of the video output, see [reportVisibility].
+  VideoVisibility get visibility => _visibility;
+
   /// A [Future] that completes when the first video frame has been rendered.
   Future<void> get waitUntilFirstFrameRendered async {
     final instance = await platform.future;
     return instance.waitUntilFirstFrameRendered;
   }
+
+  final Map<Object, VideoVisibility> _visibilities = {};
+  VideoVisibility _visibility = VideoVisibility.visible;
 }
@@ -0,0 +1,64 @@
+/// This file is a part of media_kit (https://github.com/media-kit/media-kit).
+///
+/// Copyright © 2026 & onwards, Predidit.
+/// All rights reserved.
+/// Use of this source code is governed by MIT license that can be found in the LICENSE file.
+
+/// {@template video_memory_usage}
+///
+/// VideoMemoryUsage
+/// ----------------
+///
+/// Memory held by a video output & its player, in bytes.
+///
+/// {@endtemplate}
+class VideoMemoryUsage {
+  /// Number of GPU texture buffers. All buffers of an output are of equal size.
+  final int gpuBufferCount;
+
+  /// Total size of the GPU texture buffers.
+  final int gpuBytes;
+
+  /// Size of the CPU side pixel buffers i.e. S/W rendering & subtitle overlay.
+  final int cpuPixelBytes;
+
+  /// Size of the demuxer cache. With `cache-on-disk`, this is backed by a file instead of RAM.
+  final int demuxerCacheBytes;
+
+  /// Upper bound estimate of the hardware decoder surface pool.
+  final int hwdecSurfaceBytes;
+
+  /// {@macro video_memory_usage}
+  const VideoMemoryUsage({
+    this.gpuBufferCount = 0,
+    this.gpuBytes = 0,
+    this.cpuPixelBytes = 0,
+    this.demuxerCacheBytes = 0,
+    this.hwdecSurfaceBytes = 0,
+  });
+
+  factory VideoMemoryUsage.fromMap(Map<dynamic, dynamic> map) =>
+      VideoMemoryUsage(
+        gpuBufferCount: map['gpuBufferCount'] ?? 0,
+        gpuBytes: map['gpuBytes'] ?? 0,
+        cpuPixelBytes: map['cpuPixelBytes'] ?? 0,
+        demuxerCacheBytes: map['demuxerCacheBytes'] ?? 0,
+        hwdecSurfaceBytes: map['hwdecSurfaceBytes'] ?? 0,
+      );
+
+  /// Size of each GPU texture buffer.
+  int get gpuBufferSize => gpuBufferCount == 0 ? 0 : gpuBytes ~/ gpuBufferCount;
+
+  /// Sum of all the above.
+  int get totalBytes =>
+      gpuBytes + cpuPixelBytes + demuxerCacheBytes + hwdecSurfaceBytes;
+
+  @override
+  String toString() => 'VideoMemoryUsage('
+      'gpuBufferCount: $gpuBufferCount, '
+      'gpuBytes: $gpuBytes, '
+      'cpuPixelBytes: $cpuPixelBytes, '
+      'demuxerCacheBytes: $demuxerCacheBytes, '
+      'hwdecSurfaceBytes: $hwdecSurfaceBytes'
+      ')';
+}
@@ -0,0 +1,19 @@
+/// This file is a part of media_kit (https://github.com/media-kit/media-kit).
+///
+/// Copyright © 2026 & onwards, Predidit.
+/// All rights reserved.
+/// Use of this source code is governed by MIT license that can be found in the LICENSE file.
+
+/// Visibility of a video output on screen.
+///
+/// Video frames of an output that is not [visible] are consumed without being rendered, while audio playback & the player's clock continue. See [VideoController.reportVisibility].
+enum VideoVisibility {
+  /// At least partially visible on screen.
+  visible,
+
+  /// Covered e.g. by an opaque route or in an inactive tab.
+  occluded,
+
+  /// Scrolled out of view, not painted or the application is in background.
+  offscreen,
+}
@@ -0,0 +1,196 @@
+// This file is a part of media_kit
+// (https://github.com/media-kit/media-kit).
+//
+// Copyright © 2026 & onwards, Predidit.
+// All rights reserved.
+// Use of this source code is governed by MIT license that can be found in the
+// LICENSE file.
+
+#include "include/media_kit_video/allocator.h"
+
+#include <dlfcn.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <mutex>
+
+namespace {
+
+// Subset of mimalloc's API (mimalloc.h, v2.x).
+typedef struct mi_heap_s mi_heap_t;
+typedef struct {
+  void* blocks;
+  size_t reserved;
+  size_t committed;
+  size_t used;
+  size_t block_size;
+} mi_heap_area_t;
+typedef bool (*mi_block_visit_fun)(const mi_heap_t*,
+                                   const mi_heap_area_t*,
+                                   void*,
+                                   size_t,
+                                   void*);
+typedef void (*mi_output_fun)(const char*, void*);
+
+// glibc 2.33+.
+struct mallinfo2_t {
+  size_t arena, ordblks, smblks, hblks, hblkhd, usmblks, fsmblks, uordblks,
+      fordblks, keepcost;
+};
+
+struct Functions {
+  void (*mi_process_info)(size_t*, size_t*, size_t*, size_t*, size_t*,
+                          size_t*, size_t*, size_t*) = nullptr;
+  void (*mi_stats_print_out)(mi_output_fun, void*) = nullptr;
+  mi_heap_t* (*mi_heap_new)() = nullptr;
+  mi_heap_t* (*mi_heap_set_default)(mi_heap_t*) = nullptr;
+  void (*mi_heap_delete)(mi_heap_t*) = nullptr;
+  void (*mi_heap_collect)(mi_heap_t*, bool) = nullptr;
+  void (*mi_collect)(bool) = nullptr;
+  bool (*mi_heap_visit_blocks)(const mi_heap_t*,
+                               bool,
+                               mi_block_visit_fun,
+                               void*) = nullptr;
+  mallinfo2_t (*mallinfo2)() = nullptr;
+  int (*malloc_trim)(size_t) = nullptr;
+};
+
+template <typename T>
+void Resolve(T& function, const char* name) {
+  function = reinterpret_cast<T>(dlsym(RTLD_DEFAULT, name));
+}
+
+const Functions& GetFunctions() {
+  static Functions functions;
+  static std::once_flag once;
+  std::call_once(once, []() {
+    Resolve(functions.mi_process_info, "mi_process_info");
+    Resolve(functions.mi_stats_print_out, "mi_stats_print_out");
+    Resolve(functions.mi_heap_new, "mi_heap_new");
+    Resolve(functions.mi_heap_set_default, "mi_heap_set_default");
+    Resolve(functions.mi_heap_delete, "mi_heap_delete");
+    Resolve(functions.mi_heap_collect, "mi_heap_collect");
+    Resolve(functions.mi_collect, "mi_collect");
+    Resolve(functions.mi_heap_visit_blocks, "mi_heap_visit_blocks");
+    Resolve(functions.mallinfo2, "mallinfo2");
+    Resolve(functions.malloc_trim, "malloc_trim");
+  });
+  return functions;
+}
+
+thread_local mi_heap_t* thread_heap = nullptr;
+thread_local mi_heap_t* previous_heap = nullptr;
+
+// Resident set size from /proc/self/statm.
+size_t CurrentRss() {
+  FILE* file = fopen("/proc/self/statm", "r");
+  if (file == nullptr) {
+    return 0;
+  }
+  unsigned long size = 0, resident = 0;
+  int count = fscanf(file, "%lu %lu", &size, &resident);
+  fclose(file);
+  return count == 2 ? resident * (size_t)sysconf(_SC_PAGESIZE) : 0;
+}
+
+}  // namespace
+
+bool Allocator::IsMimalloc() {
+  return GetFunctions().mi_heap_new != nullptr;
+}
+
+Allocator::Stats Allocator::GetStats() {
+  const Functions& functions = GetFunctions();
+  Stats stats;
+  if (functions.mi_process_info != nullptr) {
+    size_t elapsed, user, system;
+    functions.mi_process_info(&elapsed, &user, &system, &stats.current_rss,
+                              &stats.peak_rss, &stats.current_commit,
+                              &stats.peak_commit, &stats.page_faults);
+    stats.mimalloc = true;
+    return stats;
+  }
+  stats.current_rss = CurrentRss();
+  if (functions.mallinfo2 != nullptr) {
+    mallinfo2_t info = functions.mallinfo2();
+    stats.heap_allocated = info.uordblks;
+    stats.heap_free = info.fordblks;
+  }
+  return stats;
+}
+
+std::string Allocator::PrintStats() {
+  const Functions& functions = GetFunctions();
+  std::string out;
+  if (functions.mi_stats_print_out != nullptr) {
+    functions.mi_stats_print_out(
+        [](const char* message, void* data) {
+          static_cast<std::string*>(data)->append(message);
+        },
+        &out);
+  }
+  return out;
+}
+
+void Allocator::CreateThreadHeap() {
+  const Functions& functions = GetFunctions();
+  if (thread_heap != nullptr || functions.mi_heap_new == nullptr ||
+      functions.mi_heap_set_default == nullptr) {
+    return;
+  }
+  thread_heap = functions.mi_heap_new();
+  if (thread_heap != nullptr) {
+    previous_heap = functions.mi_heap_set_default(thread_heap);
+  }
+}
+
+void Allocator::DeleteThreadHeap() {
+  const Functions& functions = GetFunctions();
+  if (thread_heap == nullptr) {
+    return;
+  }
+  functions.mi_heap_set_default(previous_heap);
+  functions.mi_heap_delete(thread_heap);
+  thread_heap = nullptr;
+  previous_heap = nullptr;
+}
+
+void Allocator::CollectThreadHeap(bool force) {
+  const Functions& functions = GetFunctions();
+  if (thread_heap != nullptr && functions.mi_heap_collect != nullptr) {
+    functions.mi_heap_collect(thread_heap, force);
+  }
+}
+
+void Allocator::Collect(bool force) {
+  const Functions& functions = GetFunctions();
+  if (functions.mi_collect != nullptr) {
+    functions.mi_collect(force);
+  } else if (functions.malloc_trim != nullptr) {
+    functions.malloc_trim(0);
+  }
+}
+
+bool Allocator::GetThreadHeapStats(HeapStats* stats) {
+  const Functions& functions = GetFunctions();
+  *stats = HeapStats{};
+  if (thread_heap == nullptr || functions.mi_heap_visit_blocks == nullptr) {
+    return false;
+  }
+  // Areas only; |block| is NULL when |visit_all_blocks| is false.
+  functions.mi_heap_visit_blocks(
+      thread_heap, false,
+      [](const mi_heap_t*, const mi_heap_area_t* area, void* block, size_t,
+         void* data) -> bool {
+        if (block == nullptr) {
+          HeapStats* stats = static_cast<HeapStats*>(data);
+          stats->reserved += area->reserved;
+          stats->committed += area->committed;
+          stats->used += area->used * area->block_size;
+          stats->blocks += area->used;
+        }
+        return true;
+      },
+      stats);
+  return true;
+}
@@ -0,0 +1,360 @@
+// This file is a part of media_kit
+// (https://github.com/media-kit/media-kit).
+//
+// Copyright © 2026 & onwards, Predidit.
+// All rights reserved.
+// Use of this source code is governed by MIT license that can be found in the
+// LICENSE file.
+
+// Replays viewing sessions of a synthetic remote file through
+// |HttpCacheProxy| & measures the hit rate, the throughput & the time to first
+// byte of each, against the origin read directly. The origin runs in process &
+// simulates a remote server with a fixed latency & bandwidth.
+//
+// A session plays from the start & seeks |seeks| times, reading a fixed
+// amount after each seek on a new connection, like mpv does. The first
+// session is cold; the next ones watch the file again, half of their seeks
+// landing where the previous session's did. The last pass restarts the proxy,
+// reloading its index.
+//
+// Usage: http_cache_benchmark [--size=MiB] [--sessions=N] [--seeks=N]
+//                             [--latency=ms] [--bandwidth=MiB/s]
+//                             [--cache-size=MiB]
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "include/media_kit_video/http_cache_proxy.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int64_t kMiB = 1024 * 1024;
+
+double ElapsedMs(Clock::time_point begin) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - begin)
+      .count();
+}
+
+bool SendAll(int fd, const char* data, size_t size) {
+  while (size > 0) {
+    ssize_t result = send(fd, data, size, MSG_NOSIGNAL);
+    if (result <= 0) {
+      return false;
+    }
+    data += result;
+    size -= result;
+  }
+  return true;
+}
+
+int Listen(int* port) {
+  int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  struct sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t size = sizeof(address);
+  if (fd < 0 || bind(fd, (struct sockaddr*)&address, sizeof(address)) != 0 ||
+      listen(fd, 16) != 0 ||
+      getsockname(fd, (struct sockaddr*)&address, &size) != 0) {
+    fprintf(stderr, "Unable to listen on 127.0.0.1.\n");
+    exit(1);
+  }
+  *port = ntohs(address.sin_port);
+  return fd;
+}
+
+// Serves |data| with `ETag` & single ranges, a connection at a time, after
+// |latency_ms| & at |bandwidth| bytes per second.
+class Origin {
+ public:
+  Origin(std::string data, int latency_ms, int64_t bandwidth)
+      : data_(std::move(data)),
+        latency_ms_(latency_ms),
+        bandwidth_(bandwidth),
+        listener_(Listen(&port_)),
+        thread_([this]() {
+          int fd;
+          while ((fd = accept4(listener_, NULL, NULL, SOCK_CLOEXEC)) >= 0) {
+            Serve(fd);
+            close(fd);
+          }
+        }) {}
+
+  ~Origin() {
+    shutdown(listener_, SHUT_RDWR);
+    thread_.join();
+    close(listener_);
+  }
+
+  int port() const { return port_; }
+
+ private:
+  void Serve(int fd) {
+    std::string request;
+    char chunk[4096];
+    while (request.find("\r\n\r\n") == std::string::npos) {
+      ssize_t read = recv(fd, chunk, sizeof(chunk), 0);
+      if (read <= 0) {
+        return;
+      }
+      request.append(chunk, read);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(latency_ms_));
+    int64_t length = data_.size();
+    int64_t start = 0, end = length - 1;
+    size_t range = request.find("\r\nRange: bytes=");
+    if (range != std::string::npos) {
+      const char* spec = request.c_str() + range + 15;
+      start = std::min<int64_t>(strtoll(spec, NULL, 10), length - 1);
+      const char* dash = strchr(spec, '-');
+      if (dash != NULL && dash[1] >= '0' && dash[1] <= '9') {
+        end = std::min<int64_t>(end, strtoll(dash + 1, NULL, 10));
+      }
+    }
+    char head[512];
+    snprintf(head, sizeof(head),
+             "HTTP/1.1 206 Partial Content\r\nContent-Range: bytes "
+             "%lld-%lld/%lld\r\nContent-Length: %lld\r\nETag: \"1\"\r\n"
+             "Accept-Ranges: bytes\r\nContent-Type: video/mp4\r\n\r\n",
+             (long long)start, (long long)end, (long long)length,
+             (long long)(end - start + 1));
+    if (!SendAll(fd, head, strlen(head))) {
+      return;
+    }
+    // Paced in 64 KiB steps.
+    Clock::time_point begin = Clock::now();
+    for (int64_t sent = 0; start + sent <= end;) {
+      int64_t size = std::min<int64_t>(64 * 1024, end + 1 - start - sent);
+      if (!SendAll(fd, data_.data() + start + sent, size)) {
+        return;
+      }
+      sent += size;
+      std::this_thread::sleep_until(
+          begin + std::chrono::microseconds(sent * 1000000 / bandwidth_));
+    }
+  }
+
+  std::string data_;
+  int latency_ms_;
+  int64_t bandwidth_;
+  int port_ = 0;
+  int listener_;
+  std::thread thread_;
+};
+
+struct Read {
+  int64_t offset;
+  int64_t size;
+};
+
+struct Result {
+  double ms = 0.0;
+  std::vector<double> first_byte_ms;
+  int64_t bytes = 0;
+};
+
+// Reads |read.size| bytes at |read.offset| of |target| on 127.0.0.1:|port|
+// with an open ended range, then drops the connection like a seek does.
+bool Fetch(int port, const std::string& target, Read read, Result* result) {
+  int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  struct sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  address.sin_port = htons(port);
+  Clock::time_point begin = Clock::now();
+  std::string request = "GET " + target + " HTTP/1.1\r\nHost: 127.0.0.1:" +
+                        std::to_string(port) + "\r\nRange: bytes=" +
+                        std::to_string(read.offset) + "-\r\n\r\n";
+  if (connect(fd, (struct sockaddr*)&address, sizeof(address)) != 0 ||
+      !SendAll(fd, request.data(), request.size())) {
+    close(fd);
+    return false;
+  }
+  std::vector<char> buffer(256 * 1024);
+  std::string head;
+  int64_t body = 0;
+  bool first = true;
+  while (body < read.size) {
+    ssize_t received = recv(fd, buffer.data(), buffer.size(), 0);
+    if (received <= 0) {
+      break;
+    }
+    if (head.find("\r\n\r\n") == std::string::npos) {
+      head.append(buffer.data(), received);
+      size_t end = head.find("\r\n\r\n");
+      if (end == std::string::npos) {
+        continue;
+      }
+      received = head.size() - end - 4;
+    }
+    if (first && received > 0) {
+      result->first_byte_ms.push_back(ElapsedMs(begin));
+      first = false;
+    }
+    body += received;
+  }
+  close(fd);
+  result->bytes += std::min(body, read.size);
+  return body >= read.size;
+}
+
+Result Run(int port, const std::string& target, const std::vector<Read>& reads) {
+  Result result;
+  Clock::time_point begin = Clock::now();
+  for (const Read& read : reads) {
+    if (!Fetch(port, target, read, &result)) {
+      fprintf(stderr, "Read at %lld failed.\n", (long long)read.offset);
+    }
+  }
+  result.ms = ElapsedMs(begin);
+  return result;
+}
+
+void Print(const char* name,
+           Result& result,
+           const HttpCacheProxy::Stats* before,
+           const HttpCacheProxy::Stats* after) {
+  std::vector<double>& first_byte = result.first_byte_ms;
+  std::sort(first_byte.begin(), first_byte.end());
+  double throughput = result.bytes / (double)kMiB / (result.ms / 1000.0);
+  printf("  %-9s %8.2f MiB/s, first byte p50 %7.2f ms, p95 %7.2f ms", name,
+         throughput, first_byte.empty() ? 0.0 : first_byte[first_byte.size() / 2],
+         first_byte.empty() ? 0.0 : first_byte[first_byte.size() * 95 / 100]);
+  if (before != NULL) {
+    int64_t hit = after->hit_bytes - before->hit_bytes;
+    int64_t miss = after->miss_bytes - before->miss_bytes;
+    printf(", hit rate %5.1f%%", hit + miss > 0 ? 100.0 * hit / (hit + miss)
+                                                : 0.0);
+  }
+  printf("\n");
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  int64_t size = 256;
+  int sessions = 3;
+  int seeks = 20;
+  int latency = 40;
+  int64_t bandwidth = 20;
+  int64_t cache_size = 1024;
+  for (int i = 1; i < argc; i++) {
+    if (strncmp(argv[i], "--size=", 7) == 0) {
+      size = std::max(1, atoi(argv[i] + 7));
+    } else if (strncmp(argv[i], "--sessions=", 11) == 0) {
+      sessions = std::max(2, atoi(argv[i] + 11));
+    } else if (strncmp(argv[i], "--seeks=", 8) == 0) {
+      seeks = std::max(0, atoi(argv[i] + 8));
+    } else if (strncmp(argv[i], "--latency=", 10) == 0) {
+      latency = std::max(0, atoi(argv[i] + 10));
+    } else if (strncmp(argv[i], "--bandwidth=", 12) == 0) {
+      bandwidth = std::max(1, atoi(argv[i] + 12));
+    } else if (strncmp(argv[i], "--cache-size=", 13) == 0) {
+      cache_size = std::max(1, atoi(argv[i] + 13));
+    } else {
+      fprintf(stderr,
+              "Usage: %s [--size=MiB] [--sessions=N] [--seeks=N] "
+              "[--latency=ms] [--bandwidth=MiB/s] [--cache-size=MiB]\n",
+              argv[0]);
+      return 1;
+    }
+  }
+  size *= kMiB;
+
+  std::mt19937_64 random(42);
+  std::string data(size, '\0');
+  for (size_t i = 0; i < data.size(); i += 8) {
+    uint64_t value = random();
+    memcpy(&data[i], &value, std::min<size_t>(8, data.size() - i));
+  }
+  Origin origin(std::move(data), latency, bandwidth * kMiB);
+  std::string url = "http://127.0.0.1:" + std::to_string(origin.port()) +
+                    "/video.mp4";
+
+  // What a session reads after each seek: a demuxer cache's worth.
+  int64_t segment = std::max<int64_t>(size / (4 * (seeks + 1)), 64 * 1024);
+  std::vector<std::vector<Read>> plans;
+  std::vector<Read> plan = {{0, segment}};
+  for (int i = 0; i < seeks; i++) {
+    plan.push_back({(int64_t)(random() % (size - segment)), segment});
+  }
+  plans.push_back(plan);
+  for (int session = 1; session < sessions; session++) {
+    for (size_t i = 1; i < plan.size(); i++) {
+      if (random() % 2 == 0) {
+        plan[i].offset = random() % (size - segment);
+      }
+    }
+    plans.push_back(plan);
+  }
+
+  printf("%lld MiB at %lld MiB/s & %d ms, %d sessions of %d seeks, %lld KiB "
+         "each\n",
+         (long long)(size / kMiB), (long long)bandwidth, latency, sessions,
+         seeks, (long long)(segment / 1024));
+
+  // Not the user's cache: every run starts cold.
+  char directory[] = "/tmp/http_cache_benchmark_XXXXXX";
+  if (mkdtemp(directory) == NULL) {
+    return 1;
+  }
+  Result direct = Run(origin.port(), "/video.mp4", plans[0]);
+  Print("origin", direct, NULL, NULL);
+
+  auto proxy = std::make_unique<HttpCacheProxy>(directory, cache_size * kMiB);
+  if (!proxy->Start()) {
+    fprintf(stderr, "Unable to start the proxy.\n");
+    return 1;
+  }
+  std::string local = proxy->GetUrl(url);
+  std::string target = local.substr(local.find('/', 7));
+  for (int session = 0; session < sessions; session++) {
+    HttpCacheProxy::Stats before = proxy->GetStats();
+    Result result = Run(proxy->port(), target, plans[session]);
+    HttpCacheProxy::Stats after = proxy->GetStats();
+    char name[32] = "cold";
+    if (session > 0) {
+      snprintf(name, sizeof(name), "warm %d", session);
+    }
+    Print(name, result, &before, &after);
+  }
+
+  proxy.reset();
+  Clock::time_point begin = Clock::now();
+  proxy = std::make_unique<HttpCacheProxy>(directory, cache_size * kMiB);
+  if (!proxy->Start()) {
+    return 1;
+  }
+  double open_ms = ElapsedMs(begin);
+  HttpCacheProxy::Stats before = proxy->GetStats();
+  Result result = Run(proxy->port(), target, plans.back());
+  HttpCacheProxy::Stats after = proxy->GetStats();
+  Print("restarted", result, &before, &after);
+
+  struct stat index;
+  std::string index_path = std::string(directory) + "/index";
+  printf("  Store: %.2f MiB, index %lld bytes, loaded in %.2f ms\n",
+         after.store.size / (double)kMiB,
+         stat(index_path.c_str(), &index) == 0 ? (long long)index.st_size : 0ll,
+         open_ms);
+  proxy.reset();
+
+  std::string command = std::string("rm -rf '") + directory + "'";
+  return system(command.c_str()) == 0 ? 0 : 1;
+}
@@ -0,0 +1,169 @@
+// This file is a part of media_kit
+// (https://github.com/media-kit/media-kit).
+//
+// Copyright © 2026 & onwards, Predidit.
+// All rights reserved.
+// Use of this source code is governed by MIT license that can be found in the
+// LICENSE file.
+
+// Measures |KeyframeIndex| build & load time of local media files, then the
+// latency of scrubbing seeks with libmpv: exact seeks, keyframe seeks &
+// keyframe seeks snapped to the index, until playback restarts.
+//
+// Usage: keyframe_index_benchmark <file>... [--seeks=N]
+
+#include <mpv/client.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "include/media_kit_video/keyframe_index.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double ElapsedMs(Clock::time_point begin) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - begin)
+      .count();
+}
+
+// Waits for |event_id|. Returns false on error or end of file.
+bool WaitFor(mpv_handle* handle, mpv_event_id event_id) {
+  for (;;) {
+    mpv_event* event = mpv_wait_event(handle, 10.0);
+    if (event->event_id == event_id) {
+      return true;
+    }
+    if (event->event_id == MPV_EVENT_NONE ||
+        event->event_id == MPV_EVENT_END_FILE ||
+        event->event_id == MPV_EVENT_SHUTDOWN) {
+      return false;
+    }
+  }
+}
+
+void PrintLatencies(const char* name, std::vector<double>& latencies) {
+  if (latencies.empty()) {
+    printf("  %-10s failed\n", name);
+    return;
+  }
+  std::sort(latencies.begin(), latencies.end());
+  double total = 0.0;
+  for (double latency : latencies) {
+    total += latency;
+  }
+  printf("  %-10s mean %7.2f ms, p50 %7.2f ms, p95 %7.2f ms, max %7.2f ms\n",
+         name, total / latencies.size(), latencies[latencies.size() / 2],
+         latencies[latencies.size() * 95 / 100], latencies.back());
+}
+
+// Seeks to each of |targets| (milliseconds) with |flags| & measures the time
+// until playback restarts. |index| snaps the targets if not NULL.
+std::vector<double> MeasureSeeks(mpv_handle* handle,
+                                 const std::vector<int64_t>& targets,
+                                 const char* flags,
+                                 const KeyframeIndex* index) {
+  std::vector<double> latencies;
+  latencies.reserve(targets.size());
+  for (int64_t target : targets) {
+    if (index != nullptr) {
+      target = index->Snap(target);
+    }
+    std::string time = std::to_string(target / 1000.0);
+    const char* command[] = {"seek", time.c_str(), flags, NULL};
+    Clock::time_point begin = Clock::now();
+    if (mpv_command(handle, command) < 0 ||
+        !WaitFor(handle, MPV_EVENT_PLAYBACK_RESTART)) {
+      return std::vector<double>();
+    }
+    latencies.push_back(ElapsedMs(begin));
+  }
+  return latencies;
+}
+
+void Benchmark(const char* path, const std::string& cache, int seeks) {
+  printf("%s\n", path);
+
+  Clock::time_point begin = Clock::now();
+  KeyframeIndex index;
+  if (!index.Scan(path)) {
+    printf("  Unsupported container, no keyframe found.\n");
+    return;
+  }
+  double scan_ms = ElapsedMs(begin);
+  index.Save(cache.c_str(), path);
+  begin = Clock::now();
+  KeyframeIndex loaded;
+  bool cached = loaded.Load(cache.c_str(), path);
+  printf("  Index: %zu keyframes, scan %.2f ms, cached load %.2f ms%s\n",
+         index.size(), scan_ms, ElapsedMs(begin), cached ? "" : " (failed)");
+
+  mpv_handle* handle = mpv_create();
+  mpv_set_option_string(handle, "vo", "null");
+  mpv_set_option_string(handle, "ao", "null");
+  mpv_set_option_string(handle, "pause", "yes");
+  mpv_set_option_string(handle, "hr-seek", "yes");
+  mpv_set_option_string(handle, "hr-seek-framedrop", "no");
+  mpv_initialize(handle);
+  const char* command[] = {"loadfile", path, NULL};
+  mpv_command(handle, command);
+  double duration = 0.0;
+  if (!WaitFor(handle, MPV_EVENT_PLAYBACK_RESTART) ||
+      mpv_get_property(handle, "duration", MPV_FORMAT_DOUBLE, &duration) < 0 ||
+      duration <= 0.0) {
+    printf("  mpv failed to load the file.\n");
+    mpv_terminate_destroy(handle);
+    return;
+  }
+
+  std::mt19937 random(42);
+  std::vector<int64_t> targets(seeks);
+  for (int64_t& target : targets) {
+    target = random() % (int64_t)(duration * 1000);
+  }
+  std::vector<double> exact =
+      MeasureSeeks(handle, targets, "absolute+exact", nullptr);
+  std::vector<double> keyframes =
+      MeasureSeeks(handle, targets, "absolute+keyframes", nullptr);
+  std::vector<double> snapped =
+      MeasureSeeks(handle, targets, "absolute+keyframes", &index);
+  PrintLatencies("exact", exact);
+  PrintLatencies("keyframes", keyframes);
+  PrintLatencies("snapped", snapped);
+  mpv_terminate_destroy(handle);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  int seeks = 100;
+  std::vector<const char*> paths;
+  for (int i = 1; i < argc; i++) {
+    if (strncmp(argv[i], "--seeks=", 8) == 0) {
+      seeks = std::max(1, atoi(argv[i] + 8));
+    } else {
+      paths.push_back(argv[i]);
+    }
+  }
+  if (paths.empty()) {
+    fprintf(stderr, "Usage: %s <file>... [--seeks=N]\n", argv[0]);
+    return 1;
+  }
+  // Not the user's cache: every run starts cold.
+  char directory[] = "/tmp/keyframe_index_benchmark_XXXXXX";
+  if (mkdtemp(directory) == NULL) {
+    return 1;
+  }
+  for (const char* path : paths) {
+    Benchmark(path, directory, seeks);
+  }
+  std::string command = std::string("rm -rf '") + directory + "'";
+  return system(command.c_str()) == 0 ? 0 : 1;
+}
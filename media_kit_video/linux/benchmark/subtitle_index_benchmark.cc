@@ -0,0 +1,93 @@
+// This file is a part of media_kit
+// (https://github.com/media-kit/media-kit).
+//
+// Copyright © 2026 & onwards, Predidit.
+// All rights reserved.
+// Use of this source code is governed by MIT license that can be found in the
+// LICENSE file.
+
+// Generates a 100k cue SRT file in memory, then measures parse time, query
+// latency & search latency of |SubtitleIndex|.
+//
+// Usage: subtitle_index_benchmark [cue_count]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "include/media_kit_video/subtitle_index.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double ElapsedMs(Clock::time_point begin) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - begin)
+      .count();
+}
+
+void AppendTimestamp(std::string& out, int32_t ms) {
+  char buffer[32];
+  snprintf(buffer, sizeof(buffer), "%02d:%02d:%02d,%03d", ms / 3600000,
+           ms / 60000 % 60, ms / 1000 % 60, ms % 1000);
+  out.append(buffer);
+}
+
+std::string GenerateSrt(size_t count) {
+  std::string out;
+  out.reserve(count * 80);
+  std::mt19937 random(42);
+  int32_t time = 0;
+  for (size_t i = 0; i < count; i++) {
+    time += 500 + random() % 3000;
+    out.append(std::to_string(i + 1)).append("\r\n");
+    AppendTimestamp(out, time);
+    out.append(" --> ");
+    AppendTimestamp(out, time + 1000 + random() % 4000);
+    out.append("\r\n<i>Line ").append(std::to_string(i));
+    out.append(" of the benchmark</i>\r\nsecond line\r\n\r\n");
+  }
+  return out;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  size_t count = argc > 1 ? strtoul(argv[1], nullptr, 10) : 100000;
+  std::string srt = GenerateSrt(count);
+  printf("Input: %zu cues, %.1f MiB\n", count, srt.size() / 1048576.0);
+
+  // Feed in 64 KiB chunks, as |SubtitleIndex::LoadFile| does.
+  Clock::time_point begin = Clock::now();
+  SubtitleIndex index;
+  for (size_t offset = 0; offset < srt.size(); offset += 65536) {
+    index.Feed(srt.data() + offset,
+               std::min<size_t>(65536, srt.size() - offset));
+  }
+  index.Finish();
+  printf("Parse: %.2f ms (%zu cues, %.1f MiB text)\n", ElapsedMs(begin),
+         index.size(), index.text_size() / 1048576.0);
+
+  const int32_t duration = index.cues()[index.size() - 1].end;
+  std::mt19937 random(7);
+  std::vector<uint32_t> out(64);
+  const int kQueries = 1000000;
+  size_t matches = 0;
+  begin = Clock::now();
+  for (int i = 0; i < kQueries; i++) {
+    int32_t time = random() % duration;
+    matches += index.Query(time, time, out.data(), out.size());
+  }
+  double query_ms = ElapsedMs(begin);
+  printf("Query: %.1f ns/query (%zu matches)\n", query_ms * 1e6 / kQueries,
+         matches);
+
+  begin = Clock::now();
+  size_t found = index.Search("LINE 99999", 0, out.data(), out.size());
+  printf("Search: %.2f ms (%zu matches)\n", ElapsedMs(begin), found);
+  return 0;
+}
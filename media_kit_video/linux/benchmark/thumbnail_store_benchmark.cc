@@ -0,0 +1,265 @@
+// This file is a part of media_kit
+// (https://github.com/media-kit/media-kit).
+//
+// Copyright © 2026 & onwards, Predidit.
+// All rights reserved.
+// Use of this source code is governed by MIT license that can be found in the
+// LICENSE file.
+
+// Fills a |ThumbnailStore| with synthetic tiles for a library of |media|
+// videos, then measures what scrolling through the library costs: reopening
+// the store, looking every tile up in library order & in random order, reading
+// its bytes as an image decoder would. The same tiles stored one file each,
+// read with open / read / close, are the baseline. Finally, half of the tiles
+// are regenerated & the store is compacted.
+//
+// Usage: thumbnail_store_benchmark [--media=N] [--tiles=N] [--tile-size=KiB]
+//                                  [--budget=MiB]
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "include/media_kit_video/thumbnail_store.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int64_t kKiB = 1024;
+constexpr int64_t kMiB = 1024 * 1024;
+
+// Preview size requested by the library's grid.
+constexpr int32_t kSize = 320;
+
+double ElapsedMs(Clock::time_point begin) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - begin)
+      .count();
+}
+
+struct Key {
+  std::string media;
+  int64_t time;
+};
+
+// Stands in for the image decoder reading the bytes.
+uint64_t Touch(const uint8_t* data, int64_t length) {
+  uint64_t sum = 0;
+  for (int64_t i = 0; i < length; i += 64) {
+    sum += data[i];
+  }
+  return sum;
+}
+
+void PrintLatencies(const char* name, std::vector<double>& latencies) {
+  std::sort(latencies.begin(), latencies.end());
+  double total = 0.0;
+  for (double latency : latencies) {
+    total += latency;
+  }
+  printf("  %-8s p50 %7.2f us, p99 %7.2f us, max %8.2f us, %7.2f ms per "
+         "1000 tiles\n",
+         name, latencies[latencies.size() / 2] * 1e3,
+         latencies[latencies.size() * 99 / 100] * 1e3, latencies.back() * 1e3,
+         total * 1000 / latencies.size());
+}
+
+// Looks up every key in |order| & reads the tile. Returns the latencies, in
+// milliseconds.
+std::vector<double> Scroll(ThumbnailStore& store,
+                           const std::vector<Key>& keys,
+                           const std::vector<size_t>& order,
+                           uint64_t* sum,
+                           size_t* misses) {
+  std::vector<double> latencies;
+  latencies.reserve(order.size());
+  for (size_t i : order) {
+    Clock::time_point begin = Clock::now();
+    const ThumbnailTile* tile = store.Lookup(keys[i].media, keys[i].time, kSize);
+    if (tile != nullptr) {
+      *sum += Touch(tile->data, tile->length);
+      ThumbnailStore::Release(tile);
+    } else {
+      (*misses)++;
+    }
+    latencies.push_back(ElapsedMs(begin));
+  }
+  return latencies;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  int media = 10000;
+  int tiles = 1;
+  int64_t tile_size = 24;
+  int64_t budget = 1024;
+  for (int i = 1; i < argc; i++) {
+    if (strncmp(argv[i], "--media=", 8) == 0) {
+      media = std::max(1, atoi(argv[i] + 8));
+    } else if (strncmp(argv[i], "--tiles=", 8) == 0) {
+      tiles = std::max(1, atoi(argv[i] + 8));
+    } else if (strncmp(argv[i], "--tile-size=", 12) == 0) {
+      tile_size = std::max(1, atoi(argv[i] + 12));
+    } else if (strncmp(argv[i], "--budget=", 9) == 0) {
+      budget = std::max(1, atoi(argv[i] + 9));
+    } else {
+      fprintf(stderr,
+              "Usage: %s [--media=N] [--tiles=N] [--tile-size=KiB] "
+              "[--budget=MiB]\n",
+              argv[0]);
+      return 1;
+    }
+  }
+  tile_size *= kKiB;
+  budget *= kMiB;
+
+  // Tiles of 50% to 150% of |tile_size|, like JPEGs of varying complexity.
+  std::mt19937_64 random(42);
+  std::vector<uint8_t> pool(tile_size * 2);
+  for (uint8_t& byte : pool) {
+    byte = (uint8_t)random();
+  }
+  std::vector<Key> keys;
+  std::vector<int64_t> lengths;
+  for (int i = 0; i < media; i++) {
+    std::string path = "/media/library/video_" + std::to_string(i) + ".mkv";
+    for (int j = 0; j < tiles; j++) {
+      keys.push_back({path, (int64_t)j * 10000});
+      lengths.push_back(tile_size / 2 + (int64_t)(random() % tile_size));
+    }
+  }
+  std::vector<size_t> sequential(keys.size()), shuffled(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    sequential[i] = shuffled[i] = i;
+  }
+  std::shuffle(shuffled.begin(), shuffled.end(), random);
+
+  printf("%d media x %d tiles of ~%lld KiB, budget %lld MiB\n", media, tiles,
+         (long long)(tile_size / kKiB), (long long)(budget / kMiB));
+
+  // Not the user's store: every run starts empty.
+  char directory[] = "/tmp/thumbnail_store_benchmark_XXXXXX";
+  if (mkdtemp(directory) == NULL) {
+    return 1;
+  }
+  std::string path = std::string(directory) + "/store";
+  auto store = std::make_unique<ThumbnailStore>(path, budget);
+  if (!store->Open()) {
+    fprintf(stderr, "Unable to open the store.\n");
+    return 1;
+  }
+  int64_t bytes = 0;
+  Clock::time_point begin = Clock::now();
+  for (size_t i = 0; i < keys.size(); i++) {
+    const uint8_t* data = pool.data() + i % tile_size;
+    if (!store->Insert(keys[i].media, keys[i].time, kSize,
+                       THUMBNAIL_FORMAT_JPEG, kSize, kSize * 9 / 16, data,
+                       lengths[i])) {
+      fprintf(stderr, "Unable to insert tile %zu.\n", i);
+      return 1;
+    }
+    bytes += lengths[i];
+  }
+  store->Flush();
+  double insert_ms = ElapsedMs(begin);
+  printf("  insert   %9.0f tiles/s, %7.1f MiB/s\n",
+         keys.size() * 1000 / insert_ms, bytes / (double)kMiB * 1000 / insert_ms);
+
+  store.reset();
+  begin = Clock::now();
+  store = std::make_unique<ThumbnailStore>(path, budget);
+  if (!store->Open()) {
+    return 1;
+  }
+  double open_ms = ElapsedMs(begin);
+  struct stat index;
+  std::string index_path = path + "/index";
+  ThumbnailStore::Stats stats = store->GetStats();
+  printf("  open     %9.2f ms, index %.2f MiB, %lld tiles, %.1f MiB\n",
+         open_ms,
+         stat(index_path.c_str(), &index) == 0 ? index.st_size / (double)kMiB
+                                               : 0.0,
+         (long long)stats.tiles, stats.size / (double)kMiB);
+
+  uint64_t sum = 0;
+  size_t misses = 0;
+  std::vector<double> latencies =
+      Scroll(*store, keys, sequential, &sum, &misses);
+  PrintLatencies("scroll", latencies);
+  latencies = Scroll(*store, keys, shuffled, &sum, &misses);
+  PrintLatencies("random", latencies);
+  if (misses > 0) {
+    printf("  %zu misses (evicted beyond the budget)\n", misses);
+  }
+
+  // Baseline: a file per tile.
+  std::string files = std::string(directory) + "/files";
+  mkdir(files.c_str(), 0755);
+  auto file_path = [&](size_t i) {
+    return files + "/" + std::to_string(i) + ".jpg";
+  };
+  for (size_t i = 0; i < keys.size(); i++) {
+    int fd = open(file_path(i).c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0 || write(fd, pool.data() + i % tile_size, lengths[i]) !=
+                      (ssize_t)lengths[i]) {
+      return 1;
+    }
+    close(fd);
+  }
+  std::vector<uint8_t> buffer(tile_size * 2);
+  latencies.clear();
+  for (size_t i : shuffled) {
+    Clock::time_point begin = Clock::now();
+    int fd = open(file_path(i).c_str(), O_RDONLY);
+    ssize_t length = fd >= 0 ? read(fd, buffer.data(), buffer.size()) : -1;
+    if (fd >= 0) {
+      close(fd);
+    }
+    if (length > 0) {
+      sum += Touch(buffer.data(), length);
+    }
+    latencies.push_back(ElapsedMs(begin));
+  }
+  PrintLatencies("files", latencies);
+
+  // Regenerated: half of the tiles replaced, leaving as much garbage.
+  begin = Clock::now();
+  for (size_t i = 0; i < keys.size(); i += 2) {
+    store->Insert(keys[i].media, keys[i].time, kSize, THUMBNAIL_FORMAT_JPEG,
+                  kSize, kSize * 9 / 16, pool.data() + (i + 1) % tile_size,
+                  lengths[i]);
+  }
+  double replace_ms = ElapsedMs(begin);
+  stats = store->GetStats();
+  int64_t file_size = stats.file_size;
+  begin = Clock::now();
+  store->Compact();
+  double compact_ms = ElapsedMs(begin);
+  ThumbnailStore::Stats compacted = store->GetStats();
+  printf("  replace  %9.0f tiles/s, %lld compactions in the background\n",
+         (keys.size() + 1) / 2 * 1000 / replace_ms,
+         (long long)stats.compactions);
+  printf("  compact  %9.2f ms, data file %.1f -> %.1f MiB for %.1f MiB of "
+         "tiles\n",
+         compact_ms, file_size / (double)kMiB,
+         compacted.file_size / (double)kMiB, compacted.size / (double)kMiB);
+  store.reset();
+
+  // Keeps |sum| alive.
+  if (sum == 1) {
+    printf("\n");
+  }
+  std::string command = std::string("rm -rf '") + directory + "'";
+  return system(command.c_str()) == 0 ? 0 : 1;
+}
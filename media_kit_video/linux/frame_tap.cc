@@ -0,0 +1,278 @@
+// This file is a part of media_kit
+// (https://github.com/media-kit/media-kit).
+//
+// Copyright © 2026 & onwards, Predidit.
+// All rights reserved.
+// Use of this source code is governed by MIT license that can be found in the
+// LICENSE file.
+
+#include "include/media_kit_video/frame_tap.h"
+
+#include <algorithm>
+#include <cmath>
+
+FrameTap::FrameTap(FrameTapFormat format,
+                   int32_t width,
+                   int32_t height,
+                   double rate,
+                   int32_t buffer_count)
+    : format_(format),
+      width_(std::max(width, 0)),
+      height_(std::max(height, 0)),
+      interval_(rate > 0.0 ? (int64_t)std::llround(1000000.0 / rate) : 0),
+      buffers_(std::max(buffer_count, 2)) {}
+
+bool FrameTap::IsDue(int64_t time) const {
+  return interval_ == 0 || time - last_time_ >= interval_;
+}
+
+void FrameTap::GetSize(int32_t width,
+                       int32_t height,
+                       int32_t* tap_width,
+                       int32_t* tap_height) const {
+  int64_t w = width, h = height;
+  if (width <= 0 || height <= 0) {
+    w = h = 0;
+  } else if (width_ > 0 && height_ > 0) {
+    w = width_;
+    h = height_;
+  } else if (width_ > 0) {
+    w = width_;
+    h = ((int64_t)width_ * height + width / 2) / width;
+  } else if (height_ > 0) {
+    h = height_;
+    w = ((int64_t)height_ * width + height / 2) / height;
+  }
+  if (format_ != FRAME_TAP_FORMAT_RGBA) {
+    w &= ~1;
+    h &= ~1;
+  }
+  *tap_width = (int32_t)w;
+  *tap_height = (int32_t)h;
+}
+
+bool FrameTap::Deliver(const uint8_t* rgba,
+                       int32_t width,
+                       int32_t height,
+                       int32_t stride,
+                       int64_t time) {
+  // Catch up after a pause, instead of bursting.
+  last_time_ = interval_ > 0 && time - last_time_ < 2 * interval_
+                   ? last_time_ + interval_
+                   : time;
+  uint64_t sequence = ++sequence_;
+  int32_t tap_width = 0, tap_height = 0;
+  GetSize(width, height, &tap_width, &tap_height);
+  if (tap_width <= 0 || tap_height <= 0) {
+    return false;
+  }
+  size_t size = (size_t)tap_width * tap_height *
+                (format_ == FRAME_TAP_FORMAT_RGBA ? 4 : 1);
+  if (format_ != FRAME_TAP_FORMAT_RGBA) {
+    size += size / 2;
+  }
+
+  Buffer* buffer = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (Buffer& candidate : buffers_) {
+      if (candidate.state == FREE) {
+        buffer = &candidate;
+        break;
+      }
+    }
+    if (buffer == nullptr) {
+      // The oldest frame the consumer did not pick up is replaced.
+      for (Buffer& candidate : buffers_) {
+        if (candidate.state == READY &&
+            (buffer == nullptr ||
+             candidate.frame.sequence < buffer->frame.sequence)) {
+          buffer = &candidate;
+        }
+      }
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      if (buffer == nullptr) {
+        return false;
+      }
+    }
+    buffer->state = WRITING;
+  }
+
+  if (buffer->size != size) {
+    buffer->data.reset(new uint8_t[size]);
+    buffer->size = size;
+  }
+  FrameTapFrame* frame = &buffer->frame;
+  *frame = {};
+  uint8_t* data = buffer->data.get();
+  int32_t plane = tap_width * tap_height;
+  switch (format_) {
+    case FRAME_TAP_FORMAT_RGBA:
+      frame->planes[0] = data;
+      frame->strides[0] = tap_width * 4;
+      break;
+    case FRAME_TAP_FORMAT_NV12:
+      frame->planes[0] = data;
+      frame->planes[1] = data + plane;
+      frame->strides[0] = frame->strides[1] = tap_width;
+      break;
+    case FRAME_TAP_FORMAT_I420:
+      frame->planes[0] = data;
+      frame->planes[1] = data + plane;
+      frame->planes[2] = data + plane + plane / 4;
+      frame->strides[0] = tap_width;
+      frame->strides[1] = frame->strides[2] = tap_width / 2;
+      break;
+  }
+  frame->width = tap_width;
+  frame->height = tap_height;
+  frame->format = format_;
+  frame->index = (int32_t)(buffer - buffers_.data());
+  frame->time = time;
+  frame->sequence = sequence;
+  Convert(rgba, width, height, stride, frame);
+
+  Callback callback;
+  void* context;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    callback = callback_;
+    context = callback_context_;
+    buffer->state = callback != nullptr ? ACQUIRED : READY;
+  }
+  if (callback != nullptr) {
+    delivered_.fetch_add(1, std::memory_order_relaxed);
+    callback(this, frame, context);
+  }
+  return true;
+}
+
+void FrameTap::SetCallback(Callback callback, void* context) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  callback_ = callback;
+  callback_context_ = context;
+}
+
+const FrameTapFrame* FrameTap::Acquire() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Buffer* latest = nullptr;
+  for (Buffer& buffer : buffers_) {
+    if (buffer.state != READY) {
+      continue;
+    }
+    if (latest == nullptr || buffer.frame.sequence > latest->frame.sequence) {
+      if (latest != nullptr) {
+        latest->state = FREE;
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+      }
+      latest = &buffer;
+    } else {
+      buffer.state = FREE;
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+  if (latest == nullptr) {
+    return nullptr;
+  }
+  latest->state = ACQUIRED;
+  delivered_.fetch_add(1, std::memory_order_relaxed);
+  return &latest->frame;
+}
+
+void FrameTap::Release(const FrameTapFrame* frame) {
+  if (frame == nullptr || frame->index < 0 ||
+      frame->index >= (int32_t)buffers_.size()) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  Buffer& buffer = buffers_[frame->index];
+  if (buffer.state == ACQUIRED) {
+    buffer.state = FREE;
+  }
+}
+
+void FrameTap::Convert(const uint8_t* rgba,
+                       int32_t width,
+                       int32_t height,
+                       int32_t stride,
+                       FrameTapFrame* frame) const {
+  int32_t w = frame->width, h = frame->height;
+  // Source pixel sampled for (x, y) of the frame: centre-aligned nearest.
+  auto source = [&](int32_t x, int32_t y) {
+    int64_t sx = ((2 * (int64_t)x + 1) * width) / (2 * w);
+    int64_t sy = ((2 * (int64_t)y + 1) * height) / (2 * h);
+    return rgba + sy * stride + sx * 4;
+  };
+  if (frame->format == FRAME_TAP_FORMAT_RGBA) {
+    for (int32_t y = 0; y < h; y++) {
+      uint8_t* row = frame->planes[0] + (size_t)y * frame->strides[0];
+      if (w == width && h == height) {
+        const uint8_t* pixels = rgba + (size_t)y * stride;
+        for (int32_t x = 0; x < w; x++) {
+          row[4 * x + 0] = pixels[4 * x + 0];
+          row[4 * x + 1] = pixels[4 * x + 1];
+          row[4 * x + 2] = pixels[4 * x + 2];
+          row[4 * x + 3] = 255;
+        }
+        continue;
+      }
+      for (int32_t x = 0; x < w; x++) {
+        const uint8_t* pixel = source(x, y);
+        row[4 * x + 0] = pixel[0];
+        row[4 * x + 1] = pixel[1];
+        row[4 * x + 2] = pixel[2];
+        row[4 * x + 3] = 255;
+      }
+    }
+    return;
+  }
+  // BT.601, limited range.
+  for (int32_t y = 0; y < h; y += 2) {
+    uint8_t* luma[2] = {
+        frame->planes[0] + (size_t)y * frame->strides[0],
+        frame->planes[0] + (size_t)(y + 1) * frame->strides[0],
+    };
+    for (int32_t x = 0; x < w; x += 2) {
+      int32_t r = 0, g = 0, b = 0;
+      for (int32_t i = 0; i < 4; i++) {
+        const uint8_t* pixel = source(x + (i & 1), y + (i >> 1));
+        luma[i >> 1][x + (i & 1)] = (uint8_t)(
+            ((66 * pixel[0] + 129 * pixel[1] + 25 * pixel[2] + 128) >> 8) +
+            16);
+        r += pixel[0];
+        g += pixel[1];
+        b += pixel[2];
+      }
+      r = (r + 2) >> 2;
+      g = (g + 2) >> 2;
+      b = (b + 2) >> 2;
+      uint8_t u = (uint8_t)(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+      uint8_t v = (uint8_t)(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+      if (frame->format == FRAME_TAP_FORMAT_NV12) {
+        uint8_t* chroma =
+            frame->planes[1] + (size_t)(y / 2) * frame->strides[1] + x;
+        chroma[0] = u;
+        chroma[1] = v;
+      } else {
+        frame->planes[1][(size_t)(y / 2) * frame->strides[1] + x / 2] = u;
+        frame->planes[2][(size_t)(y / 2) * frame->strides[2] + x / 2] = v;
+      }
+    }
+  }
+}
+
+const FrameTapFrame* frame_tap_acquire(FrameTap* self) {
+  return self->Acquire();
+}
+
+void frame_tap_release(FrameTap* self, const FrameTapFrame* frame) {
+  self->Release(frame);
+}
+
+uint64_t frame_tap_get_delivered(const FrameTap* self) {
+  return self->delivered();
+}
+
+uint64_t frame_tap_get_dropped(const FrameTap* self) {
+  return self->dropped();
+}
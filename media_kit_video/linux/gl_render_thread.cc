@@ -7,10 +7,12 @@
 // LICENSE file.
 
 #include "include/media_kit_video/gl_render_thread.h"
+#include "include/media_kit_video/allocator.h"
+#include "include/media_kit_video/trace.h"
 #include <pthread.h>
 #include <sched.h>
 
-GLRenderThread::GLRenderThread() : stop_(false) {
+GLRenderThread::GLRenderThread() : tasks_(kInitialCapacity), stop_(false) {
   // Start the dedicated GL render thread
   thread_ = std::thread([this]() { Run(); });
   
@@ -43,7 +45,17 @@ void GLRenderThread::Post(std::function<void()> task) {
     if (stop_) {
       return;
     }
-    tasks_.push(std::move(task));
+    if (count_ == tasks_.size()) {
+      // Full; unroll the ring into a larger one.
+      std::vector<std::function<void()>> tasks(tasks_.size() * 2);
+      for (size_t i = 0; i < count_; i++) {
+        tasks[i] = std::move(tasks_[(head_ + i) % tasks_.size()]);
+      }
+      tasks_.swap(tasks);
+      head_ = 0;
+    }
+    tasks_[(head_ + count_) % tasks_.size()] = std::move(task);
+    count_++;
   }
   cv_.notify_one();
 }
@@ -71,12 +83,18 @@ bool GLRenderThread::IsCurrentThread() const {
 }
 
 void GLRenderThread::Run() {
+  pthread_setname_np(pthread_self(), "media_kit_gl");
+
   // Store thread ID
   {
     std::lock_guard<std::mutex> lock(mutex_);
     thread_id_ = std::this_thread::get_id();
   }
   cv_.notify_one();
+
+  // Keep the render path's allocations (mpv_render_context, GL driver) apart
+  // from the rest of the process when mimalloc is in use.
+  Allocator::CreateThreadHeap();
   
   // Main loop: process tasks
   while (true) {
@@ -84,20 +102,25 @@ void GLRenderThread::Run() {
     
     {
       std::unique_lock<std::mutex> lock(mutex_);
-      cv_.wait(lock, [this]() { return stop_ || !tasks_.empty(); });
+      cv_.wait(lock, [this]() { return stop_ || count_ > 0; });
       
-      if (stop_ && tasks_.empty()) {
+      if (stop_ && count_ == 0) {
         break;
       }
       
-      if (!tasks_.empty()) {
-        task = std::move(tasks_.front());
-        tasks_.pop();
+      if (count_ > 0) {
+        task = std::move(tasks_[head_]);
+        tasks_[head_] = nullptr;
+        head_ = (head_ + 1) % tasks_.size();
+        count_--;
       }
     }
     
     if (task) {
+      TRACE_SCOPE("GLRenderThread::Run", -1);
       task();
     }
   }
+
+  Allocator::DeleteThreadHeap();
 }
@@ -0,0 +1,983 @@
+// This file is a part of media_kit
+// (https://github.com/media-kit/media-kit).
+//
+// Copyright © 2026 & onwards, Predidit.
+// All rights reserved.
+// Use of this source code is governed by MIT license that can be found in the
+// LICENSE file.
+
+#include "include/media_kit_video/http_cache_proxy.h"
+
+#include <errno.h>
+#include <gio/gio.h>
+#include <netinet/in.h>
+#include <strings.h>
+#include <sys/random.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+namespace {
+
+constexpr size_t kChunkSize = 64 * 1024;
+// Request & response heads larger than this are rejected.
+constexpr size_t kMaxHeadSize = 32 * 1024;
+constexpr int kMaxRedirects = 5;
+// Seconds without progress before the origin, or a client sending its
+// request, is given up on.
+constexpr int kTimeout = 30;
+// Minimum interval between flushes of the store's index, in milliseconds.
+constexpr int64_t kFlushInterval = 5000;
+// Random bytes of the token in the proxy's URLs.
+constexpr size_t kTokenSize = 16;
+constexpr char kHex[] = "0123456789ABCDEF";
+
+int64_t Now() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+bool StartsWith(const std::string& value, const char* prefix) {
+  return strncasecmp(value.c_str(), prefix, strlen(prefix)) == 0;
+}
+
+std::string PercentEncode(const std::string& value) {
+  std::string result;
+  result.reserve(value.size() * 3);
+  for (char c : value) {
+    if (isalnum((unsigned char)c) || strchr("-._~", c) != nullptr) {
+      result.push_back(c);
+    } else {
+      result.push_back('%');
+      result.push_back(kHex[(uint8_t)c >> 4]);
+      result.push_back(kHex[(uint8_t)c & 0xF]);
+    }
+  }
+  return result;
+}
+
+// Returns |kTokenSize| random bytes in hex, or an empty string on failure.
+std::string MakeToken() {
+  uint8_t bytes[kTokenSize];
+  if (getrandom(bytes, sizeof(bytes), 0) != (ssize_t)sizeof(bytes)) {
+    return std::string();
+  }
+  std::string token;
+  for (uint8_t byte : bytes) {
+    token.push_back(kHex[byte >> 4]);
+    token.push_back(kHex[byte & 0xF]);
+  }
+  return token;
+}
+
+std::string PercentDecode(const std::string& value) {
+  std::string result;
+  result.reserve(value.size());
+  for (size_t i = 0; i < value.size(); i++) {
+    if (value[i] == '%' && i + 2 < value.size() &&
+        isxdigit((unsigned char)value[i + 1]) &&
+        isxdigit((unsigned char)value[i + 2])) {
+      result.push_back((char)strtol(value.substr(i + 1, 2).c_str(), nullptr,
+                                    16));
+      i += 2;
+    } else {
+      result.push_back(value[i]);
+    }
+  }
+  return result;
+}
+
+// An http:// or https:// URL, as requested from the origin.
+struct Url {
+  bool tls = false;
+  std::string authority;  // Host & port, without user information.
+  uint16_t port = 0;      // Default port of the scheme.
+  std::string target;     // Path & query.
+
+  bool Parse(const std::string& url) {
+    size_t begin;
+    if (StartsWith(url, "http://")) {
+      tls = false;
+      port = 80;
+      begin = 7;
+    } else if (StartsWith(url, "https://")) {
+      tls = true;
+      port = 443;
+      begin = 8;
+    } else {
+      return false;
+    }
+    size_t end = url.find_first_of("/?#", begin);
+    authority = url.substr(begin, end == std::string::npos ? std::string::npos
+                                                          : end - begin);
+    size_t at = authority.rfind('@');
+    if (at != std::string::npos) {
+      authority.erase(0, at + 1);
+    }
+    target = end == std::string::npos ? "/" : url.substr(end);
+    target = target.substr(0, target.find('#'));
+    if (target.empty() || target[0] != '/') {
+      target.insert(0, "/");
+    }
+    return !authority.empty();
+  }
+
+  // Resolves a `Location` against this URL.
+  bool Resolve(const std::string& location) {
+    if (StartsWith(location, "http://") || StartsWith(location, "https://")) {
+      return Parse(location);
+    }
+    std::string base = (tls ? "https://" : "http://") + authority;
+    if (location.compare(0, 2, "//") == 0) {
+      return Parse((tls ? "https:" : "http:") + location);
+    }
+    if (!location.empty() && location[0] == '/') {
+      return Parse(base + location);
+    }
+    std::string path = target.substr(0, target.find('?'));
+    return Parse(base + path.substr(0, path.rfind('/') + 1) + location);
+  }
+};
+
+// Status or request line & fields of an HTTP/1.1 message.
+struct Head {
+  std::string line;
+  int status = 0;  // Responses only.
+  std::vector<std::pair<std::string, std::string>> fields;
+
+  bool Parse(const std::string& text) {
+    size_t end = text.find("\r\n");
+    line = text.substr(0, end);
+    fields.clear();
+    status = 0;
+    if (StartsWith(line, "HTTP/")) {
+      size_t space = line.find(' ');
+      status = space != std::string::npos ? atoi(line.c_str() + space + 1) : 0;
+      if (status < 100 || status > 599) {
+        return false;
+      }
+    }
+    while (end != std::string::npos) {
+      size_t begin = end + 2;
+      end = text.find("\r\n", begin);
+      std::string field = text.substr(
+          begin, end == std::string::npos ? std::string::npos : end - begin);
+      size_t colon = field.find(':');
+      if (colon == std::string::npos || colon == 0) {
+        continue;
+      }
+      size_t value = field.find_first_not_of(" \t", colon + 1);
+      size_t value_end = field.find_last_not_of(" \t");
+      fields.emplace_back(
+          field.substr(0, colon),
+          value == std::string::npos
+              ? std::string()
+              : field.substr(value, value_end - value + 1));
+    }
+    return !line.empty();
+  }
+
+  const char* Get(const char* name) const {
+    for (const auto& [field, value] : fields) {
+      if (strcasecmp(field.c_str(), name) == 0) {
+        return value.c_str();
+      }
+    }
+    return nullptr;
+  }
+};
+
+// Connection-specific fields, never forwarded.
+bool IsHopByHop(const std::string& field) {
+  static const char* const kFields[] = {
+      "Connection",          "Keep-Alive", "Proxy-Connection",
+      "Proxy-Authenticate",  "Proxy-Authorization",
+      "TE",                  "Trailer",    "Transfer-Encoding",
+      "Upgrade",
+  };
+  for (const char* name : kFields) {
+    if (strcasecmp(field.c_str(), name) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// A connection: a client's socket or the origin's.
+class Stream {
+ public:
+  virtual ~Stream() = default;
+
+  // Returns the number of bytes read, 0 at the end, -1 on error.
+  virtual ssize_t ReadSome(void* data, size_t size) = 0;
+  virtual bool WriteAll(const void* data, size_t size) = 0;
+
+  bool WriteAll(const std::string& data) {
+    return WriteAll(data.data(), data.size());
+  }
+
+  // Reads up to an empty line, which is consumed.
+  bool ReadHead(Head* head) {
+    std::string text;
+    return ReadUntil("\r\n\r\n", &text) && head->Parse(text);
+  }
+
+  bool ReadLine(std::string* line) { return ReadUntil("\r\n", line); }
+
+  // Reads what is buffered by |ReadHead| & |ReadLine| first.
+  ssize_t Read(void* data, size_t size) {
+    if (buffer_offset_ < buffer_.size()) {
+      size = std::min(size, buffer_.size() - buffer_offset_);
+      memcpy(data, buffer_.data() + buffer_offset_, size);
+      buffer_offset_ += size;
+      return (ssize_t)size;
+    }
+    return ReadSome(data, size);
+  }
+
+ private:
+  bool ReadUntil(const char* delimiter, std::string* text) {
+    size_t length = strlen(delimiter);
+    for (;;) {
+      size_t found = buffer_.find(delimiter, buffer_offset_);
+      if (found != std::string::npos) {
+        text->assign(buffer_, buffer_offset_, found - buffer_offset_);
+        buffer_offset_ = found + length;
+        return true;
+      }
+      if (buffer_.size() - buffer_offset_ > kMaxHeadSize) {
+        return false;
+      }
+      buffer_.erase(0, buffer_offset_);
+      buffer_offset_ = 0;
+      char chunk[4096];
+      ssize_t result = ReadSome(chunk, sizeof(chunk));
+      if (result <= 0) {
+        return false;
+      }
+      buffer_.append(chunk, result);
+    }
+  }
+
+  std::string buffer_;
+  size_t buffer_offset_ = 0;
+};
+
+class SocketStream : public Stream {
+ public:
+  explicit SocketStream(int fd) : fd_(fd) {}
+
+  ssize_t ReadSome(void* data, size_t size) override {
+    ssize_t result;
+    while ((result = recv(fd_, data, size, 0)) < 0 && errno == EINTR) {
+    }
+    return result;
+  }
+
+  bool WriteAll(const void* data, size_t size) override {
+    const uint8_t* p = (const uint8_t*)data;
+    while (size > 0) {
+      ssize_t result = send(fd_, p, size, MSG_NOSIGNAL);
+      if (result < 0 && errno == EINTR) {
+        continue;
+      }
+      if (result <= 0) {
+        return false;
+      }
+      p += result;
+      size -= result;
+    }
+    return true;
+  }
+
+  using Stream::WriteAll;
+
+ private:
+  int fd_;
+};
+
+// Connection to the origin, through GIO for TLS & name resolution.
+class OriginStream : public Stream {
+ public:
+  explicit OriginStream(GCancellable* cancellable)
+      : cancellable_(cancellable) {}
+
+  ~OriginStream() override {
+    if (connection_ != nullptr) {
+      g_io_stream_close(G_IO_STREAM(connection_), nullptr, nullptr);
+      g_object_unref(connection_);
+    }
+  }
+
+  bool Connect(const Url& url) {
+    GSocketClient* client = g_socket_client_new();
+    g_socket_client_set_timeout(client, kTimeout);
+    g_socket_client_set_tls(client, url.tls);
+    GError* error = nullptr;
+    connection_ = g_socket_client_connect_to_host(
+        client, url.authority.c_str(), url.port, cancellable_, &error);
+    g_object_unref(client);
+    if (connection_ == nullptr) {
+      if (!g_cancellable_is_cancelled(cancellable_)) {
+        fprintf(stderr, "media_kit: HttpCacheProxy: %s: %s\n",
+                url.authority.c_str(), error->message);
+      }
+      g_error_free(error);
+      return false;
+    }
+    return true;
+  }
+
+  ssize_t ReadSome(void* data, size_t size) override {
+    GInputStream* input =
+        g_io_stream_get_input_stream(G_IO_STREAM(connection_));
+    GError* error = nullptr;
+    gssize result =
+        g_input_stream_read(input, data, size, cancellable_, &error);
+    if (error != nullptr) {
+      g_error_free(error);
+    }
+    return result;
+  }
+
+  bool WriteAll(const void* data, size_t size) override {
+    GOutputStream* output =
+        g_io_stream_get_output_stream(G_IO_STREAM(connection_));
+    GError* error = nullptr;
+    gboolean result = g_output_stream_write_all(output, data, size, nullptr,
+                                                cancellable_, &error);
+    if (error != nullptr) {
+      g_error_free(error);
+    }
+    return result;
+  }
+
+  using Stream::WriteAll;
+
+ private:
+  GCancellable* cancellable_;
+  GSocketConnection* connection_ = nullptr;
+};
+
+// Reads a message body, framed by `Content-Length`, chunked or up to the end
+// of the connection.
+class Body {
+ public:
+  Body(Stream* stream, const Head& head, bool empty) : stream_(stream) {
+    const char* encoding = head.Get("Transfer-Encoding");
+    const char* length = head.Get("Content-Length");
+    if (empty || head.status == 204 || head.status == 304) {
+      remaining_ = 0;
+    } else if (encoding != nullptr && strcasestr(encoding, "chunked")) {
+      chunked_ = true;
+    } else if (length != nullptr) {
+      remaining_ = std::max<int64_t>(strtoll(length, nullptr, 10), 0);
+    }
+  }
+
+  // Known length, -1 if not.
+  int64_t length() const { return chunked_ ? -1 : remaining_; }
+
+  // Returns the number of bytes read, 0 at the end, -1 on error.
+  ssize_t Read(void* data, size_t size) {
+    if (chunked_) {
+      std::string line;
+      if (done_) {
+        return 0;
+      }
+      if (chunk_ == 0) {
+        if (!stream_->ReadLine(&line)) {
+          return -1;
+        }
+        chunk_ = strtoll(line.c_str(), nullptr, 16);
+        if (chunk_ <= 0) {
+          // Trailer.
+          do {
+            if (!stream_->ReadLine(&line)) {
+              return -1;
+            }
+          } while (!line.empty());
+          done_ = true;
+          return 0;
+        }
+      }
+      ssize_t result = stream_->Read(data, std::min<int64_t>(size, chunk_));
+      if (result <= 0) {
+        return -1;
+      }
+      chunk_ -= result;
+      if (chunk_ == 0 && !stream_->ReadLine(&line)) {
+        return -1;
+      }
+      return result;
+    }
+    if (remaining_ == 0) {
+      return 0;
+    }
+    ssize_t result = stream_->Read(
+        data, remaining_ > 0 ? std::min<int64_t>(size, remaining_) : size);
+    if (result == 0 && remaining_ > 0) {
+      // Truncated.
+      return -1;
+    }
+    if (result > 0 && remaining_ > 0) {
+      remaining_ -= result;
+    }
+    return result;
+  }
+
+ private:
+  Stream* stream_;
+  bool chunked_ = false;
+  bool done_ = false;
+  int64_t chunk_ = 0;
+  int64_t remaining_ = -1;
+};
+
+// Extracts what identifies the resource a 200 or 206 response is part of &
+// the offset of its body. Returns false if it cannot be stored: ranges not
+// supported, unknown length, weak or no validator, content coding.
+bool GetResource(const Head& head,
+                 HttpCacheStore::Resource* resource,
+                 int64_t* offset) {
+  const char* etag = head.Get("ETag");
+  const char* last_modified = head.Get("Last-Modified");
+  const char* encoding = head.Get("Content-Encoding");
+  const char* transfer_encoding = head.Get("Transfer-Encoding");
+  const char* type = head.Get("Content-Type");
+  if ((encoding != nullptr && strcasecmp(encoding, "identity") != 0) ||
+      transfer_encoding != nullptr) {
+    return false;
+  }
+  // Weak validators cannot be used with `If-Range`.
+  if (etag != nullptr && etag[0] == '"') {
+    resource->validator = etag;
+  } else if (last_modified != nullptr && *last_modified != '\0') {
+    resource->validator = last_modified;
+  } else {
+    return false;
+  }
+  resource->type = type != nullptr ? type : "";
+  if (head.status == 206) {
+    const char* range = head.Get("Content-Range");
+    long long start, end, length;
+    if (range == nullptr ||
+        sscanf(range, "bytes %lld-%lld/%lld", &start, &end, &length) != 3 ||
+        start < 0 || end < start || length <= end) {
+      return false;
+    }
+    *offset = start;
+    resource->length = length;
+    return true;
+  }
+  const char* ranges = head.Get("Accept-Ranges");
+  const char* length = head.Get("Content-Length");
+  if (head.status != 200 || ranges == nullptr ||
+      strcasecmp(ranges, "bytes") != 0 || length == nullptr) {
+    return false;
+  }
+  *offset = 0;
+  resource->length = strtoll(length, nullptr, 10);
+  return resource->length > 0;
+}
+
+}  // namespace
+
+struct HttpCacheProxy::Client {
+  ~Client() {
+    close(fd);
+    g_object_unref(cancellable);
+  }
+
+  int fd = -1;
+  GCancellable* cancellable = nullptr;  // Aborts I/O with the origin.
+  std::thread thread;
+  std::atomic<bool> done{false};
+};
+
+// A request of a client, served from the store & the origin.
+class HttpCacheProxy::Request {
+ public:
+  Request(HttpCacheProxy* proxy, Client* client)
+      : proxy_(proxy), client_(client), socket_(client->fd) {}
+
+  void Run() {
+    Head request;
+    if (!socket_.ReadHead(&request)) {
+      return;
+    }
+    proxy_->requests_++;
+    size_t method_end = request.line.find(' ');
+    size_t target_end = request.line.find(' ', method_end + 1);
+    if (method_end == std::string::npos || target_end == std::string::npos) {
+      Respond("400 Bad Request");
+      return;
+    }
+    method_ = request.line.substr(0, method_end);
+    std::string target =
+        request.line.substr(method_end + 1, target_end - method_end - 1);
+    if (method_ != "GET" && method_ != "HEAD") {
+      Respond("405 Method Not Allowed");
+      return;
+    }
+    // Only URLs handed out by |GetUrl|, requested by their host name.
+    const char* host = request.Get("Host");
+    if (host == nullptr || proxy_->host_ != host ||
+        target.compare(0, proxy_->path_.size(), proxy_->path_) != 0) {
+      Respond("403 Forbidden");
+      return;
+    }
+    url_ = PercentDecode(target.substr(proxy_->path_.size()));
+    if (!origin_.Parse(url_)) {
+      Respond("400 Bad Request");
+      return;
+    }
+    for (const auto& [field, value] : request.fields) {
+      if (!IsHopByHop(field) && strcasecmp(field.c_str(), "Host") != 0 &&
+          strcasecmp(field.c_str(), "Range") != 0 &&
+          strcasecmp(field.c_str(), "If-Range") != 0 &&
+          strcasecmp(field.c_str(), "Accept-Encoding") != 0) {
+        fields_ += field + ": " + value + "\r\n";
+      }
+    }
+
+    // Only single ranges with a start are served from the store.
+    const char* range = request.Get("Range");
+    long long start = 0, end = -1;
+    int consumed = 0;
+    if (range == nullptr) {
+      start_ = 0;
+    } else if (sscanf(range, "bytes=%lld-%n", &start, &consumed) == 1 &&
+               consumed > 0 && start >= 0) {
+      start_ = start;
+      if (range[consumed] != '\0') {
+        char* rest = nullptr;
+        end = strtoll(range + consumed, &rest, 10);
+        end_ = rest != nullptr && *rest == '\0' && end >= start ? end : -2;
+      }
+      ranged_ = true;
+    } else {
+      start_ = -1;
+    }
+    if (start_ < 0 || end_ == -2) {
+      Fetch(range, false);
+      return;
+    }
+
+    HttpCacheStore::Resource resource;
+    if (proxy_->store_.Lookup(url_, &resource) && Validate(resource)) {
+      Serve(resource);
+    } else {
+      std::string origin_range;
+      if (ranged_) {
+        origin_range = "bytes=" + std::to_string(start_) + "-" +
+                       (end_ >= 0 ? std::to_string(end_) : "");
+      }
+      Fetch(ranged_ ? origin_range.c_str() : nullptr, method_ == "GET");
+    }
+  }
+
+ private:
+  void Respond(const char* status) {
+    socket_.WriteAll(std::string("HTTP/1.1 ") + status +
+                     "\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+  }
+
+  // Sends |method| for |range| of the resource, following redirects.
+  bool Open(const char* method,
+            const char* range,
+            const char* if_range,
+            std::unique_ptr<OriginStream>* origin,
+            Head* head) {
+    Url url = origin_;
+    for (int i = 0; i <= kMaxRedirects; i++) {
+      origin->reset(new OriginStream(client_->cancellable));
+      std::string request = std::string(method) + " " + url.target +
+                            " HTTP/1.1\r\nHost: " + url.authority + "\r\n" +
+                            fields_;
+      if (range != nullptr) {
+        request += std::string("Range: ") + range + "\r\n";
+      }
+      if (if_range != nullptr) {
+        request += std::string("If-Range: ") + if_range + "\r\n";
+      }
+      request += "Accept-Encoding: identity\r\nConnection: close\r\n\r\n";
+      if (!(*origin)->Connect(url) || !(*origin)->WriteAll(request) ||
+          !(*origin)->ReadHead(head)) {
+        return false;
+      }
+      const char* location = head->Get("Location");
+      bool redirect = head->status == 301 || head->status == 302 ||
+                      head->status == 303 || head->status == 307 ||
+                      head->status == 308;
+      if (!redirect || location == nullptr) {
+        return true;
+      }
+      if (!url.Resolve(location)) {
+        return false;
+      }
+    }
+    return false;
+  }
+
+  // Checks the stored resource against the origin, once per run.
+  bool Validate(const HttpCacheStore::Resource& resource) {
+    {
+      std::lock_guard<std::mutex> lock(proxy_->mutex_);
+      if (proxy_->validated_.count(url_) != 0) {
+        return true;
+      }
+    }
+    std::unique_ptr<OriginStream> origin;
+    Head head;
+    if (!Open("GET", "bytes=0-0", nullptr, &origin, &head) ||
+        head.status >= 500) {
+      // Unreachable: the stored ranges are served, e.g. offline.
+      return true;
+    }
+    HttpCacheStore::Resource current;
+    int64_t offset;
+    if (!GetResource(head, &current, &offset) ||
+        current.validator != resource.validator ||
+        current.length != resource.length) {
+      proxy_->store_.Remove(url_);
+      return false;
+    }
+    std::lock_guard<std::mutex> lock(proxy_->mutex_);
+    proxy_->validated_.insert(url_);
+    return true;
+  }
+
+  // Relays the origin's response, storing its body if |store|.
+  void Fetch(const char* range, bool store) {
+    std::unique_ptr<OriginStream> origin;
+    Head head;
+    if (!Open(method_.c_str(), range, nullptr, &origin, &head)) {
+      Respond("502 Bad Gateway");
+      return;
+    }
+    HttpCacheStore::Resource resource;
+    int64_t offset = -1;
+    if (!store || !GetResource(head, &resource, &offset) ||
+        !proxy_->store_.Insert(url_, resource)) {
+      offset = -1;
+    } else {
+      std::lock_guard<std::mutex> lock(proxy_->mutex_);
+      proxy_->validated_.insert(url_);
+    }
+    bool head_only = method_ == "HEAD";
+    Body body(origin.get(), head, head_only);
+    std::string response = head.line + "\r\n";
+    for (const auto& [field, value] : head.fields) {
+      if (!IsHopByHop(field) &&
+          (head_only || strcasecmp(field.c_str(), "Content-Length") != 0)) {
+        response += field + ": " + value + "\r\n";
+      }
+    }
+    if (!head_only && body.length() >= 0) {
+      response += "Content-Length: " + std::to_string(body.length()) + "\r\n";
+    }
+    response += "Connection: close\r\n\r\n";
+    if (!socket_.WriteAll(response)) {
+      return;
+    }
+    std::vector<uint8_t> chunk(kChunkSize);
+    ssize_t read;
+    while ((read = body.Read(chunk.data(), chunk.size())) > 0) {
+      proxy_->miss_bytes_ += read;
+      if (!socket_.WriteAll(chunk.data(), read)) {
+        break;
+      }
+      if (offset >= 0 &&
+          !proxy_->store_.Write(url_, offset, chunk.data(), read)) {
+        offset = -1;
+      } else if (offset >= 0) {
+        offset += read;
+      }
+    }
+  }
+
+  // Serves [|start_|, |end_|] of the stored |resource|, fetching the ranges
+  // missing from the origin.
+  void Serve(const HttpCacheStore::Resource& resource) {
+    int64_t length = resource.length;
+    int64_t start = start_;
+    int64_t end = end_ >= 0 ? std::min(end_, length - 1) : length - 1;
+    if (start >= length) {
+      socket_.WriteAll("HTTP/1.1 416 Range Not Satisfiable\r\nContent-Range: "
+                       "bytes */" +
+                       std::to_string(length) +
+                       "\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+      return;
+    }
+    std::string response = ranged_ ? "HTTP/1.1 206 Partial Content\r\n"
+                                    : "HTTP/1.1 200 OK\r\n";
+    if (!resource.type.empty()) {
+      response += "Content-Type: " + resource.type + "\r\n";
+    }
+    response += "Content-Length: " + std::to_string(end - start + 1) + "\r\n";
+    if (ranged_) {
+      response += "Content-Range: bytes " + std::to_string(start) + "-" +
+                  std::to_string(end) + "/" + std::to_string(length) + "\r\n";
+    }
+    response += (resource.validator[0] == '"' ? "ETag: " : "Last-Modified: ") +
+                resource.validator + "\r\n";
+    response += "Accept-Ranges: bytes\r\nConnection: close\r\n\r\n";
+    if (!socket_.WriteAll(response) || method_ == "HEAD") {
+      return;
+    }
+    std::vector<uint8_t> chunk(kChunkSize);
+    for (int64_t position = start; position <= end;) {
+      int64_t next = end + 1;
+      int64_t available = proxy_->store_.Available(url_, position, &next);
+      if (available > 0) {
+        int64_t size =
+            std::min<int64_t>({available, end + 1 - position, kChunkSize});
+        if (proxy_->store_.Read(url_, position, chunk.data(), size)) {
+          proxy_->hit_bytes_ += size;
+          if (!socket_.WriteAll(chunk.data(), size)) {
+            return;
+          }
+          position += size;
+          continue;
+        }
+        // Evicted meanwhile.
+        next = end + 1;
+      }
+      int64_t stop = std::min(std::max(next, position + 1), end + 1);
+      if (!FetchRange(resource, stop, &position, &chunk)) {
+        // Closing the connection early makes mpv reconnect.
+        return;
+      }
+    }
+  }
+
+  // Relays & stores [|*position|, |stop|) from the origin.
+  bool FetchRange(const HttpCacheStore::Resource& resource,
+                  int64_t stop,
+                  int64_t* position,
+                  std::vector<uint8_t>* chunk) {
+    std::unique_ptr<OriginStream> origin;
+    Head head;
+    std::string range = "bytes=" + std::to_string(*position) + "-" +
+                        std::to_string(stop - 1);
+    if (!Open("GET", range.c_str(), resource.validator.c_str(), &origin,
+              &head)) {
+      return false;
+    }
+    HttpCacheStore::Resource current;
+    int64_t offset = -1;
+    if (head.status != 206 || !GetResource(head, &current, &offset) ||
+        offset != *position || current.validator != resource.validator ||
+        current.length != resource.length) {
+      // Changed at the origin: what was already sent is stale.
+      if (head.status < 500) {
+        proxy_->store_.Remove(url_);
+        std::lock_guard<std::mutex> lock(proxy_->mutex_);
+        proxy_->validated_.erase(url_);
+      }
+      return false;
+    }
+    Body body(origin.get(), head, false);
+    while (*position < stop) {
+      ssize_t read = body.Read(
+          chunk->data(), std::min<int64_t>(chunk->size(), stop - *position));
+      if (read <= 0) {
+        return false;
+      }
+      proxy_->miss_bytes_ += read;
+      proxy_->store_.Write(url_, *position, chunk->data(), read);
+      if (!socket_.WriteAll(chunk->data(), read)) {
+        return false;
+      }
+      *position += read;
+    }
+    return true;
+  }
+
+  HttpCacheProxy* proxy_;
+  Client* client_;
+  SocketStream socket_;
+  std::string method_;
+  std::string url_;
+  Url origin_;
+  std::string fields_;  // Forwarded to the origin.
+  bool ranged_ = false;
+  int64_t start_ = 0;
+  int64_t end_ = -1;  // Inclusive, -1 for the end of the resource.
+};
+
+HttpCacheProxy::HttpCacheProxy(std::string directory, int64_t max_size)
+    : store_(std::move(directory), max_size) {}
+
+HttpCacheProxy::~HttpCacheProxy() {
+  if (listener_ >= 0) {
+    // Makes |accept| fail.
+    shutdown(listener_, SHUT_RDWR);
+  }
+  if (acceptor_.joinable()) {
+    acceptor_.join();
+  }
+  if (listener_ >= 0) {
+    close(listener_);
+  }
+  std::list<std::unique_ptr<Client>> clients;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    clients.swap(clients_);
+  }
+  for (const std::unique_ptr<Client>& client : clients) {
+    shutdown(client->fd, SHUT_RDWR);
+    g_cancellable_cancel(client->cancellable);
+  }
+  for (const std::unique_ptr<Client>& client : clients) {
+    client->thread.join();
+  }
+}
+
+bool HttpCacheProxy::Start() {
+  if (!store_.Open()) {
+    return false;
+  }
+  listener_ = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  struct sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t size = sizeof(address);
+  if (listener_ < 0 ||
+      bind(listener_, (struct sockaddr*)&address, sizeof(address)) != 0 ||
+      listen(listener_, SOMAXCONN) != 0 ||
+      getsockname(listener_, (struct sockaddr*)&address, &size) != 0) {
+    return false;
+  }
+  std::string token = MakeToken();
+  if (token.empty()) {
+    return false;
+  }
+  port_ = ntohs(address.sin_port);
+  host_ = "127.0.0.1:" + std::to_string(port_);
+  path_ = "/" + token + "/";
+  prefix_ = "http://" + host_ + path_;
+  acceptor_ = std::thread(&HttpCacheProxy::Accept, this);
+  return true;
+}
+
+std::string HttpCacheProxy::GetUrl(const std::string& url) const {
+  if (!StartsWith(url, "http://") && !StartsWith(url, "https://")) {
+    return url;
+  }
+  return prefix_ + PercentEncode(url);
+}
+
+HttpCacheProxy::Stats HttpCacheProxy::GetStats() {
+  Stats stats;
+  stats.requests = requests_;
+  stats.hit_bytes = hit_bytes_;
+  stats.miss_bytes = miss_bytes_;
+  stats.store = store_.GetStats();
+  return stats;
+}
+
+void HttpCacheProxy::Accept() {
+  for (;;) {
+    int fd = accept4(listener_, nullptr, nullptr, SOCK_CLOEXEC);
+    if (fd < 0) {
+      if (errno == EINTR || errno == ECONNABORTED) {
+        continue;
+      }
+      break;
+    }
+    // Only bounds reading the request: mpv stops reading the body for as
+    // long as its demuxer cache is full.
+    struct timeval timeout = {kTimeout, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    auto client = std::make_unique<Client>();
+    client->fd = fd;
+    client->cancellable = g_cancellable_new();
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = clients_.begin(); it != clients_.end();) {
+      if ((*it)->done) {
+        (*it)->thread.join();
+        it = clients_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    if (clients_.size() >= kMaxClients) {
+      // The socket's buffer is empty: never blocks.
+      static const char kResponse[] =
+          "HTTP/1.1 503 Service Unavailable\r\nContent-Length: 0\r\n"
+          "Connection: close\r\n\r\n";
+      send(fd, kResponse, sizeof(kResponse) - 1, MSG_DONTWAIT | MSG_NOSIGNAL);
+      continue;
+    }
+    client->thread = std::thread(&HttpCacheProxy::Serve, this, client.get());
+    clients_.push_back(std::move(client));
+  }
+}
+
+void HttpCacheProxy::Serve(Client* client) {
+  Request(this, client).Run();
+  // Closed once reaped, so that |~HttpCacheProxy| never shuts down another fd.
+  shutdown(client->fd, SHUT_RDWR);
+  // mpv opens a connection per seek: the index is not rewritten for each.
+  int64_t now = Now();
+  int64_t last_flush = last_flush_;
+  if (now - last_flush >= kFlushInterval &&
+      last_flush_.compare_exchange_strong(last_flush, now)) {
+    store_.Flush();
+  }
+  client->done = true;
+}
+
+// C API.
+
+HttpCacheProxy* http_cache_proxy_start(const char* directory,
+                                       int64_t max_size) {
+  std::string path = directory != nullptr ? std::string(directory)
+                                          : HttpCacheStore::DefaultDirectory();
+  HttpCacheProxy* self = new HttpCacheProxy(path, max_size);
+  if (!self->Start()) {
+    fprintf(stderr, "media_kit: HttpCacheProxy: Unable to start in %s.\n",
+            path.c_str());
+    delete self;
+    return nullptr;
+  }
+  return self;
+}
+
+void http_cache_proxy_stop(HttpCacheProxy* self) {
+  delete self;
+}
+
+int32_t http_cache_proxy_get_port(const HttpCacheProxy* self) {
+  return self->port();
+}
+
+const char* http_cache_proxy_get_prefix(const HttpCacheProxy* self) {
+  return self->prefix().c_str();
+}
+
+void http_cache_proxy_get_stats(HttpCacheProxy* self, int64_t* stats) {
+  HttpCacheProxy::Stats values = self->GetStats();
+  stats[0] = values.requests;
+  stats[1] = values.hit_bytes;
+  stats[2] = values.miss_bytes;
+  stats[3] = values.store.size;
+  stats[4] = values.store.resources;
+  stats[5] = values.store.evictions;
+}
+
+void http_cache_proxy_clear(HttpCacheProxy* self) {
+  self->store().Clear();
+}
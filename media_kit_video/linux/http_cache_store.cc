@@ -0,0 +1,556 @@
+// This file is a part of media_kit
+// (https://github.com/media-kit/media-kit).
+//
+// Copyright © 2026 & onwards, Predidit.
+// All rights reserved.
+// Use of this source code is governed by MIT license that can be found in the
+// LICENSE file.
+
+#include "include/media_kit_video/http_cache_store.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+// Bumped whenever the persisted layout changes.
+#define HTTP_CACHE_STORE_MAGIC "MKHC"
+#define HTTP_CACHE_STORE_VERSION 1
+
+// Indices larger than this are not read into memory (corrupt files).
+#define HTTP_CACHE_STORE_MAX_INDEX_SIZE (64 * 1024 * 1024)
+
+struct HttpCacheStore::Entry {
+  ~Entry() {
+    if (fd >= 0) {
+      close(fd);
+    }
+  }
+
+  uint64_t hash = 0;
+  std::string url;
+  Resource resource;
+  std::map<int64_t, int64_t> ranges;  // Start -> end, disjoint & not adjacent.
+  int64_t size = 0;                   // Bytes in |ranges|.
+  uint64_t use = 0;                   // Key in |lru_|.
+  int fd = -1;                        // Opened on first read / write.
+  bool removed = false;  // Evicted or replaced, the data file is unlinked.
+  bool unsynced = false;  // Written to since the last |Flush|.
+};
+
+namespace {
+
+void WriteVarint(std::string& out, uint64_t value) {
+  while (value >= 0x80) {
+    out.push_back((char)(value | 0x80));
+    value >>= 7;
+  }
+  out.push_back((char)value);
+}
+
+bool ReadVarint(const uint8_t*& p, const uint8_t* end, uint64_t* value) {
+  *value = 0;
+  for (int shift = 0; p < end && shift < 64; shift += 7) {
+    uint8_t byte = *p++;
+    *value |= (uint64_t)(byte & 0x7F) << shift;
+    if (!(byte & 0x80)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void WriteString(std::string& out, const std::string& value) {
+  WriteVarint(out, value.size());
+  out.append(value);
+}
+
+bool ReadString(const uint8_t*& p, const uint8_t* end, std::string* value) {
+  uint64_t size;
+  if (!ReadVarint(p, end, &size) || size > (uint64_t)(end - p)) {
+    return false;
+  }
+  value->assign((const char*)p, size);
+  p += size;
+  return true;
+}
+
+// FNV-1a.
+uint64_t Hash(const std::string& url) {
+  uint64_t hash = 0xcbf29ce484222325ull;
+  for (char c : url) {
+    hash = (hash ^ (uint8_t)c) * 0x100000001b3ull;
+  }
+  return hash;
+}
+
+// Adds [start, end) to |ranges|, merging it with the ranges it touches.
+// Returns the number of bytes added.
+int64_t AddRange(std::map<int64_t, int64_t>& ranges,
+                 int64_t start,
+                 int64_t end) {
+  int64_t added = end - start;
+  auto it = ranges.upper_bound(start);
+  if (it != ranges.begin() && std::prev(it)->second >= start) {
+    it = std::prev(it);
+  }
+  while (it != ranges.end() && it->first <= end) {
+    int64_t overlap =
+        std::min(end, it->second) - std::max(start, it->first);
+    added -= std::max<int64_t>(overlap, 0);
+    start = std::min(start, it->first);
+    end = std::max(end, it->second);
+    it = ranges.erase(it);
+  }
+  ranges[start] = end;
+  return added;
+}
+
+bool Covers(const std::map<int64_t, int64_t>& ranges,
+            int64_t start,
+            int64_t end) {
+  auto it = ranges.upper_bound(start);
+  return it != ranges.begin() && std::prev(it)->second >= end;
+}
+
+// mkdir -p.
+bool MakeDirectories(const std::string& path) {
+  for (size_t i = 1; i <= path.size(); i++) {
+    if (i == path.size() || path[i] == '/') {
+      std::string parent = path.substr(0, i);
+      if (mkdir(parent.c_str(), 0755) != 0 && errno != EEXIST) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool EndsWith(const char* name, const char* suffix) {
+  size_t size = strlen(name), suffix_size = strlen(suffix);
+  return size >= suffix_size &&
+         strcmp(name + size - suffix_size, suffix) == 0;
+}
+
+}  // namespace
+
+HttpCacheStore::HttpCacheStore(std::string directory, int64_t max_size)
+    : directory_(std::move(directory)), max_size_(max_size) {}
+
+HttpCacheStore::~HttpCacheStore() {
+  Flush();
+}
+
+bool HttpCacheStore::Open() {
+  if (directory_.empty() || !MakeDirectories(directory_)) {
+    return false;
+  }
+  std::string index = directory_ + "/index";
+  std::vector<uint8_t> data;
+  FILE* file = fopen(index.c_str(), "rb");
+  if (file != nullptr) {
+    uint8_t chunk[64 * 1024];
+    size_t read;
+    while ((read = fread(chunk, 1, sizeof(chunk), file)) > 0 &&
+           data.size() < HTTP_CACHE_STORE_MAX_INDEX_SIZE) {
+      data.insert(data.end(), chunk, chunk + read);
+    }
+    fclose(file);
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  const uint8_t* p = data.data();
+  const uint8_t* end = p + data.size();
+  bool magic = data.size() >= 4 && memcmp(p, HTTP_CACHE_STORE_MAGIC, 4) == 0;
+  p += magic ? 4 : 0;
+  uint64_t version, count = 0;
+  if (magic && ReadVarint(p, end, &version) &&
+      version == HTTP_CACHE_STORE_VERSION && ReadVarint(p, end, &count)) {
+    // Least recently used first.
+    for (uint64_t i = 0; i < count; i++) {
+      auto entry = std::make_shared<Entry>();
+      uint64_t length, ranges;
+      if (!ReadString(p, end, &entry->url) ||
+          !ReadString(p, end, &entry->resource.validator) ||
+          !ReadString(p, end, &entry->resource.type) ||
+          !ReadVarint(p, end, &length) || length == 0 ||
+          length > INT64_MAX || !ReadVarint(p, end, &ranges) ||
+          ranges > (uint64_t)(end - p)) {
+        break;
+      }
+      entry->resource.length = (int64_t)length;
+      uint64_t position = 0;
+      bool valid = true;
+      for (uint64_t j = 0; j < ranges && valid; j++) {
+        uint64_t gap, size;
+        valid = ReadVarint(p, end, &gap) && ReadVarint(p, end, &size) &&
+                size > 0 && gap <= length - position &&
+                size <= length - position - gap;
+        if (valid) {
+          entry->ranges[(int64_t)(position + gap)] =
+              (int64_t)(position + gap + size);
+          entry->size += (int64_t)size;
+          position += gap + size;
+        }
+      }
+      if (!valid) {
+        break;
+      }
+      entry->hash = Hash(entry->url);
+      struct stat info;
+      if (entries_.count(entry->hash) != 0 ||
+          stat(GetDataPath(entry->hash).c_str(), &info) != 0 ||
+          info.st_size != entry->resource.length) {
+        continue;
+      }
+      entry->use = ++clock_;
+      lru_[entry->use] = entry->hash;
+      size_ += entry->size;
+      entries_[entry->hash] = std::move(entry);
+    }
+  }
+
+  dirty_ = entries_.size() != count;
+  // Data of resources missing from the index cannot be trusted.
+  DIR* directory = opendir(directory_.c_str());
+  if (directory != nullptr) {
+    struct dirent* child;
+    while ((child = readdir(directory)) != nullptr) {
+      const char* name = child->d_name;
+      bool orphan = EndsWith(name, ".tmp");
+      if (!orphan && EndsWith(name, ".data")) {
+        uint64_t hash = strtoull(name, nullptr, 16);
+        orphan = entries_.count(hash) == 0 || GetDataPath(hash) !=
+                                                  directory_ + "/" + name;
+      }
+      if (orphan) {
+        unlink((directory_ + "/" + name).c_str());
+      }
+    }
+    closedir(directory);
+  }
+  // Evicts down to a |max_size| lowered since the last run.
+  while (size_ > max_size_ && !lru_.empty()) {
+    Evict(entries_[lru_.begin()->second]);
+  }
+  evictions_ = 0;
+  return true;
+}
+
+bool HttpCacheStore::Lookup(const std::string& url, Resource* resource) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::shared_ptr<Entry> entry = Find(url);
+  if (entry == nullptr) {
+    return false;
+  }
+  *resource = entry->resource;
+  return true;
+}
+
+bool HttpCacheStore::Insert(const std::string& url, const Resource& resource) {
+  if (resource.length <= 0 || resource.validator.empty()) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  uint64_t hash = Hash(url);
+  auto it = entries_.find(hash);
+  if (it != entries_.end()) {
+    std::shared_ptr<Entry> entry = it->second;
+    if (entry->url != url) {
+      // Hash collision, first come first served.
+      return false;
+    }
+    if (entry->resource.validator == resource.validator &&
+        entry->resource.length == resource.length) {
+      entry->resource.type = resource.type;
+      Touch(entry);
+      return true;
+    }
+    Evict(entry);
+    evictions_--;
+  }
+  auto entry = std::make_shared<Entry>();
+  entry->hash = hash;
+  entry->url = url;
+  entry->resource = resource;
+  // Sparse: no space is allocated until ranges are written.
+  entry->fd = open(GetDataPath(hash).c_str(),
+                   O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (entry->fd < 0 || ftruncate(entry->fd, resource.length) != 0) {
+    unlink(GetDataPath(hash).c_str());
+    return false;
+  }
+  entries_[hash] = entry;
+  Touch(entry);
+  return true;
+}
+
+void HttpCacheStore::Remove(const std::string& url) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::shared_ptr<Entry> entry = Find(url);
+  if (entry != nullptr) {
+    Evict(entry);
+    evictions_--;
+  }
+}
+
+int64_t HttpCacheStore::Available(const std::string& url,
+                                  int64_t offset,
+                                  int64_t* next) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::shared_ptr<Entry> entry = Find(url);
+  if (entry == nullptr) {
+    *next = offset;
+    return 0;
+  }
+  auto it = entry->ranges.upper_bound(offset);
+  if (it != entry->ranges.begin() && std::prev(it)->second > offset) {
+    return std::prev(it)->second - offset;
+  }
+  *next = it != entry->ranges.end() ? it->first : entry->resource.length;
+  return 0;
+}
+
+bool HttpCacheStore::Read(const std::string& url,
+                          int64_t offset,
+                          void* data,
+                          int64_t size) {
+  std::shared_ptr<Entry> entry;
+  int fd = -1;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entry = Find(url);
+    if (entry == nullptr || !Covers(entry->ranges, offset, offset + size)) {
+      return false;
+    }
+    if (entry->fd < 0) {
+      entry->fd = open(GetDataPath(entry->hash).c_str(), O_RDWR | O_CLOEXEC);
+    }
+    fd = entry->fd;
+    Touch(entry);
+  }
+  for (int64_t done = 0; done < size;) {
+    ssize_t result =
+        pread(fd, (uint8_t*)data + done, size - done, offset + done);
+    if (result < 0 && errno == EINTR) {
+      continue;
+    }
+    if (result <= 0) {
+      return false;
+    }
+    done += result;
+  }
+  // The range may have been trimmed meanwhile, leaving a hole.
+  std::lock_guard<std::mutex> lock(mutex_);
+  return !entry->removed && Covers(entry->ranges, offset, offset + size);
+}
+
+bool HttpCacheStore::Write(const std::string& url,
+                           int64_t offset,
+                           const void* data,
+                           int64_t size) {
+  std::shared_ptr<Entry> entry;
+  int fd = -1;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entry = Find(url);
+    if (entry == nullptr || size <= 0 || offset < 0 ||
+        offset > entry->resource.length - size) {
+      return false;
+    }
+    if (entry->fd < 0) {
+      entry->fd = open(GetDataPath(entry->hash).c_str(), O_RDWR | O_CLOEXEC);
+    }
+    fd = entry->fd;
+  }
+  for (int64_t done = 0; done < size;) {
+    ssize_t result =
+        pwrite(fd, (const uint8_t*)data + done, size - done, offset + done);
+    if (result < 0 && errno == EINTR) {
+      continue;
+    }
+    if (result <= 0) {
+      return false;
+    }
+    done += result;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (entry->removed) {
+    // Written to the unlinked file, gone with |entry|.
+    return true;
+  }
+  int64_t added = AddRange(entry->ranges, offset, offset + size);
+  entry->size += added;
+  entry->unsynced = true;
+  size_ += added;
+  Touch(entry);
+  while (size_ > max_size_) {
+    auto oldest = lru_.begin();
+    if (oldest->second == entry->hash) {
+      Trim(entry, offset);
+      break;
+    }
+    Evict(entries_[oldest->second]);
+  }
+  return true;
+}
+
+bool HttpCacheStore::Flush() {
+  std::lock_guard<std::mutex> flush_lock(flush_mutex_);
+  std::string out(HTTP_CACHE_STORE_MAGIC);
+  std::vector<std::pair<std::shared_ptr<Entry>, int>> unsynced;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!dirty_ || directory_.empty()) {
+      return true;
+    }
+    dirty_ = false;
+    WriteVarint(out, HTTP_CACHE_STORE_VERSION);
+    WriteVarint(out, lru_.size());
+    for (const auto& [use, hash] : lru_) {
+      const std::shared_ptr<Entry>& entry = entries_[hash];
+      WriteString(out, entry->url);
+      WriteString(out, entry->resource.validator);
+      WriteString(out, entry->resource.type);
+      WriteVarint(out, entry->resource.length);
+      WriteVarint(out, entry->ranges.size());
+      int64_t position = 0;
+      for (const auto& [start, end] : entry->ranges) {
+        WriteVarint(out, start - position);
+        WriteVarint(out, end - start);
+        position = end;
+      }
+      if (entry->unsynced) {
+        entry->unsynced = false;
+        unsynced.emplace_back(entry, entry->fd);
+      }
+    }
+  }
+  // The ranges listed must be on disk before the index is.
+  for (const auto& [entry, fd] : unsynced) {
+    fdatasync(fd);
+  }
+  // Written aside & renamed, so a crash never leaves a partial index.
+  std::string target = directory_ + "/index";
+  std::string temporary = target + "." + std::to_string(getpid()) + ".tmp";
+  FILE* file = fopen(temporary.c_str(), "wb");
+  bool result = file != nullptr &&
+                fwrite(out.data(), 1, out.size(), file) == out.size();
+  if (file != nullptr) {
+    result = fclose(file) == 0 && result;
+  }
+  if (!result || rename(temporary.c_str(), target.c_str()) != 0) {
+    unlink(temporary.c_str());
+    std::lock_guard<std::mutex> lock(mutex_);
+    dirty_ = true;
+    for (const auto& [entry, fd] : unsynced) {
+      entry->unsynced = true;
+    }
+    return false;
+  }
+  return true;
+}
+
+void HttpCacheStore::Clear() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    while (!lru_.empty()) {
+      Evict(entries_[lru_.begin()->second]);
+      evictions_--;
+    }
+  }
+  Flush();
+}
+
+HttpCacheStore::Stats HttpCacheStore::GetStats() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Stats stats;
+  stats.size = size_;
+  stats.resources = (int64_t)entries_.size();
+  stats.evictions = evictions_;
+  return stats;
+}
+
+std::string HttpCacheStore::DefaultDirectory() {
+  const char* cache = getenv("XDG_CACHE_HOME");
+  if (cache != nullptr && *cache == '/') {
+    return std::string(cache) + "/media_kit/http";
+  }
+  const char* home = getenv("HOME");
+  if (home != nullptr && *home == '/') {
+    return std::string(home) + "/.cache/media_kit/http";
+  }
+  return std::string();
+}
+
+std::shared_ptr<HttpCacheStore::Entry> HttpCacheStore::Find(
+    const std::string& url) {
+  auto it = entries_.find(Hash(url));
+  return it != entries_.end() && it->second->url == url ? it->second
+                                                       : nullptr;
+}
+
+std::string HttpCacheStore::GetDataPath(uint64_t hash) const {
+  char name[32];
+  snprintf(name, sizeof(name), "/%016llx.data", (unsigned long long)hash);
+  return directory_ + name;
+}
+
+void HttpCacheStore::Evict(std::shared_ptr<Entry> entry) {
+  // Readers & writers holding |entry| keep using the unlinked file.
+  unlink(GetDataPath(entry->hash).c_str());
+  entry->removed = true;
+  lru_.erase(entry->use);
+  size_ -= entry->size;
+  evictions_++;
+  dirty_ = true;
+  entries_.erase(entry->hash);
+}
+
+void HttpCacheStore::Trim(const std::shared_ptr<Entry>& current,
+                          int64_t offset) {
+  // |current| alone exceeds |max_size|: its ranges farthest from |offset|
+  // (being played) go first, the earliest ones first.
+  auto punch = [&](int64_t start, int64_t end) {
+    fallocate(current->fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, start,
+              end - start);
+    current->size -= end - start;
+    size_ -= end - start;
+  };
+  std::map<int64_t, int64_t>& ranges = current->ranges;
+  while (size_ > max_size_ && ranges.size() > 1) {
+    auto it = ranges.begin();
+    if (it->second > offset) {
+      it = std::prev(ranges.end());
+    }
+    punch(it->first, it->second);
+    ranges.erase(it);
+  }
+  if (size_ > max_size_ && !ranges.empty()) {
+    auto it = ranges.begin();
+    int64_t start = std::min(it->first + (size_ - max_size_), it->second);
+    int64_t end = it->second;
+    punch(it->first, start);
+    ranges.erase(it);
+    if (start < end) {
+      ranges[start] = end;
+    }
+  }
+  dirty_ = true;
+}
+
+void HttpCacheStore::Touch(const std::shared_ptr<Entry>& entry) {
+  lru_.erase(entry->use);
+  entry->use = ++clock_;
+  lru_[entry->use] = entry->hash;
+  dirty_ = true;
+}
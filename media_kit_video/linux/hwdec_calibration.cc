@@ -0,0 +1,492 @@
+// This file is a part of media_kit
+// (https://github.com/media-kit/media-kit).
+//
+// Copyright © 2026 & onwards, Predidit.
+// All rights reserved.
+// Use of this source code is governed by MIT license that can be found in the
+// LICENSE file.
+
+#include "include/media_kit_video/hwdec_calibration.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <mpv/client.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+extern char** environ;
+
+// Bumped whenever the persisted layout or the measurement changes.
+#define HWDEC_CALIBRATION_MAGIC "MKHW"
+#define HWDEC_CALIBRATION_VERSION 2
+#define HWDEC_CALIBRATION_FILE "/hwdec.txt"
+
+// Seconds to wait for libmpv to encode, load or finish decoding a sample.
+#define HWDEC_CALIBRATION_TIMEOUT 30.0
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Encoders of the samples, tried in order for each codec, with the options of
+// libmpv's `ovcopts`. Fastest presets: only the decoding is measured.
+struct Encoder {
+  const char* codec;
+  const char* name;
+  const char* options;
+};
+
+const Encoder kEncoders[] = {
+    {"h264", "libx264", "preset=ultrafast"},
+    {"hevc", "libx265", "preset=ultrafast,x265-params=[log-level=error]"},
+    {"vp9", "libvpx-vp9", "deadline=realtime,cpu-used=8,row-mt=1"},
+    {"av1", "libsvtav1", "preset=12"},
+    {"av1", "libaom-av1", "usage=realtime,cpu-used=8,row-mt=1"},
+};
+
+double GetProcessCpuTime() {
+  struct timespec time;
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &time);
+  return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+Clock::time_point GetDeadline() {
+  return Clock::now() +
+         std::chrono::duration_cast<Clock::duration>(
+             std::chrono::duration<double>(HWDEC_CALIBRATION_TIMEOUT));
+}
+
+// Runs |helper| with `--hwdec-measure` in a process of its own & parses the
+// |Measurement| it writes to stdout.
+bool MeasureInHelper(const char* helper,
+                     const std::string& path,
+                     const std::string& hwdec,
+                     HwdecCalibration::Measurement* measurement) {
+  int fds[2];
+  if (pipe2(fds, O_CLOEXEC) != 0) {
+    return false;
+  }
+  posix_spawn_file_actions_t actions;
+  posix_spawn_file_actions_init(&actions);
+  posix_spawn_file_actions_addopen(&actions, 0, "/dev/null", O_RDONLY, 0);
+  posix_spawn_file_actions_adddup2(&actions, fds[1], 1);
+  posix_spawn_file_actions_addopen(&actions, 2, "/dev/null", O_WRONLY, 0);
+  const char* argv[] = {helper, "--hwdec-measure", path.c_str(),
+                        hwdec.c_str(), NULL};
+  pid_t pid;
+  int result = posix_spawn(&pid, helper, &actions, NULL, (char* const*)argv,
+                           environ);
+  posix_spawn_file_actions_destroy(&actions);
+  close(fds[1]);
+  if (result != 0) {
+    close(fds[0]);
+    return false;
+  }
+  char output[128];
+  size_t length = 0;
+  while (length < sizeof(output) - 1) {
+    ssize_t count = read(fds[0], output + length, sizeof(output) - 1 - length);
+    if (count < 0 && errno == EINTR) {
+      continue;
+    }
+    if (count <= 0) {
+      break;
+    }
+    length += count;
+  }
+  output[length] = '\0';
+  close(fds[0]);
+  int status = 0;
+  while (waitpid(pid, &status, 0) < 0) {
+    if (errno != EINTR) {
+      return false;
+    }
+  }
+  long long drops = 0;
+  if (!WIFEXITED(status) || WEXITSTATUS(status) != 0 ||
+      sscanf(output, "%lf %lf %lld", &measurement->fps, &measurement->cpu,
+             &drops) != 3) {
+    return false;
+  }
+  measurement->drops = drops;
+  return true;
+}
+
+// Waits for |event_id|, or for `eof-reached` if |event_id| is
+// MPV_EVENT_PROPERTY_CHANGE. Returns false on error or timeout.
+bool WaitFor(mpv_handle* handle, mpv_event_id event_id) {
+  Clock::time_point deadline = GetDeadline();
+  while (Clock::now() < deadline) {
+    mpv_event* event = mpv_wait_event(handle, 1.0);
+    if (event->event_id == MPV_EVENT_END_FILE ||
+        event->event_id == MPV_EVENT_SHUTDOWN) {
+      return false;
+    }
+    if (event->event_id == event_id) {
+      if (event_id != MPV_EVENT_PROPERTY_CHANGE) {
+        return true;
+      }
+      mpv_event_property* property = (mpv_event_property*)event->data;
+      if (property->format == MPV_FORMAT_FLAG && *(int*)property->data) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+// Decodes |path| as fast as possible with |hwdec|. Returns false if |hwdec|
+// is not available (mpv fell back to another decoder) or decoding failed.
+// The CPU time is the process's: the helper runs nothing else.
+bool Measure(const char* path,
+             const char* hwdec,
+             HwdecCalibration::Measurement* measurement) {
+  mpv_handle* handle = mpv_create();
+  if (handle == NULL) {
+    return false;
+  }
+  const char* options[][2] = {
+      {"config", "no"},     {"terminal", "no"},      {"load-scripts", "no"},
+      {"vo", "null"},       {"ao", "null"},          {"audio", "no"},
+      {"untimed", "yes"},   {"keep-open", "yes"},    {"hwdec-codecs", "all"},
+      {"hwdec", hwdec},
+  };
+  for (auto& option : options) {
+    mpv_set_option_string(handle, option[0], option[1]);
+  }
+  bool result = false;
+  if (mpv_initialize(handle) >= 0) {
+    mpv_observe_property(handle, 0, "eof-reached", MPV_FORMAT_FLAG);
+    const char* command[] = {"loadfile", path, NULL};
+    if (mpv_command(handle, command) >= 0 &&
+        WaitFor(handle, MPV_EVENT_PLAYBACK_RESTART)) {
+      Clock::time_point begin = Clock::now();
+      double cpu = GetProcessCpuTime();
+      char* current = mpv_get_property_string(handle, "hwdec-current");
+      bool available = strcmp(hwdec, "no") == 0 ||
+                       (current != NULL && strcmp(hwdec, current) == 0);
+      mpv_free(current);
+      if (available && WaitFor(handle, MPV_EVENT_PROPERTY_CHANGE)) {
+        double elapsed =
+            std::chrono::duration<double>(Clock::now() - begin).count();
+        // The first frame was decoded before |begin|.
+        int frames = HwdecCalibration::kSampleFrames - 1;
+        int64_t drops = 0, decoder_drops = 0;
+        mpv_get_property(handle, "frame-drop-count", MPV_FORMAT_INT64, &drops);
+        mpv_get_property(handle, "decoder-frame-drop-count", MPV_FORMAT_INT64,
+                         &decoder_drops);
+        measurement->fps = frames / std::max(elapsed, 1e-6);
+        measurement->cpu = (GetProcessCpuTime() - cpu) * 1000.0 / frames;
+        measurement->drops = drops + decoder_drops;
+        result = true;
+      }
+    }
+  }
+  mpv_terminate_destroy(handle);
+  return result;
+}
+
+// Whether |a| is a better choice than |b|.
+bool IsBetter(const HwdecCalibration::Measurement& a,
+              const HwdecCalibration::Measurement& b) {
+  double realtime =
+      HwdecCalibration::kSampleRate * HwdecCalibration::kRealtimeFactor;
+  bool a_realtime = a.drops == 0 && a.fps >= realtime;
+  bool b_realtime = b.drops == 0 && b.fps >= realtime;
+  if (a_realtime != b_realtime) {
+    return a_realtime;
+  }
+  if (a_realtime) {
+    return a.cpu < b.cpu;
+  }
+  if ((a.drops == 0) != (b.drops == 0)) {
+    return a.drops == 0;
+  }
+  return a.fps > b.fps;
+}
+
+std::string ReadLine(const std::string& path) {
+  std::string line;
+  FILE* file = fopen(path.c_str(), "r");
+  if (file != NULL) {
+    char buffer[256];
+    if (fgets(buffer, sizeof(buffer), file) != NULL) {
+      line = buffer;
+      while (!line.empty() && (line.back() == '\n' || line.back() == ' ')) {
+        line.pop_back();
+      }
+    }
+    fclose(file);
+  }
+  return line;
+}
+
+// mkdir -p.
+bool MakeDirectories(const std::string& path) {
+  for (size_t i = 1; i <= path.size(); i++) {
+    if (i == path.size() || path[i] == '/') {
+      std::string parent = path.substr(0, i);
+      if (mkdir(parent.c_str(), 0755) != 0 && errno != EEXIST) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+bool HwdecCalibration::Run(const char* work_dir,
+                           const char* helper,
+                           const std::atomic<bool>* cancel) {
+  entries_.clear();
+  for (const char* codec : kCodecs) {
+    for (int resolution : kResolutions) {
+      if (cancel->load(std::memory_order_relaxed)) {
+        return false;
+      }
+      std::string path = std::string(work_dir) + "/" + codec + "_" +
+                         std::to_string(resolution) + ".mkv";
+      if (!Encode(codec, resolution, path.c_str())) {
+        // No encoder: not calibrated, `auto` applies.
+        unlink(path.c_str());
+        continue;
+      }
+      Entry entry;
+      Measurement best;
+      for (const char* api : kApis) {
+        if (cancel->load(std::memory_order_relaxed)) {
+          unlink(path.c_str());
+          return false;
+        }
+        std::string hwdec = strcmp(api, "no") == 0
+                                ? std::string(api)
+                                : std::string(api) + "-copy";
+        Measurement measurement;
+        if (MeasureInHelper(helper, path, hwdec, &measurement) &&
+            (entry.api.empty() || IsBetter(measurement, best))) {
+          best = measurement;
+          entry.api = api;
+        }
+      }
+      unlink(path.c_str());
+      if (!entry.api.empty()) {
+        entry.codec = codec;
+        entry.resolution = resolution;
+        entry.fps = best.fps;
+        entry.cpu = best.cpu;
+        entry.drops = best.drops;
+        entries_.push_back(entry);
+      }
+    }
+  }
+  return !entries_.empty();
+}
+
+bool HwdecCalibration::Encode(const char* codec,
+                              int resolution,
+                              const char* path) {
+  char source[160];
+  snprintf(source, sizeof(source),
+           "av://lavfi:testsrc2=size=%dx%d:rate=%d:duration=%d",
+           resolution * 16 / 9, resolution, kSampleRate,
+           kSampleFrames / kSampleRate);
+  std::string gop = "g=" + std::to_string(kSampleRate) + ",";
+  for (const Encoder& encoder : kEncoders) {
+    if (strcmp(encoder.codec, codec) != 0) {
+      continue;
+    }
+    mpv_handle* handle = mpv_create();
+    if (handle == NULL) {
+      return false;
+    }
+    std::string options = gop + encoder.options;
+    const char* settings[][2] = {
+        {"config", "no"},
+        {"terminal", "no"},
+        {"load-scripts", "no"},
+        {"audio", "no"},
+        {"idle", "yes"},
+        {"o", path},
+        {"of", "matroska"},
+        {"ovc", encoder.name},
+        {"ovcopts", options.c_str()},
+        {"vf", "format=yuv420p"},
+    };
+    for (auto& setting : settings) {
+      mpv_set_option_string(handle, setting[0], setting[1]);
+    }
+    bool result = false;
+    const char* command[] = {"loadfile", source, NULL};
+    if (mpv_initialize(handle) >= 0 && mpv_command(handle, command) >= 0) {
+      Clock::time_point deadline = GetDeadline();
+      while (Clock::now() < deadline) {
+        mpv_event* event = mpv_wait_event(handle, 1.0);
+        if (event->event_id == MPV_EVENT_SHUTDOWN) {
+          break;
+        }
+        if (event->event_id == MPV_EVENT_END_FILE) {
+          mpv_event_end_file* end_file = (mpv_event_end_file*)event->data;
+          result = end_file->reason == MPV_END_FILE_REASON_EOF;
+          break;
+        }
+      }
+    }
+    // The file is only complete once the encoder is closed.
+    mpv_terminate_destroy(handle);
+    struct stat info;
+    if (result && stat(path, &info) == 0 && info.st_size > 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+int HwdecCalibration::RunHelper(const char* path, const char* hwdec) {
+  Measurement measurement;
+  if (!Measure(path, hwdec, &measurement)) {
+    return 1;
+  }
+  printf("%.3f %.6f %lld\n", measurement.fps, measurement.cpu,
+         (long long)measurement.drops);
+  return fflush(stdout) == 0 ? 0 : 1;
+}
+
+bool HwdecCalibration::Load(const char* cache_dir) {
+  entries_.clear();
+  if (cache_dir == nullptr || *cache_dir == '\0') {
+    return false;
+  }
+  std::string path = std::string(cache_dir) + HWDEC_CALIBRATION_FILE;
+  FILE* file = fopen(path.c_str(), "r");
+  if (file == NULL) {
+    return false;
+  }
+  char line[512];
+  int version = 0;
+  bool result = fgets(line, sizeof(line), file) != NULL &&
+                sscanf(line, HWDEC_CALIBRATION_MAGIC " %d", &version) == 1 &&
+                version == HWDEC_CALIBRATION_VERSION &&
+                fgets(line, sizeof(line), file) != NULL &&
+                line == "key " + SystemKey() + "\n";
+  while (result && fgets(line, sizeof(line), file) != NULL) {
+    char codec[32], api[32];
+    Entry entry;
+    long long drops = 0;
+    if (sscanf(line, "%31s %d %31s %lf %lf %lld", codec, &entry.resolution,
+               api, &entry.fps, &entry.cpu, &drops) != 6) {
+      result = false;
+      break;
+    }
+    entry.codec = codec;
+    entry.api = api;
+    entry.drops = drops;
+    entries_.push_back(entry);
+  }
+  fclose(file);
+  if (!result) {
+    entries_.clear();
+  }
+  return result;
+}
+
+bool HwdecCalibration::Save(const char* cache_dir) const {
+  if (cache_dir == nullptr || *cache_dir == '\0' ||
+      !MakeDirectories(cache_dir)) {
+    return false;
+  }
+  // Written aside & renamed, so concurrent readers never see a partial file.
+  std::string target = std::string(cache_dir) + HWDEC_CALIBRATION_FILE;
+  std::string temporary = target + "." + std::to_string(getpid()) + ".tmp";
+  FILE* file = fopen(temporary.c_str(), "w");
+  if (file == NULL) {
+    return false;
+  }
+  bool result =
+      fprintf(file, HWDEC_CALIBRATION_MAGIC " %d\nkey %s\n",
+              HWDEC_CALIBRATION_VERSION, SystemKey().c_str()) > 0;
+  for (const Entry& entry : entries_) {
+    result = result && fprintf(file, "%s %d %s %.1f %.3f %lld\n",
+                               entry.codec.c_str(), entry.resolution,
+                               entry.api.c_str(), entry.fps, entry.cpu,
+                               (long long)entry.drops) > 0;
+  }
+  result = fclose(file) == 0 && result;
+  if (!result || rename(temporary.c_str(), target.c_str()) != 0) {
+    unlink(temporary.c_str());
+    return false;
+  }
+  return true;
+}
+
+std::string HwdecCalibration::Lookup(const char* codec,
+                                     int64_t width,
+                                     int64_t height,
+                                     bool copy) const {
+  // Smallest class whose sample has at least as many pixels.
+  int64_t pixels = width * height;
+  int resolution = kResolutions[sizeof(kResolutions) / sizeof(int) - 1];
+  for (int candidate : kResolutions) {
+    if (pixels <= (int64_t)candidate * 16 / 9 * candidate) {
+      resolution = candidate;
+      break;
+    }
+  }
+  for (const Entry& entry : entries_) {
+    if (entry.resolution == resolution && entry.codec == codec) {
+      if (entry.api == "no" || !copy) {
+        return entry.api;
+      }
+      return entry.api + "-copy";
+    }
+  }
+  return std::string();
+}
+
+std::string HwdecCalibration::DefaultCacheDirectory() {
+  const char* cache = getenv("XDG_CACHE_HOME");
+  if (cache != nullptr && *cache == '/') {
+    return std::string(cache) + "/media_kit/hwdec";
+  }
+  const char* home = getenv("HOME");
+  if (home != nullptr && *home == '/') {
+    return std::string(home) + "/.cache/media_kit/hwdec";
+  }
+  return std::string();
+}
+
+std::string HwdecCalibration::SystemKey() {
+  char version[32];
+  snprintf(version, sizeof(version), "mpv-%lx", mpv_client_api_version());
+  std::string key = version;
+  std::vector<std::string> devices;
+  DIR* directory = opendir("/sys/class/drm");
+  if (directory != NULL) {
+    while (struct dirent* entry = readdir(directory)) {
+      if (strncmp(entry->d_name, "renderD", 7) != 0) {
+        continue;
+      }
+      std::string device = std::string("/sys/class/drm/") + entry->d_name;
+      devices.push_back(ReadLine(device + "/device/vendor") + ":" +
+                        ReadLine(device + "/device/device"));
+    }
+    closedir(directory);
+  }
+  // |readdir| order is unspecified.
+  std::sort(devices.begin(), devices.end());
+  for (const std::string& device : devices) {
+    key += " " + device;
+  }
+  return key;
+}
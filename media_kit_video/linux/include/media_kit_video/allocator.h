@@ -0,0 +1,69 @@
+// This file is a part of media_kit
+// (https://github.com/media-kit/media-kit).
+//
+// Copyright © 2026 & onwards, Predidit.
+// All rights reserved.
+// Use of this source code is governed by MIT license that can be found in the
+// LICENSE file.
+
+#ifndef ALLOCATOR_H_
+#define ALLOCATOR_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Process & per-thread heap statistics of the allocator in use.
+//
+// When the application links mimalloc's static override (see
+// package:media_kit_libs_linux), malloc is interposed for the whole process,
+// including this plugin & libmpv. mimalloc's API is then looked up at
+// runtime, so that the plugin also works with glibc's malloc.
+class Allocator {
+ public:
+  struct Stats {
+    bool mimalloc = false;
+    size_t current_rss = 0;
+    size_t peak_rss = 0;
+    size_t current_commit = 0;  // mimalloc only.
+    size_t peak_commit = 0;     // mimalloc only.
+    size_t page_faults = 0;     // mimalloc only.
+    size_t heap_allocated = 0;  // glibc: |mallinfo2::uordblks|.
+    size_t heap_free = 0;       // glibc: |mallinfo2::fordblks|.
+  };
+
+  // Statistics of a dedicated thread heap (mimalloc only).
+  struct HeapStats {
+    size_t reserved = 0;
+    size_t committed = 0;
+    size_t used = 0;
+    size_t blocks = 0;
+  };
+
+  static bool IsMimalloc();
+
+  static Stats GetStats();
+
+  // Returns mimalloc's `mi_stats_print` output, or an empty string.
+  static std::string PrintStats();
+
+  // Gives the calling thread a dedicated heap as its default, so that its
+  // allocations (including those of libmpv & the GL driver on it) are not
+  // interleaved with other threads' & can be collected separately.
+  static void CreateThreadHeap();
+
+  // Deletes the calling thread's heap; live blocks move to the backing heap.
+  static void DeleteThreadHeap();
+
+  // Returns free memory of the calling thread's heap to the OS.
+  static void CollectThreadHeap(bool force);
+
+  // Returns free memory of all heaps to the OS.
+  static void Collect(bool force);
+
+  // Statistics of the calling thread's heap. Walks the heap; not for hot
+  // paths. Returns false without a dedicated heap.
+  static bool GetThreadHeapStats(HeapStats* stats);
+};
+
+#endif  // ALLOCATOR_H_
@@ -0,0 +1,22 @@
+// This file is a part of media_kit
+// (https://github.com/media-kit/media-kit).
+//
+// Copyright © 2026 & onwards, Predidit.
+// All rights reserved.
+// Use of this source code is governed by MIT license that can be found in the
+// LICENSE file.
+
+#ifndef EXPORT_H_
+#define EXPORT_H_
+
+// Marks the C functions looked up from Dart through `dart:ffi`. The plugin is
+// built with hidden visibility, so these must be exported explicitly.
+#ifdef __cplusplus
+#define MEDIA_KIT_VIDEO_EXPORT \
+  extern "C" __attribute__((visibility("default"))) __attribute__((used))
+#else
+#define MEDIA_KIT_VIDEO_EXPORT \
+  __attribute__((visibility("default"))) __attribute__((used))
+#endif
+
+#endif  // EXPORT_H_
@@ -0,0 +1,154 @@
+// This file is a part of media_kit
+// (https://github.com/media-kit/media-kit).
+//
+// Copyright © 2026 & onwards, Predidit.
+// All rights reserved.
+// Use of this source code is governed by MIT license that can be found in the
+// LICENSE file.
+
+#ifndef FRAME_TAP_H_
+#define FRAME_TAP_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "export.h"
+
+// Pixel formats of |FrameTapFrame|. YUV formats are BT.601 limited range,
+// with 4:2:0 chroma averaged over 2x2 pixels.
+enum FrameTapFormat : int32_t {
+  FRAME_TAP_FORMAT_RGBA = 0,  // 1 plane, alpha is 255.
+  FRAME_TAP_FORMAT_NV12 = 1,  // Y plane, interleaved UV plane.
+  FRAME_TAP_FORMAT_I420 = 2,  // Y, U & V planes.
+};
+
+// A frame delivered by |FrameTap|, in one of its pool's buffers. Plain C
+// layout, mirrored by a `dart:ffi` `Struct`.
+struct FrameTapFrame {
+  uint8_t* planes[3];  // NULL past the planes of |format|.
+  int32_t strides[3];  // Bytes per row of each plane.
+  int32_t width;
+  int32_t height;
+  int32_t format;      // |FrameTapFormat|.
+  int32_t index;       // Of the buffer in the pool.
+  int64_t time;        // Monotonic capture time, in microseconds.
+  uint64_t sequence;   // Of the rendered frames tapped, gaps are drops.
+};
+
+// Copies the frames a |VideoOutput| renders into a pool of reusable buffers,
+// at a limited rate & resolution, for consumers such as computer vision.
+//
+// The producer (the GL thread, or the main thread for S/W rendering) never
+// waits for the consumer: a frame is written into a free buffer, or replaces
+// the oldest one not acquired yet, or is dropped if the consumer holds every
+// buffer. The consumer either polls the latest frame with |Acquire| or gets
+// each one through a |Callback|, & returns buffers with |Release|.
+//
+// Buffers are (re)allocated for the first frame & upon resolution changes
+// only, so steady-state tapping does not allocate.
+class FrameTap {
+ public:
+  // Invoked on the producer's thread with an acquired frame; must return
+  // quickly & call |Release| eventually, from any thread.
+  typedef void (*Callback)(FrameTap* tap,
+                           const FrameTapFrame* frame,
+                           void* context);
+
+  // |width| x |height| is the size of the frames; if either is 0, it follows
+  // the aspect ratio of the video, if both are, the video's size. |rate| is
+  // the maximum frames per second, 0 for every rendered frame.
+  // |buffer_count| is the size of the pool, at least 2.
+  FrameTap(FrameTapFormat format,
+           int32_t width,
+           int32_t height,
+           double rate,
+           int32_t buffer_count);
+
+  FrameTap(const FrameTap&) = delete;
+  FrameTap& operator=(const FrameTap&) = delete;
+
+  // Producer. Whether a frame rendered at |time| (monotonic, microseconds)
+  // is due according to the rate.
+  bool IsDue(int64_t time) const;
+
+  // Producer. Size of the frames for a video of |width| x |height|. Even for
+  // the YUV formats.
+  void GetSize(int32_t width,
+               int32_t height,
+               int32_t* tap_width,
+               int32_t* tap_height) const;
+
+  // Producer. Converts |rgba| (RGBA or RGB0, |stride| bytes per row) into a
+  // buffer, scaling it to |GetSize| (nearest neighbour) if needed. Returns
+  // false if the frame was dropped.
+  bool Deliver(const uint8_t* rgba,
+               int32_t width,
+               int32_t height,
+               int32_t stride,
+               int64_t time);
+
+  void SetCallback(Callback callback, void* context);
+
+  // Consumer. Returns the latest frame delivered since the previous call, or
+  // NULL; frames skipped in between are dropped.
+  const FrameTapFrame* Acquire();
+
+  // Consumer. Returns the buffer of |frame| to the pool.
+  void Release(const FrameTapFrame* frame);
+
+  FrameTapFormat format() const { return format_; }
+
+  // Frames delivered to the consumer / dropped because it was too slow.
+  uint64_t delivered() const {
+    return delivered_.load(std::memory_order_relaxed);
+  }
+  uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+ private:
+  enum State { FREE, WRITING, READY, ACQUIRED };
+
+  struct Buffer {
+    State state = FREE;
+    std::unique_ptr<uint8_t[]> data;
+    size_t size = 0;
+    FrameTapFrame frame = {};
+  };
+
+  void Convert(const uint8_t* rgba,
+               int32_t width,
+               int32_t height,
+               int32_t stride,
+               FrameTapFrame* frame) const;
+
+  const FrameTapFormat format_;
+  const int32_t width_;
+  const int32_t height_;
+  const int64_t interval_;  // Microseconds between frames, 0 if unlimited.
+
+  std::mutex mutex_;
+  std::vector<Buffer> buffers_;
+  Callback callback_ = nullptr;
+  void* callback_context_ = nullptr;
+  int64_t last_time_ = INT64_MIN / 2;  // Producer only.
+  uint64_t sequence_ = 0;  // Producer only.
+  std::atomic<uint64_t> delivered_{0};
+  std::atomic<uint64_t> dropped_{0};
+};
+
+// C API for `dart:ffi`. Taps are created & destroyed through the plugin's
+// method channel (see |video_output_manager_create_frame_tap|).
+
+MEDIA_KIT_VIDEO_EXPORT const FrameTapFrame* frame_tap_acquire(FrameTap* self);
+
+MEDIA_KIT_VIDEO_EXPORT void frame_tap_release(FrameTap* self,
+                                              const FrameTapFrame* frame);
+
+MEDIA_KIT_VIDEO_EXPORT uint64_t frame_tap_get_delivered(const FrameTap* self);
+
+MEDIA_KIT_VIDEO_EXPORT uint64_t frame_tap_get_dropped(const FrameTap* self);
+
+#endif  // FRAME_TAP_H_
@@ -12,7 +12,7 @@
 #include <glib.h>
 #include <functional>
 #include <thread>
-#include <queue>
+#include <vector>
 #include <mutex>
 #include <condition_variable>
 #include <atomic>
@@ -34,9 +34,17 @@ class GLRenderThread {
  private:
   void Run();
 
+  // Initial capacity of |tasks_|; grows (doubling) only if ever exceeded.
+  static constexpr size_t kInitialCapacity = 64;
+
   std::thread thread_;
   std::thread::id thread_id_;
-  std::queue<std::function<void()>> tasks_;
+  // Ring buffer of pending tasks. The slots are reused, so that posting a
+  // task whose captures fit |std::function|'s local storage (e.g. a single
+  // pointer) does not allocate in steady state, unlike |std::queue|.
+  std::vector<std::function<void()>> tasks_;
+  size_t head_ = 0;
+  size_t count_ = 0;
   std::mutex mutex_;
   std::condition_variable cv_;
   std::atomic<bool> stop_;
@@ -0,0 +1,132 @@
+// This file is a part of media_kit
+// (https://github.com/media-kit/media-kit).
+//
+// Copyright © 2026 & onwards, Predidit.
+// All rights reserved.
+// Use of this source code is governed by MIT license that can be found in the
+// LICENSE file.
+
+#ifndef HTTP_CACHE_PROXY_H_
+#define HTTP_CACHE_PROXY_H_
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+
+#include "export.h"
+#include "http_cache_store.h"
+
+// HTTP/1.1 proxy on a localhost port caching the byte ranges mpv fetches in
+// an |HttpCacheStore|, so that media watched again is read from disk.
+//
+// mpv opens `http://127.0.0.1:<port>/<token>/<percent-encoded URL>` (see
+// |GetUrl|) instead of the http:// or https:// URL itself & keeps its own
+// network stack: seeking, reconnection & demuxer cache work as usual. Each request is
+// served from the stored ranges it covers, the gaps are fetched from the
+// origin with `Range` & stored on the way. A resource is only stored if the
+// origin supports ranges & reports its length & an `ETag` or
+// `Last-Modified`, which is revalidated on its first request of every run
+// (an unreachable origin leaves the stored ranges usable offline).
+//
+// The request headers of mpv (`User-Agent`, `Referer`, cookies,
+// `http-header-fields`...) are forwarded to the origin. The origin is reached
+// through GIO, with TLS for https://. One thread per connection, at most
+// |kMaxClients| at a time.
+//
+// Not an open proxy: the token is random per |Start| & only known to |GetUrl|
+// callers, so other local processes & web pages (through DNS rebinding, also
+// stopped by requiring `Host: 127.0.0.1:<port>`) cannot reach origins through
+// it.
+class HttpCacheProxy {
+ public:
+  struct Stats {
+    int64_t requests = 0;
+    int64_t hit_bytes = 0;   // Served from the store.
+    int64_t miss_bytes = 0;  // Fetched from the origin.
+    HttpCacheStore::Stats store;
+  };
+
+  // Connections served concurrently, beyond which they are refused with 503.
+  static constexpr size_t kMaxClients = 32;
+
+  // Stores at most |max_size| bytes in |directory|.
+  HttpCacheProxy(std::string directory, int64_t max_size);
+
+  HttpCacheProxy(const HttpCacheProxy&) = delete;
+  HttpCacheProxy& operator=(const HttpCacheProxy&) = delete;
+
+  // Aborts the connections being served & flushes the store.
+  ~HttpCacheProxy();
+
+  // Opens the store & listens on an ephemeral port of 127.0.0.1. Returns
+  // false on failure.
+  bool Start();
+
+  int32_t port() const { return port_; }
+
+  // `http://127.0.0.1:<port>/<token>/`, to which |GetUrl| appends the
+  // percent-encoded URL.
+  const std::string& prefix() const { return prefix_; }
+
+  // Returns the URL of the proxy serving |url|, or |url| itself if it is not
+  // an http:// or https:// URL.
+  std::string GetUrl(const std::string& url) const;
+
+  Stats GetStats();
+
+  HttpCacheStore& store() { return store_; }
+
+ private:
+  struct Client;
+  class Request;
+
+  void Accept();
+  void Serve(Client* client);
+
+  HttpCacheStore store_;
+  int listener_ = -1;
+  int32_t port_ = 0;
+  std::string host_;    // Expected `Host` of requests.
+  std::string prefix_;  // See |prefix|.
+  std::string path_;    // Path of |prefix_|, `/<token>/`.
+  std::thread acceptor_;
+  std::mutex mutex_;
+  std::list<std::unique_ptr<Client>> clients_;
+  // Resources revalidated with the origin during this run.
+  std::set<std::string> validated_;
+  std::atomic<int64_t> requests_{0};
+  std::atomic<int64_t> hit_bytes_{0};
+  std::atomic<int64_t> miss_bytes_{0};
+  std::atomic<int64_t> last_flush_{0};
+};
+
+// C API for `dart:ffi`.
+
+// Starts a proxy storing at most |max_size| bytes in |directory| (NULL for
+// the default). Returns NULL on failure.
+MEDIA_KIT_VIDEO_EXPORT HttpCacheProxy* http_cache_proxy_start(
+    const char* directory,
+    int64_t max_size);
+
+MEDIA_KIT_VIDEO_EXPORT void http_cache_proxy_stop(HttpCacheProxy* self);
+
+MEDIA_KIT_VIDEO_EXPORT int32_t
+http_cache_proxy_get_port(const HttpCacheProxy* self);
+
+// Returns |HttpCacheProxy::prefix|, valid until |http_cache_proxy_stop|.
+MEDIA_KIT_VIDEO_EXPORT const char* http_cache_proxy_get_prefix(
+    const HttpCacheProxy* self);
+
+// Writes requests, hit bytes, miss bytes, stored bytes, stored resources &
+// evictions to |stats|.
+MEDIA_KIT_VIDEO_EXPORT void http_cache_proxy_get_stats(HttpCacheProxy* self,
+                                                       int64_t* stats);
+
+MEDIA_KIT_VIDEO_EXPORT void http_cache_proxy_clear(HttpCacheProxy* self);
+
+#endif  // HTTP_CACHE_PROXY_H_
@@ -0,0 +1,117 @@
+// This file is a part of media_kit
+// (https://github.com/media-kit/media-kit).
+//
+// Copyright © 2026 & onwards, Predidit.
+// All rights reserved.
+// Use of this source code is governed by MIT license that can be found in the
+// LICENSE file.
+
+#ifndef HTTP_CACHE_STORE_H_
+#define HTTP_CACHE_STORE_H_
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// Byte ranges of HTTP resources persisted in a directory, bounded to
+// |max_size| bytes by evicting the least recently used resources first.
+//
+// Each resource is a sparse file of its full length, `<hash of URL>.data`,
+// filled in as its ranges are fetched. The ranges present, the validator
+// (`ETag`, or `Last-Modified` without one), the length & the type of every
+// resource are kept in a compact, delta-encoded `index` file next to them,
+// ordered by last use. A resource is identified by its URL & validator: once
+// the origin reports another validator, its ranges are discarded.
+//
+// Thread safe. Data is read & written with pread / pwrite outside the lock.
+class HttpCacheStore {
+ public:
+  struct Resource {
+    std::string validator;
+    std::string type;  // `Content-Type`, may be empty.
+    int64_t length = 0;
+  };
+
+  struct Stats {
+    int64_t size = 0;  // Bytes stored.
+    int64_t resources = 0;
+    int64_t evictions = 0;  // Resources evicted since |Open|.
+  };
+
+  HttpCacheStore(std::string directory, int64_t max_size);
+
+  HttpCacheStore(const HttpCacheStore&) = delete;
+  HttpCacheStore& operator=(const HttpCacheStore&) = delete;
+
+  // Flushes the index.
+  ~HttpCacheStore();
+
+  // Creates the directory & loads the index. Resources without data & data
+  // without an index entry (e.g. after a crash) are deleted. Returns false if
+  // the directory is not usable.
+  bool Open();
+
+  // Returns false if |url| is not stored.
+  bool Lookup(const std::string& url, Resource* resource);
+
+  // Starts storing |url|, keeping the ranges already stored unless
+  // |resource| differs. Returns false if it cannot be stored.
+  bool Insert(const std::string& url, const Resource& resource);
+
+  void Remove(const std::string& url);
+
+  // Returns the number of bytes stored contiguously from |offset|. If none,
+  // |next| receives the offset of the next stored byte, or the length.
+  int64_t Available(const std::string& url, int64_t offset, int64_t* next);
+
+  // Reads |size| stored bytes at |offset|. Returns false on I/O error or if
+  // they are not stored (anymore).
+  bool Read(const std::string& url, int64_t offset, void* data, int64_t size);
+
+  // Stores |size| bytes at |offset|, evicting as needed. Marks |url| as most
+  // recently used.
+  bool Write(const std::string& url,
+             int64_t offset,
+             const void* data,
+             int64_t size);
+
+  // Persists the index if it changed, after syncing the data it refers to.
+  bool Flush();
+
+  // Deletes every resource.
+  void Clear();
+
+  Stats GetStats();
+
+  const std::string& directory() const { return directory_; }
+
+  // Default directory: `$XDG_CACHE_HOME/media_kit/http`.
+  static std::string DefaultDirectory();
+
+ private:
+  struct Entry;
+
+  std::shared_ptr<Entry> Find(const std::string& url);
+  std::string GetDataPath(uint64_t hash) const;
+  void Evict(std::shared_ptr<Entry> entry);
+  void Trim(const std::shared_ptr<Entry>& current, int64_t offset);
+  void Touch(const std::shared_ptr<Entry>& entry);
+
+  const std::string directory_;
+  const int64_t max_size_;
+  std::mutex mutex_;
+  // Keyed by the hash of the URL, which names the data file.
+  std::unordered_map<uint64_t, std::shared_ptr<Entry>> entries_;
+  // Least recently used first.
+  std::map<uint64_t, uint64_t> lru_;  // Use -> hash.
+  uint64_t clock_ = 0;
+  int64_t size_ = 0;
+  int64_t evictions_ = 0;
+  bool dirty_ = false;
+  std::mutex flush_mutex_;  // Serializes |Flush|, taken before |mutex_|.
+};
+
+#endif  // HTTP_CACHE_STORE_H_
@@ -0,0 +1,105 @@
+// This file is a part of media_kit
+// (https://github.com/media-kit/media-kit).
+//
+// Copyright © 2026 & onwards, Predidit.
+// All rights reserved.
+// Use of this source code is governed by MIT license that can be found in the
+// LICENSE file.
+
+#ifndef HWDEC_CALIBRATION_H_
+#define HWDEC_CALIBRATION_H_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Picks the `hwdec` API to decode each codec & resolution class with, by
+// measuring every API the system offers instead of trusting `hwdec=auto`.
+//
+// Short samples are encoded in process by libmpv's encoding mode from `lavfi`
+// & decoded as fast as possible by a headless libmpv instance per API, in
+// copy-back mode (the interop variants need a render context; they share the
+// decoder). Each decoding runs in a helper process of its own, so that its CPU
+// time is not mixed with the application's. The decoding rate, the CPU time
+// per frame & the dropped frames are measured; among the APIs decoding at
+// least |kRealtimeFactor| times faster than the sample plays without dropping
+// any frame, the one using the least CPU wins, otherwise the fastest one does.
+//
+// The results, even none, are persisted in a cache directory & re-measured
+// once the libmpv version or the GPUs of the system change.
+class HwdecCalibration {
+ public:
+  // Codecs calibrated, named as in mpv's `track-list/N/codec`.
+  static constexpr const char* kCodecs[] = {"h264", "hevc", "vp9", "av1"};
+  // Resolution classes, by the height of their 16:9 sample.
+  static constexpr int kResolutions[] = {1080, 2160};
+  // APIs tried, named as in mpv's `hwdec` without the `-copy` suffix. "no"
+  // is software decoding.
+  static constexpr const char* kApis[] = {"vaapi", "nvdec", "vdpau", "vulkan",
+                                          "no"};
+
+  static constexpr int kSampleRate = 30;
+  static constexpr int kSampleFrames = 60;
+  static constexpr double kRealtimeFactor = 2.0;
+
+  struct Measurement {
+    double fps = 0.0;
+    double cpu = 0.0;  // CPU time per frame in milliseconds.
+    int64_t drops = 0;
+  };
+
+  struct Entry {
+    std::string codec;
+    int resolution = 0;
+    std::string api;  // Winner.
+    double fps = 0.0;
+    double cpu = 0.0;  // CPU time per frame in milliseconds.
+    int64_t drops = 0;
+  };
+
+  // Encodes the samples into |work_dir| & measures every API, each in a
+  // process of |helper| run with `--hwdec-measure <sample> <hwdec>` (see
+  // |RunHelper|). Checks |cancel| between measurements. Blocking: takes a few
+  // seconds per codec. Returns false if cancelled or if nothing could be
+  // measured e.g. without any encoder in libmpv.
+  bool Run(const char* work_dir,
+           const char* helper,
+           const std::atomic<bool>* cancel);
+
+  // Encodes a |kSampleFrames| frames sample of |codec| & 16:9 |resolution|
+  // into |path|. Returns false if libmpv has no encoder for |codec|.
+  static bool Encode(const char* codec, int resolution, const char* path);
+
+  // Entry point of the helper process: measures |hwdec| decoding |path| &
+  // writes the |Measurement| to stdout. Returns the exit status.
+  static int RunHelper(const char* path, const char* hwdec);
+
+  // Reads / writes the results in |cache_dir|. |Load| returns false if there
+  // are none or they were measured on another system (see |SystemKey|); it
+  // returns true without any entry if nothing could be measured.
+  bool Load(const char* cache_dir);
+  bool Save(const char* cache_dir) const;
+
+  // Returns the `hwdec` value for a |codec| video of |width| x |height|, or
+  // an empty string if it was not calibrated. |copy| selects the copy-back
+  // variant, for S/W rendering.
+  std::string Lookup(const char* codec,
+                     int64_t width,
+                     int64_t height,
+                     bool copy) const;
+
+  const std::vector<Entry>& entries() const { return entries_; }
+
+  // Default cache directory: `$XDG_CACHE_HOME/media_kit/hwdec`.
+  static std::string DefaultCacheDirectory();
+
+  // Identifies the libmpv version & the GPUs (PCI IDs of the DRM render
+  // nodes) the results were measured with.
+  static std::string SystemKey();
+
+ private:
+  std::vector<Entry> entries_;
+};
+
+#endif  // HWDEC_CALIBRATION_H_
@@ -0,0 +1,87 @@
+// This file is a part of media_kit
+// (https://github.com/media-kit/media-kit).
+//
+// Copyright © 2026 & onwards, Predidit.
+// All rights reserved.
+// Use of this source code is governed by MIT license that can be found in the
+// LICENSE file.
+
+#ifndef KEYFRAME_INDEX_H_
+#define KEYFRAME_INDEX_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "export.h"
+
+// Sorted presentation times (milliseconds) of the video keyframes of a local
+// MP4/MOV or Matroska/WebM file, used to snap scrubbing seeks to positions
+// mpv's demuxer can land on without searching.
+//
+// The container's own index is used where present: `stss` + `stts` + `ctts`
+// of the first video track for MP4, `Cues` for Matroska. Fragmented MP4
+// (`moof`/`trun` sample flags) & Matroska without `Cues` (block keyframe
+// flags) are scanned element by element, reading only headers. Other
+// containers are not supported.
+//
+// The result is persisted as a compact, delta-encoded table in a cache
+// directory, keyed by path & validated by the size & modification time of
+// the file, so a file is only ever scanned once.
+class KeyframeIndex {
+ public:
+  // Scans the file at |path|. Returns false on I/O error, unsupported
+  // container or if no keyframe was found.
+  bool Scan(const char* path);
+
+  // Reads / writes the table persisted for |path| in |cache_dir|. |Load|
+  // returns false if there is none or it is stale.
+  bool Load(const char* cache_dir, const char* path);
+  bool Save(const char* cache_dir, const char* path) const;
+
+  // Returns the keyframe closest to |time|, or |time| if the index is empty.
+  int64_t Snap(int64_t time) const;
+
+  // Returns the last keyframe at or before |time|, or the first keyframe.
+  int64_t Floor(int64_t time) const;
+
+  const int64_t* times() const { return times_.data(); }
+  size_t size() const { return times_.size(); }
+
+  // Default cache directory: `$XDG_CACHE_HOME/media_kit/keyframes`.
+  static std::string DefaultCacheDirectory();
+
+ private:
+  bool ScanMp4(FILE* file, int64_t size);
+  bool ScanMkv(FILE* file, int64_t size);
+  void Finish();
+
+  std::vector<int64_t> times_;
+};
+
+// C API for `dart:ffi`.
+
+// Loads the table persisted for |path| in |cache_dir| (NULL for the default)
+// or scans the file & persists the result. Blocking; returns NULL if the file
+// could not be indexed.
+MEDIA_KIT_VIDEO_EXPORT KeyframeIndex* keyframe_index_load_file(
+    const char* path,
+    const char* cache_dir);
+
+MEDIA_KIT_VIDEO_EXPORT void keyframe_index_free(KeyframeIndex* self);
+
+MEDIA_KIT_VIDEO_EXPORT int64_t keyframe_index_snap(const KeyframeIndex* self,
+                                                   int64_t time);
+
+MEDIA_KIT_VIDEO_EXPORT int64_t keyframe_index_floor(const KeyframeIndex* self,
+                                                    int64_t time);
+
+MEDIA_KIT_VIDEO_EXPORT const int64_t* keyframe_index_get_times(
+    const KeyframeIndex* self);
+
+MEDIA_KIT_VIDEO_EXPORT size_t
+keyframe_index_get_count(const KeyframeIndex* self);
+
+#endif  // KEYFRAME_INDEX_H_
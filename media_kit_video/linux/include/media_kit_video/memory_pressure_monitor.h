@@ -0,0 +1,50 @@
+// This file is a part of media_kit
+// (https://github.com/media-kit/media-kit).
+//
+// Copyright © 2026 & onwards, Predidit.
+// All rights reserved.
+// Use of this source code is governed by MIT license that can be found in the
+// LICENSE file.
+
+#ifndef MEMORY_PRESSURE_MONITOR_H_
+#define MEMORY_PRESSURE_MONITOR_H_
+
+#include <glib-object.h>
+
+typedef enum {
+  MEMORY_PRESSURE_LEVEL_LOW,
+  MEMORY_PRESSURE_LEVEL_MEDIUM,
+  MEMORY_PRESSURE_LEVEL_CRITICAL,
+} MemoryPressureLevel;
+
+// Callback invoked on the main thread when the system is low on memory.
+typedef void (*MemoryPressureCallback)(MemoryPressureLevel level,
+                                       gpointer context);
+
+#define MEMORY_PRESSURE_MONITOR_TYPE (memory_pressure_monitor_get_type())
+
+// Watches system memory pressure through GLib's |GMemoryMonitor| (GLib 2.64+)
+// & PSI triggers on `/proc/pressure/memory` (Linux 4.20+). Either source may
+// be unavailable; the monitor is silently inert then.
+G_DECLARE_FINAL_TYPE(MemoryPressureMonitor,
+                     memory_pressure_monitor,
+                     MEMORY_PRESSURE_MONITOR,
+                     MEMORY_PRESSURE_MONITOR,
+                     GObject)
+
+#define MEMORY_PRESSURE_MONITOR(obj)                                     \
+  (G_TYPE_CHECK_INSTANCE_CAST((obj), memory_pressure_monitor_get_type(), \
+                              MemoryPressureMonitor))
+
+MemoryPressureMonitor* memory_pressure_monitor_new(
+    MemoryPressureCallback callback,
+    gpointer callback_context);
+
+/**
+ * @brief Invokes the callback as if the system reported |level|. Useful for
+ * testing the response to memory pressure.
+ */
+void memory_pressure_monitor_notify(MemoryPressureMonitor* self,
+                                    MemoryPressureLevel level);
+
+#endif  // MEMORY_PRESSURE_MONITOR_H_
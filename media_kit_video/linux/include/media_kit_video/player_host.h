@@ -0,0 +1,102 @@
+// This file is a part of media_kit
+// (https://github.com/media-kit/media-kit).
+//
+// Copyright © 2026 & onwards, Predidit.
+// All rights reserved.
+// Use of this source code is governed by MIT license that can be found in the
+// LICENSE file.
+
+#ifndef PLAYER_HOST_H_
+#define PLAYER_HOST_H_
+
+#include <sys/types.h>
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "player_host_protocol.h"
+
+// Runs players in `media_kit_video_player_host` processes, at most
+// |players_per_host| per process, spawning processes as needed: a crash takes
+// down the players of one process, never the application, & decoding scales
+// over several processes.
+//
+// Players are identified by ids unique within the pool. Messages of a player
+// are delivered to its |Callback|, on a thread reading its process' socket;
+// once the process is gone (crash, `kill`), a last PLAYER_HOST_EXIT message is
+// delivered & the player is forgotten.
+class PlayerHostPool {
+ public:
+  // Takes ownership of |message.fd|.
+  typedef std::function<void(PlayerHostMessage& message)> Callback;
+
+  // |path| of `media_kit_video_player_host`, see |DefaultPath|.
+  PlayerHostPool(std::string path, int32_t players_per_host);
+
+  PlayerHostPool(const PlayerHostPool&) = delete;
+  PlayerHostPool& operator=(const PlayerHostPool&) = delete;
+
+  // Terminates every process.
+  ~PlayerHostPool();
+
+  // Applies to the players created afterwards.
+  void SetPlayersPerHost(int32_t players_per_host);
+
+  // Creates a player in a process with room for it. Returns its id, 0 on
+  // failure.
+  uint32_t Create(Callback callback);
+
+  // Sends |message| (its |player| is set) to |player|'s process. Returns false
+  // if the player is gone.
+  bool Send(uint32_t player, PlayerHostMessage message);
+
+  // Destroys |player|. Its callback is not running & is never invoked again
+  // once this returns, so it must not be called from the callback. Processes
+  // left without players are terminated.
+  void Destroy(uint32_t player);
+
+  // Process running |player|, 0 if none. For diagnostics & tests.
+  pid_t GetProcessId(uint32_t player);
+
+  // Number of processes running.
+  size_t GetHostCount();
+
+  // `media_kit_video_player_host` next to the plugin's shared library, or
+  // $MEDIA_KIT_VIDEO_PLAYER_HOST if set.
+  static std::string DefaultPath();
+
+ private:
+  struct Host {
+    // The socket outlives |Stop| for concurrent |Send|s, which fail.
+    ~Host();
+
+    pid_t pid = 0;
+    int socket = -1;
+    std::thread reader;
+    // Held while a callback runs, so that |Destroy| can wait for it.
+    std::mutex callback_mutex;
+    std::map<uint32_t, Callback> players;  // |callback_mutex|.
+    bool exited = false;                   // |mutex_|.
+  };
+
+  std::shared_ptr<Host> Spawn();
+  void Read(std::shared_ptr<Host> host);
+  void Stop(const std::shared_ptr<Host>& host);
+  std::shared_ptr<Host> Find(uint32_t player);
+
+  const std::string path_;
+
+  std::mutex mutex_;
+  int32_t players_per_host_;                  // |mutex_|.
+  uint32_t next_id_ = 1;                      // |mutex_|.
+  std::vector<std::shared_ptr<Host>> hosts_;  // |mutex_|.
+  std::map<uint32_t, std::shared_ptr<Host>> players_;  // |mutex_|.
+};
+
+#endif  // PLAYER_HOST_H_
@@ -0,0 +1,84 @@
+// This file is a part of media_kit
+// (https://github.com/media-kit/media-kit).
+//
+// Copyright © 2026 & onwards, Predidit.
+// All rights reserved.
+// Use of this source code is governed by MIT license that can be found in the
+// LICENSE file.
+
+#ifndef PLAYER_HOST_PROTOCOL_H_
+#define PLAYER_HOST_PROTOCOL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Messages between the plugin & `media_kit_video_player_host`, the helper
+// process |PlayerHostPool| runs players in. Exchanged over a SOCK_SEQPACKET
+// Unix socket pair, one message per packet:
+//
+//   uint32 type | uint32 player | uint8 integer count | uint8 string count |
+//   int64 integers... | (uint32 size, bytes) strings...
+//
+// in host byte order, as both ends run on the same machine. At most one file
+// descriptor accompanies a message, as SCM_RIGHTS ancillary data.
+enum PlayerHostMessageType : uint32_t {
+  // Plugin to host.
+  PLAYER_HOST_CREATE = 1,        // Creates |player|.
+  PLAYER_HOST_DESTROY,           // Destroys |player|.
+  PLAYER_HOST_COMMAND,           // strings: `mpv_command` arguments.
+  PLAYER_HOST_SET_PROPERTY,      // strings: name, value.
+  PLAYER_HOST_GET_PROPERTY,      // integers: request; strings: name.
+  PLAYER_HOST_OBSERVE_PROPERTY,  // strings: name.
+  PLAYER_HOST_SET_SIZE,          // integers: width, height; 0 follows video.
+  PLAYER_HOST_RELEASE_FRAME,     // integers: generation, index.
+
+  // Host to plugin.
+  PLAYER_HOST_BUFFERS = 64,      // integers: generation, width, height,
+                                 // stride, count; fd: memfd of the frames.
+  PLAYER_HOST_FRAME,             // integers: generation, index.
+  PLAYER_HOST_REPLY,             // integers: request, error; strings: value.
+  PLAYER_HOST_PROPERTY_CHANGE,   // strings: name, value ("" if unavailable).
+  PLAYER_HOST_EVENT,             // strings: `mpv_event_name`.
+
+  // Synthesized by |PlayerHostPool| once the host process is gone.
+  PLAYER_HOST_EXIT = 128,        // integers: `waitpid` status.
+};
+
+struct PlayerHostMessage {
+  uint32_t type = 0;
+  uint32_t player = 0;
+  std::vector<int64_t> integers;
+  std::vector<std::string> strings;
+  int fd = -1;  // Owned by the receiver.
+};
+
+class PlayerHostProtocol {
+ public:
+  // Largest packet; large enough for URLs & most property values.
+  static constexpr size_t kMaxMessageSize = 64 * 1024;
+
+  // File descriptor of the socket in the host process.
+  static constexpr int kHostSocket = 3;
+
+  // Serializes |message|, without its |fd|. Returns false if it does not fit
+  // in |kMaxMessageSize| or has too many integers or strings.
+  static bool Encode(const PlayerHostMessage& message,
+                     std::vector<uint8_t>* data);
+
+  // Parses a packet. Returns false if it is malformed.
+  static bool Decode(const uint8_t* data,
+                     size_t size,
+                     PlayerHostMessage* message);
+
+  // Sends |message| & its |fd|, if any, which remains open. Thread-safe, as
+  // each message is a single packet. Returns false on error.
+  static bool Send(int socket, const PlayerHostMessage& message);
+
+  // Receives the next well-formed message, skipping malformed ones. Blocking.
+  // Returns false once the peer is gone or on error.
+  static bool Receive(int socket, PlayerHostMessage* message);
+};
+
+#endif  // PLAYER_HOST_PROTOCOL_H_
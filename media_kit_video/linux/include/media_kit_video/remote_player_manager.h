@@ -0,0 +1,76 @@
+// This file is a part of media_kit
+// (https://github.com/media-kit/media-kit).
+//
+// Copyright © 2026 & onwards, Predidit.
+// All rights reserved.
+// Use of this source code is governed by MIT license that can be found in the
+// LICENSE file.
+
+#ifndef REMOTE_PLAYER_MANAGER_H_
+#define REMOTE_PLAYER_MANAGER_H_
+
+#include <flutter_linux/flutter_linux.h>
+#include <sys/types.h>
+
+#include "player_host_protocol.h"
+
+#define REMOTE_PLAYER_MANAGER_TYPE (remote_player_manager_get_type())
+
+// Creates & disposes players running in `media_kit_video_player_host`
+// processes (see |PlayerHostPool|), each shown through a |TextureRemote|.
+G_DECLARE_FINAL_TYPE(RemotePlayerManager,
+                     remote_player_manager,
+                     REMOTE_PLAYER_MANAGER,
+                     REMOTE_PLAYER_MANAGER,
+                     GObject)
+
+#define REMOTE_PLAYER_MANAGER(obj)                                     \
+  (G_TYPE_CHECK_INSTANCE_CAST((obj), remote_player_manager_get_type(), \
+                              RemotePlayerManager))
+
+// Invoked on the main thread with the messages of player |id|, other than
+// frames: PLAYER_HOST_BUFFERS (the size of the texture changed), _REPLY,
+// _PROPERTY_CHANGE, _EVENT & lastly _EXIT if its process is gone.
+typedef void (*RemotePlayerCallback)(guint32 id,
+                                     const PlayerHostMessage* message,
+                                     gpointer context);
+
+RemotePlayerManager* remote_player_manager_new(
+    FlTextureRegistrar* texture_registrar,
+    RemotePlayerCallback callback,
+    gpointer callback_context);
+
+/**
+ * @brief Creates a player in a `media_kit_video_player_host` process shared
+ * by at most |players_per_host| players, spawning one if needed.
+ *
+ * @return Its id, 0 on failure.
+ */
+guint32 remote_player_manager_create(RemotePlayerManager* self,
+                                     gint32 players_per_host);
+
+/**
+ * @brief Returns the ID of the texture player |id| is shown through, 0 if
+ * none.
+ */
+gint64 remote_player_manager_get_texture_id(RemotePlayerManager* self,
+                                            guint32 id);
+
+/**
+ * @brief Sends |message| to player |id|.
+ *
+ * @return FALSE if its process is gone.
+ */
+gboolean remote_player_manager_send(RemotePlayerManager* self,
+                                    guint32 id,
+                                    PlayerHostMessage message);
+
+/**
+ * @brief Returns the process player |id| runs in, 0 if none.
+ */
+pid_t remote_player_manager_get_process_id(RemotePlayerManager* self,
+                                           guint32 id);
+
+void remote_player_manager_dispose(RemotePlayerManager* self, guint32 id);
+
+#endif  // REMOTE_PLAYER_MANAGER_H_
@@ -0,0 +1,63 @@
+// This file is a part of media_kit
+// (https://github.com/media-kit/media-kit).
+//
+// Copyright © 2026 & onwards, Predidit.
+// All rights reserved.
+// Use of this source code is governed by MIT license that can be found in the
+// LICENSE file.
+
+#ifndef RENDER_SCALE_CONTROLLER_H_
+#define RENDER_SCALE_CONTROLLER_H_
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Chooses the render scale of each video output from the time spent
+// rendering it, so that all outputs together fit the render budget.
+//
+// Fed once per measurement window: when the total render time exceeds
+// |kHighLoad| of the window, the least important output is scaled down by
+// one step. Once the load has stayed below |kLowLoad| for |kRaiseWindows|
+// windows, the most important scaled down output is raised by one step, if
+// its predicted cost still keeps the load below |kHighLoad|. No change is
+// made for |kCooldownWindows| after a change, while buffers are re-allocated
+// & the measurements settle.
+class RenderScaleController {
+ public:
+  // Render scale of each step; the area halves roughly every two steps.
+  static constexpr double kScales[] = {1.0, 0.85, 0.7, 0.6, 0.5, 0.35, 0.25};
+  static constexpr int kLevelCount = sizeof(kScales) / sizeof(kScales[0]);
+
+  static constexpr double kHighLoad = 0.85;
+  static constexpr double kLowLoad = 0.55;
+  static constexpr int kRaiseWindows = 4;
+  static constexpr int kCooldownWindows = 2;
+
+  struct Sample {
+    int64_t key = 0;
+    // Higher is more important; equal priorities degrade the most expensive
+    // output first.
+    int priority = 0;
+    // Time spent rendering the output in the window, in microseconds.
+    int64_t render_time = 0;
+  };
+
+  // Adjusts the levels for one window of |window| microseconds. Outputs
+  // missing from |samples| are forgotten. Returns the keys whose scale
+  // changed.
+  std::vector<int64_t> Update(const std::vector<Sample>& samples,
+                              int64_t window);
+
+  double GetScale(int64_t key) const;
+
+  // Restores all outputs to full scale.
+  void Reset();
+
+ private:
+  std::unordered_map<int64_t, int> levels_;
+  int low_windows_ = 0;
+  int cooldown_ = 0;
+};
+
+#endif  // RENDER_SCALE_CONTROLLER_H_
@@ -0,0 +1,153 @@
+// This file is a part of media_kit
+// (https://github.com/media-kit/media-kit).
+//
+// Copyright © 2026 & onwards, Predidit.
+// All rights reserved.
+// Use of this source code is governed by MIT license that can be found in the
+// LICENSE file.
+
+#ifndef SUBTITLE_INDEX_H_
+#define SUBTITLE_INDEX_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "export.h"
+
+// A single cue. Layout is shared with Dart (`SubtitleCue` FFI struct), so the
+// cue array can be read without copying.
+typedef struct {
+  int32_t start;         // Milliseconds.
+  int32_t end;           // Milliseconds, exclusive.
+  uint32_t text_offset;  // Offset of the UTF-8 text in the text blob.
+  uint32_t text_length;  // Length of the UTF-8 text in bytes.
+} SubtitleCue;
+
+// Time-sorted cue index of a SRT, WebVTT or ASS/SSA subtitle file.
+//
+// Input is parsed incrementally through |Feed|, so large files never need to
+// be resident in memory. |Finish| sorts the cues & builds an implicit interval
+// tree (max end time per subtree) over the sorted array, which answers time
+// range queries in O(log n + k) without any per-node allocation.
+class SubtitleIndex {
+ public:
+  SubtitleIndex();
+
+  // Parses the next chunk of the file. Format is detected from the content.
+  void Feed(const char* data, size_t size);
+
+  // Adds an already decoded cue e.g. from mpv's `sub-text` of an embedded
+  // track. Must be followed by |Finish| before querying.
+  void AddCue(int32_t start, int32_t end, const char* text, size_t size);
+
+  // Flushes the pending input, sorts the cues & builds the interval tree.
+  void Finish();
+
+  // Parses the file at |path| in fixed size chunks. Returns false on I/O error.
+  bool LoadFile(const char* path);
+
+  // Writes indices of the cues overlapping [start, end] (in start order) to
+  // |out|, up to |capacity|. Returns the total number of overlapping cues.
+  size_t Query(int32_t start, int32_t end, uint32_t* out, size_t capacity) const;
+
+  // Writes indices of the cues containing |needle| (ASCII case-insensitive)
+  // to |out|, starting from cue |from|, up to |capacity|. Returns the number
+  // of indices written.
+  size_t Search(const char* needle,
+                uint32_t from,
+                uint32_t* out,
+                size_t capacity) const;
+
+  // Returns the index of the first cue starting at or after |time|.
+  uint32_t LowerBound(int32_t time) const;
+
+  const SubtitleCue* cues() const { return cues_.data(); }
+  size_t size() const { return cues_.size(); }
+  const char* text() const { return text_.data(); }
+  size_t text_size() const { return text_.size(); }
+
+ private:
+  enum class Format { kUnknown, kSrt, kVtt, kAss };
+
+  void ParseLine(std::string& line);
+  void ParseSrtLine(const std::string& line);
+  void ParseAssLine(const std::string& line);
+  void FlushCue();
+  void AppendText(const char* data, size_t size, bool ass);
+
+  void QueryRange(size_t lo,
+                  size_t hi,
+                  int32_t start,
+                  int32_t end,
+                  uint32_t* out,
+                  size_t capacity,
+                  size_t* count) const;
+  int32_t BuildTree(size_t lo, size_t hi);
+
+  std::vector<SubtitleCue> cues_;
+  std::vector<int32_t> max_end_;
+  std::string text_;
+
+  // Incremental parser state.
+  Format format_ = Format::kUnknown;
+  std::string line_;
+  bool first_line_ = true;
+  bool in_cue_ = false;
+  bool in_events_ = false;
+  int32_t cue_start_ = 0;
+  int32_t cue_end_ = 0;
+  std::string cue_text_;
+  int ass_start_field_ = 1;
+  int ass_end_field_ = 2;
+  int ass_text_field_ = 9;
+  bool finished_ = false;
+};
+
+// C API for `dart:ffi`.
+
+MEDIA_KIT_VIDEO_EXPORT SubtitleIndex* subtitle_index_new();
+
+MEDIA_KIT_VIDEO_EXPORT void subtitle_index_free(SubtitleIndex* self);
+
+MEDIA_KIT_VIDEO_EXPORT void subtitle_index_feed(SubtitleIndex* self,
+                                                const char* data,
+                                                size_t size);
+
+MEDIA_KIT_VIDEO_EXPORT void subtitle_index_add_cue(SubtitleIndex* self,
+                                                   int32_t start,
+                                                   int32_t end,
+                                                   const char* text,
+                                                   size_t size);
+
+MEDIA_KIT_VIDEO_EXPORT void subtitle_index_finish(SubtitleIndex* self);
+
+MEDIA_KIT_VIDEO_EXPORT SubtitleIndex* subtitle_index_load_file(
+    const char* path);
+
+MEDIA_KIT_VIDEO_EXPORT size_t subtitle_index_query(const SubtitleIndex* self,
+                                                   int32_t start,
+                                                   int32_t end,
+                                                   uint32_t* out,
+                                                   size_t capacity);
+
+MEDIA_KIT_VIDEO_EXPORT size_t subtitle_index_search(const SubtitleIndex* self,
+                                                    const char* needle,
+                                                    uint32_t from,
+                                                    uint32_t* out,
+                                                    size_t capacity);
+
+MEDIA_KIT_VIDEO_EXPORT uint32_t
+subtitle_index_lower_bound(const SubtitleIndex* self, int32_t time);
+
+MEDIA_KIT_VIDEO_EXPORT const SubtitleCue* subtitle_index_get_cues(
+    const SubtitleIndex* self);
+
+MEDIA_KIT_VIDEO_EXPORT size_t
+subtitle_index_get_count(const SubtitleIndex* self);
+
+MEDIA_KIT_VIDEO_EXPORT const char* subtitle_index_get_text(
+    const SubtitleIndex* self);
+
+#endif  // SUBTITLE_INDEX_H_
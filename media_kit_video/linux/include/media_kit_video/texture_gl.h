@@ -13,8 +13,13 @@
 
 #include "video_output.h"
 
+class FrameTap;
+
 #define TEXTURE_GL_TYPE (texture_gl_get_type())
 
+// Number of buffers for mailbox triple buffering.
+#define TEXTURE_GL_BUFFER_COUNT 3
+
 G_DECLARE_FINAL_TYPE(TextureGL, texture_gl, TEXTURE_GL, TEXTURE_GL, FlTextureGL)
 
 #define TEXTURE_GL(obj) \
@@ -35,6 +40,14 @@ void texture_gl_check_and_resize(TextureGL* self, gint64 required_width, gint64
  */
 gboolean texture_gl_render(TextureGL* self);
 
+/**
+ * @brief Copies the frame rendered last into |tap|, captured at |time|
+ * (monotonic, microseconds). Blocks until the GPU finished rendering it.
+ * Called from the dedicated GL thread after |texture_gl_render|, before
+ * |texture_gl_swap_buffers|.
+ */
+void texture_gl_tap(TextureGL* self, FrameTap* tap, gint64 time);
+
 /**
  * @brief Publishes the rendered frame using mailbox swap.
  * Atomically swaps back buffer with mailbox, old mailbox content becomes new back buffer.
@@ -42,6 +55,41 @@ gboolean texture_gl_render(TextureGL* self);
  */
 void texture_gl_swap_buffers(TextureGL* self);
 
+/**
+ * @brief Releases all buffers except the one currently displayed, which
+ * remains as a snapshot. The released buffers are re-allocated by the next
+ * |texture_gl_check_and_resize|. Called from the main thread after the
+ * producer has stopped rendering.
+ */
+void texture_gl_suspend(TextureGL* self);
+
+/**
+ * @brief Whether the current GL context can upload S/W rendered frames
+ * through pixel buffer objects: |glMapBufferRange| & fence syncs are core in
+ * OpenGL ES 3.0 & OpenGL 3.2.
+ */
+gboolean texture_gl_is_sw_upload_supported();
+
+/**
+ * @brief Returns the number of allocated GPU buffers (0 before first frame).
+ * Thread-safe.
+ */
+gint64 texture_gl_get_buffer_count(TextureGL* self);
+
+/**
+ * @brief Returns the size of each allocated GPU buffer in bytes (RGBA).
+ * Thread-safe.
+ */
+gint64 texture_gl_get_buffer_size(TextureGL* self);
+
+/**
+ * @brief Returns the time spent rendering since the previous call in
+ * microseconds & resets it. Measured on the GPU through timestamp queries
+ * where available, otherwise as the render's wall time on the GL thread.
+ * Thread-safe.
+ */
+gint64 texture_gl_take_render_time(TextureGL* self);
+
 /**
  * @brief Populates texture with video frame using mailbox model.
  * Atomically swaps front buffer with mailbox to get the latest frame.
@@ -0,0 +1,88 @@
+// This file is a part of media_kit
+// (https://github.com/media-kit/media-kit).
+//
+// Copyright © 2026 & onwards, Predidit.
+// All rights reserved.
+// Use of this source code is governed by MIT license that can be found in the
+// LICENSE file.
+
+#ifndef TEXTURE_OVERLAY_H_
+#define TEXTURE_OVERLAY_H_
+
+#include <flutter_linux/flutter_linux.h>
+
+#define TEXTURE_OVERLAY_TYPE (texture_overlay_get_type())
+
+// Small premultiplied RGBA texture holding the rasterized subtitles of a
+// |VideoOutput|: plain text rasterized with Pango, or ASS rendered with
+// libass. Flutter composites it on top of the video texture, so that subtitle
+// changes never require the video frame to be rendered again.
+G_DECLARE_FINAL_TYPE(TextureOverlay,
+                     texture_overlay,
+                     TEXTURE_OVERLAY,
+                     TEXTURE_OVERLAY,
+                     FlPixelBufferTexture)
+
+#define TEXTURE_OVERLAY(obj) \
+  (G_TYPE_CHECK_INSTANCE_CAST((obj), texture_overlay_get_type(), TextureOverlay))
+
+TextureOverlay* texture_overlay_new();
+
+/**
+ * @brief Rasterizes |text| into the overlay bitmap.
+ *
+ * The bitmap is as wide as the video frame & only as tall as the text block,
+ * so that it can be anchored at the bottom of the video by the consumer.
+ * Thread-safe; called from the dedicated GL thread.
+ *
+ * @param self |TextureOverlay| reference.
+ * @param text UTF-8 subtitle text. Empty or `NULL` clears the overlay.
+ * @param frame_width Width of the video frame the overlay is placed upon.
+ * @param frame_height Height of the video frame the overlay is placed upon.
+ * @return TRUE if the bitmap dimensions changed.
+ */
+gboolean texture_overlay_update(TextureOverlay* self,
+                                const gchar* text,
+                                gint64 frame_width,
+                                gint64 frame_height);
+
+/**
+ * @brief Renders |text| with libass into the overlay bitmap, in place of mpv
+ * rendering the subtitles into the video frame.
+ *
+ * The bitmap is as wide as the video frame & spans from the topmost glyph to
+ * the bottom of the frame. Events are rendered with the track's default
+ * style. Called from the dedicated GL thread.
+ *
+ * @param self |TextureOverlay| reference.
+ * @param header ASS header of the track (`sub-ass-extradata`); `NULL` for
+ * FFmpeg's default one.
+ * @param text Current events in ASS format (`sub-text/ass`), one per line.
+ * Empty or `NULL` clears the overlay.
+ * @param frame_width Width of the video frame the overlay is placed upon.
+ * @param frame_height Height of the video frame the overlay is placed upon.
+ * @return TRUE if the bitmap dimensions changed.
+ */
+gboolean texture_overlay_update_ass(TextureOverlay* self,
+                                    const gchar* header,
+                                    const gchar* text,
+                                    gint64 frame_width,
+                                    gint64 frame_height);
+
+// Whether libass is loaded in the process, for |texture_overlay_update_ass|.
+gboolean texture_overlay_is_ass_supported();
+
+gint64 texture_overlay_get_width(TextureOverlay* self);
+
+gint64 texture_overlay_get_height(TextureOverlay* self);
+
+// Bytes currently held by the overlay bitmaps. Thread-safe.
+gint64 texture_overlay_get_size_in_bytes(TextureOverlay* self);
+
+gboolean texture_overlay_copy_pixels(FlPixelBufferTexture* texture,
+                                     const guint8** buffer,
+                                     guint32* width,
+                                     guint32* height,
+                                     GError** error);
+
+#endif  // TEXTURE_OVERLAY_H_
@@ -0,0 +1,72 @@
+// This file is a part of media_kit
+// (https://github.com/media-kit/media-kit).
+//
+// Copyright © 2026 & onwards, Predidit.
+// All rights reserved.
+// Use of this source code is governed by MIT license that can be found in the
+// LICENSE file.
+
+#ifndef TEXTURE_REMOTE_H_
+#define TEXTURE_REMOTE_H_
+
+#include <flutter_linux/flutter_linux.h>
+
+#define TEXTURE_REMOTE_TYPE (texture_remote_get_type())
+
+// Shows the frames a player renders in `media_kit_video_player_host`, read
+// in place from the memfd they are shared through (see player_host_protocol.h).
+G_DECLARE_FINAL_TYPE(TextureRemote,
+                     texture_remote,
+                     TEXTURE_REMOTE,
+                     TEXTURE_REMOTE,
+                     FlPixelBufferTexture)
+
+#define TEXTURE_REMOTE(obj) \
+  (G_TYPE_CHECK_INSTANCE_CAST((obj), texture_remote_get_type(), TextureRemote))
+
+// Invoked with a frame no longer needed, which is to be returned to the
+// player host. From the thread calling |texture_remote_push_frame| or
+// Flutter's raster thread.
+typedef void (*TextureRemoteReleaseCallback)(gint64 generation,
+                                             gint32 index,
+                                             gpointer context);
+
+TextureRemote* texture_remote_new(TextureRemoteReleaseCallback release_callback,
+                                  gpointer release_callback_context);
+
+/**
+ * @brief Maps the |count| frames of |generation| in |fd|, each |height| rows
+ * of |stride| bytes of RGB0. Takes ownership of |fd|. Previous generations
+ * remain mapped for as long as Flutter may read their frames.
+ *
+ * @return FALSE if |fd| could not be mapped.
+ */
+gboolean texture_remote_set_buffers(TextureRemote* self,
+                                    gint fd,
+                                    gint64 generation,
+                                    gint32 width,
+                                    gint32 height,
+                                    gint32 stride,
+                                    gint32 count);
+
+/**
+ * @brief Queues frame |index| of |generation| for display. A frame queued
+ * earlier & not picked up by Flutter yet is released.
+ */
+void texture_remote_push_frame(TextureRemote* self,
+                               gint64 generation,
+                               gint32 index);
+
+/**
+ * @brief Releases the queued & displayed frames & unmaps every generation.
+ * Called once the texture is unregistered.
+ */
+void texture_remote_clear(TextureRemote* self);
+
+gboolean texture_remote_copy_pixels(FlPixelBufferTexture* texture,
+                                    const guint8** buffer,
+                                    guint32* width,
+                                    guint32* height,
+                                    GError** error);
+
+#endif  // TEXTURE_REMOTE_H_
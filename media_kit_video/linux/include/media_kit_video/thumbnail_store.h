@@ -0,0 +1,200 @@
+// This file is a part of media_kit
+// (https://github.com/media-kit/media-kit).
+//
+// Copyright © 2026 & onwards, Predidit.
+// All rights reserved.
+// Use of this source code is governed by MIT license that can be found in the
+// LICENSE file.
+
+#ifndef THUMBNAIL_STORE_H_
+#define THUMBNAIL_STORE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "export.h"
+
+// Encodings of the bytes of a |ThumbnailTile|, matching the formats of
+// `Player.screenshot`.
+enum ThumbnailFormat : int32_t {
+  THUMBNAIL_FORMAT_BGRA = 0,  // Raw, 4 bytes per pixel, no padding.
+  THUMBNAIL_FORMAT_JPEG = 1,
+  THUMBNAIL_FORMAT_PNG = 2,
+};
+
+// A tile returned by |ThumbnailStore::Lookup|. |data| points into the store's
+// mapping of its data file & stays valid until |ThumbnailStore::Release|,
+// even if the tile is replaced, evicted or compacted in the meantime. Plain C
+// layout, mirrored by a `dart:ffi` `Struct`.
+struct ThumbnailTile {
+  const uint8_t* data;
+  int64_t length;
+  int32_t width;
+  int32_t height;
+  int32_t format;  // |ThumbnailFormat|.
+  int32_t reserved;
+};
+
+// Persistent store of preview thumbnails, keyed by media (any string, e.g. a
+// path or URL, hashed to 64 bits), time & requested size, bounded to
+// |max_size| bytes of tiles by evicting the least recently used first.
+//
+// Tiles are appended to a data file, `tiles.<generation>`, mapped read-only:
+// lookups return pointers into the mapping, without any copy or syscall. The
+// `index` is an open-addressing hash table mapped read-write & updated in
+// place, so opening the store does not read it. It is only scanned to repair
+// it after a crash.
+//
+// Replaced & evicted tiles leave garbage in the data file. Once it outweighs
+// the live tiles, a background thread copies those into the next generation
+// & swaps the files, without blocking lookups but for the final swap.
+//
+// Thread safe. A directory is used by one store at a time, across processes.
+class ThumbnailStore {
+ public:
+  struct Stats {
+    int64_t tiles = 0;
+    int64_t size = 0;       // Bytes of the tiles stored.
+    int64_t file_size = 0;  // Bytes of the data file, including garbage.
+    int64_t evictions = 0;  // Tiles evicted since |Open|.
+    int64_t compactions = 0;  // Since |Open|.
+  };
+
+  // Stores at most |max_size| bytes of tiles in |directory|.
+  ThumbnailStore(std::string directory, int64_t max_size);
+
+  ThumbnailStore(const ThumbnailStore&) = delete;
+  ThumbnailStore& operator=(const ThumbnailStore&) = delete;
+
+  // Aborts a compaction in progress & syncs the files. Tiles not released yet
+  // stay valid.
+  ~ThumbnailStore();
+
+  // Creates the directory & maps the index & the data file, repairing them
+  // after a crash. Returns false if the directory is not usable or already
+  // used by another store.
+  bool Open();
+
+  // Returns the tile stored for |media|, |time| & |size|, or NULL. Marks it
+  // as most recently used. Must be passed to |Release|.
+  const ThumbnailTile* Lookup(const std::string& media,
+                              int64_t time,
+                              int32_t size);
+
+  static void Release(const ThumbnailTile* tile);
+
+  // Stores |length| bytes of |data| for |media|, |time| & |size|, replacing
+  // the previous tile, evicting as needed. Returns false on I/O error or if
+  // the tile is too large.
+  bool Insert(const std::string& media,
+              int64_t time,
+              int32_t size,
+              ThumbnailFormat format,
+              int32_t width,
+              int32_t height,
+              const void* data,
+              int64_t length);
+
+  bool Remove(const std::string& media, int64_t time, int32_t size);
+
+  // Removes every tile of |media| e.g. once it changed. Scans the index.
+  void RemoveMedia(const std::string& media);
+
+  // Copies the live tiles into a new data file, dropping the garbage. Done in
+  // the background as needed; blocking.
+  bool Compact();
+
+  // Syncs the data file & the index.
+  void Flush();
+
+  // Deletes every tile.
+  void Clear();
+
+  Stats GetStats();
+
+  const std::string& directory() const { return directory_; }
+
+  // Default directory: `$XDG_CACHE_HOME/media_kit/thumbnails`.
+  static std::string DefaultDirectory();
+
+ private:
+  struct Slot;
+  struct Index;
+  struct Data;
+  struct Lease;
+
+  std::string GetDataPath(uint32_t generation) const;
+  std::shared_ptr<Data> OpenData(uint32_t generation, bool truncate);
+  bool Reset();
+  void Repair();
+  bool Rebuild(uint64_t capacity,
+               std::shared_ptr<Data> data,
+               const std::function<bool(Slot*)>& move);
+  void Evict();
+  void MaybeCompact();
+
+  const std::string directory_;
+  const int64_t max_size_;
+  const int64_t reservation_;  // Address space mapped past each data file.
+  int lock_ = -1;
+  std::mutex mutex_;
+  std::unique_ptr<Index> index_;
+  std::shared_ptr<Data> data_;
+  int64_t evictions_ = 0;
+  int64_t compactions_ = 0;
+  std::mutex compact_mutex_;  // Serializes |Compact|, taken before |mutex_|.
+  std::thread compactor_;
+  std::atomic<bool> compacting_{false};
+  std::atomic<bool> compact_failed_{false};  // Not retried in the background.
+  std::atomic<bool> stopping_{false};
+};
+
+// C API for `dart:ffi`.
+
+// Opens a store of at most |max_size| bytes of tiles in |directory| (NULL
+// for the default). Returns NULL on failure.
+MEDIA_KIT_VIDEO_EXPORT ThumbnailStore* thumbnail_store_open(
+    const char* directory,
+    int64_t max_size);
+
+MEDIA_KIT_VIDEO_EXPORT void thumbnail_store_close(ThumbnailStore* self);
+
+MEDIA_KIT_VIDEO_EXPORT const ThumbnailTile* thumbnail_store_lookup(
+    ThumbnailStore* self,
+    const char* media,
+    int64_t time,
+    int32_t size);
+
+MEDIA_KIT_VIDEO_EXPORT void thumbnail_store_release(const ThumbnailTile* tile);
+
+MEDIA_KIT_VIDEO_EXPORT bool thumbnail_store_insert(ThumbnailStore* self,
+                                                   const char* media,
+                                                   int64_t time,
+                                                   int32_t size,
+                                                   int32_t format,
+                                                   int32_t width,
+                                                   int32_t height,
+                                                   const uint8_t* data,
+                                                   int64_t length);
+
+MEDIA_KIT_VIDEO_EXPORT bool thumbnail_store_remove(ThumbnailStore* self,
+                                                   const char* media,
+                                                   int64_t time,
+                                                   int32_t size);
+
+MEDIA_KIT_VIDEO_EXPORT void thumbnail_store_remove_media(ThumbnailStore* self,
+                                                         const char* media);
+
+// Writes tiles, bytes of tiles, bytes of the data file, evictions &
+// compactions to |stats|.
+MEDIA_KIT_VIDEO_EXPORT void thumbnail_store_get_stats(ThumbnailStore* self,
+                                                      int64_t* stats);
+
+MEDIA_KIT_VIDEO_EXPORT void thumbnail_store_clear(ThumbnailStore* self);
+
+#endif  // THUMBNAIL_STORE_H_
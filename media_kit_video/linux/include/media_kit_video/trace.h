@@ -0,0 +1,84 @@
+// This file is a part of media_kit
+// (https://github.com/media-kit/media-kit).
+//
+// Copyright © 2026 & onwards, Predidit.
+// All rights reserved.
+// Use of this source code is governed by MIT license that can be found in the
+// LICENSE file.
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Lightweight timeline tracing of the native render & event pipeline.
+//
+// Each thread records completed scopes into its own fixed size ring, so the
+// producers never take a lock or allocate after the first event of a thread.
+// Older events are overwritten once a ring is full. When tracing is disabled
+// (default), a scope costs one relaxed atomic load.
+//
+// Tracing is enabled with the `MEDIA_KIT_VIDEO_TRACE=1` environment variable
+// or at runtime through |Trace::SetEnabled|.
+class Trace {
+ public:
+  static bool IsEnabled() {
+    return enabled_.load(std::memory_order_relaxed);
+  }
+
+  static void SetEnabled(bool enabled);
+
+  // Monotonic timestamp in microseconds.
+  static uint64_t Now();
+
+  // Records a completed scope on the calling thread's ring. |name| must
+  // outlive the trace i.e. be a literal or come from |Intern|.
+  static void Record(const char* name,
+                     int64_t id,
+                     uint64_t begin,
+                     uint64_t duration);
+
+  // Returns a stable copy of |name| for use with |Record|.
+  static const char* Intern(const char* name);
+
+  // Returns the recorded events of all threads in Chrome's JSON trace event
+  // format, which can be loaded in `chrome://tracing` or ui.perfetto.dev.
+  static std::string DumpChromeJson();
+
+ private:
+  static std::atomic<bool> enabled_;
+};
+
+// Records the lifetime of the enclosing scope.
+class TraceScope {
+ public:
+  TraceScope(const char* name, int64_t id)
+      : name_(Trace::IsEnabled() ? name : nullptr),
+        id_(id),
+        begin_(name_ != nullptr ? Trace::Now() : 0) {}
+
+  ~TraceScope() {
+    if (name_ != nullptr) {
+      Trace::Record(name_, id_, begin_, Trace::Now() - begin_);
+    }
+  }
+
+  TraceScope(const TraceScope&) = delete;
+  TraceScope& operator=(const TraceScope&) = delete;
+
+ private:
+  const char* name_;
+  int64_t id_;
+  uint64_t begin_;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+// Traces the enclosing scope as |name|, tagged with the output |id|.
+#define TRACE_SCOPE(name, id) \
+  TraceScope TRACE_CONCAT(trace_scope_, __LINE__)((name), (int64_t)(id))
+
+#endif  // TRACE_H_
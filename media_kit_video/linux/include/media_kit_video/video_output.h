@@ -17,25 +17,85 @@
 #include "mpv/render_gl.h"
 #include "gl_render_thread.h"
 
+class FrameTap;
+class HwdecCalibration;
+
+// Milliseconds |video_output_end_preview| waits for the first frame of the
+// exact seek before handing the texture back anyway.
+#define VIDEO_OUTPUT_PREVIEW_HANDOFF_TIMEOUT 1000
+// Milliseconds after the end of scrubbing before the preview player is
+// destroyed.
+#define VIDEO_OUTPUT_PREVIEW_IDLE_TIMEOUT 10000
+
 typedef struct _VideoOutputConfiguration {
   gint64 width;
   gint64 height;
   bool enable_hardware_acceleration;
+  // Subtitles are rasterized into a separate texture: `sub-text` with Pango,
+  // or, if the player enabled `sub-visibility`, libass output in place of
+  // mpv rendering them into the video frame.
+  bool enable_subtitle_overlay;
+  // Milliseconds an output stays invisible before its video decoding is
+  // suspended, -1 to keep decoding. See |video_output_set_visibility|.
+  gint64 decode_suspension_delay;
+  // Live sources: frames are published as soon as they are decoded instead of
+  // at their display time & `video-sync` is left to the player's options
+  // (mpv's low-latency options are applied by `PlayerConfiguration`).
+  bool low_latency;
+  // `hwdec` was left to the plugin: the API measured best for the codec &
+  // resolution of each file is applied once known. See |HwdecCalibration|.
+  bool hwdec_calibration;
+  // Renders in S/W into pixel buffer objects even where mpv's GL renderer is
+  // usable. See |video_output_is_sw_upload|.
+  bool sw_upload;
 
   _VideoOutputConfiguration(gint64 width = NULL,
                             gint64 height = NULL,
-                            bool enable_hardware_acceleration = true)
+                            bool enable_hardware_acceleration = true,
+                            bool enable_subtitle_overlay = false,
+                            gint64 decode_suspension_delay = -1,
+                            bool low_latency = false,
+                            bool hwdec_calibration = false,
+                            bool sw_upload = false)
       : width(width),
         height(height),
-        enable_hardware_acceleration(enable_hardware_acceleration) {}
+        enable_hardware_acceleration(enable_hardware_acceleration),
+        enable_subtitle_overlay(enable_subtitle_overlay),
+        decode_suspension_delay(decode_suspension_delay),
+        low_latency(low_latency),
+        hwdec_calibration(hwdec_calibration),
+        sw_upload(sw_upload) {}
 } VideoOutputConfiguration;
 
+// Memory held by a |VideoOutput| & its mpv instance, in bytes.
+typedef struct _VideoOutputMemoryUsage {
+  gint64 gpu_buffer_count;    // Number of |TextureGL| buffers (equal size).
+  gint64 gpu_bytes;           // Total size of the |TextureGL| buffers.
+  gint64 cpu_pixel_bytes;     // S/W pixel buffer & subtitle overlay bitmaps.
+  gint64 demuxer_cache_bytes; // `demuxer-cache-state/total-bytes`.
+  gint64 hwdec_surface_bytes; // Upper bound estimate of the hwdec pool.
+} VideoOutputMemoryUsage;
+
+// Visibility of the |VideoOutput|'s texture, as reported by the widget tree.
+typedef enum {
+  VIDEO_OUTPUT_VISIBILITY_VISIBLE = 0,
+  VIDEO_OUTPUT_VISIBILITY_OCCLUDED,   // Covered e.g. by an opaque route.
+  VIDEO_OUTPUT_VISIBILITY_OFFSCREEN,  // Scrolled out of view or not painted.
+} VideoOutputVisibility;
+
 // Callback invoked when the texture ID updates i.e. video dimensions changes.
 typedef void (*TextureUpdateCallback)(gint64 id,
                                       gint64 width,
                                       gint64 height,
                                       gpointer context);
 
+// Callback invoked when the |VideoOutput| is suspended or resumed. The owner
+// of the player's demuxer cache sizes trims it to |demuxer_cache_bytes| while
+// suspended & restores it afterwards.
+typedef void (*SuspensionCallback)(gboolean suspended,
+                                   gint64 demuxer_cache_bytes,
+                                   gpointer context);
+
 #define VIDEO_OUTPUT_TYPE (video_output_get_type())
 
 G_DECLARE_FINAL_TYPE(VideoOutput,
@@ -76,6 +136,33 @@ void video_output_set_texture_update_callback(
     TextureUpdateCallback texture_update_callback,
     gpointer texture_update_callback_context);
 
+/**
+ * @brief Sets the callback invoked when the subtitle overlay texture is
+ * created or its dimensions change. Only invoked if
+ * |VideoOutputConfiguration::enable_subtitle_overlay| is set.
+ *
+ * @param self |VideoOutput| reference.
+ * @param subtitle_overlay_update_callback Callback.
+ * @param subtitle_overlay_update_callback_context Callback context.
+ */
+void video_output_set_subtitle_overlay_update_callback(
+    VideoOutput* self,
+    TextureUpdateCallback subtitle_overlay_update_callback,
+    gpointer subtitle_overlay_update_callback_context);
+
+/**
+ * @brief Sets the callback invoked when the |VideoOutput| is suspended or
+ * resumed. See |video_output_suspend|.
+ *
+ * @param self |VideoOutput| reference.
+ * @param suspension_callback Callback.
+ * @param suspension_callback_context Callback context.
+ */
+void video_output_set_suspension_callback(
+    VideoOutput* self,
+    SuspensionCallback suspension_callback,
+    gpointer suspension_callback_context);
+
 /**
  * @brief Sets the required video output size. This forces |VideoOutput| to
  * resize the internal OpenGL surface / texture.
@@ -88,6 +175,153 @@ void video_output_set_texture_update_callback(
  */
 void video_output_set_size(VideoOutput* self, gint64 width, gint64 height);
 
+/**
+ * @brief Sets a soft limit for the GPU buffers of the |VideoOutput|. When the
+ * buffers for the current video resolution exceed |bytes|, the render size is
+ * scaled down (keeping aspect ratio) until they fit. Only applies to H/W
+ * rendering.
+ *
+ * @param self |VideoOutput| reference.
+ * @param bytes Limit in bytes. Pass 0 to remove the limit.
+ */
+void video_output_set_memory_limit(VideoOutput* self, gint64 bytes);
+
+gint64 video_output_get_memory_limit(VideoOutput* self);
+
+/**
+ * @brief Sets the scale of the H/W render size relative to the size set
+ * through |video_output_set_size| (or the video resolution), keeping aspect
+ * ratio. Combined with the memory limit, the smaller scale wins. Buffers are
+ * re-allocated upon the next render.
+ *
+ * @param self |VideoOutput| reference.
+ * @param scale Scale in (0, 1].
+ */
+void video_output_set_render_scale(VideoOutput* self, gdouble scale);
+
+gdouble video_output_get_render_scale(VideoOutput* self);
+
+/**
+ * @brief Returns the time spent rendering since the previous call in
+ * microseconds & resets it. See |texture_gl_take_render_time|.
+ */
+gint64 video_output_take_render_time(VideoOutput* self);
+
+/**
+ * @brief Fills |usage| with the memory currently held by the |VideoOutput|.
+ * Must be called from the main thread.
+ */
+void video_output_get_memory_usage(VideoOutput* self,
+                                   VideoOutputMemoryUsage* usage);
+
+/**
+ * @brief Suspends the |VideoOutput| e.g. while it is not visible. The mpv
+ * render context, the video decoder & all GPU buffers but the one on screen
+ * are released; that last frame remains displayed as a snapshot. Audio
+ * playback continues. Must be called from the main thread.
+ *
+ * @param self |VideoOutput| reference.
+ * @param demuxer_cache_bytes Size the demuxer cache is to be trimmed to, with
+ * the back buffer dropped entirely, passed to the |SuspensionCallback|.
+ * @param resume_on_playback Whether to resume automatically when playback is
+ * unpaused or a seek is performed.
+ */
+void video_output_suspend(VideoOutput* self,
+                          gint64 demuxer_cache_bytes,
+                          gboolean resume_on_playback);
+
+/**
+ * @brief Undoes |video_output_suspend|. Must be called from the main thread.
+ */
+void video_output_resume(VideoOutput* self);
+
+gboolean video_output_is_suspended(VideoOutput* self);
+
+/**
+ * @brief Sets the visibility of the |VideoOutput|. While not visible, frames
+ * are consumed without being rendered, so that playback & A/V sync continue
+ * without GPU work & the texture keeps showing the last visible frame. The
+ * current frame is rendered once upon becoming visible again. Must be called
+ * from the main thread.
+ *
+ * With |VideoOutputConfiguration::decode_suspension_delay|, video decoding is
+ * disabled (`vid=no`) once invisible for that long. Upon becoming visible, the
+ * track is restored & a keyframe seek to the current (audio) position keeps
+ * the decoded frames to a minimum; the last frame stays on screen until the
+ * first new one. See |video_output_get_decode_resume_latency|.
+ *
+ * @param self |VideoOutput| reference.
+ * @param visibility Visibility.
+ */
+void video_output_set_visibility(VideoOutput* self,
+                                 VideoOutputVisibility visibility);
+
+VideoOutputVisibility video_output_get_visibility(VideoOutput* self);
+
+gboolean video_output_is_decoding_suspended(VideoOutput* self);
+
+/**
+ * @brief Returns the time from the last resume of video decoding to its first
+ * frame on screen in microseconds, or 0 if none was measured yet.
+ */
+gint64 video_output_get_decode_resume_latency(VideoOutput* self);
+
+/**
+ * @brief Shows the keyframe at or before |position| (seconds) while scrubbing.
+ * The keyframes are decoded by a secondary mpv instance of the same file,
+ * rendered into the same texture, that skips every other frame & the loop
+ * filter; a new position supersedes the previous one still queued. The
+ * secondary instance is created in the background; the current frame stays on
+ * screen until its first keyframe. The main player is paused until
+ * |video_output_end_preview|. Must be called from the main thread.
+ *
+ * Returns FALSE if not supported (S/W rendering, suspended or invisible
+ * output), nothing is loaded or the secondary instance could not be created;
+ * the caller should seek the main player.
+ */
+gboolean video_output_preview(VideoOutput* self, gdouble position);
+
+/**
+ * @brief Ends |video_output_preview| with an exact seek of the main player to
+ * |position| (seconds), restoring its playback state. The preview stays on
+ * screen until the first frame after the seek. The secondary instance is kept
+ * for |VIDEO_OUTPUT_PREVIEW_IDLE_TIMEOUT|. Must be called from the main
+ * thread.
+ */
+void video_output_end_preview(VideoOutput* self, gdouble position);
+
+/**
+ * @brief Whether the texture shows the frames of the preview player.
+ */
+gboolean video_output_is_previewing(VideoOutput* self);
+
+/**
+ * @brief Sets the calibration whose `hwdec` is applied to the files opened
+ * from now on, if |VideoOutputConfiguration::hwdec_calibration| is set.
+ * |calibration| must outlive |self|; NULL until calibrated.
+ */
+void video_output_set_hwdec_calibration(VideoOutput* self,
+                                        const HwdecCalibration* calibration);
+
+/**
+ * @brief Sets the |FrameTap| the rendered frames are copied into, taking
+ * ownership of it; NULL removes it. The previous one is destroyed once no
+ * thread delivers into it anymore; frames acquired from it must have been
+ * released. Frames skipped while invisible or in trick play are not tapped.
+ */
+void video_output_set_frame_tap(VideoOutput* self, FrameTap* tap);
+
+gint64 video_output_get_handle(VideoOutput* self);
+
+gboolean video_output_is_low_latency(VideoOutput* self);
+
+/**
+ * @brief Whether mpv renders in S/W into |TextureGL|'s pixel buffer objects,
+ * uploaded on the dedicated GL thread. Used where a GL context exists but
+ * mpv's GL renderer is unusable, or if |VideoOutputConfiguration::sw_upload|.
+ */
+gboolean video_output_is_sw_upload(VideoOutput* self);
+
 mpv_render_context* video_output_get_render_context(VideoOutput* self);
 
 GdkGLContext* video_output_get_gdk_gl_context(VideoOutput* self);
@@ -108,6 +342,8 @@ gint64 video_output_get_height(VideoOutput* self);
 
 gint64 video_output_get_texture_id(VideoOutput* self);
 
+gint64 video_output_get_subtitle_overlay_texture_id(VideoOutput* self);
+
 void video_output_notify_texture_update(VideoOutput* self);
 
 void video_output_notify_render(VideoOutput* self);
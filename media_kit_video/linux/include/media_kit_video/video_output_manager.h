@@ -11,6 +11,8 @@
 
 #include "video_output.h"
 #include "gl_render_thread.h"
+#include "allocator.h"
+#include "frame_tap.h"
 
 #define VIDEO_OUTPUT_MANAGER_TYPE (video_output_manager_get_type())
 
@@ -50,6 +52,37 @@ void video_output_manager_create(VideoOutputManager* self,
                                  TextureUpdateCallback texture_update_callback,
                                  gpointer texture_update_callback_context);
 
+/**
+ * @brief Sets the callback invoked when the subtitle overlay texture of the
+ * |VideoOutput| for given |handle| is created or resized.
+ *
+ * @param self |VideoOutputManager| reference.
+ * @param handle |mpv_handle| reference casted to gint64.
+ * @param subtitle_overlay_update_callback Callback.
+ * @param subtitle_overlay_update_callback_context Context passed to
+ * |subtitle_overlay_update_callback|.
+ */
+void video_output_manager_set_subtitle_overlay_update_callback(
+    VideoOutputManager* self,
+    gint64 handle,
+    TextureUpdateCallback subtitle_overlay_update_callback,
+    gpointer subtitle_overlay_update_callback_context);
+
+/**
+ * @brief Sets the callback invoked when the |VideoOutput| for given |handle|
+ * is suspended or resumed, also under memory pressure.
+ *
+ * @param self |VideoOutputManager| reference.
+ * @param handle |mpv_handle| reference casted to gint64.
+ * @param suspension_callback Callback.
+ * @param suspension_callback_context Context passed to |suspension_callback|.
+ */
+void video_output_manager_set_suspension_callback(
+    VideoOutputManager* self,
+    gint64 handle,
+    SuspensionCallback suspension_callback,
+    gpointer suspension_callback_context);
+
 /**
  * @brief Sets the required video output size. This forces |VideoOutput| to
  * resize the internal OpenGL surface / texture.
@@ -65,6 +98,164 @@ void video_output_manager_set_size(VideoOutputManager* self,
                                    gint64 width,
                                    gint64 height);
 
+/**
+ * @brief Sets the soft GPU memory limit of the |VideoOutput| for given
+ * |handle|. See |video_output_set_memory_limit|.
+ *
+ * @param self |VideoOutputManager| reference.
+ * @param handle |mpv_handle| reference casted to gint64.
+ * @param bytes Limit in bytes. Pass 0 to remove the limit.
+ */
+void video_output_manager_set_memory_limit(VideoOutputManager* self,
+                                           gint64 handle,
+                                           gint64 bytes);
+
+/**
+ * @brief Sets a soft GPU memory limit shared equally by all |VideoOutput|s.
+ * Combined with the per-output limits; the lower one applies.
+ *
+ * @param self |VideoOutputManager| reference.
+ * @param bytes Limit in bytes. Pass 0 to remove the limit.
+ */
+void video_output_manager_set_total_memory_limit(VideoOutputManager* self,
+                                                 gint64 bytes);
+
+/**
+ * @brief Fills |usage| with the memory held by the |VideoOutput| for given
+ * |handle|, or the sum of all |VideoOutput|s if |handle| is 0.
+ *
+ * @return FALSE if there is no |VideoOutput| for |handle|.
+ */
+gboolean video_output_manager_get_memory_usage(VideoOutputManager* self,
+                                               gint64 handle,
+                                               VideoOutputMemoryUsage* usage);
+
+/**
+ * @brief Suspends the |VideoOutput| for given |handle|. See
+ * |video_output_suspend|.
+ *
+ * @param self |VideoOutputManager| reference.
+ * @param handle |mpv_handle| reference casted to gint64.
+ * @param demuxer_cache_bytes Size the demuxer cache is trimmed to. Pass -1
+ * for the default set through |video_output_manager_set_auto_suspend|.
+ */
+void video_output_manager_suspend(VideoOutputManager* self,
+                                  gint64 handle,
+                                  gint64 demuxer_cache_bytes);
+
+/**
+ * @brief Resumes the |VideoOutput| for given |handle|.
+ */
+void video_output_manager_resume(VideoOutputManager* self, gint64 handle);
+
+/**
+ * @brief Sets the visibility of the |VideoOutput| for given |handle|. See
+ * |video_output_set_visibility|.
+ */
+void video_output_manager_set_visibility(VideoOutputManager* self,
+                                         gint64 handle,
+                                         VideoOutputVisibility visibility);
+
+/**
+ * @brief Retrieves |video_output_get_decode_resume_latency| of the
+ * |VideoOutput| for given |handle|.
+ *
+ * @return FALSE if there is no |VideoOutput| for |handle|.
+ */
+gboolean video_output_manager_get_decode_resume_latency(
+    VideoOutputManager* self,
+    gint64 handle,
+    gint64* latency);
+
+/**
+ * @brief Shows the keyframe at |position| (seconds) in the |VideoOutput| for
+ * given |handle| while scrubbing. See |video_output_preview|.
+ *
+ * @return FALSE if there is no |VideoOutput| for |handle| or it cannot
+ * preview.
+ */
+gboolean video_output_manager_preview(VideoOutputManager* self,
+                                      gint64 handle,
+                                      gdouble position);
+
+/**
+ * @brief Ends scrubbing of the |VideoOutput| for given |handle| at |position|
+ * (seconds). See |video_output_end_preview|.
+ */
+void video_output_manager_end_preview(VideoOutputManager* self,
+                                      gint64 handle,
+                                      gdouble position);
+
+/**
+ * @brief Creates a |FrameTap| for the |VideoOutput| for given |handle|,
+ * replacing its previous one. See |FrameTap::FrameTap| for the parameters.
+ *
+ * @return The tap, owned by the |VideoOutput|, or NULL if there is no
+ * |VideoOutput| for |handle|.
+ */
+FrameTap* video_output_manager_create_frame_tap(VideoOutputManager* self,
+                                                gint64 handle,
+                                                FrameTapFormat format,
+                                                gint32 width,
+                                                gint32 height,
+                                                gdouble rate,
+                                                gint32 buffer_count);
+
+/**
+ * @brief Destroys the |FrameTap| of the |VideoOutput| for given |handle|.
+ */
+void video_output_manager_dispose_frame_tap(VideoOutputManager* self,
+                                            gint64 handle);
+
+/**
+ * @brief Enables adaptive render resolution: the time spent rendering each
+ * H/W |VideoOutput| is measured (GPU timestamps where available) & when all
+ * of them together no longer fit in real time, the render resolution of the
+ * least important output is lowered step by step, & raised again once there
+ * is headroom. See |RenderScaleController|. Disabling restores full scale.
+ */
+void video_output_manager_set_adaptive_resolution(VideoOutputManager* self,
+                                                  gboolean enabled);
+
+/**
+ * @brief Sets the priority of the |VideoOutput| for given |handle| for
+ * adaptive render resolution; lower priorities are scaled down first.
+ * Default: 0.
+ */
+void video_output_manager_set_priority(VideoOutputManager* self,
+                                       gint64 handle,
+                                       gint priority);
+
+/**
+ * @brief Configures the response to system memory pressure: when |enabled|
+ * (default), paused |VideoOutput|s are suspended & resume by themselves once
+ * played or seeked.
+ *
+ * @param self |VideoOutputManager| reference.
+ * @param enabled Whether to suspend paused outputs under memory pressure.
+ * @param demuxer_cache_bytes Size the demuxer cache of suspended outputs is
+ * trimmed to. Pass -1 to keep the current value (4 MiB by default).
+ */
+void video_output_manager_set_auto_suspend(VideoOutputManager* self,
+                                           gboolean enabled,
+                                           gint64 demuxer_cache_bytes);
+
+/**
+ * @brief Responds as if the system reported memory pressure of |level|
+ * (|MemoryPressureLevel|).
+ */
+void video_output_manager_notify_memory_pressure(VideoOutputManager* self,
+                                                 gint level);
+
+/**
+ * @brief Fills |stats| with the process-wide allocator statistics & |heap|
+ * with those of the dedicated heap of the GL render thread (zero unless
+ * mimalloc is in use).
+ */
+void video_output_manager_get_allocator_stats(VideoOutputManager* self,
+                                              Allocator::Stats* stats,
+                                              Allocator::HeapStats* heap);
+
 /**
  * @brief Disposes |VideoOutput| instance for given |handle|.
  *
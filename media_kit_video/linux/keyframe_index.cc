@@ -0,0 +1,1040 @@
+// This file is a part of media_kit
+// (https://github.com/media-kit/media-kit).
+//
+// Copyright © 2026 & onwards, Predidit.
+// All rights reserved.
+// Use of this source code is governed by MIT license that can be found in the
+// LICENSE file.
+
+#include "include/media_kit_video/keyframe_index.h"
+
+#include <errno.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+// Bumped whenever the persisted layout changes.
+#define KEYFRAME_INDEX_MAGIC "MKKF"
+#define KEYFRAME_INDEX_VERSION 1
+
+// Tables larger than this are not read into memory (corrupt files).
+#define KEYFRAME_INDEX_MAX_TABLE_SIZE (256 * 1024 * 1024)
+
+namespace {
+
+// Big endian / EBML reading over a |FILE|, tracking the position.
+class Reader {
+ public:
+  Reader(FILE* file, int64_t size) : file_(file), size_(size) {}
+
+  int64_t size() const { return size_; }
+  int64_t position() const { return position_; }
+
+  bool Seek(int64_t position) {
+    if (position < 0 || position > size_) {
+      return false;
+    }
+    if (position != position_ && fseeko(file_, position, SEEK_SET) != 0) {
+      return false;
+    }
+    position_ = position;
+    return true;
+  }
+
+  bool Read(void* data, size_t size) {
+    if (fread(data, 1, size, file_) != size) {
+      return false;
+    }
+    position_ += size;
+    return true;
+  }
+
+  bool ReadBE(int bytes, uint64_t* value) {
+    uint8_t data[8];
+    if (bytes > 8 || !Read(data, bytes)) {
+      return false;
+    }
+    *value = 0;
+    for (int i = 0; i < bytes; i++) {
+      *value = (*value << 8) | data[i];
+    }
+    return true;
+  }
+
+  // EBML element ID, marker bit kept.
+  bool ReadId(uint32_t* id) {
+    uint8_t first;
+    if (!Read(&first, 1) || first == 0) {
+      return false;
+    }
+    int length = 1;
+    while (length <= 4 && !(first & (0x80 >> (length - 1)))) {
+      length++;
+    }
+    if (length > 4) {
+      return false;
+    }
+    uint64_t rest = 0;
+    if (length > 1 && !ReadBE(length - 1, &rest)) {
+      return false;
+    }
+    *id = (uint32_t)(((uint64_t)first << (8 * (length - 1))) | rest);
+    return true;
+  }
+
+  // EBML variable size integer, marker bit removed. |unknown| is set for the
+  // reserved all ones value.
+  bool ReadVint(uint64_t* value, bool* unknown = nullptr) {
+    uint8_t first;
+    if (!Read(&first, 1) || first == 0) {
+      return false;
+    }
+    int length = 1;
+    while (!(first & (0x80 >> (length - 1)))) {
+      length++;
+    }
+    uint64_t rest = 0;
+    if (length > 1 && !ReadBE(length - 1, &rest)) {
+      return false;
+    }
+    uint64_t mask = (1ull << (7 * length)) - 1;
+    *value = ((((uint64_t)first) << (8 * (length - 1))) | rest) & mask;
+    if (unknown != nullptr) {
+      *unknown = *value == mask;
+    }
+    return true;
+  }
+
+ private:
+  FILE* file_;
+  int64_t size_;
+  int64_t position_ = 0;
+};
+
+// Reads the remaining |end| - position bytes of a box into |data|.
+bool ReadPayload(Reader& reader, int64_t end, std::vector<uint8_t>& data) {
+  int64_t size = end - reader.position();
+  if (size < 0 || size > KEYFRAME_INDEX_MAX_TABLE_SIZE) {
+    return false;
+  }
+  data.resize(size);
+  return size == 0 || reader.Read(data.data(), size);
+}
+
+uint32_t BE32(const uint8_t* data) {
+  return ((uint32_t)data[0] << 24) | ((uint32_t)data[1] << 16) |
+         ((uint32_t)data[2] << 8) | data[3];
+}
+
+uint64_t BE64(const uint8_t* data) {
+  return ((uint64_t)BE32(data) << 32) | BE32(data + 4);
+}
+
+constexpr uint32_t FourCC(const char* type) {
+  return ((uint32_t)(uint8_t)type[0] << 24) |
+         ((uint32_t)(uint8_t)type[1] << 16) |
+         ((uint32_t)(uint8_t)type[2] << 8) | (uint32_t)(uint8_t)type[3];
+}
+
+// MP4.
+
+struct Mp4Track {
+  uint32_t id = 0;
+  uint32_t timescale = 0;
+  bool video = false;
+  int64_t media_time = 0;  // First edit, in |timescale| units.
+  std::vector<uint8_t> stts;
+  std::vector<uint8_t> ctts;
+  std::vector<uint8_t> stss;
+  bool has_stss = false;
+  // `trex` defaults & running decode time of fragments.
+  uint32_t default_duration = 0;
+  uint32_t default_flags = 0;
+  int64_t fragment_time = 0;
+};
+
+struct Mp4State {
+  std::vector<Mp4Track> tracks;
+  Mp4Track* current = nullptr;  // Track of the `trak` / `traf` being parsed.
+  // `tfhd` of the `traf` being parsed.
+  uint32_t traf_duration = 0;
+  uint32_t traf_flags = 0;
+  std::vector<int64_t> times;
+};
+
+Mp4Track* FindMp4Track(Mp4State& state, uint32_t id) {
+  for (Mp4Track& track : state.tracks) {
+    if (track.id == id) {
+      return &track;
+    }
+  }
+  return nullptr;
+}
+
+// The video track fragments are indexed for: the first one.
+Mp4Track* FindMp4VideoTrack(Mp4State& state) {
+  for (Mp4Track& track : state.tracks) {
+    if (track.video && track.timescale > 0) {
+      return &track;
+    }
+  }
+  return nullptr;
+}
+
+int64_t Mp4TimeToMs(const Mp4Track& track, int64_t time) {
+  return std::max<int64_t>(
+      0, (time - track.media_time) * 1000 / (int64_t)track.timescale);
+}
+
+// Walks `stts`, `ctts` & `stss` of a non-fragmented track.
+void AddMp4SampleTable(const Mp4Track& track, std::vector<int64_t>& times) {
+  if (track.stts.size() < 8 || track.timescale == 0) {
+    return;
+  }
+  uint32_t stts_count =
+      std::min<uint32_t>(BE32(track.stts.data() + 4),
+                         (uint32_t)((track.stts.size() - 8) / 8));
+  uint32_t ctts_count =
+      track.ctts.size() < 8
+          ? 0
+          : std::min<uint32_t>(BE32(track.ctts.data() + 4),
+                               (uint32_t)((track.ctts.size() - 8) / 8));
+  uint32_t stss_count =
+      track.stss.size() < 8
+          ? 0
+          : std::min<uint32_t>(BE32(track.stss.data() + 4),
+                               (uint32_t)((track.stss.size() - 8) / 4));
+  // Version 1 `ctts` offsets are signed; version 0 ones are in practice too.
+  uint32_t ctts_entry = 0, ctts_left = 0;
+  int64_t ctts_offset = 0;
+  uint32_t stss_entry = 0;
+  uint32_t sample = 1;
+  int64_t dts = 0;
+  for (uint32_t i = 0; i < stts_count; i++) {
+    const uint8_t* entry = track.stts.data() + 8 + i * 8;
+    uint32_t count = BE32(entry);
+    uint32_t delta = BE32(entry + 4);
+    for (uint32_t j = 0; j < count; j++, sample++, dts += delta) {
+      if (ctts_left == 0 && ctts_entry < ctts_count) {
+        const uint8_t* ctts = track.ctts.data() + 8 + ctts_entry * 8;
+        ctts_left = BE32(ctts);
+        ctts_offset = (int32_t)BE32(ctts + 4);
+        ctts_entry++;
+      }
+      int64_t offset = ctts_left > 0 ? ctts_offset : 0;
+      if (ctts_left > 0) {
+        ctts_left--;
+      }
+      if (track.has_stss) {
+        while (stss_entry < stss_count &&
+               BE32(track.stss.data() + 8 + stss_entry * 4) < sample) {
+          stss_entry++;
+        }
+        if (stss_entry >= stss_count) {
+          return;
+        }
+        if (BE32(track.stss.data() + 8 + stss_entry * 4) != sample) {
+          continue;
+        }
+      }
+      times.push_back(Mp4TimeToMs(track, dts + offset));
+    }
+  }
+}
+
+void ParseTrun(Mp4State& state, const std::vector<uint8_t>& data) {
+  Mp4Track* track = state.current;
+  if (track == nullptr || !track->video || track->timescale == 0 ||
+      data.size() < 8) {
+    return;
+  }
+  uint32_t flags = BE32(data.data()) & 0xFFFFFF;
+  uint32_t count = BE32(data.data() + 4);
+  size_t offset = 8;
+  if (flags & 0x1) {
+    offset += 4;  // data_offset
+  }
+  bool has_first_flags = flags & 0x4;
+  uint32_t first_flags = 0;
+  if (has_first_flags) {
+    if (offset + 4 > data.size()) {
+      return;
+    }
+    first_flags = BE32(data.data() + offset);
+    offset += 4;
+  }
+  size_t entry_size = ((flags & 0x100) ? 4 : 0) + ((flags & 0x200) ? 4 : 0) +
+                      ((flags & 0x400) ? 4 : 0) + ((flags & 0x800) ? 4 : 0);
+  for (uint32_t i = 0; i < count; i++) {
+    if (offset + entry_size > data.size()) {
+      return;
+    }
+    const uint8_t* entry = data.data() + offset;
+    uint32_t duration = state.traf_duration;
+    uint32_t sample_flags = state.traf_flags;
+    int64_t cts = 0;
+    if (flags & 0x100) {
+      duration = BE32(entry);
+      entry += 4;
+    }
+    if (flags & 0x200) {
+      entry += 4;  // sample_size
+    }
+    if (flags & 0x400) {
+      sample_flags = BE32(entry);
+      entry += 4;
+    }
+    if (flags & 0x800) {
+      cts = (int32_t)BE32(entry);
+    }
+    if (i == 0 && has_first_flags) {
+      sample_flags = first_flags;
+    }
+    offset += entry_size;
+    // sample_is_non_sync_sample
+    if (!(sample_flags & 0x10000)) {
+      state.times.push_back(Mp4TimeToMs(*track, track->fragment_time + cts));
+    }
+    track->fragment_time += duration;
+  }
+}
+
+bool ParseMp4Boxes(Reader& reader, int64_t end, Mp4State& state, int depth) {
+  std::vector<uint8_t> data;
+  while (reader.position() + 8 <= end) {
+    int64_t start = reader.position();
+    uint64_t size, type;
+    if (!reader.ReadBE(4, &size) || !reader.ReadBE(4, &type)) {
+      return false;
+    }
+    if (size == 1) {
+      if (!reader.ReadBE(8, &size)) {
+        return false;
+      }
+    } else if (size == 0) {
+      size = end - start;
+    }
+    int64_t box_end = start + (int64_t)size;
+    if (size < 8 || box_end > end) {
+      // Truncated (e.g. still downloading): keep what was found.
+      return depth == 0 && !state.tracks.empty();
+    }
+    switch (type) {
+      case FourCC("moov"):
+      case FourCC("mdia"):
+      case FourCC("minf"):
+      case FourCC("stbl"):
+      case FourCC("edts"):
+      case FourCC("mvex"):
+      case FourCC("moof"):
+        if (!ParseMp4Boxes(reader, box_end, state, depth + 1)) {
+          return false;
+        }
+        break;
+      case FourCC("trak"):
+        state.tracks.emplace_back();
+        state.current = &state.tracks.back();
+        if (!ParseMp4Boxes(reader, box_end, state, depth + 1)) {
+          return false;
+        }
+        state.current = nullptr;
+        break;
+      case FourCC("traf"):
+        state.current = nullptr;
+        if (!ParseMp4Boxes(reader, box_end, state, depth + 1)) {
+          return false;
+        }
+        state.current = nullptr;
+        break;
+      case FourCC("tkhd"):
+      case FourCC("mdhd"):
+      case FourCC("hdlr"):
+      case FourCC("elst"):
+      case FourCC("stts"):
+      case FourCC("ctts"):
+      case FourCC("stss"):
+      case FourCC("trex"):
+      case FourCC("tfhd"):
+      case FourCC("tfdt"):
+      case FourCC("trun"): {
+        if (!ReadPayload(reader, box_end, data) || data.size() < 4) {
+          break;
+        }
+        uint8_t version = data[0];
+        Mp4Track* track = state.current;
+        if (type == FourCC("trex") && data.size() >= 24) {
+          Mp4Track* trex = FindMp4Track(state, BE32(data.data() + 4));
+          if (trex != nullptr) {
+            trex->default_duration = BE32(data.data() + 12);
+            trex->default_flags = BE32(data.data() + 20);
+          }
+        } else if (type == FourCC("tfhd") && data.size() >= 8) {
+          uint32_t flags = BE32(data.data()) & 0xFFFFFF;
+          state.current = FindMp4Track(state, BE32(data.data() + 4));
+          if (state.current == nullptr) {
+            break;
+          }
+          size_t offset = 8;
+          offset += (flags & 0x1) ? 8 : 0;  // base_data_offset
+          offset += (flags & 0x2) ? 4 : 0;  // sample_description_index
+          state.traf_duration = state.current->default_duration;
+          state.traf_flags = state.current->default_flags;
+          if ((flags & 0x8) && offset + 4 <= data.size()) {
+            state.traf_duration = BE32(data.data() + offset);
+            offset += 4;
+          }
+          offset += (flags & 0x10) ? 4 : 0;  // default_sample_size
+          if ((flags & 0x20) && offset + 4 <= data.size()) {
+            state.traf_flags = BE32(data.data() + offset);
+          }
+        } else if (type == FourCC("trun")) {
+          ParseTrun(state, data);
+        } else if (track == nullptr) {
+          break;
+        } else if (type == FourCC("tfdt")) {
+          if (version == 1 && data.size() >= 12) {
+            track->fragment_time = (int64_t)BE64(data.data() + 4);
+          } else if (data.size() >= 8) {
+            track->fragment_time = BE32(data.data() + 4);
+          }
+        } else if (type == FourCC("tkhd")) {
+          size_t offset = version == 1 ? 20 : 12;
+          if (data.size() >= offset + 4) {
+            track->id = BE32(data.data() + offset);
+          }
+        } else if (type == FourCC("mdhd")) {
+          size_t offset = version == 1 ? 20 : 12;
+          if (data.size() >= offset + 4) {
+            track->timescale = BE32(data.data() + offset);
+          }
+        } else if (type == FourCC("hdlr") && data.size() >= 12) {
+          track->video = BE32(data.data() + 8) == FourCC("vide");
+        } else if (type == FourCC("elst") && data.size() >= 8) {
+          // First non-empty edit; leading empty edits are ignored.
+          uint32_t count = BE32(data.data() + 4);
+          size_t entry_size = version == 1 ? 20 : 12;
+          for (uint32_t i = 0; i < count; i++) {
+            size_t offset = 8 + i * entry_size;
+            if (offset + entry_size > data.size()) {
+              break;
+            }
+            int64_t media_time =
+                version == 1 ? (int64_t)BE64(data.data() + offset + 8)
+                             : (int32_t)BE32(data.data() + offset + 4);
+            if (media_time >= 0) {
+              track->media_time = media_time;
+              break;
+            }
+          }
+        } else if (type == FourCC("stts")) {
+          track->stts.swap(data);
+        } else if (type == FourCC("ctts")) {
+          track->ctts.swap(data);
+        } else if (type == FourCC("stss")) {
+          track->stss.swap(data);
+          track->has_stss = true;
+        }
+        break;
+      }
+      default:
+        break;
+    }
+    if (type == FourCC("moov")) {
+      Mp4Track* track = FindMp4VideoTrack(state);
+      if (track != nullptr) {
+        AddMp4SampleTable(*track, state.times);
+      }
+    }
+    if (!reader.Seek(box_end)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Matroska.
+
+#define MKV_ID_EBML 0x1A45DFA3
+#define MKV_ID_SEGMENT 0x18538067
+#define MKV_ID_SEEK_HEAD 0x114D9B74
+#define MKV_ID_SEEK 0x4DBB
+#define MKV_ID_SEEK_ID 0x53AB
+#define MKV_ID_SEEK_POSITION 0x53AC
+#define MKV_ID_INFO 0x1549A966
+#define MKV_ID_TIMECODE_SCALE 0x2AD7B1
+#define MKV_ID_TRACKS 0x1654AE6B
+#define MKV_ID_TRACK_ENTRY 0xAE
+#define MKV_ID_TRACK_NUMBER 0xD7
+#define MKV_ID_TRACK_TYPE 0x83
+#define MKV_ID_CUES 0x1C53BB6B
+#define MKV_ID_CUE_POINT 0xBB
+#define MKV_ID_CUE_TIME 0xB3
+#define MKV_ID_CUE_TRACK_POSITIONS 0xB7
+#define MKV_ID_CUE_TRACK 0xF7
+#define MKV_ID_CLUSTER 0x1F43B675
+#define MKV_ID_TIMECODE 0xE7
+#define MKV_ID_SIMPLE_BLOCK 0xA3
+#define MKV_ID_BLOCK_GROUP 0xA0
+#define MKV_ID_BLOCK 0xA1
+#define MKV_ID_REFERENCE_BLOCK 0xFB
+
+struct MkvElement {
+  uint32_t id;
+  int64_t data;
+  int64_t end;
+  bool unknown_size;
+};
+
+bool ReadMkvElement(Reader& reader, int64_t parent_end, MkvElement* element) {
+  uint64_t size;
+  if (!reader.ReadId(&element->id) ||
+      !reader.ReadVint(&size, &element->unknown_size)) {
+    return false;
+  }
+  element->data = reader.position();
+  if (element->unknown_size ||
+      (int64_t)size > parent_end - element->data) {
+    element->end = parent_end;
+  } else {
+    element->end = element->data + (int64_t)size;
+  }
+  return true;
+}
+
+bool ReadMkvUInt(Reader& reader, const MkvElement& element, uint64_t* value) {
+  int64_t size = element.end - element.data;
+  if (size <= 0) {
+    *value = 0;
+    return true;
+  }
+  return size <= 8 && reader.ReadBE((int)size, value);
+}
+
+// Level 1 elements, which end a Cluster of unknown size.
+bool IsMkvTopLevel(uint32_t id) {
+  switch (id) {
+    case MKV_ID_CLUSTER:
+    case MKV_ID_CUES:
+    case MKV_ID_SEEK_HEAD:
+    case MKV_ID_INFO:
+    case MKV_ID_TRACKS:
+    case 0x1043A770:  // Chapters
+    case 0x1254C367:  // Tags
+    case 0x1941A469:  // Attachments
+      return true;
+    default:
+      return false;
+  }
+}
+
+struct MkvState {
+  int64_t segment = 0;
+  uint64_t timecode_scale = 1000000;
+  uint64_t video_track = 0;  // 0 if unknown: all tracks.
+  int64_t cues = -1;
+  std::vector<int64_t> cue_times;
+  std::vector<int64_t> block_times;
+};
+
+int64_t MkvTimeToMs(const MkvState& state, int64_t time) {
+  return std::max<int64_t>(
+      0, (int64_t)((__int128)time * state.timecode_scale / 1000000));
+}
+
+bool ParseMkvCues(Reader& reader, int64_t end, MkvState& state) {
+  MkvElement point;
+  while (reader.position() < end && ReadMkvElement(reader, end, &point)) {
+    if (point.id == MKV_ID_CUE_POINT) {
+      uint64_t time = 0;
+      bool matches = state.video_track == 0;
+      MkvElement child;
+      while (reader.position() < point.end &&
+             ReadMkvElement(reader, point.end, &child)) {
+        if (child.id == MKV_ID_CUE_TIME) {
+          if (!ReadMkvUInt(reader, child, &time)) {
+            return false;
+          }
+        } else if (child.id == MKV_ID_CUE_TRACK_POSITIONS) {
+          MkvElement position;
+          while (reader.position() < child.end &&
+                 ReadMkvElement(reader, child.end, &position)) {
+            uint64_t track;
+            if (position.id == MKV_ID_CUE_TRACK &&
+                ReadMkvUInt(reader, position, &track) &&
+                track == state.video_track) {
+              matches = true;
+            }
+            if (!reader.Seek(position.end)) {
+              return false;
+            }
+          }
+        }
+        if (!reader.Seek(child.end)) {
+          return false;
+        }
+      }
+      if (matches) {
+        state.cue_times.push_back(MkvTimeToMs(state, (int64_t)time));
+      }
+    }
+    if (!reader.Seek(point.end)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Block header: track number, relative timecode, flags.
+bool ReadMkvBlockHeader(Reader& reader,
+                        uint64_t* track,
+                        int16_t* timecode,
+                        uint8_t* flags) {
+  uint64_t relative;
+  if (!reader.ReadVint(track) || !reader.ReadBE(2, &relative) ||
+      !reader.Read(flags, 1)) {
+    return false;
+  }
+  *timecode = (int16_t)relative;
+  return true;
+}
+
+// Scans the blocks of a Cluster for keyframes. Returns the end of the
+// Cluster, which is only known after the fact for unknown size ones.
+int64_t ScanMkvCluster(Reader& reader,
+                       const MkvElement& cluster,
+                       MkvState& state) {
+  int64_t time = 0;
+  MkvElement child;
+  while (reader.position() < cluster.end) {
+    int64_t start = reader.position();
+    if (!ReadMkvElement(reader, cluster.end, &child)) {
+      return -1;
+    }
+    if (cluster.unknown_size && IsMkvTopLevel(child.id)) {
+      return start;
+    }
+    uint64_t track, value;
+    int16_t relative;
+    uint8_t flags;
+    if (child.id == MKV_ID_TIMECODE) {
+      if (!ReadMkvUInt(reader, child, &value)) {
+        return -1;
+      }
+      time = (int64_t)value;
+    } else if (child.id == MKV_ID_SIMPLE_BLOCK) {
+      if (ReadMkvBlockHeader(reader, &track, &relative, &flags) &&
+          (flags & 0x80) &&
+          (state.video_track == 0 || track == state.video_track)) {
+        state.block_times.push_back(MkvTimeToMs(state, time + relative));
+      }
+    } else if (child.id == MKV_ID_BLOCK_GROUP) {
+      // A Block without ReferenceBlock is a keyframe.
+      bool block = false, reference = false;
+      int64_t block_time = 0;
+      MkvElement element;
+      while (reader.position() < child.end &&
+             ReadMkvElement(reader, child.end, &element)) {
+        if (element.id == MKV_ID_BLOCK &&
+            ReadMkvBlockHeader(reader, &track, &relative, &flags)) {
+          block = state.video_track == 0 || track == state.video_track;
+          block_time = time + relative;
+        } else if (element.id == MKV_ID_REFERENCE_BLOCK) {
+          reference = true;
+        }
+        if (!reader.Seek(element.end)) {
+          return -1;
+        }
+      }
+      if (block && !reference) {
+        state.block_times.push_back(MkvTimeToMs(state, block_time));
+      }
+    }
+    if (!reader.Seek(child.end)) {
+      return -1;
+    }
+  }
+  return cluster.end;
+}
+
+}  // namespace
+
+bool KeyframeIndex::Scan(const char* path) {
+  times_.clear();
+  FILE* file = fopen(path, "rb");
+  if (file == nullptr) {
+    return false;
+  }
+  struct stat info;
+  uint8_t header[8];
+  bool result = false;
+  if (fstat(fileno(file), &info) == 0 &&
+      fread(header, 1, sizeof(header), file) == sizeof(header)) {
+    rewind(file);
+    uint32_t type = BE32(header + 4);
+    if (BE32(header) == MKV_ID_EBML) {
+      result = ScanMkv(file, info.st_size);
+    } else if (type == FourCC("ftyp") || type == FourCC("moov") ||
+               type == FourCC("styp") || type == FourCC("free") ||
+               type == FourCC("mdat") || type == FourCC("wide") ||
+               type == FourCC("skip")) {
+      result = ScanMp4(file, info.st_size);
+    }
+  }
+  fclose(file);
+  Finish();
+  return result && !times_.empty();
+}
+
+bool KeyframeIndex::ScanMp4(FILE* file, int64_t size) {
+  Reader reader(file, size);
+  Mp4State state;
+  bool result = ParseMp4Boxes(reader, size, state, 0);
+  times_.swap(state.times);
+  return result || !times_.empty();
+}
+
+bool KeyframeIndex::ScanMkv(FILE* file, int64_t size) {
+  Reader reader(file, size);
+  MkvState state;
+  MkvElement element;
+  if (!ReadMkvElement(reader, size, &element) || element.id != MKV_ID_EBML ||
+      !reader.Seek(element.end) || !ReadMkvElement(reader, size, &element) ||
+      element.id != MKV_ID_SEGMENT) {
+    return false;
+  }
+  state.segment = element.data;
+  int64_t end = element.end;
+  bool tried_cues = false;
+  while (reader.position() < end) {
+    if (!ReadMkvElement(reader, end, &element)) {
+      break;
+    }
+    int64_t next = element.end;
+    if (element.id == MKV_ID_SEEK_HEAD) {
+      MkvElement seek;
+      while (reader.position() < element.end &&
+             ReadMkvElement(reader, element.end, &seek)) {
+        uint64_t id = 0, position = 0;
+        MkvElement child;
+        while (seek.id == MKV_ID_SEEK && reader.position() < seek.end &&
+               ReadMkvElement(reader, seek.end, &child)) {
+          if (child.id == MKV_ID_SEEK_ID) {
+            ReadMkvUInt(reader, child, &id);
+          } else if (child.id == MKV_ID_SEEK_POSITION) {
+            ReadMkvUInt(reader, child, &position);
+          }
+          if (!reader.Seek(child.end)) {
+            return false;
+          }
+        }
+        if (id == MKV_ID_CUES) {
+          state.cues = state.segment + (int64_t)position;
+        }
+        if (!reader.Seek(seek.end)) {
+          return false;
+        }
+      }
+    } else if (element.id == MKV_ID_INFO) {
+      MkvElement child;
+      while (reader.position() < element.end &&
+             ReadMkvElement(reader, element.end, &child)) {
+        uint64_t scale;
+        if (child.id == MKV_ID_TIMECODE_SCALE &&
+            ReadMkvUInt(reader, child, &scale) && scale > 0) {
+          state.timecode_scale = scale;
+        }
+        if (!reader.Seek(child.end)) {
+          return false;
+        }
+      }
+    } else if (element.id == MKV_ID_TRACKS) {
+      MkvElement entry;
+      while (reader.position() < element.end &&
+             ReadMkvElement(reader, element.end, &entry)) {
+        uint64_t number = 0, type = 0;
+        MkvElement child;
+        while (entry.id == MKV_ID_TRACK_ENTRY &&
+               reader.position() < entry.end &&
+               ReadMkvElement(reader, entry.end, &child)) {
+          if (child.id == MKV_ID_TRACK_NUMBER) {
+            ReadMkvUInt(reader, child, &number);
+          } else if (child.id == MKV_ID_TRACK_TYPE) {
+            ReadMkvUInt(reader, child, &type);
+          }
+          if (!reader.Seek(child.end)) {
+            return false;
+          }
+        }
+        if (type == 1 && state.video_track == 0) {
+          state.video_track = number;
+        }
+        if (!reader.Seek(entry.end)) {
+          return false;
+        }
+      }
+    } else if (element.id == MKV_ID_CUES) {
+      if (ParseMkvCues(reader, element.end, state) &&
+          !state.cue_times.empty()) {
+        break;
+      }
+      state.cue_times.clear();
+    } else if (element.id == MKV_ID_CLUSTER) {
+      // Cues are usually written after the clusters: jump there first.
+      if (!tried_cues && state.cues > element.data) {
+        tried_cues = true;
+        MkvElement cues;
+        if (reader.Seek(state.cues) && ReadMkvElement(reader, end, &cues) &&
+            cues.id == MKV_ID_CUES && ParseMkvCues(reader, cues.end, state) &&
+            !state.cue_times.empty()) {
+          break;
+        }
+        state.cue_times.clear();
+        if (!reader.Seek(element.data)) {
+          return false;
+        }
+      }
+      next = ScanMkvCluster(reader, element, state);
+      if (next < 0) {
+        break;
+      }
+    }
+    if (!reader.Seek(next)) {
+      break;
+    }
+  }
+  times_.swap(state.cue_times.empty() ? state.block_times : state.cue_times);
+  return true;
+}
+
+void KeyframeIndex::Finish() {
+  std::sort(times_.begin(), times_.end());
+  times_.erase(std::unique(times_.begin(), times_.end()), times_.end());
+  times_.shrink_to_fit();
+}
+
+// Persistence.
+
+namespace {
+
+void WriteVarint(std::string& out, uint64_t value) {
+  while (value >= 0x80) {
+    out.push_back((char)(value | 0x80));
+    value >>= 7;
+  }
+  out.push_back((char)value);
+}
+
+bool ReadVarint(const uint8_t*& p, const uint8_t* end, uint64_t* value) {
+  *value = 0;
+  for (int shift = 0; p < end && shift < 64; shift += 7) {
+    uint8_t byte = *p++;
+    *value |= (uint64_t)(byte & 0x7F) << shift;
+    if (!(byte & 0x80)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Identity of the indexed file: the table is stale once this changes.
+bool GetStamp(const char* path, uint64_t* size, uint64_t* mtime) {
+  struct stat info;
+  if (stat(path, &info) != 0) {
+    return false;
+  }
+  *size = (uint64_t)info.st_size;
+  *mtime = (uint64_t)info.st_mtim.tv_sec * 1000000000ull +
+           (uint64_t)info.st_mtim.tv_nsec;
+  return true;
+}
+
+std::string GetCachePath(const char* cache_dir, const char* path) {
+  // FNV-1a.
+  uint64_t hash = 0xcbf29ce484222325ull;
+  for (const char* p = path; *p != '\0'; p++) {
+    hash = (hash ^ (uint8_t)*p) * 0x100000001b3ull;
+  }
+  char name[32];
+  snprintf(name, sizeof(name), "/%016llx.kfi", (unsigned long long)hash);
+  return std::string(cache_dir) + name;
+}
+
+// mkdir -p.
+bool MakeDirectories(const std::string& path) {
+  for (size_t i = 1; i <= path.size(); i++) {
+    if (i == path.size() || path[i] == '/') {
+      std::string parent = path.substr(0, i);
+      if (mkdir(parent.c_str(), 0755) != 0 && errno != EEXIST) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+bool KeyframeIndex::Load(const char* cache_dir, const char* path) {
+  uint64_t size, mtime;
+  if (cache_dir == nullptr || *cache_dir == '\0' ||
+      !GetStamp(path, &size, &mtime)) {
+    return false;
+  }
+  FILE* file = fopen(GetCachePath(cache_dir, path).c_str(), "rb");
+  if (file == nullptr) {
+    return false;
+  }
+  std::vector<uint8_t> data;
+  uint8_t chunk[64 * 1024];
+  size_t read;
+  while ((read = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+    data.insert(data.end(), chunk, chunk + read);
+  }
+  fclose(file);
+
+  const uint8_t* p = data.data();
+  const uint8_t* end = p + data.size();
+  uint64_t version, stored_size, stored_mtime, path_size, count;
+  if (data.size() < 4 || memcmp(p, KEYFRAME_INDEX_MAGIC, 4) != 0) {
+    return false;
+  }
+  p += 4;
+  if (!ReadVarint(p, end, &version) || version != KEYFRAME_INDEX_VERSION ||
+      !ReadVarint(p, end, &stored_size) || stored_size != size ||
+      !ReadVarint(p, end, &stored_mtime) || stored_mtime != mtime ||
+      !ReadVarint(p, end, &path_size) || path_size > (uint64_t)(end - p) ||
+      path_size != strlen(path) || memcmp(p, path, path_size) != 0) {
+    return false;
+  }
+  p += path_size;
+  if (!ReadVarint(p, end, &count) || count > (uint64_t)(end - p)) {
+    return false;
+  }
+  std::vector<int64_t> times;
+  times.reserve(count);
+  uint64_t time = 0;
+  for (uint64_t i = 0; i < count; i++) {
+    uint64_t delta;
+    if (!ReadVarint(p, end, &delta)) {
+      return false;
+    }
+    time += delta;
+    times.push_back((int64_t)time);
+  }
+  times_.swap(times);
+  return true;
+}
+
+bool KeyframeIndex::Save(const char* cache_dir, const char* path) const {
+  uint64_t size, mtime;
+  if (cache_dir == nullptr || *cache_dir == '\0' ||
+      !GetStamp(path, &size, &mtime) || !MakeDirectories(cache_dir)) {
+    return false;
+  }
+  // Keyframes are typically 0.5 to 10 s apart: 2 to 3 bytes each.
+  std::string out(KEYFRAME_INDEX_MAGIC);
+  WriteVarint(out, KEYFRAME_INDEX_VERSION);
+  WriteVarint(out, size);
+  WriteVarint(out, mtime);
+  WriteVarint(out, strlen(path));
+  out.append(path);
+  WriteVarint(out, times_.size());
+  int64_t previous = 0;
+  for (int64_t time : times_) {
+    WriteVarint(out, (uint64_t)(time - previous));
+    previous = time;
+  }
+  // Written aside & renamed, so concurrent readers never see a partial table.
+  std::string target = GetCachePath(cache_dir, path);
+  std::string temporary = target + "." + std::to_string(getpid()) + ".tmp";
+  FILE* file = fopen(temporary.c_str(), "wb");
+  if (file == nullptr) {
+    return false;
+  }
+  bool result = fwrite(out.data(), 1, out.size(), file) == out.size();
+  result = fclose(file) == 0 && result;
+  if (!result || rename(temporary.c_str(), target.c_str()) != 0) {
+    unlink(temporary.c_str());
+    return false;
+  }
+  return true;
+}
+
+int64_t KeyframeIndex::Snap(int64_t time) const {
+  if (times_.empty()) {
+    return time;
+  }
+  auto it = std::lower_bound(times_.begin(), times_.end(), time);
+  if (it == times_.end()) {
+    return times_.back();
+  }
+  if (it != times_.begin() && time - *(it - 1) <= *it - time) {
+    return *(it - 1);
+  }
+  return *it;
+}
+
+int64_t KeyframeIndex::Floor(int64_t time) const {
+  if (times_.empty()) {
+    return time;
+  }
+  auto it = std::upper_bound(times_.begin(), times_.end(), time);
+  return it == times_.begin() ? *it : *(it - 1);
+}
+
+std::string KeyframeIndex::DefaultCacheDirectory() {
+  const char* cache = getenv("XDG_CACHE_HOME");
+  if (cache != nullptr && *cache == '/') {
+    return std::string(cache) + "/media_kit/keyframes";
+  }
+  const char* home = getenv("HOME");
+  if (home != nullptr && *home == '/') {
+    return std::string(home) + "/.cache/media_kit/keyframes";
+  }
+  return std::string();
+}
+
+// C API.
+
+KeyframeIndex* keyframe_index_load_file(const char* path,
+                                        const char* cache_dir) {
+  std::string directory = cache_dir != nullptr
+                              ? std::string(cache_dir)
+                              : KeyframeIndex::DefaultCacheDirectory();
+  KeyframeIndex* self = new KeyframeIndex();
+  if (self->Load(directory.c_str(), path)) {
+    return self;
+  }
+  if (!self->Scan(path)) {
+    delete self;
+    return nullptr;
+  }
+  if (!self->Save(directory.c_str(), path)) {
+    fprintf(stderr, "media_kit: KeyframeIndex: Unable to persist %s.\n",
+            path);
+  }
+  return self;
+}
+
+void keyframe_index_free(KeyframeIndex* self) {
+  delete self;
+}
+
+int64_t keyframe_index_snap(const KeyframeIndex* self, int64_t time) {
+  return self->Snap(time);
+}
+
+int64_t keyframe_index_floor(const KeyframeIndex* self, int64_t time) {
+  return self->Floor(time);
+}
+
+const int64_t* keyframe_index_get_times(const KeyframeIndex* self) {
+  return self->times();
+}
+
+size_t keyframe_index_get_count(const KeyframeIndex* self) {
+  return self->size();
+}
@@ -12,6 +12,8 @@
 
 #include <gtk/gtk.h>
 
+#include "include/media_kit_video/remote_player_manager.h"
+#include "include/media_kit_video/trace.h"
 #include "include/media_kit_video/utils.h"
 #include "include/media_kit_video/video_output_manager.h"
 
@@ -24,15 +26,110 @@ struct _MediaKitVideoPlugin {
   FlMethodChannel* channel;
   FlView* view;
   VideoOutputManager* video_output_manager;
+  FlMethodChannel* player_host_channel; /* Players in helper processes. */
+  RemotePlayerManager* remote_player_manager;
+  GHashTable* property_requests; /* Unanswered "PlayerHost.GetProperty". */
+  guint32 next_property_request;
 };
 
+// A "PlayerHost.GetProperty" call, answered by PLAYER_HOST_REPLY.
+typedef struct {
+  guint32 player;
+  FlMethodCall* method_call;
+} PropertyRequest;
+
+static void property_request_free(gpointer data) {
+  PropertyRequest* request = (PropertyRequest*)data;
+  g_object_unref(request->method_call);
+  g_free(request);
+}
+
 G_DEFINE_TYPE(MediaKitVideoPlugin, media_kit_video_plugin, g_object_get_type())
 
+// Invokes |method| on the Dart side with |arguments| (ownership is taken).
+// May be called from any thread.
+static void media_kit_video_plugin_invoke_method(FlMethodChannel* channel,
+                                                 const gchar* method,
+                                                 FlValue* arguments) {
+  typedef struct {
+    FlMethodChannel* channel;
+    gchar* method;
+    FlValue* arguments;
+  } IdleCallbackData;
+
+  IdleCallbackData* idle_data = g_new0(IdleCallbackData, 1);
+  idle_data->channel = channel;
+  idle_data->method = g_strdup(method);
+  idle_data->arguments = arguments;
+
+  // `fl_method_channel_invoke_method` should be called from PlatformThread.
+  g_idle_add([](gpointer user_data) -> gboolean {
+    IdleCallbackData* idle_data = (IdleCallbackData*)user_data;
+    fl_method_channel_invoke_method(idle_data->channel, idle_data->method,
+                                    idle_data->arguments, NULL, NULL, NULL);
+    fl_value_unref(idle_data->arguments);
+    g_free(idle_data->method);
+    g_free(idle_data);
+    return G_SOURCE_REMOVE;
+  }, idle_data);
+}
+
+static FlValue* media_kit_video_plugin_memory_usage_to_value(
+    const VideoOutputMemoryUsage* usage) {
+  FlValue* value = fl_value_new_map();
+  fl_value_set_string_take(value, "gpuBufferCount",
+                           fl_value_new_int(usage->gpu_buffer_count));
+  fl_value_set_string_take(value, "gpuBytes",
+                           fl_value_new_int(usage->gpu_bytes));
+  fl_value_set_string_take(value, "cpuPixelBytes",
+                           fl_value_new_int(usage->cpu_pixel_bytes));
+  fl_value_set_string_take(value, "demuxerCacheBytes",
+                           fl_value_new_int(usage->demuxer_cache_bytes));
+  fl_value_set_string_take(value, "hwdecSurfaceBytes",
+                           fl_value_new_int(usage->hwdec_surface_bytes));
+  return value;
+}
+
+static FlValue* media_kit_video_plugin_allocator_stats_to_value(
+    const Allocator::Stats* stats,
+    const Allocator::HeapStats* heap) {
+  FlValue* value = fl_value_new_map();
+  fl_value_set_string_take(
+      value, "allocator",
+      fl_value_new_string(stats->mimalloc ? "mimalloc" : "glibc"));
+  fl_value_set_string_take(value, "currentRss",
+                           fl_value_new_int(stats->current_rss));
+  fl_value_set_string_take(value, "peakRss",
+                           fl_value_new_int(stats->peak_rss));
+  fl_value_set_string_take(value, "currentCommit",
+                           fl_value_new_int(stats->current_commit));
+  fl_value_set_string_take(value, "peakCommit",
+                           fl_value_new_int(stats->peak_commit));
+  fl_value_set_string_take(value, "pageFaults",
+                           fl_value_new_int(stats->page_faults));
+  fl_value_set_string_take(value, "heapAllocated",
+                           fl_value_new_int(stats->heap_allocated));
+  fl_value_set_string_take(value, "heapFree",
+                           fl_value_new_int(stats->heap_free));
+  fl_value_set_string_take(value, "renderHeapReserved",
+                           fl_value_new_int(heap->reserved));
+  fl_value_set_string_take(value, "renderHeapCommitted",
+                           fl_value_new_int(heap->committed));
+  fl_value_set_string_take(value, "renderHeapUsed",
+                           fl_value_new_int(heap->used));
+  fl_value_set_string_take(value, "renderHeapBlocks",
+                           fl_value_new_int(heap->blocks));
+  fl_value_set_string_take(
+      value, "text", fl_value_new_string(Allocator::PrintStats().c_str()));
+  return value;
+}
+
 static void media_kit_video_plugin_handle_method_call(
     MediaKitVideoPlugin* self,
     FlMethodCall* method_call) {
   g_autoptr(FlMethodResponse) response = NULL;
   const gchar* method = fl_method_call_get_name(method_call);
+  TRACE_SCOPE(Trace::IsEnabled() ? Trace::Intern(method) : NULL, -1);
   if (g_strcmp0(method, "VideoOutputManager.Create") == 0) {
     FlValue* arguments = fl_method_call_get_args(method_call);
     FlValue* handle = fl_value_lookup_string(arguments, "handle");
@@ -48,6 +145,14 @@ static void media_kit_video_plugin_handle_method_call(
         fl_value_get_string(fl_value_lookup_string(configuration, "height"));
     const bool configuration_enable_hardware_acceleration = fl_value_get_bool(
         fl_value_lookup_string(configuration, "enableHardwareAcceleration"));
+    FlValue* configuration_enable_subtitle_overlay =
+        fl_value_lookup_string(configuration, "enableSubtitleOverlay");
+    FlValue* configuration_decode_suspension_delay =
+        fl_value_lookup_string(configuration, "decodeSuspensionDelay");
+    FlValue* configuration_low_latency =
+        fl_value_lookup_string(configuration, "lowLatency");
+    FlValue* configuration_hwdec_calibration =
+        fl_value_lookup_string(configuration, "hwdecCalibration");
 
     if (g_strcmp0(configuration_width, "null") != 0) {
       configuration_value.width =
@@ -59,6 +164,22 @@ static void media_kit_video_plugin_handle_method_call(
     }
     configuration_value.enable_hardware_acceleration =
         configuration_enable_hardware_acceleration;
+    configuration_value.enable_subtitle_overlay =
+        configuration_enable_subtitle_overlay != NULL &&
+        fl_value_get_bool(configuration_enable_subtitle_overlay);
+    if (configuration_decode_suspension_delay != NULL &&
+        g_strcmp0(fl_value_get_string(configuration_decode_suspension_delay),
+                  "null") != 0) {
+      configuration_value.decode_suspension_delay = g_ascii_strtoll(
+          fl_value_get_string(configuration_decode_suspension_delay), NULL,
+          10);
+    }
+    configuration_value.low_latency =
+        configuration_low_latency != NULL &&
+        fl_value_get_bool(configuration_low_latency);
+    configuration_value.hwdec_calibration =
+        configuration_hwdec_calibration != NULL &&
+        fl_value_get_bool(configuration_hwdec_calibration);
 
     typedef struct _VideoOutputTextureUpdateCallbackData {
       FlMethodChannel* channel;
@@ -84,26 +205,45 @@ static void media_kit_video_plugin_handle_method_call(
           fl_value_set_string_take(result, "handle", fl_value_new_int(handle));
           fl_value_set_string_take(result, "id", fl_value_new_int(id));
           fl_value_set_string_take(result, "rect", rect);
-          
-          typedef struct {
-            FlMethodChannel* channel;
-            FlValue* result;
-          } IdleCallbackData;
-          
-          IdleCallbackData* idle_data = g_new0(IdleCallbackData, 1);
-          idle_data->channel = channel;
-          idle_data->result = result;
-
-          // `fl_method_channel_invoke_method` should be called from PlatformThread.
-          g_idle_add([](gpointer user_data) -> gboolean {
-            IdleCallbackData* idle_data = (IdleCallbackData*)user_data;
-            fl_method_channel_invoke_method(idle_data->channel, "VideoOutput.Resize", 
-                                          idle_data->result, NULL, NULL, NULL);
-            g_free(idle_data);
-            return G_SOURCE_REMOVE;
-          }, idle_data);
+          media_kit_video_plugin_invoke_method(channel, "VideoOutput.Resize",
+                                               result);
+        },
+        data);
+    video_output_manager_set_suspension_callback(
+        self->video_output_manager, handle_value,
+        [](gboolean suspended, gint64 demuxer_cache_bytes, gpointer context) {
+          auto data = (VideoOutputTextureUpdateCallbackData*)context;
+          FlValue* result = fl_value_new_map();
+          fl_value_set_string_take(result, "handle",
+                                   fl_value_new_int(data->handle));
+          fl_value_set_string_take(result, "suspended",
+                                   fl_value_new_bool(suspended));
+          fl_value_set_string_take(result, "demuxerCacheBytes",
+                                   fl_value_new_int(demuxer_cache_bytes));
+          media_kit_video_plugin_invoke_method(
+              data->channel, "VideoOutput.Suspension", result);
         },
         data);
+    if (configuration_value.enable_subtitle_overlay) {
+      video_output_manager_set_subtitle_overlay_update_callback(
+          self->video_output_manager, handle_value,
+          [](gint64 id, gint64 width, gint64 height, gpointer context) {
+            auto data = (VideoOutputTextureUpdateCallbackData*)context;
+            FlValue* rect = fl_value_new_map();
+            fl_value_set_string_take(rect, "left", fl_value_new_int(0));
+            fl_value_set_string_take(rect, "top", fl_value_new_int(0));
+            fl_value_set_string_take(rect, "width", fl_value_new_int(width));
+            fl_value_set_string_take(rect, "height", fl_value_new_int(height));
+            FlValue* result = fl_value_new_map();
+            fl_value_set_string_take(result, "handle",
+                                     fl_value_new_int(data->handle));
+            fl_value_set_string_take(result, "id", fl_value_new_int(id));
+            fl_value_set_string_take(result, "rect", rect);
+            media_kit_video_plugin_invoke_method(
+                data->channel, "VideoOutput.SubtitleOverlay", result);
+          },
+          data);
+    }
     FlValue* result = fl_value_new_null();
     response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
   } else if (g_strcmp0(method, "VideoOutputManager.SetSize") == 0) {
@@ -133,6 +273,206 @@ static void media_kit_video_plugin_handle_method_call(
     video_output_manager_dispose(self->video_output_manager, handle_value);
     FlValue* result = fl_value_new_null();
     response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  } else if (g_strcmp0(method, "VideoOutputManager.GetMemoryUsage") == 0) {
+    // Usage of a single output, or of all outputs if "handle" is null.
+    FlValue* arguments = fl_method_call_get_args(method_call);
+    FlValue* handle = fl_value_lookup_string(arguments, "handle");
+    gint64 handle_value = 0;
+    if (handle != NULL && fl_value_get_type(handle) == FL_VALUE_TYPE_STRING) {
+      handle_value = g_ascii_strtoll(fl_value_get_string(handle), NULL, 10);
+    }
+    VideoOutputMemoryUsage usage;
+    FlValue* result = fl_value_new_null();
+    if (video_output_manager_get_memory_usage(self->video_output_manager,
+                                              handle_value, &usage)) {
+      fl_value_unref(result);
+      result = media_kit_video_plugin_memory_usage_to_value(&usage);
+    }
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  } else if (g_strcmp0(method, "VideoOutputManager.SetMemoryLimit") == 0) {
+    // Limit of a single output, or the shared limit if "handle" is null.
+    FlValue* arguments = fl_method_call_get_args(method_call);
+    FlValue* handle = fl_value_lookup_string(arguments, "handle");
+    FlValue* bytes = fl_value_lookup_string(arguments, "bytes");
+    gint64 bytes_value = 0;
+    if (g_strcmp0(fl_value_get_string(bytes), "null") != 0) {
+      bytes_value = g_ascii_strtoll(fl_value_get_string(bytes), NULL, 10);
+    }
+    if (handle != NULL && fl_value_get_type(handle) == FL_VALUE_TYPE_STRING) {
+      gint64 handle_value =
+          g_ascii_strtoll(fl_value_get_string(handle), NULL, 10);
+      video_output_manager_set_memory_limit(self->video_output_manager,
+                                            handle_value, bytes_value);
+    } else {
+      video_output_manager_set_total_memory_limit(self->video_output_manager,
+                                                  bytes_value);
+    }
+    FlValue* result = fl_value_new_null();
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  } else if (g_strcmp0(method, "VideoOutputManager.Suspend") == 0) {
+    FlValue* arguments = fl_method_call_get_args(method_call);
+    FlValue* handle = fl_value_lookup_string(arguments, "handle");
+    FlValue* demuxer_cache_bytes =
+        fl_value_lookup_string(arguments, "demuxerCacheBytes");
+    gint64 handle_value =
+        g_ascii_strtoll(fl_value_get_string(handle), NULL, 10);
+    gint64 demuxer_cache_bytes_value = -1;
+    if (g_strcmp0(fl_value_get_string(demuxer_cache_bytes), "null") != 0) {
+      demuxer_cache_bytes_value =
+          g_ascii_strtoll(fl_value_get_string(demuxer_cache_bytes), NULL, 10);
+    }
+    video_output_manager_suspend(self->video_output_manager, handle_value,
+                                 demuxer_cache_bytes_value);
+    FlValue* result = fl_value_new_null();
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  } else if (g_strcmp0(method, "VideoOutputManager.Resume") == 0) {
+    FlValue* arguments = fl_method_call_get_args(method_call);
+    FlValue* handle = fl_value_lookup_string(arguments, "handle");
+    gint64 handle_value =
+        g_ascii_strtoll(fl_value_get_string(handle), NULL, 10);
+    video_output_manager_resume(self->video_output_manager, handle_value);
+    FlValue* result = fl_value_new_null();
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  } else if (g_strcmp0(method, "VideoOutputManager.SetVisibility") == 0) {
+    FlValue* arguments = fl_method_call_get_args(method_call);
+    FlValue* handle = fl_value_lookup_string(arguments, "handle");
+    FlValue* visibility = fl_value_lookup_string(arguments, "visibility");
+    gint64 handle_value =
+        g_ascii_strtoll(fl_value_get_string(handle), NULL, 10);
+    VideoOutputVisibility visibility_value = VIDEO_OUTPUT_VISIBILITY_VISIBLE;
+    if (g_strcmp0(fl_value_get_string(visibility), "occluded") == 0) {
+      visibility_value = VIDEO_OUTPUT_VISIBILITY_OCCLUDED;
+    } else if (g_strcmp0(fl_value_get_string(visibility), "offscreen") == 0) {
+      visibility_value = VIDEO_OUTPUT_VISIBILITY_OFFSCREEN;
+    }
+    video_output_manager_set_visibility(self->video_output_manager,
+                                        handle_value, visibility_value);
+    FlValue* result = fl_value_new_null();
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  } else if (g_strcmp0(method, "VideoOutputManager.Preview") == 0 ||
+             g_strcmp0(method, "VideoOutputManager.EndPreview") == 0) {
+    FlValue* arguments = fl_method_call_get_args(method_call);
+    FlValue* handle = fl_value_lookup_string(arguments, "handle");
+    FlValue* position = fl_value_lookup_string(arguments, "position");
+    gint64 handle_value =
+        g_ascii_strtoll(fl_value_get_string(handle), NULL, 10);
+    gdouble position_value =
+        g_ascii_strtod(fl_value_get_string(position), NULL);
+    FlValue* result = NULL;
+    if (g_strcmp0(method, "VideoOutputManager.Preview") == 0) {
+      result = fl_value_new_bool(video_output_manager_preview(
+          self->video_output_manager, handle_value, position_value));
+    } else {
+      video_output_manager_end_preview(self->video_output_manager,
+                                       handle_value, position_value);
+      result = fl_value_new_null();
+    }
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  } else if (g_strcmp0(method, "VideoOutputManager.CreateFrameTap") == 0) {
+    // Returns the address of the tap, for `dart:ffi`.
+    FlValue* arguments = fl_method_call_get_args(method_call);
+    const gchar* values[] = {"format", "width", "height", "rate",
+                             "bufferCount"};
+    gdouble parsed[G_N_ELEMENTS(values)];
+    for (gsize i = 0; i < G_N_ELEMENTS(values); i++) {
+      parsed[i] = g_ascii_strtod(
+          fl_value_get_string(fl_value_lookup_string(arguments, values[i])),
+          NULL);
+    }
+    gint64 handle_value = g_ascii_strtoll(
+        fl_value_get_string(fl_value_lookup_string(arguments, "handle")), NULL,
+        10);
+    FrameTap* tap = video_output_manager_create_frame_tap(
+        self->video_output_manager, handle_value, (FrameTapFormat)parsed[0],
+        (gint32)parsed[1], (gint32)parsed[2], parsed[3], (gint32)parsed[4]);
+    FlValue* result = tap != NULL ? fl_value_new_int((gint64)(intptr_t)tap)
+                                  : fl_value_new_null();
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  } else if (g_strcmp0(method, "VideoOutputManager.DisposeFrameTap") == 0) {
+    FlValue* arguments = fl_method_call_get_args(method_call);
+    FlValue* handle = fl_value_lookup_string(arguments, "handle");
+    gint64 handle_value =
+        g_ascii_strtoll(fl_value_get_string(handle), NULL, 10);
+    video_output_manager_dispose_frame_tap(self->video_output_manager,
+                                           handle_value);
+    FlValue* result = fl_value_new_null();
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  } else if (g_strcmp0(method, "VideoOutputManager.SetAdaptiveResolution") ==
+             0) {
+    FlValue* arguments = fl_method_call_get_args(method_call);
+    FlValue* enabled = fl_value_lookup_string(arguments, "enabled");
+    video_output_manager_set_adaptive_resolution(self->video_output_manager,
+                                                 fl_value_get_bool(enabled));
+    FlValue* result = fl_value_new_null();
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  } else if (g_strcmp0(method, "VideoOutputManager.SetPriority") == 0) {
+    FlValue* arguments = fl_method_call_get_args(method_call);
+    FlValue* handle = fl_value_lookup_string(arguments, "handle");
+    FlValue* priority = fl_value_lookup_string(arguments, "priority");
+    gint64 handle_value =
+        g_ascii_strtoll(fl_value_get_string(handle), NULL, 10);
+    gint64 priority_value =
+        g_ascii_strtoll(fl_value_get_string(priority), NULL, 10);
+    video_output_manager_set_priority(self->video_output_manager, handle_value,
+                                      (gint)priority_value);
+    FlValue* result = fl_value_new_null();
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  } else if (g_strcmp0(method, "VideoOutputManager.SetAutoSuspend") == 0) {
+    FlValue* arguments = fl_method_call_get_args(method_call);
+    FlValue* enabled = fl_value_lookup_string(arguments, "enabled");
+    FlValue* demuxer_cache_bytes =
+        fl_value_lookup_string(arguments, "demuxerCacheBytes");
+    gint64 demuxer_cache_bytes_value = -1;
+    if (g_strcmp0(fl_value_get_string(demuxer_cache_bytes), "null") != 0) {
+      demuxer_cache_bytes_value =
+          g_ascii_strtoll(fl_value_get_string(demuxer_cache_bytes), NULL, 10);
+    }
+    video_output_manager_set_auto_suspend(self->video_output_manager,
+                                          fl_value_get_bool(enabled),
+                                          demuxer_cache_bytes_value);
+    FlValue* result = fl_value_new_null();
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  } else if (g_strcmp0(method, "VideoOutputManager.NotifyMemoryPressure") ==
+             0) {
+    FlValue* arguments = fl_method_call_get_args(method_call);
+    FlValue* level = fl_value_lookup_string(arguments, "level");
+    video_output_manager_notify_memory_pressure(self->video_output_manager,
+                                                fl_value_get_int(level));
+    FlValue* result = fl_value_new_null();
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  } else if (g_strcmp0(method, "VideoOutputManager.GetAllocatorStats") == 0) {
+    Allocator::Stats stats;
+    Allocator::HeapStats heap;
+    video_output_manager_get_allocator_stats(self->video_output_manager,
+                                             &stats, &heap);
+    FlValue* result =
+        media_kit_video_plugin_allocator_stats_to_value(&stats, &heap);
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  } else if (g_strcmp0(method, "VideoOutputManager.SetTraceEnabled") == 0) {
+    FlValue* arguments = fl_method_call_get_args(method_call);
+    FlValue* enabled = fl_value_lookup_string(arguments, "enabled");
+    Trace::SetEnabled(fl_value_get_bool(enabled));
+    FlValue* result = fl_value_new_null();
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  } else if (g_strcmp0(method, "VideoOutputManager.DumpTrace") == 0) {
+    // Returns the trace as Chrome JSON, or writes it to |path| if specified.
+    FlValue* arguments = fl_method_call_get_args(method_call);
+    FlValue* path = fl_value_lookup_string(arguments, "path");
+    std::string trace = Trace::DumpChromeJson();
+    if (path != NULL && fl_value_get_type(path) == FL_VALUE_TYPE_STRING) {
+      g_autoptr(GError) error = NULL;
+      if (g_file_set_contents(fl_value_get_string(path), trace.c_str(),
+                              trace.size(), &error)) {
+        FlValue* result = fl_value_new_string(fl_value_get_string(path));
+        response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+      } else {
+        response = FL_METHOD_RESPONSE(fl_method_error_response_new(
+            "IOError", error->message, NULL));
+      }
+    } else {
+      FlValue* result = fl_value_new_string(trace.c_str());
+      response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+    }
 
   } else if (g_strcmp0(method, "Utils.EnterNativeFullscreen") == 0) {
     utils_enter_native_fullscreen(
@@ -150,6 +490,206 @@ static void media_kit_video_plugin_handle_method_call(
   fl_method_call_respond(method_call, response, nullptr);
 }
 
+static void media_kit_video_plugin_respond_property_request(
+    MediaKitVideoPlugin* self,
+    guint32 request_id,
+    FlValue* result) {
+  PropertyRequest* request = (PropertyRequest*)g_hash_table_lookup(
+      self->property_requests, GUINT_TO_POINTER(request_id));
+  if (request == NULL) {
+    fl_value_unref(result);
+    return;
+  }
+  g_autoptr(FlMethodResponse) response =
+      FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  fl_value_unref(result);
+  fl_method_call_respond(request->method_call, response, nullptr);
+  g_hash_table_remove(self->property_requests, GUINT_TO_POINTER(request_id));
+}
+
+// Forwards the messages of a remote player to the Dart side.
+static void media_kit_video_plugin_on_remote_player_message(
+    guint32 id,
+    const PlayerHostMessage* message,
+    gpointer context) {
+  MediaKitVideoPlugin* self = MEDIA_KIT_VIDEO_PLUGIN(context);
+  const std::vector<int64_t>& integers = message->integers;
+  const std::vector<std::string>& strings = message->strings;
+  const gchar* method = NULL;
+  FlValue* arguments = fl_value_new_map();
+  fl_value_set_string_take(arguments, "id", fl_value_new_int(id));
+  switch (message->type) {
+    case PLAYER_HOST_BUFFERS: {
+      method = "PlayerHost.Resize";
+      fl_value_set_string_take(
+          arguments, "textureId",
+          fl_value_new_int(remote_player_manager_get_texture_id(
+              self->remote_player_manager, id)));
+      fl_value_set_string_take(arguments, "width",
+                               fl_value_new_int(integers[1]));
+      fl_value_set_string_take(arguments, "height",
+                               fl_value_new_int(integers[2]));
+      break;
+    }
+    case PLAYER_HOST_REPLY: {
+      if (integers.size() == 2 && strings.size() == 1) {
+        media_kit_video_plugin_respond_property_request(
+            self, (guint32)integers[0],
+            integers[1] >= 0 ? fl_value_new_string(strings[0].c_str())
+                             : fl_value_new_null());
+      }
+      break;
+    }
+    case PLAYER_HOST_PROPERTY_CHANGE: {
+      if (strings.size() == 2) {
+        method = "PlayerHost.PropertyChange";
+        fl_value_set_string_take(arguments, "name",
+                                 fl_value_new_string(strings[0].c_str()));
+        fl_value_set_string_take(arguments, "value",
+                                 fl_value_new_string(strings[1].c_str()));
+      }
+      break;
+    }
+    case PLAYER_HOST_EVENT: {
+      if (strings.size() == 1) {
+        method = "PlayerHost.Event";
+        fl_value_set_string_take(arguments, "name",
+                                 fl_value_new_string(strings[0].c_str()));
+      }
+      break;
+    }
+    case PLAYER_HOST_EXIT: {
+      method = "PlayerHost.Exit";
+      fl_value_set_string_take(
+          arguments, "status",
+          fl_value_new_int(integers.empty() ? -1 : integers[0]));
+      // Never answered by the host now.
+      GList* requests = g_hash_table_get_keys(self->property_requests);
+      for (GList* it = requests; it != NULL; it = it->next) {
+        PropertyRequest* request =
+            (PropertyRequest*)g_hash_table_lookup(self->property_requests,
+                                                  it->data);
+        if (request->player == id) {
+          media_kit_video_plugin_respond_property_request(
+              self, GPOINTER_TO_UINT(it->data), fl_value_new_null());
+        }
+      }
+      g_list_free(requests);
+      break;
+    }
+    default:
+      break;
+  }
+  if (method != NULL) {
+    fl_method_channel_invoke_method(self->player_host_channel, method,
+                                    arguments, NULL, NULL, NULL);
+  }
+  fl_value_unref(arguments);
+}
+
+static void media_kit_video_plugin_handle_player_host_method_call(
+    MediaKitVideoPlugin* self,
+    FlMethodCall* method_call) {
+  g_autoptr(FlMethodResponse) response = NULL;
+  const gchar* method = fl_method_call_get_name(method_call);
+  FlValue* arguments = fl_method_call_get_args(method_call);
+  guint32 id_value = 0;
+  FlValue* id = fl_value_get_type(arguments) == FL_VALUE_TYPE_MAP
+                    ? fl_value_lookup_string(arguments, "id")
+                    : NULL;
+  if (id != NULL && fl_value_get_type(id) == FL_VALUE_TYPE_STRING) {
+    id_value = (guint32)g_ascii_strtoull(fl_value_get_string(id), NULL, 10);
+  }
+  PlayerHostMessage message;
+  if (g_strcmp0(method, "PlayerHost.Create") == 0) {
+    FlValue* players_per_host =
+        fl_value_lookup_string(arguments, "playersPerHost");
+    gint64 players_per_host_value =
+        g_ascii_strtoll(fl_value_get_string(players_per_host), NULL, 10);
+    guint32 created = remote_player_manager_create(
+        self->remote_player_manager, (gint32)players_per_host_value);
+    FlValue* result = fl_value_new_null();
+    if (created != 0) {
+      fl_value_unref(result);
+      result = fl_value_new_map();
+      fl_value_set_string_take(result, "id", fl_value_new_int(created));
+      fl_value_set_string_take(
+          result, "textureId",
+          fl_value_new_int(remote_player_manager_get_texture_id(
+              self->remote_player_manager, created)));
+    }
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+    fl_value_unref(result);
+  } else if (g_strcmp0(method, "PlayerHost.Command") == 0) {
+    FlValue* command = fl_value_lookup_string(arguments, "arguments");
+    message.type = PLAYER_HOST_COMMAND;
+    for (size_t i = 0; i < fl_value_get_length(command); i++) {
+      message.strings.push_back(
+          fl_value_get_string(fl_value_get_list_value(command, i)));
+    }
+  } else if (g_strcmp0(method, "PlayerHost.SetProperty") == 0) {
+    message.type = PLAYER_HOST_SET_PROPERTY;
+    message.strings = {
+        fl_value_get_string(fl_value_lookup_string(arguments, "name")),
+        fl_value_get_string(fl_value_lookup_string(arguments, "value")),
+    };
+  } else if (g_strcmp0(method, "PlayerHost.ObserveProperty") == 0) {
+    message.type = PLAYER_HOST_OBSERVE_PROPERTY;
+    message.strings = {
+        fl_value_get_string(fl_value_lookup_string(arguments, "name")),
+    };
+  } else if (g_strcmp0(method, "PlayerHost.SetSize") == 0) {
+    FlValue* width = fl_value_lookup_string(arguments, "width");
+    FlValue* height = fl_value_lookup_string(arguments, "height");
+    gint64 width_value = 0;
+    gint64 height_value = 0;
+    if (g_strcmp0(fl_value_get_string(width), "null") != 0) {
+      width_value = g_ascii_strtoll(fl_value_get_string(width), NULL, 10);
+    }
+    if (g_strcmp0(fl_value_get_string(height), "null") != 0) {
+      height_value = g_ascii_strtoll(fl_value_get_string(height), NULL, 10);
+    }
+    message.type = PLAYER_HOST_SET_SIZE;
+    message.integers = {width_value, height_value};
+  } else if (g_strcmp0(method, "PlayerHost.GetProperty") == 0) {
+    // Answered once the host replies, see
+    // |media_kit_video_plugin_on_remote_player_message|.
+    guint32 request_id = ++self->next_property_request;
+    message.type = PLAYER_HOST_GET_PROPERTY;
+    message.integers = {request_id};
+    message.strings = {
+        fl_value_get_string(fl_value_lookup_string(arguments, "name")),
+    };
+    if (remote_player_manager_send(self->remote_player_manager, id_value,
+                                   std::move(message))) {
+      PropertyRequest* request = g_new0(PropertyRequest, 1);
+      request->player = id_value;
+      request->method_call = FL_METHOD_CALL(g_object_ref(method_call));
+      g_hash_table_insert(self->property_requests,
+                          GUINT_TO_POINTER(request_id), request);
+      return;
+    }
+    FlValue* result = fl_value_new_null();
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+    fl_value_unref(result);
+  } else if (g_strcmp0(method, "PlayerHost.Dispose") == 0) {
+    remote_player_manager_dispose(self->remote_player_manager, id_value);
+    FlValue* result = fl_value_new_null();
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+    fl_value_unref(result);
+  } else {
+    response = FL_METHOD_RESPONSE(fl_method_not_implemented_response_new());
+  }
+  if (response == NULL) {
+    // Whether the player is still there to receive |message|.
+    FlValue* result = fl_value_new_bool(remote_player_manager_send(
+        self->remote_player_manager, id_value, std::move(message)));
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+    fl_value_unref(result);
+  }
+  fl_method_call_respond(method_call, response, nullptr);
+}
+
 static void media_kit_video_plugin_dispose(GObject* object) {
   G_OBJECT_CLASS(media_kit_video_plugin_parent_class)->dispose(object);
 }
@@ -161,6 +701,11 @@ static void media_kit_video_plugin_class_init(MediaKitVideoPluginClass* klass) {
 static void media_kit_video_plugin_init(MediaKitVideoPlugin* self) {
   self->channel = NULL;
   self->video_output_manager = NULL;
+  self->player_host_channel = NULL;
+  self->remote_player_manager = NULL;
+  self->property_requests = g_hash_table_new_full(
+      g_direct_hash, g_direct_equal, NULL, property_request_free);
+  self->next_property_request = 0;
 }
 
 static void method_call_cb(FlMethodChannel* channel,
@@ -170,6 +715,13 @@ static void method_call_cb(FlMethodChannel* channel,
   media_kit_video_plugin_handle_method_call(plugin, method_call);
 }
 
+static void player_host_method_call_cb(FlMethodChannel* channel,
+                                       FlMethodCall* method_call,
+                                       gpointer user_data) {
+  MediaKitVideoPlugin* plugin = MEDIA_KIT_VIDEO_PLUGIN(user_data);
+  media_kit_video_plugin_handle_player_host_method_call(plugin, method_call);
+}
+
 static MediaKitVideoPlugin* media_kit_video_plugin_new(
     FlPluginRegistrar* registrar) {
   MediaKitVideoPlugin* self = MEDIA_KIT_VIDEO_PLUGIN(
@@ -187,6 +739,15 @@ static MediaKitVideoPlugin* media_kit_video_plugin_new(
   self->view = view;
   self->video_output_manager =
       video_output_manager_new(texture_registrar, view);
+  self->player_host_channel = fl_method_channel_new(
+      fl_plugin_registrar_get_messenger(registrar),
+      "com.alexmercerind/media_kit_video/player_host", codec);
+  fl_method_channel_set_method_call_handler(
+      self->player_host_channel, player_host_method_call_cb,
+      g_object_ref(self), g_object_unref);
+  self->remote_player_manager = remote_player_manager_new(
+      texture_registrar, media_kit_video_plugin_on_remote_player_message,
+      self);
   return self;
 }
 
@@ -0,0 +1,162 @@
+// This file is a part of media_kit
+// (https://github.com/media-kit/media-kit).
+//
+// Copyright © 2026 & onwards, Predidit.
+// All rights reserved.
+// Use of this source code is governed by MIT license that can be found in the
+// LICENSE file.
+
+#include "include/media_kit_video/memory_pressure_monitor.h"
+
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <gio/gio.h>
+#include <glib-unix.h>
+
+// PSI triggers: stall time (us) within a window (us). Unprivileged processes
+// may only use windows that are a multiple of 2 seconds.
+#define PSI_MEDIUM_TRIGGER "some 150000 2000000"
+#define PSI_CRITICAL_TRIGGER "full 100000 2000000"
+
+typedef struct {
+  gint fd;
+  guint source_id;
+  MemoryPressureLevel level;
+} PsiTrigger;
+
+struct _MemoryPressureMonitor {
+  GObject parent_instance;
+  MemoryPressureCallback callback;
+  gpointer callback_context;
+  GObject* memory_monitor; /* |GMemoryMonitor|, if available. */
+  gulong memory_monitor_handler_id;
+  PsiTrigger psi_triggers[2];
+};
+
+G_DEFINE_TYPE(MemoryPressureMonitor, memory_pressure_monitor, G_TYPE_OBJECT)
+
+static void memory_pressure_monitor_init(MemoryPressureMonitor* self) {
+  self->callback = NULL;
+  self->callback_context = NULL;
+  self->memory_monitor = NULL;
+  self->memory_monitor_handler_id = 0;
+  for (PsiTrigger& trigger : self->psi_triggers) {
+    trigger.fd = -1;
+    trigger.source_id = 0;
+    trigger.level = MEMORY_PRESSURE_LEVEL_MEDIUM;
+  }
+}
+
+static void memory_pressure_monitor_dispose(GObject* object) {
+  MemoryPressureMonitor* self = MEMORY_PRESSURE_MONITOR(object);
+  if (self->memory_monitor != NULL) {
+    g_signal_handler_disconnect(self->memory_monitor,
+                                self->memory_monitor_handler_id);
+    g_clear_object(&self->memory_monitor);
+  }
+  for (PsiTrigger& trigger : self->psi_triggers) {
+    if (trigger.source_id != 0) {
+      g_source_remove(trigger.source_id);
+      trigger.source_id = 0;
+    }
+    if (trigger.fd >= 0) {
+      close(trigger.fd);
+      trigger.fd = -1;
+    }
+  }
+  G_OBJECT_CLASS(memory_pressure_monitor_parent_class)->dispose(object);
+}
+
+static void memory_pressure_monitor_class_init(
+    MemoryPressureMonitorClass* klass) {
+  G_OBJECT_CLASS(klass)->dispose = memory_pressure_monitor_dispose;
+}
+
+#if GLIB_CHECK_VERSION(2, 64, 0)
+static void memory_pressure_monitor_on_low_memory_warning(
+    GMemoryMonitor* memory_monitor,
+    GMemoryMonitorWarningLevel warning_level,
+    gpointer data) {
+  MemoryPressureMonitor* self = MEMORY_PRESSURE_MONITOR(data);
+  MemoryPressureLevel level = MEMORY_PRESSURE_LEVEL_LOW;
+  if (warning_level >= G_MEMORY_MONITOR_WARNING_LEVEL_CRITICAL) {
+    level = MEMORY_PRESSURE_LEVEL_CRITICAL;
+  } else if (warning_level >= G_MEMORY_MONITOR_WARNING_LEVEL_MEDIUM) {
+    level = MEMORY_PRESSURE_LEVEL_MEDIUM;
+  }
+  memory_pressure_monitor_notify(self, level);
+}
+#endif
+
+static gboolean memory_pressure_monitor_on_psi_event(gint fd,
+                                                     GIOCondition condition,
+                                                     gpointer data) {
+  MemoryPressureMonitor* self = MEMORY_PRESSURE_MONITOR(data);
+  for (PsiTrigger& trigger : self->psi_triggers) {
+    if (trigger.fd != fd) {
+      continue;
+    }
+    if (condition & (G_IO_ERR | G_IO_HUP | G_IO_NVAL)) {
+      // Trigger is gone e.g. cgroup was removed.
+      trigger.source_id = 0;
+      return G_SOURCE_REMOVE;
+    }
+    memory_pressure_monitor_notify(self, trigger.level);
+  }
+  return G_SOURCE_CONTINUE;
+}
+
+static void memory_pressure_monitor_add_psi_trigger(
+    MemoryPressureMonitor* self,
+    PsiTrigger* trigger,
+    const gchar* definition,
+    MemoryPressureLevel level) {
+  gint fd = open("/proc/pressure/memory", O_RDWR | O_NONBLOCK | O_CLOEXEC);
+  if (fd < 0) {
+    return;
+  }
+  // The kernel expects the terminating NUL to be written.
+  if (write(fd, definition, strlen(definition) + 1) < 0) {
+    close(fd);
+    return;
+  }
+  trigger->fd = fd;
+  trigger->level = level;
+  trigger->source_id = g_unix_fd_add(
+      fd, (GIOCondition)(G_IO_PRI | G_IO_ERR),
+      memory_pressure_monitor_on_psi_event, self);
+}
+
+MemoryPressureMonitor* memory_pressure_monitor_new(
+    MemoryPressureCallback callback,
+    gpointer callback_context) {
+  MemoryPressureMonitor* self = MEMORY_PRESSURE_MONITOR(
+      g_object_new(memory_pressure_monitor_get_type(), NULL));
+  self->callback = callback;
+  self->callback_context = callback_context;
+#if GLIB_CHECK_VERSION(2, 64, 0)
+  GMemoryMonitor* memory_monitor = g_memory_monitor_dup_default();
+  if (memory_monitor != NULL) {
+    self->memory_monitor = G_OBJECT(memory_monitor);
+    self->memory_monitor_handler_id = g_signal_connect(
+        memory_monitor, "low-memory-warning",
+        G_CALLBACK(memory_pressure_monitor_on_low_memory_warning), self);
+  }
+#endif
+  memory_pressure_monitor_add_psi_trigger(self, &self->psi_triggers[0],
+                                          PSI_MEDIUM_TRIGGER,
+                                          MEMORY_PRESSURE_LEVEL_MEDIUM);
+  memory_pressure_monitor_add_psi_trigger(self, &self->psi_triggers[1],
+                                          PSI_CRITICAL_TRIGGER,
+                                          MEMORY_PRESSURE_LEVEL_CRITICAL);
+  return self;
+}
+
+void memory_pressure_monitor_notify(MemoryPressureMonitor* self,
+                                    MemoryPressureLevel level) {
+  if (self->callback != NULL) {
+    self->callback(level, self->callback_context);
+  }
+}
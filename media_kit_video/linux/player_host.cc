@@ -0,0 +1,278 @@
+// This file is a part of media_kit
+// (https://github.com/media-kit/media-kit).
+//
+// Copyright © 2026 & onwards, Predidit.
+// All rights reserved.
+// Use of this source code is governed by MIT license that can be found in the
+// LICENSE file.
+
+#include "include/media_kit_video/player_host.h"
+
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+
+extern char** environ;
+
+namespace {
+
+// Any symbol of the plugin's shared library, for |dladdr|.
+void Anchor() {}
+
+}  // namespace
+
+PlayerHostPool::Host::~Host() {
+  if (socket >= 0) {
+    close(socket);
+  }
+}
+
+PlayerHostPool::PlayerHostPool(std::string path, int32_t players_per_host)
+    : path_(std::move(path)),
+      players_per_host_(std::max(players_per_host, 1)) {}
+
+PlayerHostPool::~PlayerHostPool() {
+  std::vector<std::shared_ptr<Host>> hosts;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    hosts.swap(hosts_);
+    players_.clear();
+    // Tearing down the players is pointless with the application exiting,
+    // & must not hang it.
+    for (const std::shared_ptr<Host>& host : hosts) {
+      if (!host->exited) {
+        kill(host->pid, SIGKILL);
+      }
+    }
+  }
+  for (const std::shared_ptr<Host>& host : hosts) {
+    {
+      std::lock_guard<std::mutex> lock(host->callback_mutex);
+      host->players.clear();
+    }
+    Stop(host);
+  }
+}
+
+void PlayerHostPool::SetPlayersPerHost(int32_t players_per_host) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  players_per_host_ = std::max(players_per_host, 1);
+}
+
+uint32_t PlayerHostPool::Create(Callback callback) {
+  std::shared_ptr<Host> host;
+  std::vector<std::shared_ptr<Host>> exited;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::map<Host*, int32_t> counts;
+    for (const auto& [id, player_host] : players_) {
+      counts[player_host.get()]++;
+    }
+    for (auto it = hosts_.begin(); it != hosts_.end();) {
+      if ((*it)->exited) {
+        exited.push_back(*it);
+        it = hosts_.erase(it);
+        continue;
+      }
+      if (host == nullptr && counts[it->get()] < players_per_host_) {
+        host = *it;
+      }
+      ++it;
+    }
+  }
+  for (const std::shared_ptr<Host>& exited_host : exited) {
+    Stop(exited_host);
+  }
+  if (host == nullptr) {
+    host = Spawn();
+    if (host == nullptr) {
+      return 0;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    hosts_.push_back(host);
+  }
+
+  uint32_t id = 0;
+  {
+    // Registered atomically w.r.t. |Read| observing the exit of |host|: the
+    // player either fails here or gets PLAYER_HOST_EXIT.
+    std::lock_guard<std::mutex> callback_lock(host->callback_mutex);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (host->exited) {
+      return 0;
+    }
+    id = next_id_++;
+    players_[id] = host;
+    host->players[id] = std::move(callback);
+  }
+  PlayerHostMessage message;
+  message.type = PLAYER_HOST_CREATE;
+  message.player = id;
+  PlayerHostProtocol::Send(host->socket, message);
+  return id;
+}
+
+bool PlayerHostPool::Send(uint32_t player, PlayerHostMessage message) {
+  std::shared_ptr<Host> host = Find(player);
+  if (host == nullptr) {
+    return false;
+  }
+  message.player = player;
+  return PlayerHostProtocol::Send(host->socket, message);
+}
+
+void PlayerHostPool::Destroy(uint32_t player) {
+  std::shared_ptr<Host> host;
+  bool empty = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = players_.find(player);
+    if (it == players_.end()) {
+      return;
+    }
+    host = it->second;
+    players_.erase(it);
+    empty = std::none_of(players_.begin(), players_.end(),
+                         [&](const auto& entry) { return entry.second == host; });
+    if (empty) {
+      hosts_.erase(std::remove(hosts_.begin(), hosts_.end(), host),
+                   hosts_.end());
+    }
+  }
+  {
+    std::lock_guard<std::mutex> lock(host->callback_mutex);
+    host->players.erase(player);
+  }
+  if (empty) {
+    // The process exits once its socket is closed, destroying its players.
+    Stop(host);
+    return;
+  }
+  PlayerHostMessage message;
+  message.type = PLAYER_HOST_DESTROY;
+  message.player = player;
+  PlayerHostProtocol::Send(host->socket, message);
+}
+
+pid_t PlayerHostPool::GetProcessId(uint32_t player) {
+  std::shared_ptr<Host> host = Find(player);
+  return host != nullptr ? host->pid : 0;
+}
+
+size_t PlayerHostPool::GetHostCount() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return std::count_if(
+      hosts_.begin(), hosts_.end(),
+      [](const std::shared_ptr<Host>& host) { return !host->exited; });
+}
+
+std::string PlayerHostPool::DefaultPath() {
+  const char* path = getenv("MEDIA_KIT_VIDEO_PLAYER_HOST");
+  if (path != nullptr && path[0] != '\0') {
+    return path;
+  }
+  Dl_info info = {};
+  if (dladdr((void*)&Anchor, &info) == 0 || info.dli_fname == nullptr) {
+    return "media_kit_video_player_host";
+  }
+  std::string library = info.dli_fname;
+  size_t separator = library.rfind('/');
+  if (separator == std::string::npos) {
+    return "media_kit_video_player_host";
+  }
+  return library.substr(0, separator + 1) + "media_kit_video_player_host";
+}
+
+std::shared_ptr<PlayerHostPool::Host> PlayerHostPool::Spawn() {
+  int fds[2];
+  if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, fds) != 0) {
+    return nullptr;
+  }
+  int child_socket = fds[1];
+  // dup2 onto itself would keep FD_CLOEXEC.
+  if (child_socket == PlayerHostProtocol::kHostSocket) {
+    child_socket =
+        fcntl(fds[1], F_DUPFD_CLOEXEC, PlayerHostProtocol::kHostSocket + 1);
+    close(fds[1]);
+  }
+  pid_t pid = 0;
+  int result = -1;
+  posix_spawn_file_actions_t actions;
+  if (child_socket >= 0 && posix_spawn_file_actions_init(&actions) == 0) {
+    posix_spawn_file_actions_adddup2(&actions, child_socket,
+                                     PlayerHostProtocol::kHostSocket);
+    char* argv[] = {(char*)path_.c_str(), NULL};
+    result = posix_spawn(&pid, path_.c_str(), &actions, NULL, argv, environ);
+    posix_spawn_file_actions_destroy(&actions);
+  }
+  if (child_socket >= 0) {
+    close(child_socket);
+  }
+  if (result != 0) {
+    fprintf(stderr, "media_kit: PlayerHostPool: Unable to spawn %s.\n",
+            path_.c_str());
+    close(fds[0]);
+    return nullptr;
+  }
+  auto host = std::make_shared<Host>();
+  host->pid = pid;
+  host->socket = fds[0];
+  host->reader = std::thread(&PlayerHostPool::Read, this, host);
+  return host;
+}
+
+void PlayerHostPool::Read(std::shared_ptr<Host> host) {
+  PlayerHostMessage message;
+  while (PlayerHostProtocol::Receive(host->socket, &message)) {
+    std::lock_guard<std::mutex> lock(host->callback_mutex);
+    auto it = host->players.find(message.player);
+    if (it == host->players.end()) {
+      if (message.fd >= 0) {
+        close(message.fd);
+      }
+      continue;
+    }
+    it->second(message);
+  }
+  int status = 0;
+  while (waitpid(host->pid, &status, 0) < 0 && errno == EINTR) {
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    host->exited = true;
+    for (auto it = players_.begin(); it != players_.end();) {
+      it = it->second == host ? players_.erase(it) : std::next(it);
+    }
+  }
+  std::lock_guard<std::mutex> lock(host->callback_mutex);
+  for (auto& [id, callback] : host->players) {
+    PlayerHostMessage exit_message;
+    exit_message.type = PLAYER_HOST_EXIT;
+    exit_message.player = id;
+    exit_message.integers = {status};
+    callback(exit_message);
+  }
+  host->players.clear();
+}
+
+void PlayerHostPool::Stop(const std::shared_ptr<Host>& host) {
+  shutdown(host->socket, SHUT_RDWR);
+  if (host->reader.joinable()) {
+    host->reader.join();
+  }
+}
+
+std::shared_ptr<PlayerHostPool::Host> PlayerHostPool::Find(uint32_t player) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = players_.find(player);
+  return it != players_.end() ? it->second : nullptr;
+}
@@ -0,0 +1,453 @@
+// This file is a part of media_kit
+// (https://github.com/media-kit/media-kit).
+//
+// Copyright © 2026 & onwards, Predidit.
+// All rights reserved.
+// Use of this source code is governed by MIT license that can be found in the
+// LICENSE file.
+
+// media_kit_video_player_host: runs players of the plugin in a process of its
+// own (see |PlayerHostPool|), so that a crashing demuxer or decoder takes down
+// this process & its players only, instead of the whole application.
+//
+// The plugin's end of a SOCK_SEQPACKET socket pair is inherited as file
+// descriptor |PlayerHostProtocol::kHostSocket|. Each player renders with mpv's
+// S/W renderer into a ring of frames in a memfd shared with the plugin; a
+// frame belongs to the plugin from PLAYER_HOST_FRAME until it is returned with
+// PLAYER_HOST_RELEASE_FRAME, & frames are dropped while none is free. The
+// process exits once the plugin's end is closed.
+
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <mpv/client.h>
+#include <mpv/render.h>
+
+#include "include/media_kit_video/hwdec_calibration.h"
+#include "include/media_kit_video/player_host_protocol.h"
+
+namespace {
+
+// Same limits as S/W rendering within the plugin (see texture_sw.h).
+constexpr int64_t kMaxWidth = 1920;
+constexpr int64_t kMaxHeight = 1080;
+
+// Frames shared with the plugin: one shown, one queued, one being rendered.
+constexpr int32_t kFrameCount = 3;
+
+// |reply_userdata| of the properties observed for the host's own use.
+constexpr uint64_t kSizeObservation = 1;
+
+int socket_fd = PlayerHostProtocol::kHostSocket;
+int wakeup_fd = -1;
+
+struct Player {
+  uint32_t id = 0;
+  mpv_handle* handle = nullptr;
+  mpv_render_context* render_context = nullptr;
+  std::atomic<bool> events_pending{false};
+  std::atomic<bool> render_pending{false};
+  bool redraw = false;
+  // Requested size, 0 to follow the video's.
+  int64_t requested_width = 0;
+  int64_t requested_height = 0;
+  int64_t video_width = 0;
+  int64_t video_height = 0;
+  // Ring of frames shared with the plugin.
+  int64_t generation = 0;
+  int64_t width = 0;
+  int64_t height = 0;
+  uint8_t* frames = nullptr;
+  size_t frames_size = 0;
+  bool in_use[kFrameCount] = {};
+};
+
+std::map<uint32_t, std::unique_ptr<Player>> players;
+
+void Wakeup() {
+  uint64_t value = 1;
+  ssize_t result = write(wakeup_fd, &value, sizeof(value));
+  (void)result;
+}
+
+void Send(uint32_t type,
+          uint32_t player,
+          std::vector<int64_t> integers,
+          std::vector<std::string> strings,
+          int fd = -1) {
+  PlayerHostMessage message;
+  message.type = type;
+  message.player = player;
+  message.integers = std::move(integers);
+  message.strings = std::move(strings);
+  message.fd = fd;
+  PlayerHostProtocol::Send(socket_fd, message);
+}
+
+void UnmapFrames(Player* player) {
+  if (player->frames != nullptr) {
+    munmap(player->frames, player->frames_size);
+    player->frames = nullptr;
+    player->frames_size = 0;
+  }
+}
+
+void Destroy(uint32_t id) {
+  auto it = players.find(id);
+  if (it == players.end()) {
+    return;
+  }
+  Player* player = it->second.get();
+  if (player->render_context != nullptr) {
+    mpv_render_context_free(player->render_context);
+  }
+  mpv_set_wakeup_callback(player->handle, nullptr, nullptr);
+  mpv_terminate_destroy(player->handle);
+  UnmapFrames(player);
+  players.erase(it);
+}
+
+void Create(uint32_t id) {
+  if (players.count(id) != 0) {
+    return;
+  }
+  auto player = std::make_unique<Player>();
+  player->id = id;
+  player->handle = mpv_create();
+  if (player->handle == nullptr) {
+    Send(PLAYER_HOST_EVENT, id, {}, {"shutdown"});
+    return;
+  }
+  mpv_set_option_string(player->handle, "vo", "libmpv");
+  mpv_set_option_string(player->handle, "idle", "yes");
+  mpv_set_option_string(player->handle, "terminal", "no");
+  mpv_render_param params[] = {
+      {MPV_RENDER_PARAM_API_TYPE, (void*)MPV_RENDER_API_TYPE_SW},
+      {MPV_RENDER_PARAM_INVALID, (void*)0},
+  };
+  if (mpv_initialize(player->handle) < 0 ||
+      mpv_render_context_create(&player->render_context, player->handle,
+                                params) < 0) {
+    player->render_context = nullptr;
+    mpv_terminate_destroy(player->handle);
+    Send(PLAYER_HOST_EVENT, id, {}, {"shutdown"});
+    return;
+  }
+  mpv_observe_property(player->handle, kSizeObservation, "dwidth",
+                       MPV_FORMAT_INT64);
+  mpv_observe_property(player->handle, kSizeObservation, "dheight",
+                       MPV_FORMAT_INT64);
+  mpv_set_wakeup_callback(
+      player->handle,
+      [](void* data) {
+        ((Player*)data)->events_pending.store(true, std::memory_order_release);
+        Wakeup();
+      },
+      player.get());
+  mpv_render_context_set_update_callback(
+      player->render_context,
+      [](void* data) {
+        ((Player*)data)->render_pending.store(true, std::memory_order_release);
+        Wakeup();
+      },
+      player.get());
+  players[id] = std::move(player);
+}
+
+// Size of the frames: the requested one, else the video's, scaled down to fit
+// |kMaxWidth| x |kMaxHeight| while maintaining aspect ratio.
+void GetSize(const Player* player, int64_t* width, int64_t* height) {
+  int64_t w = player->requested_width, h = player->requested_height;
+  if (w <= 0 || h <= 0) {
+    w = player->video_width;
+    h = player->video_height;
+  }
+  if (w > kMaxWidth || h > kMaxHeight) {
+    if (w * kMaxHeight > h * kMaxWidth) {
+      h = std::max<int64_t>(h * kMaxWidth / w, 1);
+      w = kMaxWidth;
+    } else {
+      w = std::max<int64_t>(w * kMaxHeight / h, 1);
+      h = kMaxHeight;
+    }
+  }
+  *width = std::max<int64_t>(w, 0);
+  *height = std::max<int64_t>(h, 0);
+}
+
+// (Re)allocates the ring of frames for |width| x |height| & shares it with the
+// plugin. Frames of the previous generation are no longer written to.
+bool AllocateFrames(Player* player, int64_t width, int64_t height) {
+  UnmapFrames(player);
+  player->width = player->height = 0;
+  size_t size = (size_t)(width * height * 4) * kFrameCount;
+  int fd = memfd_create("media_kit_video_frames", MFD_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+  void* frames = MAP_FAILED;
+  if (ftruncate(fd, (off_t)size) == 0) {
+    frames = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  }
+  if (frames == MAP_FAILED) {
+    close(fd);
+    return false;
+  }
+  player->frames = (uint8_t*)frames;
+  player->frames_size = size;
+  player->width = width;
+  player->height = height;
+  player->generation++;
+  std::fill(std::begin(player->in_use), std::end(player->in_use), false);
+  Send(PLAYER_HOST_BUFFERS, player->id,
+       {player->generation, width, height, width * 4, kFrameCount}, {}, fd);
+  close(fd);
+  return true;
+}
+
+void Render(Player* player) {
+  uint64_t flags = mpv_render_context_update(player->render_context);
+  bool redraw = player->redraw;
+  player->redraw = false;
+  if ((flags & MPV_RENDER_UPDATE_FRAME) == 0 && !redraw) {
+    return;
+  }
+  int64_t width = 0, height = 0;
+  GetSize(player, &width, &height);
+  if (width <= 0 || height <= 0) {
+    return;
+  }
+  if ((width != player->width || height != player->height) &&
+      !AllocateFrames(player, width, height)) {
+    return;
+  }
+  int32_t index = -1;
+  for (int32_t i = 0; i < kFrameCount; i++) {
+    if (!player->in_use[i]) {
+      index = i;
+      break;
+    }
+  }
+  // The plugin holds every frame: the frame is consumed without rendering,
+  // so that playback does not stall.
+  int skip_rendering = index < 0;
+  int32_t size[]{(int32_t)width, (int32_t)height};
+  size_t stride = (size_t)width * 4;
+  uint8_t* pixels = player->frames;
+  if (index >= 0) {
+    pixels += (size_t)index * stride * height;
+  }
+  mpv_render_param params[]{
+      {MPV_RENDER_PARAM_SW_SIZE, size},
+      {MPV_RENDER_PARAM_SW_FORMAT, (void*)"rgb0"},
+      {MPV_RENDER_PARAM_SW_STRIDE, &stride},
+      {MPV_RENDER_PARAM_SW_POINTER, pixels},
+      {MPV_RENDER_PARAM_SKIP_RENDERING, &skip_rendering},
+      {MPV_RENDER_PARAM_INVALID, (void*)0},
+  };
+  if (mpv_render_context_render(player->render_context, params) < 0 ||
+      skip_rendering) {
+    return;
+  }
+  player->in_use[index] = true;
+  Send(PLAYER_HOST_FRAME, player->id, {player->generation, index}, {});
+}
+
+// Returns false once |player| has shut down (e.g. `quit`) & must be destroyed.
+bool HandleEvents(Player* player) {
+  while (true) {
+    mpv_event* event = mpv_wait_event(player->handle, 0);
+    if (event->event_id == MPV_EVENT_NONE) {
+      return true;
+    }
+    switch (event->event_id) {
+      case MPV_EVENT_PROPERTY_CHANGE: {
+        mpv_event_property* property = (mpv_event_property*)event->data;
+        if (event->reply_userdata == kSizeObservation) {
+          int64_t value = property->format == MPV_FORMAT_INT64
+                              ? *(int64_t*)property->data
+                              : 0;
+          if (strcmp(property->name, "dwidth") == 0) {
+            player->video_width = value;
+          } else {
+            player->video_height = value;
+          }
+          player->redraw = true;
+          break;
+        }
+        const char* value = property->format == MPV_FORMAT_STRING
+                                ? *(const char**)property->data
+                                : "";
+        Send(PLAYER_HOST_PROPERTY_CHANGE, player->id, {},
+             {property->name, value});
+        break;
+      }
+      case MPV_EVENT_GET_PROPERTY_REPLY: {
+        mpv_event_property* property = (mpv_event_property*)event->data;
+        const char* value =
+            event->error >= 0 && property->format == MPV_FORMAT_STRING
+                ? *(const char**)property->data
+                : "";
+        Send(PLAYER_HOST_REPLY, player->id,
+             {(int64_t)event->reply_userdata, event->error}, {value});
+        break;
+      }
+      case MPV_EVENT_SET_PROPERTY_REPLY:
+      case MPV_EVENT_COMMAND_REPLY:
+        break;
+      case MPV_EVENT_SHUTDOWN:
+        Send(PLAYER_HOST_EVENT, player->id, {}, {"shutdown"});
+        return false;
+      default:
+        Send(PLAYER_HOST_EVENT, player->id, {},
+             {mpv_event_name(event->event_id)});
+        break;
+    }
+  }
+}
+
+void HandleMessage(PlayerHostMessage& message) {
+  if (message.fd >= 0) {
+    close(message.fd);
+  }
+  if (message.type == PLAYER_HOST_CREATE) {
+    Create(message.player);
+    return;
+  }
+  if (message.type == PLAYER_HOST_DESTROY) {
+    Destroy(message.player);
+    return;
+  }
+  auto it = players.find(message.player);
+  if (it == players.end()) {
+    return;
+  }
+  Player* player = it->second.get();
+  const std::vector<int64_t>& integers = message.integers;
+  const std::vector<std::string>& strings = message.strings;
+  switch (message.type) {
+    case PLAYER_HOST_COMMAND: {
+      std::vector<const char*> arguments;
+      for (const std::string& argument : strings) {
+        arguments.push_back(argument.c_str());
+      }
+      arguments.push_back(nullptr);
+      mpv_command_async(player->handle, 0, arguments.data());
+      break;
+    }
+    case PLAYER_HOST_SET_PROPERTY: {
+      if (strings.size() == 2) {
+        const char* value = strings[1].c_str();
+        mpv_set_property_async(player->handle, 0, strings[0].c_str(),
+                               MPV_FORMAT_STRING, &value);
+      }
+      break;
+    }
+    case PLAYER_HOST_GET_PROPERTY: {
+      if (integers.size() == 1 && strings.size() == 1) {
+        mpv_get_property_async(player->handle, (uint64_t)integers[0],
+                               strings[0].c_str(), MPV_FORMAT_STRING);
+      }
+      break;
+    }
+    case PLAYER_HOST_OBSERVE_PROPERTY: {
+      if (strings.size() == 1) {
+        mpv_observe_property(player->handle, 0, strings[0].c_str(),
+                             MPV_FORMAT_STRING);
+      }
+      break;
+    }
+    case PLAYER_HOST_SET_SIZE: {
+      if (integers.size() == 2) {
+        player->requested_width = integers[0];
+        player->requested_height = integers[1];
+        player->redraw = true;
+      }
+      break;
+    }
+    case PLAYER_HOST_RELEASE_FRAME: {
+      if (integers.size() == 2 && integers[0] == player->generation &&
+          integers[1] >= 0 && integers[1] < kFrameCount) {
+        player->in_use[integers[1]] = false;
+      }
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  // Do not outlive the plugin, even if the socket is leaked to another process.
+  prctl(PR_SET_PDEATHSIG, SIGKILL);
+  if (argc == 4 && strcmp(argv[1], "--hwdec-measure") == 0) {
+    return HwdecCalibration::RunHelper(argv[2], argv[3]);
+  }
+  signal(SIGPIPE, SIG_IGN);
+  if (fcntl(socket_fd, F_SETFD, FD_CLOEXEC) < 0) {
+    fprintf(stderr, "media_kit: PlayerHost: No socket.\n");
+    return 1;
+  }
+  wakeup_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  if (wakeup_fd < 0) {
+    return 1;
+  }
+  while (true) {
+    pollfd fds[2] = {{socket_fd, POLLIN, 0}, {wakeup_fd, POLLIN, 0}};
+    if (poll(fds, 2, -1) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      break;
+    }
+    if (fds[0].revents != 0) {
+      PlayerHostMessage message;
+      if (!PlayerHostProtocol::Receive(socket_fd, &message)) {
+        break;
+      }
+      HandleMessage(message);
+    }
+    if (fds[1].revents != 0) {
+      uint64_t value;
+      ssize_t result = read(wakeup_fd, &value, sizeof(value));
+      (void)result;
+    }
+    // Also after messages, which may have made a redraw due.
+    std::vector<uint32_t> shut_down;
+    for (auto& [id, player] : players) {
+      if (player->events_pending.exchange(false, std::memory_order_acquire) &&
+          !HandleEvents(player.get())) {
+        shut_down.push_back(id);
+        continue;
+      }
+      if (player->render_pending.exchange(false, std::memory_order_acquire) ||
+          player->redraw) {
+        Render(player.get());
+      }
+    }
+    for (uint32_t id : shut_down) {
+      Destroy(id);
+    }
+  }
+  while (!players.empty()) {
+    Destroy(players.begin()->first);
+  }
+  close(wakeup_fd);
+  return 0;
+}
@@ -0,0 +1,161 @@
+// This file is a part of media_kit
+// (https://github.com/media-kit/media-kit).
+//
+// Copyright © 2026 & onwards, Predidit.
+// All rights reserved.
+// Use of this source code is governed by MIT license that can be found in the
+// LICENSE file.
+
+#include "include/media_kit_video/player_host_protocol.h"
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+namespace {
+
+constexpr size_t kHeaderSize = 10;
+
+template <typename T>
+void Append(std::vector<uint8_t>* data, T value) {
+  size_t offset = data->size();
+  data->resize(offset + sizeof(T));
+  memcpy(data->data() + offset, &value, sizeof(T));
+}
+
+template <typename T>
+bool Read(const uint8_t* data, size_t size, size_t* offset, T* value) {
+  if (size - *offset < sizeof(T)) {
+    return false;
+  }
+  memcpy(value, data + *offset, sizeof(T));
+  *offset += sizeof(T);
+  return true;
+}
+
+}  // namespace
+
+bool PlayerHostProtocol::Encode(const PlayerHostMessage& message,
+                                std::vector<uint8_t>* data) {
+  if (message.integers.size() > UINT8_MAX ||
+      message.strings.size() > UINT8_MAX) {
+    return false;
+  }
+  size_t size = kHeaderSize + message.integers.size() * sizeof(int64_t);
+  for (const std::string& string : message.strings) {
+    size += sizeof(uint32_t) + string.size();
+  }
+  if (size > kMaxMessageSize) {
+    return false;
+  }
+  data->clear();
+  data->reserve(size);
+  Append<uint32_t>(data, message.type);
+  Append<uint32_t>(data, message.player);
+  Append<uint8_t>(data, (uint8_t)message.integers.size());
+  Append<uint8_t>(data, (uint8_t)message.strings.size());
+  for (int64_t integer : message.integers) {
+    Append<int64_t>(data, integer);
+  }
+  for (const std::string& string : message.strings) {
+    Append<uint32_t>(data, (uint32_t)string.size());
+    data->insert(data->end(), string.begin(), string.end());
+  }
+  return true;
+}
+
+bool PlayerHostProtocol::Decode(const uint8_t* data,
+                                size_t size,
+                                PlayerHostMessage* message) {
+  size_t offset = 0;
+  uint8_t integer_count = 0, string_count = 0;
+  if (!Read(data, size, &offset, &message->type) ||
+      !Read(data, size, &offset, &message->player) ||
+      !Read(data, size, &offset, &integer_count) ||
+      !Read(data, size, &offset, &string_count)) {
+    return false;
+  }
+  message->integers.resize(integer_count);
+  for (int64_t& integer : message->integers) {
+    if (!Read(data, size, &offset, &integer)) {
+      return false;
+    }
+  }
+  message->strings.resize(string_count);
+  for (std::string& string : message->strings) {
+    uint32_t length = 0;
+    if (!Read(data, size, &offset, &length) || size - offset < length) {
+      return false;
+    }
+    string.assign((const char*)data + offset, length);
+    offset += length;
+  }
+  return offset == size;
+}
+
+bool PlayerHostProtocol::Send(int socket, const PlayerHostMessage& message) {
+  std::vector<uint8_t> data;
+  if (!Encode(message, &data)) {
+    return false;
+  }
+  iovec iov = {data.data(), data.size()};
+  msghdr header = {};
+  header.msg_iov = &iov;
+  header.msg_iovlen = 1;
+  alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+  if (message.fd >= 0) {
+    header.msg_control = control;
+    header.msg_controllen = sizeof(control);
+    cmsghdr* control_header = CMSG_FIRSTHDR(&header);
+    control_header->cmsg_level = SOL_SOCKET;
+    control_header->cmsg_type = SCM_RIGHTS;
+    control_header->cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(control_header), &message.fd, sizeof(int));
+  }
+  ssize_t sent;
+  do {
+    sent = sendmsg(socket, &header, MSG_NOSIGNAL);
+  } while (sent < 0 && errno == EINTR);
+  return sent == (ssize_t)data.size();
+}
+
+bool PlayerHostProtocol::Receive(int socket, PlayerHostMessage* message) {
+  std::vector<uint8_t> data(kMaxMessageSize);
+  while (true) {
+    iovec iov = {data.data(), data.size()};
+    msghdr header = {};
+    header.msg_iov = &iov;
+    header.msg_iovlen = 1;
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+    header.msg_control = control;
+    header.msg_controllen = sizeof(control);
+    ssize_t received = recvmsg(socket, &header, MSG_CMSG_CLOEXEC);
+    if (received < 0 && errno == EINTR) {
+      continue;
+    }
+    if (received <= 0) {
+      return false;
+    }
+    int fd = -1;
+    for (cmsghdr* control_header = CMSG_FIRSTHDR(&header);
+         control_header != NULL;
+         control_header = CMSG_NXTHDR(&header, control_header)) {
+      if (control_header->cmsg_level == SOL_SOCKET &&
+          control_header->cmsg_type == SCM_RIGHTS) {
+        memcpy(&fd, CMSG_DATA(control_header), sizeof(int));
+      }
+    }
+    *message = PlayerHostMessage{};
+    if ((header.msg_flags & (MSG_TRUNC | MSG_CTRUNC)) != 0 ||
+        !Decode(data.data(), (size_t)received, message)) {
+      if (fd >= 0) {
+        close(fd);
+      }
+      continue;
+    }
+    message->fd = fd;
+    return true;
+  }
+}
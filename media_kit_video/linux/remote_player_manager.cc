@@ -0,0 +1,232 @@
+// This file is a part of media_kit
+// (https://github.com/media-kit/media-kit).
+//
+// Copyright © 2026 & onwards, Predidit.
+// All rights reserved.
+// Use of this source code is governed by MIT license that can be found in the
+// LICENSE file.
+
+#include "include/media_kit_video/remote_player_manager.h"
+#include "include/media_kit_video/player_host.h"
+#include "include/media_kit_video/texture_remote.h"
+
+#include <unistd.h>
+
+typedef struct {
+  RemotePlayerManager* manager;
+  guint id; /* Atomic, messages may precede |PlayerHostPool::Create|'s return. */
+  TextureRemote* texture;
+} RemotePlayer;
+
+// A message forwarded to the main thread.
+typedef struct {
+  RemotePlayerManager* manager;
+  PlayerHostMessage* message;
+} RemotePlayerMessage;
+
+struct _RemotePlayerManager {
+  GObject parent_instance;
+  FlTextureRegistrar* texture_registrar;
+  PlayerHostPool* pool; /* Created on first use. */
+  GHashTable* players;  /* Id to |RemotePlayer|, NULL once disposed. */
+  RemotePlayerCallback callback;
+  gpointer callback_context;
+};
+
+G_DEFINE_TYPE(RemotePlayerManager, remote_player_manager, G_TYPE_OBJECT)
+
+static void remote_player_free(gpointer data) {
+  RemotePlayer* player = (RemotePlayer*)data;
+  fl_texture_registrar_unregister_texture(player->manager->texture_registrar,
+                                          FL_TEXTURE(player->texture));
+  texture_remote_clear(player->texture);
+  g_object_unref(player->texture);
+  g_free(player);
+}
+
+static void remote_player_manager_init(RemotePlayerManager* self) {
+  self->texture_registrar = NULL;
+  self->pool = NULL;
+  self->players = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL,
+                                        remote_player_free);
+  self->callback = NULL;
+  self->callback_context = NULL;
+}
+
+static void remote_player_manager_dispose(GObject* object) {
+  RemotePlayerManager* self = REMOTE_PLAYER_MANAGER(object);
+  // Reader threads may still take a reference through
+  // |remote_player_manager_on_message| until the pool is gone.
+  delete self->pool;
+  self->pool = NULL;
+  if (self->players != NULL) {
+    g_hash_table_unref(self->players);
+    self->players = NULL;
+  }
+  G_OBJECT_CLASS(remote_player_manager_parent_class)->dispose(object);
+}
+
+static void remote_player_manager_class_init(
+    RemotePlayerManagerClass* klass) {
+  G_OBJECT_CLASS(klass)->dispose = remote_player_manager_dispose;
+}
+
+RemotePlayerManager* remote_player_manager_new(
+    FlTextureRegistrar* texture_registrar,
+    RemotePlayerCallback callback,
+    gpointer callback_context) {
+  RemotePlayerManager* self = REMOTE_PLAYER_MANAGER(
+      g_object_new(remote_player_manager_get_type(), NULL));
+  self->texture_registrar = texture_registrar;
+  self->callback = callback;
+  self->callback_context = callback_context;
+  return self;
+}
+
+/**
+ * Forwards |message| to |RemotePlayerManager::callback|.
+ * Called from the main thread, as an idle source.
+ */
+static gboolean remote_player_manager_dispatch(gpointer data) {
+  RemotePlayerMessage* forwarded = (RemotePlayerMessage*)data;
+  RemotePlayerManager* self = forwarded->manager;
+  if (self->players != NULL && self->callback != NULL) {
+    self->callback(forwarded->message->player, forwarded->message,
+                   self->callback_context);
+  }
+  g_object_unref(self);
+  delete forwarded->message;
+  g_free(forwarded);
+  return G_SOURCE_REMOVE;
+}
+
+/**
+ * Handles a message of |player|: frames are handed to its texture right away,
+ * everything else is forwarded to the main thread.
+ * Called from the reader thread of |player|'s host.
+ */
+static void remote_player_manager_on_message(RemotePlayer* player,
+                                             PlayerHostMessage& message) {
+  RemotePlayerManager* self = player->manager;
+  g_atomic_int_set(&player->id, message.player);
+  const std::vector<int64_t>& integers = message.integers;
+  switch (message.type) {
+    case PLAYER_HOST_FRAME: {
+      if (integers.size() == 2) {
+        texture_remote_push_frame(player->texture, integers[0],
+                                  (gint32)integers[1]);
+        fl_texture_registrar_mark_texture_frame_available(
+            self->texture_registrar, FL_TEXTURE(player->texture));
+      }
+      return;
+    }
+    case PLAYER_HOST_BUFFERS: {
+      gint fd = message.fd;
+      message.fd = -1;
+      if (integers.size() != 5 ||
+          !texture_remote_set_buffers(player->texture, fd, integers[0],
+                                      (gint32)integers[1], (gint32)integers[2],
+                                      (gint32)integers[3],
+                                      (gint32)integers[4])) {
+        g_printerr(
+            "media_kit: RemotePlayerManager: Unable to map frames of player "
+            "%u.\n",
+            message.player);
+        return;
+      }
+      break;
+    }
+    case PLAYER_HOST_EXIT: {
+      g_printerr(
+          "media_kit: RemotePlayerManager: Host of player %u exited (status "
+          "%d).\n",
+          message.player, integers.empty() ? -1 : (gint)integers[0]);
+      break;
+    }
+    default:
+      break;
+  }
+  if (message.fd >= 0) {
+    close(message.fd);
+    message.fd = -1;
+  }
+  RemotePlayerMessage* forwarded = g_new0(RemotePlayerMessage, 1);
+  forwarded->manager = REMOTE_PLAYER_MANAGER(g_object_ref(self));
+  forwarded->message = new PlayerHostMessage(std::move(message));
+  g_idle_add(remote_player_manager_dispatch, forwarded);
+}
+
+guint32 remote_player_manager_create(RemotePlayerManager* self,
+                                     gint32 players_per_host) {
+  if (self->players == NULL) {
+    return 0;
+  }
+  if (self->pool == NULL) {
+    self->pool =
+        new PlayerHostPool(PlayerHostPool::DefaultPath(), players_per_host);
+  } else {
+    self->pool->SetPlayersPerHost(players_per_host);
+  }
+  RemotePlayer* player = g_new0(RemotePlayer, 1);
+  player->manager = self;
+  player->texture = texture_remote_new(
+      [](gint64 generation, gint32 index, gpointer context) {
+        RemotePlayer* player = (RemotePlayer*)context;
+        PlayerHostMessage message;
+        message.type = PLAYER_HOST_RELEASE_FRAME;
+        message.integers = {generation, index};
+        player->manager->pool->Send(g_atomic_int_get(&player->id),
+                                    std::move(message));
+      },
+      player);
+  if (!fl_texture_registrar_register_texture(self->texture_registrar,
+                                             FL_TEXTURE(player->texture))) {
+    g_object_unref(player->texture);
+    g_free(player);
+    return 0;
+  }
+  guint32 id = self->pool->Create([player](PlayerHostMessage& message) {
+    remote_player_manager_on_message(player, message);
+  });
+  if (id == 0) {
+    remote_player_free(player);
+    return 0;
+  }
+  g_atomic_int_set(&player->id, id);
+  g_hash_table_insert(self->players, GUINT_TO_POINTER(id), player);
+  return id;
+}
+
+gint64 remote_player_manager_get_texture_id(RemotePlayerManager* self,
+                                            guint32 id) {
+  RemotePlayer* player =
+      self->players != NULL
+          ? (RemotePlayer*)g_hash_table_lookup(self->players,
+                                               GUINT_TO_POINTER(id))
+          : NULL;
+  return player != NULL ? (gint64)player->texture : 0;
+}
+
+gboolean remote_player_manager_send(RemotePlayerManager* self,
+                                    guint32 id,
+                                    PlayerHostMessage message) {
+  if (self->pool == NULL) {
+    return FALSE;
+  }
+  return self->pool->Send(id, std::move(message));
+}
+
+pid_t remote_player_manager_get_process_id(RemotePlayerManager* self,
+                                           guint32 id) {
+  return self->pool != NULL ? self->pool->GetProcessId(id) : 0;
+}
+
+void remote_player_manager_dispose(RemotePlayerManager* self, guint32 id) {
+  if (self->players == NULL ||
+      !g_hash_table_contains(self->players, GUINT_TO_POINTER(id))) {
+    return;
+  }
+  // No message of the player is being handled once this returns.
+  self->pool->Destroy(id);
+  g_hash_table_remove(self->players, GUINT_TO_POINTER(id));
+}
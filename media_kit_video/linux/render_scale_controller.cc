@@ -0,0 +1,103 @@
+// This file is a part of media_kit
+// (https://github.com/media-kit/media-kit).
+//
+// Copyright © 2026 & onwards, Predidit.
+// All rights reserved.
+// Use of this source code is governed by MIT license that can be found in the
+// LICENSE file.
+
+#include "include/media_kit_video/render_scale_controller.h"
+
+constexpr double RenderScaleController::kScales[];
+
+std::vector<int64_t> RenderScaleController::Update(
+    const std::vector<Sample>& samples,
+    int64_t window) {
+  std::vector<int64_t> changed;
+  // Forget disposed outputs.
+  std::unordered_map<int64_t, int> levels;
+  for (const Sample& sample : samples) {
+    auto it = levels_.find(sample.key);
+    levels[sample.key] = it != levels_.end() ? it->second : 0;
+  }
+  levels_.swap(levels);
+  if (window <= 0 || samples.empty()) {
+    return changed;
+  }
+
+  int64_t total = 0;
+  for (const Sample& sample : samples) {
+    total += sample.render_time;
+  }
+  double load = (double)total / window;
+  if (load >= kLowLoad) {
+    low_windows_ = 0;
+  } else {
+    low_windows_++;
+  }
+  if (cooldown_ > 0) {
+    cooldown_--;
+    return changed;
+  }
+
+  if (load > kHighLoad) {
+    // Least important first; among equals, the one that saves the most.
+    const Sample* target = nullptr;
+    for (const Sample& sample : samples) {
+      if (levels_[sample.key] >= kLevelCount - 1 || sample.render_time <= 0) {
+        continue;
+      }
+      if (target == nullptr || sample.priority < target->priority ||
+          (sample.priority == target->priority &&
+           sample.render_time > target->render_time)) {
+        target = &sample;
+      }
+    }
+    if (target != nullptr) {
+      levels_[target->key]++;
+      changed.push_back(target->key);
+      cooldown_ = kCooldownWindows;
+    }
+    return changed;
+  }
+
+  if (low_windows_ >= kRaiseWindows) {
+    // Most important first; among equals, the cheapest to raise.
+    const Sample* target = nullptr;
+    for (const Sample& sample : samples) {
+      if (levels_[sample.key] == 0) {
+        continue;
+      }
+      if (target == nullptr || sample.priority > target->priority ||
+          (sample.priority == target->priority &&
+           sample.render_time < target->render_time)) {
+        target = &sample;
+      }
+    }
+    if (target != nullptr) {
+      // Render time is roughly proportional to the area.
+      int level = levels_[target->key];
+      double ratio = kScales[level - 1] / kScales[level];
+      double predicted =
+          load + target->render_time * (ratio * ratio - 1.0) / window;
+      if (predicted < kHighLoad) {
+        levels_[target->key] = level - 1;
+        changed.push_back(target->key);
+        cooldown_ = kCooldownWindows;
+        low_windows_ = 0;
+      }
+    }
+  }
+  return changed;
+}
+
+double RenderScaleController::GetScale(int64_t key) const {
+  auto it = levels_.find(key);
+  return it != levels_.end() ? kScales[it->second] : 1.0;
+}
+
+void RenderScaleController::Reset() {
+  levels_.clear();
+  low_windows_ = 0;
+  cooldown_ = 0;
+}
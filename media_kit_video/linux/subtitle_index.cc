@@ -0,0 +1,484 @@
+// This file is a part of media_kit
+// (https://github.com/media-kit/media-kit).
+//
+// Copyright © 2026 & onwards, Predidit.
+// All rights reserved.
+// Use of this source code is governed by MIT license that can be found in the
+// LICENSE file.
+
+#include "include/media_kit_video/subtitle_index.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+
+// Size of the chunks read by |SubtitleIndex::LoadFile|.
+#define SUBTITLE_INDEX_CHUNK_SIZE (64 * 1024)
+
+namespace {
+
+bool StartsWith(const std::string& line, const char* prefix) {
+  return line.compare(0, strlen(prefix), prefix) == 0;
+}
+
+// Parses a non-negative integer, advancing |p|. Returns -1 if no digit.
+int64_t ParseNumber(const char*& p, int* digits = nullptr) {
+  int64_t value = 0;
+  int count = 0;
+  while (*p >= '0' && *p <= '9') {
+    value = value * 10 + (*p - '0');
+    p++;
+    count++;
+  }
+  if (digits != nullptr) {
+    *digits = count;
+  }
+  return count > 0 ? value : -1;
+}
+
+// Parses `[hh:]mm:ss[,.]fff` (SRT & WebVTT) or `h:mm:ss.cc` (ASS) to
+// milliseconds, advancing |p|. Returns -1 if malformed.
+int64_t ParseTimestamp(const char*& p) {
+  while (*p == ' ' || *p == '\t') {
+    p++;
+  }
+  int64_t parts[3] = {0, 0, 0};
+  int count = 0;
+  while (count < 3) {
+    int64_t value = ParseNumber(p);
+    if (value < 0) {
+      return -1;
+    }
+    parts[count++] = value;
+    if (*p != ':') {
+      break;
+    }
+    p++;
+  }
+  if (count < 2) {
+    return -1;
+  }
+  int64_t hours = count == 3 ? parts[0] : 0;
+  int64_t minutes = count == 3 ? parts[1] : parts[0];
+  int64_t seconds = count == 3 ? parts[2] : parts[1];
+  int64_t milliseconds = 0;
+  if (*p == ',' || *p == '.') {
+    p++;
+    int digits = 0;
+    int64_t fraction = ParseNumber(p, &digits);
+    if (fraction < 0) {
+      return -1;
+    }
+    // Normalize 1, 2 (ASS centiseconds) or 3+ fractional digits.
+    for (; digits < 3; digits++) {
+      fraction *= 10;
+    }
+    for (; digits > 3; digits--) {
+      fraction /= 10;
+    }
+    milliseconds = fraction;
+  }
+  return ((hours * 60 + minutes) * 60 + seconds) * 1000 + milliseconds;
+}
+
+// Parses `start --> end`. Returns false if |line| is not a timing line.
+bool ParseTimingLine(const std::string& line, int32_t* start, int32_t* end) {
+  size_t arrow = line.find("-->");
+  if (arrow == std::string::npos) {
+    return false;
+  }
+  const char* p = line.c_str();
+  int64_t s = ParseTimestamp(p);
+  p = line.c_str() + arrow + 3;
+  int64_t e = ParseTimestamp(p);
+  if (s < 0 || e < 0) {
+    return false;
+  }
+  *start = (int32_t)s;
+  *end = (int32_t)e;
+  return true;
+}
+
+bool EqualsIgnoreCase(char a, char b) {
+  return std::tolower((unsigned char)a) == std::tolower((unsigned char)b);
+}
+
+}  // namespace
+
+SubtitleIndex::SubtitleIndex() = default;
+
+void SubtitleIndex::Feed(const char* data, size_t size) {
+  const char* end = data + size;
+  while (data < end) {
+    const char* newline = (const char*)memchr(data, '\n', end - data);
+    if (newline == nullptr) {
+      line_.append(data, end - data);
+      return;
+    }
+    line_.append(data, newline - data);
+    ParseLine(line_);
+    line_.clear();
+    data = newline + 1;
+  }
+}
+
+void SubtitleIndex::AddCue(int32_t start,
+                           int32_t end,
+                           const char* text,
+                           size_t size) {
+  SubtitleCue cue;
+  cue.start = start;
+  cue.end = end;
+  cue.text_offset = (uint32_t)text_.size();
+  text_.append(text, size);
+  cue.text_length = (uint32_t)size;
+  cues_.push_back(cue);
+  finished_ = false;
+}
+
+void SubtitleIndex::Finish() {
+  if (!line_.empty()) {
+    ParseLine(line_);
+    line_.clear();
+  }
+  if (in_cue_) {
+    FlushCue();
+    in_cue_ = false;
+  }
+  std::stable_sort(cues_.begin(), cues_.end(),
+                   [](const SubtitleCue& a, const SubtitleCue& b) {
+                     return a.start < b.start;
+                   });
+  cues_.shrink_to_fit();
+  text_.shrink_to_fit();
+  max_end_.assign(cues_.size(), 0);
+  max_end_.shrink_to_fit();
+  BuildTree(0, cues_.size());
+  finished_ = true;
+}
+
+bool SubtitleIndex::LoadFile(const char* path) {
+  FILE* file = fopen(path, "rb");
+  if (file == nullptr) {
+    return false;
+  }
+  std::vector<char> chunk(SUBTITLE_INDEX_CHUNK_SIZE);
+  size_t read = 0;
+  while ((read = fread(chunk.data(), 1, chunk.size(), file)) > 0) {
+    Feed(chunk.data(), read);
+  }
+  bool error = ferror(file) != 0;
+  fclose(file);
+  Finish();
+  return !error;
+}
+
+void SubtitleIndex::ParseLine(std::string& line) {
+  if (!line.empty() && line.back() == '\r') {
+    line.pop_back();
+  }
+  if (first_line_) {
+    first_line_ = false;
+    // UTF-8 BOM.
+    if (StartsWith(line, "\xEF\xBB\xBF")) {
+      line.erase(0, 3);
+    }
+  }
+  if (format_ == Format::kUnknown) {
+    if (StartsWith(line, "WEBVTT")) {
+      format_ = Format::kVtt;
+      return;
+    }
+    if (StartsWith(line, "[Script Info]") || StartsWith(line, "[V4") ||
+        StartsWith(line, "[Events]")) {
+      format_ = Format::kAss;
+    } else if (line.find("-->") != std::string::npos) {
+      format_ = Format::kSrt;
+    } else {
+      return;
+    }
+  }
+  if (format_ == Format::kAss) {
+    ParseAssLine(line);
+  } else {
+    ParseSrtLine(line);
+  }
+}
+
+void SubtitleIndex::ParseSrtLine(const std::string& line) {
+  int32_t start = 0, end = 0;
+  if (ParseTimingLine(line, &start, &end)) {
+    // Tolerate a missing blank line between two cues.
+    if (in_cue_) {
+      FlushCue();
+    }
+    in_cue_ = true;
+    cue_start_ = start;
+    cue_end_ = end;
+    cue_text_.clear();
+    return;
+  }
+  if (!in_cue_) {
+    // Sequence numbers, WebVTT headers, NOTE & STYLE blocks.
+    return;
+  }
+  if (line.empty()) {
+    FlushCue();
+    in_cue_ = false;
+    return;
+  }
+  if (!cue_text_.empty()) {
+    cue_text_.push_back('\n');
+  }
+  cue_text_.append(line);
+}
+
+void SubtitleIndex::ParseAssLine(const std::string& line) {
+  if (StartsWith(line, "[")) {
+    in_events_ = StartsWith(line, "[Events]");
+    return;
+  }
+  if (!in_events_) {
+    return;
+  }
+  if (StartsWith(line, "Format:")) {
+    int field = 0;
+    size_t position = 7;
+    while (position <= line.size()) {
+      size_t comma = line.find(',', position);
+      if (comma == std::string::npos) {
+        comma = line.size();
+      }
+      std::string name = line.substr(position, comma - position);
+      name.erase(0, name.find_first_not_of(" \t"));
+      name.erase(name.find_last_not_of(" \t") + 1);
+      if (name == "Start") {
+        ass_start_field_ = field;
+      } else if (name == "End") {
+        ass_end_field_ = field;
+      } else if (name == "Text") {
+        ass_text_field_ = field;
+      }
+      field++;
+      position = comma + 1;
+    }
+    return;
+  }
+  if (!StartsWith(line, "Dialogue:")) {
+    return;
+  }
+  // Text is always the last field & may itself contain commas.
+  int64_t start = -1, end = -1;
+  size_t position = 9;
+  for (int field = 0; field < ass_text_field_; field++) {
+    size_t comma = line.find(',', position);
+    if (comma == std::string::npos) {
+      return;
+    }
+    if (field == ass_start_field_ || field == ass_end_field_) {
+      const char* p = line.c_str() + position;
+      int64_t value = ParseTimestamp(p);
+      (field == ass_start_field_ ? start : end) = value;
+    }
+    position = comma + 1;
+  }
+  if (start < 0 || end < 0) {
+    return;
+  }
+  cue_start_ = (int32_t)start;
+  cue_end_ = (int32_t)end;
+  cue_text_.assign(line, position, std::string::npos);
+  FlushCue();
+}
+
+void SubtitleIndex::FlushCue() {
+  SubtitleCue cue;
+  cue.start = cue_start_;
+  cue.end = cue_end_;
+  cue.text_offset = (uint32_t)text_.size();
+  AppendText(cue_text_.data(), cue_text_.size(), format_ == Format::kAss);
+  cue.text_length = (uint32_t)(text_.size() - cue.text_offset);
+  cues_.push_back(cue);
+  cue_text_.clear();
+}
+
+// Appends plain text to the blob, dropping markup: `<i>`, `<c.yellow>` etc.
+// for SRT & WebVTT and `{\an8}` override blocks & escapes for ASS.
+void SubtitleIndex::AppendText(const char* data, size_t size, bool ass) {
+  const char open = ass ? '{' : '<';
+  const char close = ass ? '}' : '>';
+  bool in_tag = false;
+  for (size_t i = 0; i < size; i++) {
+    char c = data[i];
+    if (in_tag) {
+      in_tag = c != close;
+      continue;
+    }
+    if (c == open && memchr(data + i, close, size - i) != nullptr) {
+      in_tag = true;
+      continue;
+    }
+    if (ass && c == '\\' && i + 1 < size) {
+      char next = data[i + 1];
+      if (next == 'N' || next == 'n') {
+        text_.push_back('\n');
+        i++;
+        continue;
+      }
+      if (next == 'h') {
+        text_.push_back(' ');
+        i++;
+        continue;
+      }
+    }
+    text_.push_back(c);
+  }
+}
+
+// Implicit interval tree: the node of [lo, hi) is the middle cue & stores the
+// maximum end time of the whole range.
+int32_t SubtitleIndex::BuildTree(size_t lo, size_t hi) {
+  if (lo >= hi) {
+    return INT32_MIN;
+  }
+  size_t mid = lo + (hi - lo) / 2;
+  int32_t value = cues_[mid].end;
+  value = std::max(value, BuildTree(lo, mid));
+  value = std::max(value, BuildTree(mid + 1, hi));
+  max_end_[mid] = value;
+  return value;
+}
+
+void SubtitleIndex::QueryRange(size_t lo,
+                               size_t hi,
+                               int32_t start,
+                               int32_t end,
+                               uint32_t* out,
+                               size_t capacity,
+                               size_t* count) const {
+  if (lo >= hi) {
+    return;
+  }
+  size_t mid = lo + (hi - lo) / 2;
+  // Every cue in this subtree ends before the range.
+  if (max_end_[mid] <= start) {
+    return;
+  }
+  QueryRange(lo, mid, start, end, out, capacity, count);
+  // Cues are sorted by start; everything from |mid| onwards starts too late.
+  if (cues_[mid].start > end) {
+    return;
+  }
+  if (cues_[mid].end > start) {
+    if (*count < capacity) {
+      out[*count] = (uint32_t)mid;
+    }
+    (*count)++;
+  }
+  QueryRange(mid + 1, hi, start, end, out, capacity, count);
+}
+
+size_t SubtitleIndex::Query(int32_t start,
+                            int32_t end,
+                            uint32_t* out,
+                            size_t capacity) const {
+  if (!finished_) {
+    return 0;
+  }
+  size_t count = 0;
+  QueryRange(0, cues_.size(), start, end, out, capacity, &count);
+  return count;
+}
+
+size_t SubtitleIndex::Search(const char* needle,
+                             uint32_t from,
+                             uint32_t* out,
+                             size_t capacity) const {
+  size_t needle_size = strlen(needle);
+  size_t count = 0;
+  for (size_t i = from; i < cues_.size() && count < capacity; i++) {
+    const char* begin = text_.data() + cues_[i].text_offset;
+    const char* end = begin + cues_[i].text_length;
+    if (std::search(begin, end, needle, needle + needle_size,
+                    EqualsIgnoreCase) != end ||
+        needle_size == 0) {
+      out[count++] = (uint32_t)i;
+    }
+  }
+  return count;
+}
+
+uint32_t SubtitleIndex::LowerBound(int32_t time) const {
+  auto it = std::lower_bound(
+      cues_.begin(), cues_.end(), time,
+      [](const SubtitleCue& cue, int32_t time) { return cue.start < time; });
+  return (uint32_t)(it - cues_.begin());
+}
+
+// C API.
+
+SubtitleIndex* subtitle_index_new() {
+  return new SubtitleIndex();
+}
+
+void subtitle_index_free(SubtitleIndex* self) {
+  delete self;
+}
+
+void subtitle_index_feed(SubtitleIndex* self, const char* data, size_t size) {
+  self->Feed(data, size);
+}
+
+void subtitle_index_add_cue(SubtitleIndex* self,
+                            int32_t start,
+                            int32_t end,
+                            const char* text,
+                            size_t size) {
+  self->AddCue(start, end, text, size);
+}
+
+void subtitle_index_finish(SubtitleIndex* self) {
+  self->Finish();
+}
+
+SubtitleIndex* subtitle_index_load_file(const char* path) {
+  SubtitleIndex* self = new SubtitleIndex();
+  if (!self->LoadFile(path)) {
+    delete self;
+    return nullptr;
+  }
+  return self;
+}
+
+size_t subtitle_index_query(const SubtitleIndex* self,
+                            int32_t start,
+                            int32_t end,
+                            uint32_t* out,
+                            size_t capacity) {
+  return self->Query(start, end, out, capacity);
+}
+
+size_t subtitle_index_search(const SubtitleIndex* self,
+                             const char* needle,
+                             uint32_t from,
+                             uint32_t* out,
+                             size_t capacity) {
+  return self->Search(needle, from, out, capacity);
+}
+
+uint32_t subtitle_index_lower_bound(const SubtitleIndex* self, int32_t time) {
+  return self->LowerBound(time);
+}
+
+const SubtitleCue* subtitle_index_get_cues(const SubtitleIndex* self) {
+  return self->cues();
+}
+
+size_t subtitle_index_get_count(const SubtitleIndex* self) {
+  return self->size();
+}
+
+const char* subtitle_index_get_text(const SubtitleIndex* self) {
+  return self->text();
+}
@@ -0,0 +1,174 @@
+// This file is a part of media_kit
+// (https://github.com/media-kit/media-kit).
+//
+// Copyright © 2026 & onwards, Predidit.
+// All rights reserved.
+// Use of this source code is governed by MIT license that can be found in the
+// LICENSE file.
+
+#include "allocation_counter.h"
+
+#if defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__)
+#define ALLOCATION_COUNTER_SUPPORTED 0
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer) || __has_feature(thread_sanitizer) || \
+    __has_feature(memory_sanitizer)
+#define ALLOCATION_COUNTER_SUPPORTED 0
+#endif
+#endif
+#ifndef ALLOCATION_COUNTER_SUPPORTED
+#define ALLOCATION_COUNTER_SUPPORTED 1
+#endif
+
+#if ALLOCATION_COUNTER_SUPPORTED
+
+#include <execinfo.h>
+#include <link.h>
+#include <pthread.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t count, size_t size);
+extern "C" void* __libc_realloc(void* pointer, size_t size);
+
+namespace {
+
+enum Owner {
+  kOwnerSelf,     // This executable.
+  kOwnerRuntime,  // Allocates on behalf of its caller.
+  kOwnerOther,
+};
+
+struct Region {
+  uintptr_t begin;
+  uintptr_t end;
+  Owner owner;
+};
+
+constexpr size_t kMaxRegions = 1024;
+constexpr int kMaxFrames = 32;
+
+Region regions[kMaxRegions];
+size_t region_count = 0;
+pthread_t excluded_thread;
+std::atomic<bool> counting{false};
+std::atomic<size_t> count{0};
+thread_local bool in_hook = false;
+
+const char* const kRuntimeLibraries[] = {
+    "/libc.so",       "/libm.so",           "/libstdc++.so",
+    "/libgcc_s.so",   "/libglib-2.0.so",    "/libgobject-2.0.so",
+    "/ld-linux",
+};
+
+int AddRegions(dl_phdr_info* info, size_t, void* data) {
+  bool* first = static_cast<bool*>(data);
+  Owner owner = kOwnerOther;
+  if (*first) {
+    // The main program is reported first.
+    owner = kOwnerSelf;
+    *first = false;
+  } else {
+    for (const char* library : kRuntimeLibraries) {
+      if (strstr(info->dlpi_name, library) != nullptr) {
+        owner = kOwnerRuntime;
+      }
+    }
+  }
+  for (int i = 0; i < info->dlpi_phnum && region_count < kMaxRegions; i++) {
+    const ElfW(Phdr)& header = info->dlpi_phdr[i];
+    if (header.p_type == PT_LOAD && (header.p_flags & PF_X)) {
+      uintptr_t begin = info->dlpi_addr + header.p_vaddr;
+      regions[region_count++] = {begin, begin + header.p_memsz, owner};
+    }
+  }
+  return 0;
+}
+
+Owner OwnerOf(uintptr_t address) {
+  for (size_t i = 0; i < region_count; i++) {
+    if (address >= regions[i].begin && address < regions[i].end) {
+      return regions[i].owner;
+    }
+  }
+  return kOwnerOther;
+}
+
+__attribute__((noinline)) void Record() {
+  if (!counting.load(std::memory_order_relaxed) || in_hook) {
+    return;
+  }
+  in_hook = true;
+  if (!pthread_equal(pthread_self(), excluded_thread)) {
+    void* frames[kMaxFrames];
+    int depth = backtrace(frames, kMaxFrames);
+    // [0] |Record|, [1] the interposed allocation function.
+    for (int i = 2; i < depth; i++) {
+      Owner owner = OwnerOf(reinterpret_cast<uintptr_t>(frames[i]));
+      if (owner == kOwnerRuntime) {
+        continue;
+      }
+      if (owner == kOwnerSelf) {
+        count.fetch_add(1, std::memory_order_relaxed);
+      }
+      break;
+    }
+  }
+  in_hook = false;
+}
+
+}  // namespace
+
+extern "C" __attribute__((noinline)) void* malloc(size_t size) {
+  Record();
+  return __libc_malloc(size);
+}
+
+extern "C" __attribute__((noinline)) void* calloc(size_t count, size_t size) {
+  Record();
+  return __libc_calloc(count, size);
+}
+
+extern "C" __attribute__((noinline)) void* realloc(void* pointer,
+                                                   size_t size) {
+  Record();
+  return __libc_realloc(pointer, size);
+}
+
+bool AllocationCounter::IsSupported() {
+  return true;
+}
+
+void AllocationCounter::Start() {
+  region_count = 0;
+  bool first = true;
+  dl_iterate_phdr(AddRegions, &first);
+  // The first |backtrace| loads the unwinder, which allocates.
+  void* frames[kMaxFrames];
+  backtrace(frames, kMaxFrames);
+  excluded_thread = pthread_self();
+  count.store(0, std::memory_order_relaxed);
+  counting.store(true, std::memory_order_seq_cst);
+}
+
+size_t AllocationCounter::Stop() {
+  counting.store(false, std::memory_order_seq_cst);
+  return count.load(std::memory_order_relaxed);
+}
+
+#else
+
+bool AllocationCounter::IsSupported() {
+  return false;
+}
+
+void AllocationCounter::Start() {}
+
+size_t AllocationCounter::Stop() {
+  return 0;
+}
+
+#endif  // ALLOCATION_COUNTER_SUPPORTED
@@ -0,0 +1,32 @@
+// This file is a part of media_kit
+// (https://github.com/media-kit/media-kit).
+//
+// Copyright © 2026 & onwards, Predidit.
+// All rights reserved.
+// Use of this source code is governed by MIT license that can be found in the
+// LICENSE file.
+
+#ifndef ALLOCATION_COUNTER_H_
+#define ALLOCATION_COUNTER_H_
+
+#include <cstddef>
+
+// Counts the heap allocations made by this executable's own code i.e. the
+// plugin's sources, on all threads but the one calling |Start| (which runs
+// the test itself & the fakes). Allocations
+// performed inside other libraries on their own behalf (libmpv, the GL
+// driver) are not counted; those performed through the C/C++ runtime or GLib
+// on behalf of this executable (|std::function|, containers, |g_new|) are.
+//
+// Works by interposing malloc, so it is unavailable with ASan, TSan & MSan.
+class AllocationCounter {
+ public:
+  static bool IsSupported();
+
+  static void Start();
+
+  // Returns the number of allocations since |Start|.
+  static size_t Stop();
+};
+
+#endif  // ALLOCATION_COUNTER_H_
@@ -0,0 +1,226 @@
+// This file is a part of media_kit
+// (https://github.com/media-kit/media-kit).
+//
+// Copyright © 2026 & onwards, Predidit.
+// All rights reserved.
+// Use of this source code is governed by MIT license that can be found in the
+// LICENSE file.
+
+#include "fake_texture_registrar.h"
+
+static gint alive_count = 0;
+
+G_DEFINE_INTERFACE(FlTexture, fl_texture, G_TYPE_OBJECT)
+
+static void fl_texture_default_init(FlTextureInterface* iface) {}
+
+// FlTextureGL
+
+static void fl_texture_gl_texture_iface_init(FlTextureInterface* iface) {}
+
+G_DEFINE_TYPE_WITH_CODE(FlTextureGL,
+                        fl_texture_gl,
+                        G_TYPE_OBJECT,
+                        G_IMPLEMENT_INTERFACE(fl_texture_get_type(),
+                                              fl_texture_gl_texture_iface_init))
+
+static void fl_texture_gl_finalize(GObject* object) {
+  g_atomic_int_add(&alive_count, -1);
+  G_OBJECT_CLASS(fl_texture_gl_parent_class)->finalize(object);
+}
+
+static void fl_texture_gl_class_init(FlTextureGLClass* klass) {
+  G_OBJECT_CLASS(klass)->finalize = fl_texture_gl_finalize;
+}
+
+static void fl_texture_gl_init(FlTextureGL* self) {
+  g_atomic_int_inc(&alive_count);
+}
+
+// FlPixelBufferTexture
+
+static void fl_pixel_buffer_texture_texture_iface_init(
+    FlTextureInterface* iface) {}
+
+G_DEFINE_TYPE_WITH_CODE(
+    FlPixelBufferTexture,
+    fl_pixel_buffer_texture,
+    G_TYPE_OBJECT,
+    G_IMPLEMENT_INTERFACE(fl_texture_get_type(),
+                          fl_pixel_buffer_texture_texture_iface_init))
+
+static void fl_pixel_buffer_texture_finalize(GObject* object) {
+  g_atomic_int_add(&alive_count, -1);
+  G_OBJECT_CLASS(fl_pixel_buffer_texture_parent_class)->finalize(object);
+}
+
+static void fl_pixel_buffer_texture_class_init(
+    FlPixelBufferTextureClass* klass) {
+  G_OBJECT_CLASS(klass)->finalize = fl_pixel_buffer_texture_finalize;
+}
+
+static void fl_pixel_buffer_texture_init(FlPixelBufferTexture* self) {
+  g_atomic_int_inc(&alive_count);
+}
+
+gint fake_texture_get_alive_count() {
+  return g_atomic_int_get(&alive_count);
+}
+
+// FlTextureRegistrar
+
+struct _FlTextureRegistrar {
+  GObject parent_instance;
+  GMutex mutex;
+  GHashTable* textures;  // FlTexture* -> gboolean (frame available).
+  guint64 frame_count;
+  FakeFrameCallback frame_callback;
+  gpointer frame_callback_context;
+  FakePopulateCallback populate_callback;  // Main thread only.
+  gpointer populate_callback_context;
+};
+
+G_DEFINE_TYPE(FlTextureRegistrar, fl_texture_registrar, G_TYPE_OBJECT)
+
+static void fl_texture_registrar_init(FlTextureRegistrar* self) {
+  g_mutex_init(&self->mutex);
+  // Like Flutter, the registrar holds a reference to registered textures.
+  self->textures =
+      g_hash_table_new_full(g_direct_hash, g_direct_equal, g_object_unref, NULL);
+  self->frame_count = 0;
+  self->frame_callback = NULL;
+  self->frame_callback_context = NULL;
+  self->populate_callback = NULL;
+  self->populate_callback_context = NULL;
+}
+
+static void fl_texture_registrar_dispose(GObject* object) {
+  FlTextureRegistrar* self = FL_TEXTURE_REGISTRAR(object);
+  g_clear_pointer(&self->textures, g_hash_table_unref);
+  G_OBJECT_CLASS(fl_texture_registrar_parent_class)->dispose(object);
+}
+
+static void fl_texture_registrar_finalize(GObject* object) {
+  FlTextureRegistrar* self = FL_TEXTURE_REGISTRAR(object);
+  g_mutex_clear(&self->mutex);
+  G_OBJECT_CLASS(fl_texture_registrar_parent_class)->finalize(object);
+}
+
+static void fl_texture_registrar_class_init(FlTextureRegistrarClass* klass) {
+  G_OBJECT_CLASS(klass)->dispose = fl_texture_registrar_dispose;
+  G_OBJECT_CLASS(klass)->finalize = fl_texture_registrar_finalize;
+}
+
+FlTextureRegistrar* fake_texture_registrar_new() {
+  return FL_TEXTURE_REGISTRAR(
+      g_object_new(fl_texture_registrar_get_type(), NULL));
+}
+
+gboolean fl_texture_registrar_register_texture(FlTextureRegistrar* self,
+                                               FlTexture* texture) {
+  g_mutex_lock(&self->mutex);
+  gboolean inserted = !g_hash_table_contains(self->textures, texture);
+  if (inserted) {
+    g_hash_table_insert(self->textures, g_object_ref(texture),
+                        GINT_TO_POINTER(FALSE));
+  }
+  g_mutex_unlock(&self->mutex);
+  return inserted;
+}
+
+gboolean fl_texture_registrar_mark_texture_frame_available(
+    FlTextureRegistrar* self,
+    FlTexture* texture) {
+  g_mutex_lock(&self->mutex);
+  gboolean registered = g_hash_table_contains(self->textures, texture);
+  if (registered) {
+    g_hash_table_insert(self->textures, g_object_ref(texture),
+                        GINT_TO_POINTER(TRUE));
+    self->frame_count++;
+  }
+  FakeFrameCallback frame_callback = self->frame_callback;
+  gpointer frame_callback_context = self->frame_callback_context;
+  g_mutex_unlock(&self->mutex);
+  if (registered && frame_callback != NULL) {
+    frame_callback(texture, frame_callback_context);
+  }
+  return registered;
+}
+
+gboolean fl_texture_registrar_unregister_texture(FlTextureRegistrar* self,
+                                                 FlTexture* texture) {
+  g_mutex_lock(&self->mutex);
+  gboolean removed = g_hash_table_remove(self->textures, texture);
+  g_mutex_unlock(&self->mutex);
+  return removed;
+}
+
+guint fake_texture_registrar_get_texture_count(FlTextureRegistrar* self) {
+  g_mutex_lock(&self->mutex);
+  guint count = g_hash_table_size(self->textures);
+  g_mutex_unlock(&self->mutex);
+  return count;
+}
+
+guint64 fake_texture_registrar_get_frame_count(FlTextureRegistrar* self) {
+  g_mutex_lock(&self->mutex);
+  guint64 count = self->frame_count;
+  g_mutex_unlock(&self->mutex);
+  return count;
+}
+
+void fake_texture_registrar_set_frame_callback(FlTextureRegistrar* self,
+                                               FakeFrameCallback callback,
+                                               gpointer context) {
+  g_mutex_lock(&self->mutex);
+  self->frame_callback = callback;
+  self->frame_callback_context = context;
+  g_mutex_unlock(&self->mutex);
+}
+
+void fake_texture_registrar_set_populate_callback(
+    FlTextureRegistrar* self,
+    FakePopulateCallback callback,
+    gpointer context) {
+  self->populate_callback = callback;
+  self->populate_callback_context = context;
+}
+
+guint fake_texture_registrar_consume_frames(FlTextureRegistrar* self) {
+  // Collect under the lock, populate outside of it (as the raster thread does).
+  GPtrArray* available = g_ptr_array_new_with_free_func(g_object_unref);
+  g_mutex_lock(&self->mutex);
+  GHashTableIter iter;
+  gpointer key, value;
+  g_hash_table_iter_init(&iter, self->textures);
+  while (g_hash_table_iter_next(&iter, &key, &value)) {
+    if (GPOINTER_TO_INT(value)) {
+      g_ptr_array_add(available, g_object_ref(key));
+      g_hash_table_iter_replace(&iter, GINT_TO_POINTER(FALSE));
+    }
+  }
+  g_mutex_unlock(&self->mutex);
+
+  for (guint i = 0; i < available->len; i++) {
+    gpointer texture = g_ptr_array_index(available, i);
+    g_autoptr(GError) error = NULL;
+    uint32_t width = 0, height = 0;
+    if (FL_IS_TEXTURE_GL(texture)) {
+      uint32_t target = 0, name = 0;
+      if (FL_TEXTURE_GL_GET_CLASS(texture)->populate(
+              FL_TEXTURE_GL(texture), &target, &name, &width, &height,
+              &error) &&
+          self->populate_callback != NULL) {
+        self->populate_callback(FL_TEXTURE(texture), name, width, height,
+                                self->populate_callback_context);
+      }
+    } else if (FL_IS_PIXEL_BUFFER_TEXTURE(texture)) {
+      const uint8_t* buffer = NULL;
+      FL_PIXEL_BUFFER_TEXTURE_GET_CLASS(texture)->copy_pixels(
+          FL_PIXEL_BUFFER_TEXTURE(texture), &buffer, &width, &height, &error);
+    }
+  }
+  guint count = available->len;
+  g_ptr_array_unref(available);
+  return count;
+}
@@ -0,0 +1,58 @@
+// This file is a part of media_kit
+// (https://github.com/media-kit/media-kit).
+//
+// Copyright © 2026 & onwards, Predidit.
+// All rights reserved.
+// Use of this source code is governed by MIT license that can be found in the
+// LICENSE file.
+
+#ifndef FAKE_TEXTURE_REGISTRAR_H_
+#define FAKE_TEXTURE_REGISTRAR_H_
+
+#include <flutter_linux/flutter_linux.h>
+
+// Test-only controls of the fake |FlTextureRegistrar|.
+
+FlTextureRegistrar* fake_texture_registrar_new();
+
+// Number of currently registered textures.
+guint fake_texture_registrar_get_texture_count(FlTextureRegistrar* self);
+
+// Total number of |mark_texture_frame_available| calls.
+guint64 fake_texture_registrar_get_frame_count(FlTextureRegistrar* self);
+
+// Invoked from |mark_texture_frame_available| (i.e. from the GL thread) for
+// every frame of a registered texture.
+typedef void (*FakeFrameCallback)(FlTexture* texture, gpointer context);
+
+void fake_texture_registrar_set_frame_callback(FlTextureRegistrar* self,
+                                               FakeFrameCallback callback,
+                                               gpointer context);
+
+// Invoked from |fake_texture_registrar_consume_frames| for every populated
+// |FlTextureGL|, with the texture Flutter would composite.
+typedef void (*FakePopulateCallback)(FlTexture* texture,
+                                     guint32 name,
+                                     guint32 width,
+                                     guint32 height,
+                                     gpointer context);
+
+void fake_texture_registrar_set_populate_callback(
+    FlTextureRegistrar* self,
+    FakePopulateCallback callback,
+    gpointer context);
+
+/**
+ * @brief Acts as Flutter's raster thread: populates every texture marked as
+ * available since the previous call.
+ *
+ * Must be called on the thread where the "Flutter" EGL context is current.
+ *
+ * @return Number of textures populated.
+ */
+guint fake_texture_registrar_consume_frames(FlTextureRegistrar* self);
+
+// Number of |FlTextureGL| & |FlPixelBufferTexture| instances not finalized.
+gint fake_texture_get_alive_count();
+
+#endif  // FAKE_TEXTURE_REGISTRAR_H_
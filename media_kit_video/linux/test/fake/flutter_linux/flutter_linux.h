@@ -0,0 +1,76 @@
+// This file is a part of media_kit
+// (https://github.com/media-kit/media-kit).
+//
+// Copyright © 2026 & onwards, Predidit.
+// All rights reserved.
+// Use of this source code is governed by MIT license that can be found in the
+// LICENSE file.
+
+#ifndef FAKE_FLUTTER_LINUX_H_
+#define FAKE_FLUTTER_LINUX_H_
+
+// Minimal stand-in for the Flutter Linux embedder API used by the plugin's
+// texture & video output code. The types mirror the layout of the real
+// declarations, so the plugin sources compile unmodified against it.
+
+#include <gtk/gtk.h>
+#include <stdint.h>
+
+G_BEGIN_DECLS
+
+typedef struct _FlView FlView;
+
+G_DECLARE_INTERFACE(FlTexture, fl_texture, FL, TEXTURE, GObject)
+
+struct _FlTextureInterface {
+  GTypeInterface g_iface;
+};
+
+G_DECLARE_DERIVABLE_TYPE(FlTextureGL, fl_texture_gl, FL, TEXTURE_GL, GObject)
+
+struct _FlTextureGLClass {
+  GObjectClass parent_class;
+  gboolean (*populate)(FlTextureGL* texture,
+                       uint32_t* target,
+                       uint32_t* name,
+                       uint32_t* width,
+                       uint32_t* height,
+                       GError** error);
+  gpointer padding[8];
+};
+
+G_DECLARE_DERIVABLE_TYPE(FlPixelBufferTexture,
+                         fl_pixel_buffer_texture,
+                         FL,
+                         PIXEL_BUFFER_TEXTURE,
+                         GObject)
+
+struct _FlPixelBufferTextureClass {
+  GObjectClass parent_class;
+  gboolean (*copy_pixels)(FlPixelBufferTexture* texture,
+                          const uint8_t** buffer,
+                          uint32_t* width,
+                          uint32_t* height,
+                          GError** error);
+  gpointer padding[8];
+};
+
+G_DECLARE_FINAL_TYPE(FlTextureRegistrar,
+                     fl_texture_registrar,
+                     FL,
+                     TEXTURE_REGISTRAR,
+                     GObject)
+
+gboolean fl_texture_registrar_register_texture(FlTextureRegistrar* registrar,
+                                               FlTexture* texture);
+
+gboolean fl_texture_registrar_mark_texture_frame_available(
+    FlTextureRegistrar* registrar,
+    FlTexture* texture);
+
+gboolean fl_texture_registrar_unregister_texture(FlTextureRegistrar* registrar,
+                                                 FlTexture* texture);
+
+G_END_DECLS
+
+#endif  // FAKE_FLUTTER_LINUX_H_
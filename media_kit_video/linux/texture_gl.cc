@@ -7,14 +7,16 @@
 // LICENSE file.
 
 #include "include/media_kit_video/texture_gl.h"
+#include "include/media_kit_video/frame_tap.h"
 #include "include/media_kit_video/gl_render_thread.h"
+#include "include/media_kit_video/trace.h"
 
 #include <epoxy/gl.h>
 #include <epoxy/egl.h>
 #include <atomic>
 
 // Number of buffers for mailbox triple buffering
-#define NUM_BUFFERS 3
+#define NUM_BUFFERS TEXTURE_GL_BUFFER_COUNT
 
 // Buffer structure for mailbox triple buffering
 // Each buffer has its own GPU resources
@@ -25,6 +27,11 @@ typedef struct {
   guint32 flutter_texture;  // Flutter's texture bound to EGLImage
   gboolean flutter_texture_valid;  // Whether Flutter texture is valid
   std::atomic<EGLSyncKHR> render_sync;  // Sync created after mpv render (atomic for cross-thread access)
+  guint32 time_queries[2];  // GL_TIMESTAMP_EXT before & after mpv render (GL thread only)
+  gboolean time_queries_pending;  // Results of |time_queries| not read yet
+  guint32 pbo;              // S/W upload: pixel buffer object mpv renders into
+  guint8* pbo_data;         // S/W upload: persistent mapping of |pbo|, NULL if mapped per frame
+  GLsync upload_fence;      // S/W upload: signaled once |pbo| was copied into |texture|
 } RenderBuffer;
 
 /**
@@ -77,7 +84,21 @@ struct _TextureGL {
   guint32 current_height;
   gboolean buffers_initialized;
   gboolean initialization_posted;
+  gint has_wait_sync;                  // EGL_KHR_wait_sync; -1 until queried (main thread only)
+  gint has_timer_query;                // GL_EXT_disjoint_timer_query timestamps; -1 until queried (GL thread only)
+  gint has_buffer_storage;             // GL_EXT/ARB_buffer_storage; -1 until queried (GL thread only)
+  std::atomic<gint64> render_time;     // Microseconds spent rendering since |texture_gl_take_render_time|
   std::atomic<gboolean> resizing;      // Flag to indicate resize in progress
+  std::atomic<gint64> buffer_size;     // Bytes of each buffer, for memory accounting
+  std::atomic<gint64> buffer_count;    // Allocated buffers; fewer than NUM_BUFFERS while suspended
+  
+  // |texture_gl_tap| (GL thread only)
+  guint32 tap_fbo;                     // Downscaled copy of the back buffer
+  guint32 tap_texture;
+  gint32 tap_width;
+  gint32 tap_height;
+  guint8* tap_pixels;                  // Read back from the GPU
+  gsize tap_pixels_size;
   
   VideoOutput* video_output;
 };
@@ -92,6 +113,12 @@ static void texture_gl_init(TextureGL* self) {
     self->buffers[i].flutter_texture = 0;
     self->buffers[i].flutter_texture_valid = FALSE;
     self->buffers[i].render_sync.store(EGL_NO_SYNC_KHR, std::memory_order_relaxed);
+    self->buffers[i].time_queries[0] = 0;
+    self->buffers[i].time_queries[1] = 0;
+    self->buffers[i].time_queries_pending = FALSE;
+    self->buffers[i].pbo = 0;
+    self->buffers[i].pbo_data = NULL;
+    self->buffers[i].upload_fence = NULL;
   }
   
   // Initialize mailbox model indices
@@ -105,10 +132,87 @@ static void texture_gl_init(TextureGL* self) {
   self->current_height = 1;
   self->buffers_initialized = FALSE;
   self->initialization_posted = FALSE;
+  self->has_wait_sync = -1;
+  self->has_timer_query = -1;
+  self->has_buffer_storage = -1;
+  self->render_time.store(0, std::memory_order_relaxed);
   self->resizing.store(FALSE, std::memory_order_relaxed);
+  self->buffer_size.store(0, std::memory_order_relaxed);
+  self->buffer_count.store(0, std::memory_order_relaxed);
+  self->tap_fbo = 0;
+  self->tap_texture = 0;
+  self->tap_width = 0;
+  self->tap_height = 0;
+  self->tap_pixels = NULL;
+  self->tap_pixels_size = 0;
   self->video_output = NULL;
 }
 
+gboolean texture_gl_is_sw_upload_supported() {
+  if (epoxy_is_desktop_gl()) {
+    return epoxy_gl_version() >= 32 ||
+           (epoxy_gl_version() >= 30 &&
+            epoxy_has_gl_extension("GL_ARB_sync"));
+  }
+  return epoxy_gl_version() >= 30;
+}
+
+/**
+ * Allocates |buf|'s pixel buffer object for S/W upload, mapped persistently
+ * where buffer storage (GL_EXT_buffer_storage on OpenGL ES, OpenGL 4.4 or
+ * GL_ARB_buffer_storage) is available.
+ * Called from the dedicated GL rendering thread with mpv's context current.
+ */
+static void texture_gl_allocate_pbo(TextureGL* self,
+                                    RenderBuffer* buf,
+                                    gsize size) {
+  if (self->has_buffer_storage == -1) {
+    self->has_buffer_storage =
+        epoxy_is_desktop_gl()
+            ? epoxy_gl_version() >= 44 ||
+                  epoxy_has_gl_extension("GL_ARB_buffer_storage")
+            : epoxy_has_gl_extension("GL_EXT_buffer_storage");
+  }
+  glGenBuffers(1, &buf->pbo);
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buf->pbo);
+  if (self->has_buffer_storage) {
+    GLbitfield flags =
+        GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    if (epoxy_is_desktop_gl()) {
+      glBufferStorage(GL_PIXEL_UNPACK_BUFFER, size, NULL, flags);
+    } else {
+      glBufferStorageEXT(GL_PIXEL_UNPACK_BUFFER, size, NULL, flags);
+    }
+    buf->pbo_data =
+        (guint8*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, flags);
+  } else {
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, size, NULL, GL_STREAM_DRAW);
+  }
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+/**
+ * Frees |buf|'s pixel buffer object, if any.
+ * Called from the dedicated GL rendering thread with mpv's context current.
+ */
+static void texture_gl_free_pbo(RenderBuffer* buf) {
+  if (buf->upload_fence != NULL) {
+    glDeleteSync(buf->upload_fence);
+    buf->upload_fence = NULL;
+  }
+  if (buf->pbo == 0) {
+    return;
+  }
+  if (buf->pbo_data != NULL) {
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buf->pbo);
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    buf->pbo_data = NULL;
+  }
+  glDeleteBuffers(1, &buf->pbo);
+  buf->pbo = 0;
+}
+
 static void texture_gl_dispose(GObject* object) {
   TextureGL* self = TEXTURE_GL(object);
   VideoOutput* video_output = self->video_output;
@@ -161,10 +265,25 @@ static void texture_gl_dispose(GObject* object) {
             glDeleteFramebuffers(1, &buf->fbo);
             buf->fbo = 0;
           }
+          if (buf->time_queries[0] != 0) {
+            glDeleteQueriesEXT(2, buf->time_queries);
+            buf->time_queries[0] = buf->time_queries[1] = 0;
+          }
+          texture_gl_free_pbo(buf);
+        }
+        if (self->tap_texture != 0) {
+          glDeleteTextures(1, &self->tap_texture);
+          self->tap_texture = 0;
+        }
+        if (self->tap_fbo != 0) {
+          glDeleteFramebuffers(1, &self->tap_fbo);
+          self->tap_fbo = 0;
         }
       }
     });
   }
+  g_clear_pointer(&self->tap_pixels, g_free);
+  self->tap_pixels_size = 0;
   
   self->current_width = 1;
   self->current_height = 1;
@@ -183,12 +302,90 @@ TextureGL* texture_gl_new(VideoOutput* video_output) {
   return self;
 }
 
+/**
+ * Allocates the GPU resources of |buf|.
+ * Called from the dedicated GL rendering thread with mpv's context current.
+ */
+static void texture_gl_allocate_buffer(TextureGL* self,
+                                       RenderBuffer* buf,
+                                       gint64 width,
+                                       gint64 height) {
+  EGLDisplay egl_display = video_output_get_egl_display(self->video_output);
+  EGLContext egl_context = video_output_get_egl_context(self->video_output);
+
+  // Create FBO and texture for this buffer
+  glGenFramebuffers(1, &buf->fbo);
+  glBindFramebuffer(GL_FRAMEBUFFER, buf->fbo);
+
+  glGenTextures(1, &buf->texture);
+  glBindTexture(GL_TEXTURE_2D, buf->texture);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA,
+               GL_UNSIGNED_BYTE, NULL);
+
+  // Attach texture to FBO
+  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                         buf->texture, 0);
+
+  // Create EGLImage from texture for sharing between contexts
+  EGLint egl_image_attribs[] = { EGL_NONE };
+  buf->egl_image = eglCreateImageKHR(
+      egl_display,
+      egl_context,
+      EGL_GL_TEXTURE_2D_KHR,
+      (EGLClientBuffer)(guintptr)buf->texture,
+      egl_image_attribs);
+
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  glBindTexture(GL_TEXTURE_2D, 0);
+
+  if (video_output_is_sw_upload(self->video_output)) {
+    texture_gl_allocate_pbo(self, buf, (gsize)width * height * 4);
+  }
+
+  // Mark Flutter texture as invalid (needs recreation)
+  buf->flutter_texture_valid = FALSE;
+  buf->render_sync.store(EGL_NO_SYNC_KHR, std::memory_order_release);
+}
+
+/**
+ * Waits for pending GPU work on |buf|, then frees its GPU resources.
+ * Called from the dedicated GL rendering thread with mpv's context current.
+ */
+static void texture_gl_free_buffer(TextureGL* self, RenderBuffer* buf) {
+  EGLDisplay egl_display = video_output_get_egl_display(self->video_output);
+
+  EGLSyncKHR sync = buf->render_sync.load(std::memory_order_acquire);
+  if (sync != EGL_NO_SYNC_KHR) {
+    eglClientWaitSyncKHR(egl_display, sync,
+                         EGL_SYNC_FLUSH_COMMANDS_BIT_KHR, EGL_FOREVER_KHR);
+    eglDestroySyncKHR(egl_display, sync);
+    buf->render_sync.store(EGL_NO_SYNC_KHR, std::memory_order_release);
+  }
+
+  if (buf->egl_image != EGL_NO_IMAGE_KHR) {
+    eglDestroyImageKHR(egl_display, buf->egl_image);
+    buf->egl_image = EGL_NO_IMAGE_KHR;
+  }
+
+  glDeleteTextures(1, &buf->texture);
+  glDeleteFramebuffers(1, &buf->fbo);
+  buf->texture = 0;
+  buf->fbo = 0;
+  texture_gl_free_pbo(buf);
+}
+
 /**
  * Called from the dedicated GL rendering thread.
  * Creates or resizes all three buffers for the mailbox model.
  */
 void texture_gl_check_and_resize(TextureGL* self, gint64 required_width, gint64 required_height) {
   VideoOutput* video_output = self->video_output;
+  TRACE_SCOPE("texture_gl_check_and_resize",
+              video_output_get_handle(video_output));
   
   if (required_width < 1 || required_height < 1) {
     return;
@@ -197,8 +394,11 @@ void texture_gl_check_and_resize(TextureGL* self, gint64 required_width, gint64
   gboolean first_frame = !self->buffers_initialized;
   gboolean resize = self->current_width != (guint32)required_width ||
                     self->current_height != (guint32)required_height;
+  // Buffers released by |texture_gl_suspend| are missing.
+  gboolean restore = !first_frame && !resize &&
+      self->buffer_count.load(std::memory_order_relaxed) < NUM_BUFFERS;
   
-  if (!first_frame && !resize) {
+  if (!first_frame && !resize && !restore) {
     return;
   }
   
@@ -208,6 +408,20 @@ void texture_gl_check_and_resize(TextureGL* self, gint64 required_width, gint64
   // Switch to mpv's isolated context
   eglMakeCurrent(egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, egl_context);
   
+  if (restore) {
+    // The front buffer still holds the snapshot shown while suspended & the
+    // consumer only swaps on a new frame, so no |resizing| is needed.
+    for (int i = 0; i < NUM_BUFFERS; i++) {
+      if (self->buffers[i].fbo == 0) {
+        texture_gl_allocate_buffer(self, &self->buffers[i], required_width,
+                                   required_height);
+      }
+    }
+    glFlush();
+    self->buffer_count.store(NUM_BUFFERS, std::memory_order_relaxed);
+    return;
+  }
+  
   // Mark as resizing to prevent consumer from accessing buffers
   self->resizing.store(TRUE, std::memory_order_release);
   
@@ -217,55 +431,10 @@ void texture_gl_check_and_resize(TextureGL* self, gint64 required_width, gint64
     
     if (!first_frame) {
       // Wait for any pending GPU work before destroying resources
-      EGLSyncKHR sync = buf->render_sync.load(std::memory_order_acquire);
-      if (sync != EGL_NO_SYNC_KHR) {
-        eglClientWaitSyncKHR(egl_display, sync, 
-                              EGL_SYNC_FLUSH_COMMANDS_BIT_KHR, EGL_FOREVER_KHR);
-        eglDestroySyncKHR(egl_display, sync);
-        buf->render_sync.store(EGL_NO_SYNC_KHR, std::memory_order_release);
-      }
-      
-      if (buf->egl_image != EGL_NO_IMAGE_KHR) {
-        eglDestroyImageKHR(egl_display, buf->egl_image);
-        buf->egl_image = EGL_NO_IMAGE_KHR;
-      }
-      
-      glDeleteTextures(1, &buf->texture);
-      glDeleteFramebuffers(1, &buf->fbo);
+      texture_gl_free_buffer(self, buf);
     }
     
-    // Create FBO and texture for this buffer
-    glGenFramebuffers(1, &buf->fbo);
-    glBindFramebuffer(GL_FRAMEBUFFER, buf->fbo);
-    
-    glGenTextures(1, &buf->texture);
-    glBindTexture(GL_TEXTURE_2D, buf->texture);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, required_width, required_height,
-                 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
-    
-    // Attach texture to FBO
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
-                           GL_TEXTURE_2D, buf->texture, 0);
-    
-    // Create EGLImage from texture for sharing between contexts
-    EGLint egl_image_attribs[] = { EGL_NONE };
-    buf->egl_image = eglCreateImageKHR(
-        egl_display,
-        egl_context,
-        EGL_GL_TEXTURE_2D_KHR,
-        (EGLClientBuffer)(guintptr)buf->texture,
-        egl_image_attribs);
-    
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
-    glBindTexture(GL_TEXTURE_2D, 0);
-    
-    // Mark Flutter texture as invalid (needs recreation)
-    buf->flutter_texture_valid = FALSE;
-    buf->render_sync.store(EGL_NO_SYNC_KHR, std::memory_order_release);
+    texture_gl_allocate_buffer(self, buf, required_width, required_height);
   }
   
   // Flush to ensure textures are ready
@@ -281,16 +450,148 @@ void texture_gl_check_and_resize(TextureGL* self, gint64 required_width, gint64
   self->buffers_initialized = TRUE;
   self->current_width = required_width;
   self->current_height = required_height;
+  // S/W upload: the pixel buffer object is as large as the texture.
+  gint64 planes = video_output_is_sw_upload(video_output) ? 2 : 1;
+  self->buffer_size.store(required_width * required_height * 4 * planes,
+                          std::memory_order_relaxed);
+  self->buffer_count.store(NUM_BUFFERS, std::memory_order_relaxed);
   
   self->resizing.store(FALSE, std::memory_order_release);
 }
 
+void texture_gl_suspend(TextureGL* self) {
+  VideoOutput* video_output = self->video_output;
+  GLRenderThread* gl_thread = video_output_get_gl_render_thread(video_output);
+  if (!self->buffers_initialized || gl_thread == NULL) {
+    return;
+  }
+  // |front_index| is stable; the consumer runs on this (main) thread.
+  int front_idx = self->front_index;
+  gl_thread->PostAndWait([self, video_output, front_idx]() {
+    eglMakeCurrent(video_output_get_egl_display(video_output), EGL_NO_SURFACE,
+                   EGL_NO_SURFACE, video_output_get_egl_context(video_output));
+    for (int i = 0; i < NUM_BUFFERS; i++) {
+      if (i != front_idx && self->buffers[i].fbo != 0) {
+        texture_gl_free_buffer(self, &self->buffers[i]);
+      }
+    }
+    // Drop the unconsumed frame, if any; it may live in a released buffer.
+    int state = self->mailbox_state.load(std::memory_order_acquire);
+    self->mailbox_state.store(state & 0xFF, std::memory_order_release);
+    self->buffer_count.store(1, std::memory_order_relaxed);
+  });
+  // Flutter's textures are EGLImage siblings & would keep the storage alive.
+  for (int i = 0; i < NUM_BUFFERS; i++) {
+    RenderBuffer* buf = &self->buffers[i];
+    if (i != front_idx && buf->flutter_texture != 0) {
+      glDeleteTextures(1, &buf->flutter_texture);
+      buf->flutter_texture = 0;
+      buf->flutter_texture_valid = FALSE;
+    }
+  }
+}
+
+gint64 texture_gl_get_buffer_count(TextureGL* self) {
+  return self->buffer_count.load(std::memory_order_relaxed);
+}
+
+gint64 texture_gl_get_buffer_size(TextureGL* self) {
+  return self->buffer_size.load(std::memory_order_relaxed);
+}
+
+gint64 texture_gl_take_render_time(TextureGL* self) {
+  return self->render_time.exchange(0, std::memory_order_relaxed);
+}
+
+/**
+ * Adds the GPU time of the previous render into |buf| to |render_time|. Its
+ * fence has been waited for, so that the results are available.
+ * Called from the dedicated GL rendering thread with mpv's context current.
+ */
+static void texture_gl_collect_render_time(TextureGL* self, RenderBuffer* buf) {
+  if (!buf->time_queries_pending) {
+    return;
+  }
+  buf->time_queries_pending = FALSE;
+  GLint available = 0;
+  glGetQueryObjectivEXT(buf->time_queries[1], GL_QUERY_RESULT_AVAILABLE_EXT,
+                        &available);
+  GLint disjoint = 0;
+  glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+  if (!available || disjoint) {
+    return;
+  }
+  GLuint64 start = 0, end = 0;
+  glGetQueryObjectui64vEXT(buf->time_queries[0], GL_QUERY_RESULT_EXT, &start);
+  glGetQueryObjectui64vEXT(buf->time_queries[1], GL_QUERY_RESULT_EXT, &end);
+  if (end > start) {
+    self->render_time.fetch_add((gint64)((end - start) / 1000),
+                                std::memory_order_relaxed);
+  }
+}
+
+/**
+ * S/W upload: renders the frame with mpv's S/W renderer into |buf|'s pixel
+ * buffer object & copies that into |buf|'s texture, asynchronously on the
+ * GPU; neither Flutter's raster thread nor an intermediate buffer is involved.
+ * Called from the dedicated GL rendering thread with mpv's context current.
+ */
+static void texture_gl_render_sw(TextureGL* self,
+                                 mpv_render_context* render_context,
+                                 RenderBuffer* buf,
+                                 gint32 width,
+                                 gint32 height,
+                                 int block_for_target_time) {
+  if (buf->pbo == 0) {
+    return;
+  }
+  // The copy of the previous frame out of |pbo| must be done before mpv
+  // overwrites it.
+  if (buf->upload_fence != NULL) {
+    glClientWaitSync(buf->upload_fence, GL_SYNC_FLUSH_COMMANDS_BIT,
+                     GL_TIMEOUT_IGNORED);
+    glDeleteSync(buf->upload_fence);
+    buf->upload_fence = NULL;
+  }
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buf->pbo);
+  guint8* data = buf->pbo_data;
+  if (data == NULL) {
+    data = (guint8*)glMapBufferRange(
+        GL_PIXEL_UNPACK_BUFFER, 0, (GLsizeiptr)width * height * 4,
+        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+  }
+  if (data != NULL) {
+    gint32 size[]{width, height};
+    gint32 pitch = 4 * width;
+    mpv_render_param params[]{
+        {MPV_RENDER_PARAM_SW_SIZE, size},
+        {MPV_RENDER_PARAM_SW_FORMAT, (void*)"rgb0"},
+        {MPV_RENDER_PARAM_SW_STRIDE, &pitch},
+        {MPV_RENDER_PARAM_SW_POINTER, data},
+        {MPV_RENDER_PARAM_BLOCK_FOR_TARGET_TIME, &block_for_target_time},
+        {MPV_RENDER_PARAM_INVALID, NULL},
+    };
+    mpv_render_context_render(render_context, params);
+    if (buf->pbo_data == NULL) {
+      glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    }
+    glBindTexture(GL_TEXTURE_2D, buf->texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RGBA,
+                    GL_UNSIGNED_BYTE, NULL);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    buf->upload_fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  }
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
 /**
  * Renders mpv frame to the back buffer.
  * Called from the dedicated GL rendering thread.
  */
 gboolean texture_gl_render(TextureGL* self) {
   VideoOutput* video_output = self->video_output;
+  TRACE_SCOPE("texture_gl_render", video_output_get_handle(video_output));
   EGLDisplay egl_display = video_output_get_egl_display(video_output);
   EGLContext egl_context = video_output_get_egl_context(video_output);
   mpv_render_context* render_context = video_output_get_render_context(video_output);
@@ -307,6 +608,10 @@ gboolean texture_gl_render(TextureGL* self) {
     return FALSE;
   }
   
+  // Without GPU timestamps, the time spent here (including the wait below for
+  // the GPU to finish with this buffer) stands in for the GPU time.
+  gint64 start_time = g_get_monotonic_time();
+  
   // Before reusing this buffer, wait for any previous render to complete
   // This ensures GPU has finished with this buffer before we overwrite it
   EGLSyncKHR old_sync = back_buf->render_sync.exchange(EGL_NO_SYNC_KHR, std::memory_order_acq_rel);
@@ -322,21 +627,53 @@ gboolean texture_gl_render(TextureGL* self) {
   // Switch to mpv's isolated context for rendering
   eglMakeCurrent(egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, egl_context);
   
-  // Bind back buffer's FBO
-  glBindFramebuffer(GL_FRAMEBUFFER, back_buf->fbo);
+  if (self->has_timer_query == -1) {
+    // Timestamps are optional in GL_EXT_disjoint_timer_query. GL_TIME_ELAPSED
+    // would nest with mpv's own per-pass timers, which is not allowed.
+    GLint bits = 0;
+    if (epoxy_has_gl_extension("GL_EXT_disjoint_timer_query")) {
+      glGetQueryivEXT(GL_TIMESTAMP_EXT, GL_QUERY_COUNTER_BITS_EXT, &bits);
+    }
+    // S/W upload: the time is spent on the CPU, in mpv's renderer.
+    self->has_timer_query =
+        bits > 0 && !video_output_is_sw_upload(video_output);
+  }
+  if (self->has_timer_query) {
+    texture_gl_collect_render_time(self, back_buf);
+    if (back_buf->time_queries[0] == 0) {
+      glGenQueriesEXT(2, back_buf->time_queries);
+    }
+    glQueryCounterEXT(back_buf->time_queries[0], GL_TIMESTAMP_EXT);
+  }
   
-  // Render mpv frame to back buffer's texture
-  mpv_opengl_fbo fbo{(gint32)back_buf->fbo, required_width, required_height, 0};
-  int flip_y = 0;
-  mpv_render_param params[] = {
-      {MPV_RENDER_PARAM_OPENGL_FBO, &fbo},
-      {MPV_RENDER_PARAM_FLIP_Y, &flip_y},
-      {MPV_RENDER_PARAM_INVALID, NULL},
-  };
-  mpv_render_context_render(render_context, params);
+  // Low latency: publish right away instead of waiting for the display time.
+  int block_for_target_time = !video_output_is_low_latency(video_output);
+  if (video_output_is_sw_upload(video_output)) {
+    texture_gl_render_sw(self, render_context, back_buf, required_width,
+                         required_height, block_for_target_time);
+  } else {
+    // Bind back buffer's FBO
+    glBindFramebuffer(GL_FRAMEBUFFER, back_buf->fbo);
+    
+    // Render mpv frame to back buffer's texture
+    mpv_opengl_fbo fbo{(gint32)back_buf->fbo, required_width, required_height, 0};
+    int flip_y = 0;
+    mpv_render_param params[] = {
+        {MPV_RENDER_PARAM_OPENGL_FBO, &fbo},
+        {MPV_RENDER_PARAM_FLIP_Y, &flip_y},
+        {MPV_RENDER_PARAM_BLOCK_FOR_TARGET_TIME, &block_for_target_time},
+        {MPV_RENDER_PARAM_INVALID, NULL},
+    };
+    mpv_render_context_render(render_context, params);
+    
+    // Unbind FBO
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  }
   
-  // Unbind FBO
-  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  if (self->has_timer_query) {
+    glQueryCounterEXT(back_buf->time_queries[1], GL_TIMESTAMP_EXT);
+    back_buf->time_queries_pending = TRUE;
+  }
   
   // Flush to ensure rendering commands are submitted to GPU
   glFlush();
@@ -346,9 +683,71 @@ gboolean texture_gl_render(TextureGL* self) {
   EGLSyncKHR new_sync = eglCreateSyncKHR(egl_display, EGL_SYNC_FENCE_KHR, NULL);
   back_buf->render_sync.store(new_sync, std::memory_order_release);
   
+  if (!self->has_timer_query) {
+    self->render_time.fetch_add(g_get_monotonic_time() - start_time,
+                                std::memory_order_relaxed);
+  }
+  
   return TRUE;
 }
 
+void texture_gl_tap(TextureGL* self, FrameTap* tap, gint64 time) {
+  RenderBuffer* back_buf = &self->buffers[self->back_index];
+  if (back_buf->fbo == 0) {
+    return;
+  }
+  TRACE_SCOPE("texture_gl_tap", video_output_get_handle(self->video_output));
+  gint32 width = self->current_width;
+  gint32 height = self->current_height;
+  gint32 tap_width = 0, tap_height = 0;
+  tap->GetSize(width, height, &tap_width, &tap_height);
+  if (tap_width <= 0 || tap_height <= 0) {
+    return;
+  }
+  // Downscaled on the GPU where glBlitFramebuffer (GLES 3) is available, so
+  // that only the frame's pixels are read back; otherwise by |tap|.
+  gboolean scale = (tap_width != width || tap_height != height) &&
+                   epoxy_gl_version() >= 30;
+  if (scale) {
+    if (self->tap_width != tap_width || self->tap_height != tap_height) {
+      if (self->tap_fbo == 0) {
+        glGenFramebuffers(1, &self->tap_fbo);
+        glGenTextures(1, &self->tap_texture);
+      }
+      glBindTexture(GL_TEXTURE_2D, self->tap_texture);
+      glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, tap_width, tap_height, 0,
+                   GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+      glBindTexture(GL_TEXTURE_2D, 0);
+      glBindFramebuffer(GL_FRAMEBUFFER, self->tap_fbo);
+      glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                             GL_TEXTURE_2D, self->tap_texture, 0);
+      self->tap_width = tap_width;
+      self->tap_height = tap_height;
+    }
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, back_buf->fbo);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, self->tap_fbo);
+    glBlitFramebuffer(0, 0, width, height, 0, 0, tap_width, tap_height,
+                      GL_COLOR_BUFFER_BIT, GL_LINEAR);
+    glBindFramebuffer(GL_FRAMEBUFFER, self->tap_fbo);
+    width = tap_width;
+    height = tap_height;
+  } else {
+    glBindFramebuffer(GL_FRAMEBUFFER, back_buf->fbo);
+  }
+  gsize size = (gsize)width * height * 4;
+  if (self->tap_pixels_size < size) {
+    self->tap_pixels = (guint8*)g_realloc(self->tap_pixels, size);
+    self->tap_pixels_size = size;
+  }
+  // Waits for the render; rows are top to bottom, as mpv renders with FLIP_Y
+  // unset.
+  glPixelStorei(GL_PACK_ALIGNMENT, 4);
+  glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE,
+               self->tap_pixels);
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  tap->Deliver(self->tap_pixels, width, height, width * 4, time);
+}
+
 /**
  * Publishes the rendered frame using mailbox swap.
  * Atomically swaps back buffer with mailbox and sets dirty flag in ONE operation.
@@ -376,6 +775,8 @@ gboolean texture_gl_populate_texture(FlTextureGL* texture,
                                      GError** error) {
   TextureGL* self = TEXTURE_GL(texture);
   VideoOutput* video_output = self->video_output;
+  TRACE_SCOPE("texture_gl_populate_texture",
+              video_output_get_handle(video_output));
   GLRenderThread* gl_thread = video_output_get_gl_render_thread(video_output);
   EGLDisplay egl_display = video_output_get_egl_display(video_output);
   
@@ -434,7 +835,12 @@ gboolean texture_gl_populate_texture(FlTextureGL* texture,
   if (sync != EGL_NO_SYNC_KHR) {
     // Use GPU-side wait for better performance (doesn't block CPU)
     // This inserts a wait into Flutter's GL command stream
-    if (epoxy_has_egl_extension(egl_display, "EGL_KHR_wait_sync")) {
+    // Looked up once; it's a search through the extension string.
+    if (self->has_wait_sync < 0) {
+      self->has_wait_sync =
+          epoxy_has_egl_extension(egl_display, "EGL_KHR_wait_sync");
+    }
+    if (self->has_wait_sync) {
       eglWaitSyncKHR(egl_display, sync, 0);
     } else {
       // Fallback to CPU wait if eglWaitSyncKHR not available
@@ -0,0 +1,560 @@
+// This file is a part of media_kit
+// (https://github.com/media-kit/media-kit).
+//
+// Copyright © 2026 & onwards, Predidit.
+// All rights reserved.
+// Use of this source code is governed by MIT license that can be found in the
+// LICENSE file.
+
+#include "include/media_kit_video/texture_overlay.h"
+
+#include <dlfcn.h>
+#include <pango/pangocairo.h>
+#include <stdint.h>
+#include <string.h>
+
+// mpv's default `sub-font-size` is 55 scaled for a 720 pixel tall frame.
+#define OVERLAY_FONT_SIZE_REFERENCE 55.0
+#define OVERLAY_FONT_HEIGHT_REFERENCE 720.0
+
+// Subset of libass' API (ass.h, 0.13+). Resolved at runtime from the libass
+// libmpv is linked with, so that the plugin does not need its headers.
+typedef struct ass_library ASS_Library;
+typedef struct ass_renderer ASS_Renderer;
+typedef struct ass_track ASS_Track;
+typedef struct ass_image {
+  int w, h;
+  int stride;
+  unsigned char* bitmap;
+  uint32_t color;  // RGBA, alpha being the transparency.
+  int dst_x, dst_y;
+  struct ass_image* next;
+  int type;
+} ASS_Image;
+#define ASS_FONTPROVIDER_AUTODETECT 1
+
+typedef struct {
+  ASS_Library* (*ass_library_init)();
+  void (*ass_library_done)(ASS_Library*);
+  ASS_Renderer* (*ass_renderer_init)(ASS_Library*);
+  void (*ass_renderer_done)(ASS_Renderer*);
+  void (*ass_set_frame_size)(ASS_Renderer*, int, int);
+  void (*ass_set_storage_size)(ASS_Renderer*, int, int);
+  void (*ass_set_fonts)(ASS_Renderer*,
+                        const char*,
+                        const char*,
+                        int,
+                        const char*,
+                        int);
+  ASS_Track* (*ass_new_track)(ASS_Library*);
+  void (*ass_free_track)(ASS_Track*);
+  void (*ass_process_codec_private)(ASS_Track*, const char*, int);
+  void (*ass_process_chunk)(ASS_Track*,
+                            const char*,
+                            int,
+                            long long,
+                            long long);
+  void (*ass_flush_events)(ASS_Track*);
+  ASS_Image* (*ass_render_frame)(ASS_Renderer*, ASS_Track*, long long, int*);
+} AssFunctions;
+
+// Header of the track when mpv does not provide `sub-ass-extradata` (< 0.36):
+// FFmpeg's default for text subtitles.
+static const gchar* kDefaultAssHeader =
+    "[Script Info]\n"
+    "ScriptType: v4.00+\n"
+    "PlayResX: 384\n"
+    "PlayResY: 288\n"
+    "ScaledBorderAndShadow: yes\n"
+    "\n"
+    "[V4+ Styles]\n"
+    "Format: Name, Fontname, Fontsize, PrimaryColour, SecondaryColour, "
+    "OutlineColour, BackColour, Bold, Italic, Underline, StrikeOut, ScaleX, "
+    "ScaleY, Spacing, Angle, BorderStyle, Outline, Shadow, Alignment, MarginL, "
+    "MarginR, MarginV, Encoding\n"
+    "Style: Default,sans-serif,16,&Hffffff,&Hffffff,&H0,&H0,0,0,0,0,100,100,0,"
+    "0,1,1,0,2,10,10,10,1\n"
+    "\n"
+    "[Events]\n"
+    "Format: Layer, Start, End, Style, Name, MarginL, MarginR, MarginV, "
+    "Effect, Text\n";
+
+// libass state of a |TextureOverlay|. Only used by the thread calling
+// |texture_overlay_update_ass|.
+typedef struct {
+  ASS_Library* library;
+  ASS_Renderer* renderer;
+  ASS_Track* track;
+  gchar* header;  // |track| was created from.
+  gint read_order;
+} OverlayAss;
+
+// Bitmap handed out to the raster thread in |texture_overlay_copy_pixels|.
+typedef struct {
+  guint8* pixels;
+  guint32 width;
+  guint32 height;
+} OverlayBitmap;
+
+/**
+ * Two bitmaps are kept: |front| is owned by Flutter's raster thread (the
+ * pointer returned from |copy_pixels| must stay valid until the next call),
+ * |pending| is the latest bitmap produced by the GL thread & only valid while
+ * |dirty| is set. |copy_pixels| promotes |pending| to |front|, so the producer
+ * never frees memory which is being uploaded.
+ */
+struct _TextureOverlay {
+  FlPixelBufferTexture parent_instance;
+  GMutex mutex;
+  OverlayBitmap front;
+  OverlayBitmap pending;
+  gboolean dirty;
+  gchar* text;
+  gchar* header;  // ASS header of |text|; NULL for plain text.
+  OverlayAss ass;
+  gint64 frame_width;
+  gint64 frame_height;
+};
+
+G_DEFINE_TYPE(TextureOverlay, texture_overlay, fl_pixel_buffer_texture_get_type())
+
+// A fully transparent 1x1 pixel, used whenever there is no subtitle.
+static guint8 empty_pixel[4] = {0, 0, 0, 0};
+
+static void overlay_bitmap_clear(OverlayBitmap* bitmap) {
+  if (bitmap->pixels != NULL && bitmap->pixels != empty_pixel) {
+    g_free(bitmap->pixels);
+  }
+  bitmap->pixels = empty_pixel;
+  bitmap->width = 1;
+  bitmap->height = 1;
+}
+
+template <typename T>
+static void texture_overlay_resolve(gpointer library, T& function,
+                                    const gchar* name) {
+  function = reinterpret_cast<T>(dlsym(library, name));
+}
+
+/**
+ * Returns libass' functions, or NULL if libass is not loaded in the process.
+ * libmpv links it dynamically, even when bundled.
+ */
+static const AssFunctions* texture_overlay_get_ass_functions() {
+  static AssFunctions functions;
+  static gboolean available = FALSE;
+  static gsize once = 0;
+  if (g_once_init_enter(&once)) {
+    gpointer library = dlopen("libass.so.9", RTLD_LAZY | RTLD_NOLOAD);
+    if (library == NULL) {
+      library = RTLD_DEFAULT;
+    }
+    texture_overlay_resolve(library, functions.ass_library_init,
+                            "ass_library_init");
+    texture_overlay_resolve(library, functions.ass_library_done,
+                            "ass_library_done");
+    texture_overlay_resolve(library, functions.ass_renderer_init,
+                            "ass_renderer_init");
+    texture_overlay_resolve(library, functions.ass_renderer_done,
+                            "ass_renderer_done");
+    texture_overlay_resolve(library, functions.ass_set_frame_size,
+                            "ass_set_frame_size");
+    texture_overlay_resolve(library, functions.ass_set_storage_size,
+                            "ass_set_storage_size");
+    texture_overlay_resolve(library, functions.ass_set_fonts, "ass_set_fonts");
+    texture_overlay_resolve(library, functions.ass_new_track, "ass_new_track");
+    texture_overlay_resolve(library, functions.ass_free_track,
+                            "ass_free_track");
+    texture_overlay_resolve(library, functions.ass_process_codec_private,
+                            "ass_process_codec_private");
+    texture_overlay_resolve(library, functions.ass_process_chunk,
+                            "ass_process_chunk");
+    texture_overlay_resolve(library, functions.ass_flush_events,
+                            "ass_flush_events");
+    texture_overlay_resolve(library, functions.ass_render_frame,
+                            "ass_render_frame");
+    // |ass_set_storage_size| is optional.
+    available = functions.ass_library_init != NULL &&
+                functions.ass_library_done != NULL &&
+                functions.ass_renderer_init != NULL &&
+                functions.ass_renderer_done != NULL &&
+                functions.ass_set_frame_size != NULL &&
+                functions.ass_set_fonts != NULL &&
+                functions.ass_new_track != NULL &&
+                functions.ass_free_track != NULL &&
+                functions.ass_process_codec_private != NULL &&
+                functions.ass_process_chunk != NULL &&
+                functions.ass_flush_events != NULL &&
+                functions.ass_render_frame != NULL;
+    g_once_init_leave(&once, 1);
+  }
+  return available ? &functions : NULL;
+}
+
+gboolean texture_overlay_is_ass_supported() {
+  return texture_overlay_get_ass_functions() != NULL;
+}
+
+static void texture_overlay_init(TextureOverlay* self) {
+  g_mutex_init(&self->mutex);
+  self->front.pixels = NULL;
+  self->pending.pixels = NULL;
+  overlay_bitmap_clear(&self->front);
+  overlay_bitmap_clear(&self->pending);
+  self->dirty = FALSE;
+  self->text = NULL;
+  self->header = NULL;
+  memset(&self->ass, 0, sizeof(self->ass));
+  self->frame_width = 0;
+  self->frame_height = 0;
+}
+
+static void texture_overlay_dispose(GObject* object) {
+  TextureOverlay* self = TEXTURE_OVERLAY(object);
+  g_mutex_lock(&self->mutex);
+  overlay_bitmap_clear(&self->front);
+  if (self->dirty) {
+    overlay_bitmap_clear(&self->pending);
+    self->dirty = FALSE;
+  }
+  g_clear_pointer(&self->text, g_free);
+  g_clear_pointer(&self->header, g_free);
+  g_mutex_unlock(&self->mutex);
+  // Only created if libass is available.
+  const AssFunctions* ass = texture_overlay_get_ass_functions();
+  if (ass != NULL) {
+    if (self->ass.track != NULL) {
+      ass->ass_free_track(self->ass.track);
+    }
+    if (self->ass.renderer != NULL) {
+      ass->ass_renderer_done(self->ass.renderer);
+    }
+    if (self->ass.library != NULL) {
+      ass->ass_library_done(self->ass.library);
+    }
+  }
+  g_clear_pointer(&self->ass.header, g_free);
+  memset(&self->ass, 0, sizeof(self->ass));
+  G_OBJECT_CLASS(texture_overlay_parent_class)->dispose(object);
+}
+
+static void texture_overlay_finalize(GObject* object) {
+  TextureOverlay* self = TEXTURE_OVERLAY(object);
+  g_mutex_clear(&self->mutex);
+  G_OBJECT_CLASS(texture_overlay_parent_class)->finalize(object);
+}
+
+static void texture_overlay_class_init(TextureOverlayClass* klass) {
+  FL_PIXEL_BUFFER_TEXTURE_CLASS(klass)->copy_pixels =
+      texture_overlay_copy_pixels;
+  G_OBJECT_CLASS(klass)->dispose = texture_overlay_dispose;
+  G_OBJECT_CLASS(klass)->finalize = texture_overlay_finalize;
+}
+
+TextureOverlay* texture_overlay_new() {
+  return TEXTURE_OVERLAY(g_object_new(texture_overlay_get_type(), NULL));
+}
+
+/**
+ * Rasterizes |text| with Pango into a new premultiplied RGBA bitmap.
+ * Cairo's ARGB32 is premultiplied & stored as BGRA on little-endian, so only
+ * the red & blue channels need to be swapped for Flutter's GL_RGBA upload.
+ */
+static OverlayBitmap texture_overlay_rasterize(const gchar* text,
+                                               gint64 frame_width,
+                                               gint64 frame_height) {
+  OverlayBitmap bitmap = {empty_pixel, 1, 1};
+  if (text == NULL || *text == '\0' || frame_width < 1 || frame_height < 1) {
+    return bitmap;
+  }
+
+  gdouble font_size = OVERLAY_FONT_SIZE_REFERENCE * frame_height /
+                      OVERLAY_FONT_HEIGHT_REFERENCE;
+  gdouble outline = MAX(1.0, font_size / 18.0);
+  gint margin = (gint)(outline * 2.0);
+
+  // Measure the text block first, with the width limited to the frame.
+  cairo_surface_t* measure_surface =
+      cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 1, 1);
+  cairo_t* measure_cr = cairo_create(measure_surface);
+  PangoLayout* layout = pango_cairo_create_layout(measure_cr);
+  PangoFontDescription* font = pango_font_description_from_string("Sans Bold");
+  pango_font_description_set_absolute_size(font, font_size * PANGO_SCALE);
+  pango_layout_set_font_description(layout, font);
+  pango_layout_set_alignment(layout, PANGO_ALIGN_CENTER);
+  pango_layout_set_wrap(layout, PANGO_WRAP_WORD_CHAR);
+  pango_layout_set_width(layout,
+                         (gint)(frame_width - 2 * margin) * PANGO_SCALE);
+  pango_layout_set_text(layout, text, -1);
+  gint text_width = 0, text_height = 0;
+  pango_layout_get_pixel_size(layout, &text_width, &text_height);
+
+  guint32 width = (guint32)frame_width;
+  guint32 height = (guint32)CLAMP(text_height + 2 * margin, 1, frame_height);
+
+  cairo_surface_t* surface =
+      cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+  cairo_t* cr = cairo_create(surface);
+  pango_cairo_update_layout(cr, layout);
+  cairo_move_to(cr, margin, margin);
+  pango_cairo_layout_path(cr, layout);
+  cairo_set_line_join(cr, CAIRO_LINE_JOIN_ROUND);
+  cairo_set_line_width(cr, outline * 2.0);
+  cairo_set_source_rgba(cr, 0.0, 0.0, 0.0, 1.0);
+  cairo_stroke_preserve(cr);
+  cairo_set_source_rgba(cr, 1.0, 1.0, 1.0, 1.0);
+  cairo_fill(cr);
+  cairo_surface_flush(surface);
+
+  bitmap.width = width;
+  bitmap.height = height;
+  bitmap.pixels = g_new(guint8, (gsize)width * height * 4);
+  const guint8* data = cairo_image_surface_get_data(surface);
+  gint stride = cairo_image_surface_get_stride(surface);
+  for (guint32 y = 0; y < height; y++) {
+    const guint8* src = data + (gsize)y * stride;
+    guint8* dst = bitmap.pixels + (gsize)y * width * 4;
+    for (guint32 x = 0; x < width; x++) {
+      dst[4 * x + 0] = src[4 * x + 2];
+      dst[4 * x + 1] = src[4 * x + 1];
+      dst[4 * x + 2] = src[4 * x + 0];
+      dst[4 * x + 3] = src[4 * x + 3];
+    }
+  }
+
+  cairo_destroy(cr);
+  cairo_surface_destroy(surface);
+  pango_font_description_free(font);
+  g_object_unref(layout);
+  cairo_destroy(measure_cr);
+  cairo_surface_destroy(measure_surface);
+  return bitmap;
+}
+
+/**
+ * Renders the events of |text| with libass into a new premultiplied RGBA
+ * bitmap, as wide as the frame & spanning from the topmost glyph to the
+ * bottom of the frame. Each line of |text| is an event, shown for as long as
+ * the overlay holds it.
+ */
+static OverlayBitmap texture_overlay_rasterize_ass(TextureOverlay* self,
+                                                   const gchar* header,
+                                                   const gchar* text,
+                                                   gint64 frame_width,
+                                                   gint64 frame_height) {
+  OverlayBitmap bitmap = {empty_pixel, 1, 1};
+  const AssFunctions* ass = texture_overlay_get_ass_functions();
+  OverlayAss* state = &self->ass;
+  if (ass == NULL || text == NULL || *text == '\0' || frame_width < 1 ||
+      frame_height < 1) {
+    return bitmap;
+  }
+  if (state->library == NULL) {
+    state->library = ass->ass_library_init();
+    if (state->library == NULL) {
+      return bitmap;
+    }
+  }
+  if (state->renderer == NULL) {
+    state->renderer = ass->ass_renderer_init(state->library);
+    if (state->renderer == NULL) {
+      return bitmap;
+    }
+    // Scans the system fonts through fontconfig, once per overlay.
+    ass->ass_set_fonts(state->renderer, NULL, "sans-serif",
+                       ASS_FONTPROVIDER_AUTODETECT, NULL, 1);
+  }
+  if (state->track == NULL || g_strcmp0(state->header, header) != 0) {
+    if (state->track != NULL) {
+      ass->ass_free_track(state->track);
+    }
+    state->track = ass->ass_new_track(state->library);
+    if (state->track == NULL) {
+      return bitmap;
+    }
+    ass->ass_process_codec_private(state->track, header, (int)strlen(header));
+    g_free(state->header);
+    state->header = g_strdup(header);
+  }
+
+  ass->ass_flush_events(state->track);
+  gchar** events = g_strsplit(text, "\n", -1);
+  for (gchar** event = events; *event != NULL; event++) {
+    if (**event == '\0') {
+      continue;
+    }
+    // Matroska's block layout: ReadOrder, Layer, Style, Name, MarginL,
+    // MarginR, MarginV, Effect, Text. Read orders are never reused, in case
+    // |ass_flush_events| does not forget them.
+    gchar* chunk = g_strdup_printf("%d,0,Default,,0,0,0,,%s",
+                                   state->read_order++, *event);
+    ass->ass_process_chunk(state->track, chunk, (int)strlen(chunk), 0,
+                           G_MAXINT32);
+    g_free(chunk);
+  }
+  g_strfreev(events);
+
+  ass->ass_set_frame_size(state->renderer, (int)frame_width,
+                          (int)frame_height);
+  if (ass->ass_set_storage_size != NULL) {
+    ass->ass_set_storage_size(state->renderer, (int)frame_width,
+                              (int)frame_height);
+  }
+  int changed = 0;
+  ASS_Image* images =
+      ass->ass_render_frame(state->renderer, state->track, 0, &changed);
+  gint64 top = frame_height;
+  for (ASS_Image* image = images; image != NULL; image = image->next) {
+    if (image->w > 0 && image->h > 0) {
+      top = MIN(top, MAX(image->dst_y, 0));
+    }
+  }
+  if (top >= frame_height) {
+    return bitmap;
+  }
+
+  bitmap.width = (guint32)frame_width;
+  bitmap.height = (guint32)(frame_height - top);
+  bitmap.pixels = g_new0(guint8, (gsize)bitmap.width * bitmap.height * 4);
+  // Glyphs, outlines & shadows are alpha masks of a single color, blended
+  // back to front.
+  for (ASS_Image* image = images; image != NULL; image = image->next) {
+    guint32 r = (image->color >> 24) & 0xFF;
+    guint32 g = (image->color >> 16) & 0xFF;
+    guint32 b = (image->color >> 8) & 0xFF;
+    guint32 opacity = 255 - (image->color & 0xFF);
+    for (gint y = 0; y < image->h; y++) {
+      gint64 row = image->dst_y + y - top;
+      if (row < 0 || row >= bitmap.height) {
+        continue;
+      }
+      const guint8* src = image->bitmap + (gsize)y * image->stride;
+      guint8* dst = bitmap.pixels + (gsize)row * bitmap.width * 4;
+      for (gint x = 0; x < image->w; x++) {
+        gint64 column = image->dst_x + x;
+        if (column < 0 || column >= bitmap.width) {
+          continue;
+        }
+        guint32 a = src[x] * opacity / 255;
+        if (a == 0) {
+          continue;
+        }
+        guint8* pixel = dst + column * 4;
+        pixel[0] = (guint8)((r * a + pixel[0] * (255 - a)) / 255);
+        pixel[1] = (guint8)((g * a + pixel[1] * (255 - a)) / 255);
+        pixel[2] = (guint8)((b * a + pixel[2] * (255 - a)) / 255);
+        pixel[3] = (guint8)(a + pixel[3] * (255 - a) / 255);
+      }
+    }
+  }
+  return bitmap;
+}
+
+/**
+ * Rasterizes |text|, with libass if |header| is set, & hands the bitmap over
+ * to the raster thread. Returns TRUE if the bitmap dimensions changed.
+ */
+static gboolean texture_overlay_update_bitmap(TextureOverlay* self,
+                                              const gchar* header,
+                                              const gchar* text,
+                                              gint64 frame_width,
+                                              gint64 frame_height) {
+  g_mutex_lock(&self->mutex);
+  gboolean unchanged = g_strcmp0(self->text, text) == 0 &&
+                       g_strcmp0(self->header, header) == 0 &&
+                       self->frame_width == frame_width &&
+                       self->frame_height == frame_height;
+  g_mutex_unlock(&self->mutex);
+  if (unchanged) {
+    return FALSE;
+  }
+
+  // Rasterize outside the lock; only the pointer swap is synchronized.
+  OverlayBitmap bitmap =
+      header != NULL ? texture_overlay_rasterize_ass(self, header, text,
+                                                     frame_width, frame_height)
+                     : texture_overlay_rasterize(text, frame_width,
+                                                 frame_height);
+
+  g_mutex_lock(&self->mutex);
+  OverlayBitmap* current = self->dirty ? &self->pending : &self->front;
+  gboolean resized =
+      current->width != bitmap.width || current->height != bitmap.height;
+  if (self->dirty) {
+    // Never promoted to |front|; safe to free.
+    overlay_bitmap_clear(&self->pending);
+  }
+  self->pending = bitmap;
+  self->dirty = TRUE;
+  g_free(self->text);
+  self->text = g_strdup(text);
+  g_free(self->header);
+  self->header = g_strdup(header);
+  self->frame_width = frame_width;
+  self->frame_height = frame_height;
+  g_mutex_unlock(&self->mutex);
+  return resized;
+}
+
+gboolean texture_overlay_update(TextureOverlay* self,
+                                const gchar* text,
+                                gint64 frame_width,
+                                gint64 frame_height) {
+  return texture_overlay_update_bitmap(self, NULL, text, frame_width,
+                                       frame_height);
+}
+
+gboolean texture_overlay_update_ass(TextureOverlay* self,
+                                    const gchar* header,
+                                    const gchar* text,
+                                    gint64 frame_width,
+                                    gint64 frame_height) {
+  if (header == NULL || *header == '\0') {
+    header = kDefaultAssHeader;
+  }
+  return texture_overlay_update_bitmap(self, header, text, frame_width,
+                                       frame_height);
+}
+
+gint64 texture_overlay_get_width(TextureOverlay* self) {
+  g_mutex_lock(&self->mutex);
+  gint64 width = self->dirty ? self->pending.width : self->front.width;
+  g_mutex_unlock(&self->mutex);
+  return width;
+}
+
+gint64 texture_overlay_get_height(TextureOverlay* self) {
+  g_mutex_lock(&self->mutex);
+  gint64 height = self->dirty ? self->pending.height : self->front.height;
+  g_mutex_unlock(&self->mutex);
+  return height;
+}
+
+gint64 texture_overlay_get_size_in_bytes(TextureOverlay* self) {
+  g_mutex_lock(&self->mutex);
+  gint64 size = (gint64)self->front.width * self->front.height * 4;
+  if (self->dirty) {
+    size += (gint64)self->pending.width * self->pending.height * 4;
+  }
+  g_mutex_unlock(&self->mutex);
+  return size;
+}
+
+gboolean texture_overlay_copy_pixels(FlPixelBufferTexture* texture,
+                                     const guint8** buffer,
+                                     guint32* width,
+                                     guint32* height,
+                                     GError** error) {
+  TextureOverlay* self = TEXTURE_OVERLAY(texture);
+  g_mutex_lock(&self->mutex);
+  if (self->dirty) {
+    overlay_bitmap_clear(&self->front);
+    self->front = self->pending;
+    self->dirty = FALSE;
+  }
+  *buffer = self->front.pixels;
+  *width = self->front.width;
+  *height = self->front.height;
+  g_mutex_unlock(&self->mutex);
+  return TRUE;
+}
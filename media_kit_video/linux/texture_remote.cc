@@ -0,0 +1,223 @@
+// This file is a part of media_kit
+// (https://github.com/media-kit/media-kit).
+//
+// Copyright © 2026 & onwards, Predidit.
+// All rights reserved.
+// Use of this source code is governed by MIT license that can be found in the
+// LICENSE file.
+
+#include "include/media_kit_video/texture_remote.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+// Frames of a generation, mapped from the player host's memfd.
+typedef struct {
+  guint8* data;
+  gsize size;
+  gint64 generation;
+  gint32 width;
+  gint32 height;
+  gint32 stride;
+  gint32 count;
+} TextureRemoteBuffers;
+
+struct _TextureRemote {
+  FlPixelBufferTexture parent_instance;
+  GMutex mutex;
+  GList* buffers;                   /* Mapped generations, latest first. */
+  TextureRemoteBuffers* front;      /* Generation of the displayed frame. */
+  gint32 front_index;               /* Displayed frame, -1 if none. */
+  TextureRemoteBuffers* pending;    /* Generation of the queued frame. */
+  gint32 pending_index;             /* Queued frame, -1 if none. */
+  TextureRemoteReleaseCallback release_callback;
+  gpointer release_callback_context;
+};
+
+G_DEFINE_TYPE(TextureRemote, texture_remote, fl_pixel_buffer_texture_get_type())
+
+static void texture_remote_buffers_free(gpointer data) {
+  TextureRemoteBuffers* buffers = (TextureRemoteBuffers*)data;
+  munmap(buffers->data, buffers->size);
+  g_free(buffers);
+}
+
+static void texture_remote_init(TextureRemote* self) {
+  g_mutex_init(&self->mutex);
+  self->buffers = NULL;
+  self->front = NULL;
+  self->front_index = -1;
+  self->pending = NULL;
+  self->pending_index = -1;
+  self->release_callback = NULL;
+  self->release_callback_context = NULL;
+}
+
+static void texture_remote_dispose(GObject* object) {
+  TextureRemote* self = TEXTURE_REMOTE(object);
+  g_list_free_full(self->buffers, texture_remote_buffers_free);
+  self->buffers = NULL;
+  self->front = self->pending = NULL;
+  G_OBJECT_CLASS(texture_remote_parent_class)->dispose(object);
+}
+
+static void texture_remote_finalize(GObject* object) {
+  g_mutex_clear(&TEXTURE_REMOTE(object)->mutex);
+  G_OBJECT_CLASS(texture_remote_parent_class)->finalize(object);
+}
+
+static void texture_remote_class_init(TextureRemoteClass* klass) {
+  FL_PIXEL_BUFFER_TEXTURE_CLASS(klass)->copy_pixels =
+      texture_remote_copy_pixels;
+  G_OBJECT_CLASS(klass)->dispose = texture_remote_dispose;
+  G_OBJECT_CLASS(klass)->finalize = texture_remote_finalize;
+}
+
+TextureRemote* texture_remote_new(TextureRemoteReleaseCallback release_callback,
+                                  gpointer release_callback_context) {
+  TextureRemote* self =
+      TEXTURE_REMOTE(g_object_new(texture_remote_get_type(), NULL));
+  self->release_callback = release_callback;
+  self->release_callback_context = release_callback_context;
+  return self;
+}
+
+gboolean texture_remote_set_buffers(TextureRemote* self,
+                                    gint fd,
+                                    gint64 generation,
+                                    gint32 width,
+                                    gint32 height,
+                                    gint32 stride,
+                                    gint32 count) {
+  gboolean valid = fd >= 0 && width > 0 && height > 0 && count > 0 &&
+                   stride >= width * 4;
+  gsize size = valid ? (gsize)stride * height * count : 0;
+  void* data = valid ? mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0)
+                     : MAP_FAILED;
+  if (fd >= 0) {
+    close(fd);
+  }
+  if (data == MAP_FAILED) {
+    return FALSE;
+  }
+  TextureRemoteBuffers* buffers = g_new0(TextureRemoteBuffers, 1);
+  buffers->data = (guint8*)data;
+  buffers->size = size;
+  buffers->generation = generation;
+  buffers->width = width;
+  buffers->height = height;
+  buffers->stride = stride;
+  buffers->count = count;
+  g_mutex_lock(&self->mutex);
+  self->buffers = g_list_prepend(self->buffers, buffers);
+  g_mutex_unlock(&self->mutex);
+  return TRUE;
+}
+
+void texture_remote_push_frame(TextureRemote* self,
+                               gint64 generation,
+                               gint32 index) {
+  gint64 released_generation = -1;
+  gint32 released_index = -1;
+  g_mutex_lock(&self->mutex);
+  TextureRemoteBuffers* buffers =
+      self->buffers != NULL ? (TextureRemoteBuffers*)self->buffers->data
+                            : NULL;
+  if (buffers == NULL || buffers->generation != generation || index < 0 ||
+      index >= buffers->count) {
+    // Frames of a generation without buffers are never written to again.
+    g_mutex_unlock(&self->mutex);
+    return;
+  }
+  if (self->pending != NULL) {
+    released_generation = self->pending->generation;
+    released_index = self->pending_index;
+  }
+  self->pending = buffers;
+  self->pending_index = index;
+  g_mutex_unlock(&self->mutex);
+  if (released_index >= 0) {
+    self->release_callback(released_generation, released_index,
+                           self->release_callback_context);
+  }
+}
+
+void texture_remote_clear(TextureRemote* self) {
+  GList* buffers = NULL;
+  gint64 released_generations[2] = {-1, -1};
+  gint32 released_indices[2] = {-1, -1};
+  g_mutex_lock(&self->mutex);
+  if (self->front != NULL) {
+    released_generations[0] = self->front->generation;
+    released_indices[0] = self->front_index;
+  }
+  if (self->pending != NULL) {
+    released_generations[1] = self->pending->generation;
+    released_indices[1] = self->pending_index;
+  }
+  buffers = self->buffers;
+  self->buffers = NULL;
+  self->front = self->pending = NULL;
+  self->front_index = self->pending_index = -1;
+  g_mutex_unlock(&self->mutex);
+  g_list_free_full(buffers, texture_remote_buffers_free);
+  for (gsize i = 0; i < G_N_ELEMENTS(released_indices); i++) {
+    if (released_indices[i] >= 0) {
+      self->release_callback(released_generations[i], released_indices[i],
+                             self->release_callback_context);
+    }
+  }
+}
+
+gboolean texture_remote_copy_pixels(FlPixelBufferTexture* texture,
+                                    const guint8** buffer,
+                                    guint32* width,
+                                    guint32* height,
+                                    GError** error) {
+  // Shown until the first frame.
+  static const guint8 kBlack[4] = {0, 0, 0, 255};
+  TextureRemote* self = TEXTURE_REMOTE(texture);
+  gint64 released_generation = -1;
+  gint32 released_index = -1;
+  GList* unused = NULL;
+  g_mutex_lock(&self->mutex);
+  // Flutter is done with the previous frame by the time it asks for the next
+  // one: only then it is released & unused generations are unmapped.
+  if (self->pending != NULL) {
+    if (self->front != NULL) {
+      released_generation = self->front->generation;
+      released_index = self->front_index;
+    }
+    self->front = self->pending;
+    self->front_index = self->pending_index;
+    self->pending = NULL;
+    self->pending_index = -1;
+  }
+  for (GList* it = self->buffers != NULL ? self->buffers->next : NULL;
+       it != NULL;) {
+    GList* next = it->next;
+    if (it->data != self->front) {
+      self->buffers = g_list_remove_link(self->buffers, it);
+      unused = g_list_concat(unused, it);
+    }
+    it = next;
+  }
+  if (self->front != NULL) {
+    TextureRemoteBuffers* front = self->front;
+    *buffer = front->data + (gsize)front->stride * front->height *
+                                self->front_index;
+    *width = front->width;
+    *height = front->height;
+  } else {
+    *buffer = kBlack;
+    *width = 1;
+    *height = 1;
+  }
+  g_mutex_unlock(&self->mutex);
+  g_list_free_full(unused, texture_remote_buffers_free);
+  if (released_index >= 0) {
+    self->release_callback(released_generation, released_index,
+                           self->release_callback_context);
+  }
+  return TRUE;
+}
@@ -0,0 +1,844 @@
+// This file is a part of media_kit
+// (https://github.com/media-kit/media-kit).
+//
+// Copyright © 2026 & onwards, Predidit.
+// All rights reserved.
+// Use of this source code is governed by MIT license that can be found in the
+// LICENSE file.
+
+#include "include/media_kit_video/thumbnail_store.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+// Bumped whenever the persisted layout changes.
+#define THUMBNAIL_STORE_MAGIC "MKTS"
+#define THUMBNAIL_STORE_VERSION 1
+
+// Slots of an empty index. A power of 2.
+#define THUMBNAIL_STORE_INITIAL_CAPACITY 4096
+
+// Of the tiles in the data file, so that raw pixels are aligned.
+#define THUMBNAIL_STORE_ALIGNMENT 16
+
+#define THUMBNAIL_STORE_MAX_TILE_SIZE (16 * 1024 * 1024)
+
+// Address space mapped past the data file, beyond 4 times |max_size|: room
+// for the tiles appended until the next compaction. Pages past the end of
+// the file are never read.
+#define THUMBNAIL_STORE_MIN_RESERVATION (16 * 1024 * 1024)
+
+namespace {
+
+enum SlotState : uint8_t {
+  SLOT_EMPTY = 0,
+  SLOT_FULL = 1,
+  SLOT_REMOVED = 2,  // Probed past like a full slot, reused by inserts.
+};
+
+// Header of the index, followed by |capacity| slots. Native byte order.
+struct IndexHeader {
+  char magic[4];
+  uint32_t version;
+  uint32_t generation;  // Of the data file.
+  uint32_t clean;       // Cleared while a store has the index open.
+  uint64_t capacity;
+  uint64_t count;    // Full slots.
+  uint64_t removed;  // Removed slots.
+  uint64_t size;     // Bytes of the tiles of the full slots.
+  uint64_t clock;    // Last |Slot::use|.
+  uint64_t end;      // Size of the data file when the index was closed.
+};
+
+static_assert(sizeof(IndexHeader) == 64, "IndexHeader must be 64 bytes.");
+
+// FNV-1a.
+uint64_t HashMedia(const std::string& media) {
+  uint64_t hash = 0xcbf29ce484222325ull;
+  for (char c : media) {
+    hash = (hash ^ (uint8_t)c) * 0x100000001b3ull;
+  }
+  return hash;
+}
+
+// splitmix64 finalizer.
+uint64_t Mix(uint64_t value) {
+  value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+  value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+  return value ^ (value >> 31);
+}
+
+uint64_t HashKey(uint64_t media, int64_t time, int32_t size) {
+  return Mix(media ^ Mix((uint64_t)time ^ ((uint64_t)(uint32_t)size << 48)));
+}
+
+uint64_t Align(uint64_t offset) {
+  return (offset + THUMBNAIL_STORE_ALIGNMENT - 1) &
+         ~(uint64_t)(THUMBNAIL_STORE_ALIGNMENT - 1);
+}
+
+// Smallest capacity keeping |count| tiles under half of the slots.
+uint64_t GetCapacity(uint64_t count) {
+  uint64_t capacity = THUMBNAIL_STORE_INITIAL_CAPACITY;
+  while ((count + 1) * 2 > capacity) {
+    capacity *= 2;
+  }
+  return capacity;
+}
+
+bool WriteAll(int fd, const void* data, uint64_t size, uint64_t offset) {
+  const uint8_t* p = (const uint8_t*)data;
+  while (size > 0) {
+    ssize_t written = pwrite(fd, p, size, (off_t)offset);
+    if (written < 0 && errno == EINTR) {
+      continue;
+    }
+    if (written <= 0) {
+      return false;
+    }
+    p += written;
+    size -= written;
+    offset += written;
+  }
+  return true;
+}
+
+// mkdir -p.
+bool MakeDirectories(const std::string& path) {
+  for (size_t i = 1; i <= path.size(); i++) {
+    if (i == path.size() || path[i] == '/') {
+      std::string parent = path.substr(0, i);
+      if (mkdir(parent.c_str(), 0755) != 0 && errno != EEXIST) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool EndsWith(const char* name, const char* suffix) {
+  size_t size = strlen(name), suffix_size = strlen(suffix);
+  return size >= suffix_size &&
+         strcmp(name + size - suffix_size, suffix) == 0;
+}
+
+}  // namespace
+
+struct ThumbnailStore::Slot {
+  uint64_t media;  // |HashMedia|.
+  int64_t time;
+  uint64_t offset;  // In the data file.
+  uint64_t use;     // Larger is more recent.
+  uint32_t length;
+  int32_t size;
+  uint16_t width;
+  uint16_t height;
+  uint8_t format;
+  uint8_t state;  // |SlotState|, written last.
+  uint16_t reserved;
+};
+
+// The index file, mapped read-write.
+struct ThumbnailStore::Index {
+  static_assert(sizeof(Slot) == 48, "Slot must be 48 bytes.");
+
+  ~Index() {
+    if (base != MAP_FAILED) {
+      munmap(base, length);
+    }
+    if (fd >= 0) {
+      close(fd);
+    }
+  }
+
+  // Maps the index at |path|. Returns NULL if it is missing or invalid.
+  static std::unique_ptr<Index> Open(const std::string& path) {
+    auto index = std::make_unique<Index>();
+    index->fd = open(path.c_str(), O_RDWR | O_CLOEXEC);
+    struct stat info;
+    if (index->fd < 0 || fstat(index->fd, &info) != 0 ||
+        info.st_size < (off_t)sizeof(IndexHeader) || !index->Map(info.st_size)) {
+      return nullptr;
+    }
+    const IndexHeader* header = index->header;
+    uint64_t capacity = header->capacity;
+    if (memcmp(header->magic, THUMBNAIL_STORE_MAGIC, 4) != 0 ||
+        header->version != THUMBNAIL_STORE_VERSION || capacity == 0 ||
+        (capacity & (capacity - 1)) != 0 ||
+        capacity > (info.st_size - sizeof(IndexHeader)) / sizeof(Slot) ||
+        sizeof(IndexHeader) + capacity * sizeof(Slot) !=
+            (uint64_t)info.st_size) {
+      return nullptr;
+    }
+    return index;
+  }
+
+  // Creates an empty index of |capacity| slots at |path|.
+  static std::unique_ptr<Index> Create(const std::string& path,
+                                       uint64_t capacity,
+                                       uint32_t generation) {
+    auto index = std::make_unique<Index>();
+    size_t length = sizeof(IndexHeader) + capacity * sizeof(Slot);
+    index->fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC,
+                     0644);
+    // Allocated up front, so that a full disk fails here rather than with a
+    // SIGBUS while writing through the mapping.
+    if (index->fd < 0 || posix_fallocate(index->fd, 0, (off_t)length) != 0 ||
+        !index->Map(length)) {
+      unlink(path.c_str());
+      return nullptr;
+    }
+    memcpy(index->header->magic, THUMBNAIL_STORE_MAGIC, 4);
+    index->header->version = THUMBNAIL_STORE_VERSION;
+    index->header->generation = generation;
+    index->header->capacity = capacity;
+    return index;
+  }
+
+  bool Map(size_t size) {
+    base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+      return false;
+    }
+    length = size;
+    header = (IndexHeader*)base;
+    slots = (Slot*)((uint8_t*)base + sizeof(IndexHeader));
+    return true;
+  }
+
+  // Returns the full slot of the key, or NULL.
+  Slot* Find(uint64_t media, int64_t time, int32_t size) {
+    uint64_t mask = header->capacity - 1;
+    uint64_t i = HashKey(media, time, size) & mask;
+    for (uint64_t probe = 0; probe <= mask; probe++, i = (i + 1) & mask) {
+      Slot* slot = &slots[i];
+      if (slot->state == SLOT_EMPTY) {
+        return nullptr;
+      }
+      if (slot->state == SLOT_FULL && slot->media == media &&
+          slot->time == time && slot->size == size) {
+        return slot;
+      }
+    }
+    return nullptr;
+  }
+
+  // Fills the first empty or removed slot of the key, which must be absent,
+  // with |tile|. Returns false if the index is full.
+  bool Put(const Slot& tile) {
+    uint64_t mask = header->capacity - 1;
+    uint64_t i = HashKey(tile.media, tile.time, tile.size) & mask;
+    for (uint64_t probe = 0; probe <= mask; probe++, i = (i + 1) & mask) {
+      Slot* slot = &slots[i];
+      if (slot->state == SLOT_FULL) {
+        continue;
+      }
+      if (slot->state == SLOT_REMOVED) {
+        header->removed--;
+      }
+      // The state last, so that a crash in between leaves the slot removed.
+      Slot pending = tile;
+      pending.state = SLOT_REMOVED;
+      *slot = pending;
+      std::atomic_signal_fence(std::memory_order_release);
+      slot->state = SLOT_FULL;
+      header->count++;
+      header->size += tile.length;
+      return true;
+    }
+    return false;
+  }
+
+  void Drop(Slot* slot) {
+    // No probe sequence runs through a slot followed by an empty one.
+    Slot* next = &slots[(slot - slots + 1) & (header->capacity - 1)];
+    slot->state = next->state == SLOT_EMPTY ? SLOT_EMPTY : SLOT_REMOVED;
+    header->removed += slot->state == SLOT_REMOVED ? 1 : 0;
+    header->count--;
+    header->size -= slot->length;
+  }
+
+  int fd = -1;
+  void* base = MAP_FAILED;
+  size_t length = 0;
+  IndexHeader* header = nullptr;
+  Slot* slots = nullptr;
+};
+
+// A data file, mapped read-only. Shared with the leases of its tiles, so that
+// it outlives a compaction or the store while they are in use.
+struct ThumbnailStore::Data {
+  ~Data() {
+    if (base != nullptr) {
+      munmap((void*)base, length);
+    }
+    if (fd >= 0) {
+      close(fd);
+    }
+  }
+
+  std::string path;
+  uint32_t generation = 0;
+  int fd = -1;
+  const uint8_t* base = nullptr;
+  size_t length = 0;  // Mapped.
+  uint64_t end = 0;   // Of the last tile appended.
+};
+
+struct ThumbnailStore::Lease : ThumbnailTile {
+  std::shared_ptr<Data> file;
+};
+
+ThumbnailStore::ThumbnailStore(std::string directory, int64_t max_size)
+    : directory_(std::move(directory)),
+      max_size_(max_size),
+      reservation_(4 * std::max<int64_t>(max_size, 0) +
+                   THUMBNAIL_STORE_MIN_RESERVATION) {}
+
+ThumbnailStore::~ThumbnailStore() {
+  stopping_ = true;
+  std::thread compactor;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    compactor = std::move(compactor_);
+  }
+  if (compactor.joinable()) {
+    compactor.join();
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (index_ != nullptr) {
+      // Clean only once everything it refers to is on disk.
+      fdatasync(data_->fd);
+      index_->header->end = data_->end;
+      msync(index_->base, index_->length, MS_SYNC);
+      index_->header->clean = 1;
+      msync(index_->base, sizeof(IndexHeader), MS_SYNC);
+    }
+    index_.reset();
+    data_.reset();
+  }
+  if (lock_ >= 0) {
+    close(lock_);
+  }
+}
+
+bool ThumbnailStore::Open() {
+  if (directory_.empty() || max_size_ <= 0 ||
+      !MakeDirectories(directory_)) {
+    return false;
+  }
+  lock_ = open((directory_ + "/lock").c_str(), O_RDWR | O_CREAT | O_CLOEXEC,
+               0644);
+  if (lock_ < 0 || flock(lock_, LOCK_EX | LOCK_NB) != 0) {
+    if (lock_ >= 0) {
+      close(lock_);
+      lock_ = -1;
+    }
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  index_ = Index::Open(directory_ + "/index");
+  if (index_ != nullptr) {
+    data_ = OpenData(index_->header->generation, false);
+  }
+  if (index_ == nullptr || data_ == nullptr) {
+    if (!Reset()) {
+      return false;
+    }
+  } else if (!index_->header->clean || data_->end < index_->header->end) {
+    Repair();
+  }
+  index_->header->clean = 0;
+
+  // Leftovers of crashed compactions & rebuilds.
+  std::string current = GetDataPath(data_->generation);
+  DIR* directory = opendir(directory_.c_str());
+  if (directory != nullptr) {
+    struct dirent* child;
+    while ((child = readdir(directory)) != nullptr) {
+      std::string path = directory_ + "/" + child->d_name;
+      if ((strncmp(child->d_name, "tiles.", 6) == 0 && path != current) ||
+          EndsWith(child->d_name, ".tmp")) {
+        unlink(path.c_str());
+      }
+    }
+    closedir(directory);
+  }
+  // Evicts down to a |max_size| lowered since the last run.
+  if (index_->header->size > (uint64_t)max_size_) {
+    Evict();
+  }
+  evictions_ = 0;
+  MaybeCompact();
+  return true;
+}
+
+const ThumbnailTile* ThumbnailStore::Lookup(const std::string& media,
+                                            int64_t time,
+                                            int32_t size) {
+  uint64_t hash = HashMedia(media);
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (index_ == nullptr) {
+    return nullptr;
+  }
+  Slot* slot = index_->Find(hash, time, size);
+  if (slot == nullptr) {
+    return nullptr;
+  }
+  slot->use = ++index_->header->clock;
+  Lease* lease = new Lease();
+  lease->data = data_->base + slot->offset;
+  lease->length = slot->length;
+  lease->width = slot->width;
+  lease->height = slot->height;
+  lease->format = slot->format;
+  lease->reserved = 0;
+  lease->file = data_;
+  return lease;
+}
+
+void ThumbnailStore::Release(const ThumbnailTile* tile) {
+  delete static_cast<const Lease*>(tile);
+}
+
+bool ThumbnailStore::Insert(const std::string& media,
+                            int64_t time,
+                            int32_t size,
+                            ThumbnailFormat format,
+                            int32_t width,
+                            int32_t height,
+                            const void* data,
+                            int64_t length) {
+  if (length <= 0 || length > THUMBNAIL_STORE_MAX_TILE_SIZE ||
+      length > max_size_ || width < 0 || width > UINT16_MAX || height < 0 ||
+      height > UINT16_MAX || format < THUMBNAIL_FORMAT_BGRA ||
+      format > THUMBNAIL_FORMAT_PNG) {
+    return false;
+  }
+  uint64_t hash = HashMedia(media);
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (index_ == nullptr) {
+    return false;
+  }
+  // Appended, so that leases of the tile replaced stay intact.
+  uint64_t offset = Align(data_->end);
+  if (offset + length > data_->length ||
+      !WriteAll(data_->fd, data, length, offset)) {
+    return false;
+  }
+  data_->end = offset + length;
+
+  Slot* previous = index_->Find(hash, time, size);
+  if (previous != nullptr) {
+    index_->Drop(previous);
+  }
+  IndexHeader* header = index_->header;
+  if ((header->count + header->removed + 1) * 4 > header->capacity * 3) {
+    // Grown, or cleaned of removed slots.
+    Rebuild(GetCapacity(header->count + 1), data_, nullptr);
+    header = index_->header;
+  }
+  Slot tile = {};
+  tile.media = hash;
+  tile.time = time;
+  tile.offset = offset;
+  tile.use = ++header->clock;
+  tile.length = (uint32_t)length;
+  tile.size = size;
+  tile.width = (uint16_t)width;
+  tile.height = (uint16_t)height;
+  tile.format = (uint8_t)format;
+  tile.state = SLOT_FULL;
+  if (!index_->Put(tile)) {
+    return false;
+  }
+  if (header->size > (uint64_t)max_size_) {
+    Evict();
+  }
+  MaybeCompact();
+  return true;
+}
+
+bool ThumbnailStore::Remove(const std::string& media,
+                            int64_t time,
+                            int32_t size) {
+  uint64_t hash = HashMedia(media);
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (index_ == nullptr) {
+    return false;
+  }
+  Slot* slot = index_->Find(hash, time, size);
+  if (slot == nullptr) {
+    return false;
+  }
+  index_->Drop(slot);
+  MaybeCompact();
+  return true;
+}
+
+void ThumbnailStore::RemoveMedia(const std::string& media) {
+  uint64_t hash = HashMedia(media);
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (index_ == nullptr) {
+    return;
+  }
+  for (uint64_t i = 0; i < index_->header->capacity; i++) {
+    Slot* slot = &index_->slots[i];
+    if (slot->state == SLOT_FULL && slot->media == hash) {
+      index_->Drop(slot);
+    }
+  }
+  MaybeCompact();
+}
+
+bool ThumbnailStore::Compact() {
+  std::lock_guard<std::mutex> compact_lock(compact_mutex_);
+  std::shared_ptr<Data> source;
+  std::vector<std::pair<uint64_t, uint32_t>> tiles;  // Offset, length.
+  uint32_t generation;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (index_ == nullptr) {
+      return false;
+    }
+    source = data_;
+    generation = data_->generation + 1;
+    tiles.reserve(index_->header->count);
+    for (uint64_t i = 0; i < index_->header->capacity; i++) {
+      const Slot& slot = index_->slots[i];
+      if (slot.state == SLOT_FULL) {
+        tiles.emplace_back(slot.offset, slot.length);
+      }
+    }
+  }
+  std::shared_ptr<Data> target = OpenData(generation, true);
+  if (target == nullptr) {
+    return false;
+  }
+  // Appended tiles never move within |source|, so they are copied without
+  // the lock, in file order.
+  std::sort(tiles.begin(), tiles.end());
+  std::vector<std::pair<uint64_t, uint64_t>> moves;  // Source -> target.
+  moves.reserve(tiles.size());
+  for (const auto& [offset, length] : tiles) {
+    uint64_t destination = Align(target->end);
+    if (stopping_ ||
+        !WriteAll(target->fd, source->base + offset, length, destination)) {
+      unlink(target->path.c_str());
+      return false;
+    }
+    moves.emplace_back(offset, destination);
+    target->end = destination + length;
+  }
+  fdatasync(target->fd);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  // Tiles stored since the copy are copied now; those removed are dropped.
+  bool result = Rebuild(
+      GetCapacity(index_->header->count), target, [&](Slot* slot) {
+        auto it = std::lower_bound(moves.begin(), moves.end(),
+                                   std::make_pair(slot->offset, uint64_t{0}));
+        if (it != moves.end() && it->first == slot->offset) {
+          slot->offset = it->second;
+          return true;
+        }
+        uint64_t destination = Align(target->end);
+        if (destination + slot->length > target->length ||
+            !WriteAll(target->fd, data_->base + slot->offset, slot->length,
+                      destination)) {
+          return false;
+        }
+        slot->offset = destination;
+        target->end = destination + slot->length;
+        return true;
+      });
+  if (!result) {
+    unlink(target->path.c_str());
+    return false;
+  }
+  compactions_++;
+  return true;
+}
+
+void ThumbnailStore::Flush() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (index_ == nullptr) {
+    return;
+  }
+  fdatasync(data_->fd);
+  msync(index_->base, index_->length, MS_SYNC);
+}
+
+void ThumbnailStore::Clear() {
+  std::lock_guard<std::mutex> compact_lock(compact_mutex_);
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (index_ == nullptr) {
+    return;
+  }
+  // A new generation: leases keep reading the current one.
+  std::shared_ptr<Data> data = OpenData(data_->generation + 1, true);
+  if (data == nullptr ||
+      !Rebuild(THUMBNAIL_STORE_INITIAL_CAPACITY, data,
+               [](Slot*) { return false; })) {
+    if (data != nullptr) {
+      unlink(data->path.c_str());
+    }
+    // Dropped one by one instead.
+    for (uint64_t i = 0; i < index_->header->capacity; i++) {
+      if (index_->slots[i].state == SLOT_FULL) {
+        index_->Drop(&index_->slots[i]);
+      }
+    }
+  }
+}
+
+ThumbnailStore::Stats ThumbnailStore::GetStats() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Stats stats;
+  if (index_ != nullptr) {
+    stats.tiles = (int64_t)index_->header->count;
+    stats.size = (int64_t)index_->header->size;
+    stats.file_size = (int64_t)data_->end;
+  }
+  stats.evictions = evictions_;
+  stats.compactions = compactions_;
+  return stats;
+}
+
+std::string ThumbnailStore::DefaultDirectory() {
+  const char* cache = getenv("XDG_CACHE_HOME");
+  if (cache != nullptr && *cache == '/') {
+    return std::string(cache) + "/media_kit/thumbnails";
+  }
+  const char* home = getenv("HOME");
+  if (home != nullptr && *home == '/') {
+    return std::string(home) + "/.cache/media_kit/thumbnails";
+  }
+  return std::string();
+}
+
+std::string ThumbnailStore::GetDataPath(uint32_t generation) const {
+  return directory_ + "/tiles." + std::to_string(generation);
+}
+
+std::shared_ptr<ThumbnailStore::Data> ThumbnailStore::OpenData(
+    uint32_t generation,
+    bool truncate) {
+  auto data = std::make_shared<Data>();
+  data->path = GetDataPath(generation);
+  data->generation = generation;
+  data->fd = open(data->path.c_str(),
+                  O_RDWR | O_CREAT | O_CLOEXEC | (truncate ? O_TRUNC : 0),
+                  0644);
+  struct stat info;
+  if (data->fd < 0 || fstat(data->fd, &info) != 0) {
+    return nullptr;
+  }
+  long page = sysconf(_SC_PAGESIZE);
+  size_t length =
+      ((size_t)info.st_size + page - 1) / page * page + reservation_;
+  void* base = mmap(nullptr, length, PROT_READ, MAP_SHARED, data->fd, 0);
+  if (base == MAP_FAILED) {
+    return nullptr;
+  }
+  data->base = (const uint8_t*)base;
+  data->length = length;
+  data->end = (uint64_t)info.st_size;
+  return data;
+}
+
+bool ThumbnailStore::Reset() {
+  data_ = OpenData(1, true);
+  index_ = data_ != nullptr ? Index::Create(directory_ + "/index",
+                                            THUMBNAIL_STORE_INITIAL_CAPACITY,
+                                            data_->generation)
+                            : nullptr;
+  if (index_ == nullptr) {
+    data_.reset();
+    return false;
+  }
+  return true;
+}
+
+void ThumbnailStore::Repair() {
+  // Recounts the slots & drops those a crash left past the end of the data
+  // file, which would fault once read.
+  IndexHeader* header = index_->header;
+  header->count = 0;
+  header->removed = 0;
+  header->size = 0;
+  for (uint64_t i = 0; i < header->capacity; i++) {
+    Slot* slot = &index_->slots[i];
+    if (slot->state == SLOT_FULL &&
+        (slot->length == 0 || slot->length > THUMBNAIL_STORE_MAX_TILE_SIZE ||
+         slot->offset % THUMBNAIL_STORE_ALIGNMENT != 0 ||
+         slot->offset > data_->end ||
+         slot->length > data_->end - slot->offset ||
+         slot->format > THUMBNAIL_FORMAT_PNG)) {
+      slot->state = SLOT_REMOVED;
+    }
+    if (slot->state == SLOT_FULL) {
+      header->count++;
+      header->size += slot->length;
+      header->clock = std::max(header->clock, slot->use);
+    } else if (slot->state != SLOT_EMPTY) {
+      slot->state = SLOT_REMOVED;
+      header->removed++;
+    }
+  }
+}
+
+bool ThumbnailStore::Rebuild(uint64_t capacity,
+                             std::shared_ptr<Data> data,
+                             const std::function<bool(Slot*)>& move) {
+  // Written aside & renamed, so a crash leaves either index. Neither is
+  // synced: after a power loss, at worst the store is repaired or reset.
+  std::string target = directory_ + "/index";
+  std::string temporary = target + "." + std::to_string(getpid()) + ".tmp";
+  std::unique_ptr<Index> index =
+      Index::Create(temporary, capacity, data->generation);
+  if (index == nullptr) {
+    return false;
+  }
+  index->header->clock = index_->header->clock;
+  for (uint64_t i = 0; i < index_->header->capacity; i++) {
+    Slot tile = index_->slots[i];
+    if (tile.state == SLOT_FULL && (!move || move(&tile)) &&
+        !index->Put(tile)) {
+      unlink(temporary.c_str());
+      return false;
+    }
+  }
+  if (rename(temporary.c_str(), target.c_str()) != 0) {
+    unlink(temporary.c_str());
+    return false;
+  }
+  if (data != data_) {
+    unlink(data_->path.c_str());
+    data_ = std::move(data);
+  }
+  index_ = std::move(index);
+  return true;
+}
+
+void ThumbnailStore::Evict() {
+  // Down to 7/8 of |max_size|, so that a scan makes room for many tiles. The
+  // most recent tile is kept.
+  std::vector<Slot*> slots;
+  slots.reserve(index_->header->count);
+  for (uint64_t i = 0; i < index_->header->capacity; i++) {
+    if (index_->slots[i].state == SLOT_FULL) {
+      slots.push_back(&index_->slots[i]);
+    }
+  }
+  std::sort(slots.begin(), slots.end(),
+            [](const Slot* a, const Slot* b) { return a->use < b->use; });
+  uint64_t target = (uint64_t)(max_size_ - max_size_ / 8);
+  for (size_t i = 0; i + 1 < slots.size() && index_->header->size > target;
+       i++) {
+    index_->Drop(slots[i]);
+    evictions_++;
+  }
+}
+
+void ThumbnailStore::MaybeCompact() {
+  // Once the garbage outweighs the tiles, so that the data file stays within
+  // about twice their size.
+  uint64_t size = index_->header->size;
+  uint64_t garbage = data_->end > size ? data_->end - size : 0;
+  if (compacting_ || compact_failed_ || stopping_ || garbage <= size ||
+      garbage < (uint64_t)max_size_ / 4) {
+    return;
+  }
+  if (compactor_.joinable()) {
+    compactor_.join();
+  }
+  compacting_ = true;
+  compactor_ = std::thread([this]() {
+    compact_failed_ = !Compact() && !stopping_;
+    compacting_ = false;
+  });
+}
+
+// C API.
+
+ThumbnailStore* thumbnail_store_open(const char* directory, int64_t max_size) {
+  ThumbnailStore* self = new ThumbnailStore(
+      directory != nullptr ? std::string(directory)
+                           : ThumbnailStore::DefaultDirectory(),
+      max_size);
+  if (!self->Open()) {
+    fprintf(stderr, "media_kit: ThumbnailStore: Unable to open %s.\n",
+            self->directory().c_str());
+    delete self;
+    return nullptr;
+  }
+  return self;
+}
+
+void thumbnail_store_close(ThumbnailStore* self) {
+  delete self;
+}
+
+const ThumbnailTile* thumbnail_store_lookup(ThumbnailStore* self,
+                                            const char* media,
+                                            int64_t time,
+                                            int32_t size) {
+  return self->Lookup(media, time, size);
+}
+
+void thumbnail_store_release(const ThumbnailTile* tile) {
+  ThumbnailStore::Release(tile);
+}
+
+bool thumbnail_store_insert(ThumbnailStore* self,
+                            const char* media,
+                            int64_t time,
+                            int32_t size,
+                            int32_t format,
+                            int32_t width,
+                            int32_t height,
+                            const uint8_t* data,
+                            int64_t length) {
+  return self->Insert(media, time, size, (ThumbnailFormat)format, width,
+                      height, data, length);
+}
+
+bool thumbnail_store_remove(ThumbnailStore* self,
+                            const char* media,
+                            int64_t time,
+                            int32_t size) {
+  return self->Remove(media, time, size);
+}
+
+void thumbnail_store_remove_media(ThumbnailStore* self, const char* media) {
+  self->RemoveMedia(media);
+}
+
+void thumbnail_store_get_stats(ThumbnailStore* self, int64_t* stats) {
+  ThumbnailStore::Stats result = self->GetStats();
+  stats[0] = result.tiles;
+  stats[1] = result.size;
+  stats[2] = result.file_size;
+  stats[3] = result.evictions;
+  stats[4] = result.compactions;
+}
+
+void thumbnail_store_clear(ThumbnailStore* self) {
+  self->Clear();
+}
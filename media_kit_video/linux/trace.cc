@@ -0,0 +1,210 @@
+// This file is a part of media_kit
+// (https://github.com/media-kit/media-kit).
+//
+// Copyright © 2026 & onwards, Predidit.
+// All rights reserved.
+// Use of this source code is governed by MIT license that can be found in the
+// LICENSE file.
+
+#include "include/media_kit_video/trace.h"
+
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+// Number of events kept per thread (32 bytes each).
+#define TRACE_RING_CAPACITY 8192
+
+// Number of rings of exited threads kept dumpable, then reused by new threads.
+#define TRACE_RETIRED_RING_COUNT 8
+
+namespace {
+
+// Fields are relaxed atomics only so that a concurrent |DumpChromeJson| is
+// well-defined; torn events are detected through |TraceRing::head| instead.
+struct TraceEvent {
+  std::atomic<const char*> name;
+  std::atomic<int64_t> id;
+  std::atomic<uint64_t> begin;
+  std::atomic<uint64_t> duration;
+};
+
+// Single producer (the owning thread), any number of readers. |reserved| is
+// bumped before an event is written & |head| after, like a seqlock.
+struct TraceRing {
+  TraceEvent events[TRACE_RING_CAPACITY];
+  std::atomic<uint64_t> reserved{0};
+  std::atomic<uint64_t> head{0};
+  int64_t tid = 0;
+  char thread_name[16] = {0};
+};
+
+// The rings of exited threads remain dumpable until reused by a new thread,
+// oldest first, or freed beyond |TRACE_RETIRED_RING_COUNT|.
+std::mutex rings_mutex;
+std::vector<TraceRing*> rings;
+std::vector<TraceRing*> retired_rings;
+
+std::mutex names_mutex;
+std::unordered_set<std::string> names;
+
+TraceRing* RegisterThread() {
+  std::lock_guard<std::mutex> lock(rings_mutex);
+  TraceRing* ring;
+  if (!retired_rings.empty()) {
+    // Not read concurrently: |DumpChromeJson| holds |rings_mutex|.
+    ring = retired_rings.front();
+    retired_rings.erase(retired_rings.begin());
+    ring->reserved.store(0, std::memory_order_relaxed);
+    ring->head.store(0, std::memory_order_relaxed);
+    memset(ring->thread_name, 0, sizeof(ring->thread_name));
+  } else {
+    ring = new TraceRing();
+    rings.push_back(ring);
+  }
+  ring->tid = (int64_t)syscall(SYS_gettid);
+  pthread_getname_np(pthread_self(), ring->thread_name,
+                     sizeof(ring->thread_name));
+  return ring;
+}
+
+void RetireThread(TraceRing* ring) {
+  std::lock_guard<std::mutex> lock(rings_mutex);
+  retired_rings.push_back(ring);
+  if (retired_rings.size() > TRACE_RETIRED_RING_COUNT) {
+    TraceRing* oldest = retired_rings.front();
+    retired_rings.erase(retired_rings.begin());
+    rings.erase(std::find(rings.begin(), rings.end(), oldest));
+    delete oldest;
+  }
+}
+
+// Retires the ring of the calling thread when it exits.
+struct CurrentRing {
+  TraceRing* ring = nullptr;
+
+  ~CurrentRing() {
+    if (ring != nullptr) {
+      RetireThread(ring);
+    }
+  }
+};
+
+thread_local CurrentRing current_ring;
+
+void AppendEscaped(std::string& out, const char* value) {
+  for (; *value != '\0'; value++) {
+    char c = *value;
+    if (c == '"' || c == '\\') {
+      out.push_back('\\');
+      out.push_back(c);
+    } else if ((unsigned char)c < 0x20) {
+      char buffer[8];
+      snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+      out.append(buffer);
+    } else {
+      out.push_back(c);
+    }
+  }
+}
+
+bool EnabledFromEnvironment() {
+  const char* value = getenv("MEDIA_KIT_VIDEO_TRACE");
+  return value != nullptr && strcmp(value, "0") != 0 && *value != '\0';
+}
+
+}  // namespace
+
+std::atomic<bool> Trace::enabled_(EnabledFromEnvironment());
+
+void Trace::SetEnabled(bool enabled) {
+  enabled_.store(enabled, std::memory_order_relaxed);
+}
+
+uint64_t Trace::Now() {
+  return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void Trace::Record(const char* name,
+                   int64_t id,
+                   uint64_t begin,
+                   uint64_t duration) {
+  TraceRing* ring = current_ring.ring;
+  if (ring == nullptr) {
+    ring = current_ring.ring = RegisterThread();
+  }
+  uint64_t head = ring->head.load(std::memory_order_relaxed);
+  TraceEvent& event = ring->events[head % TRACE_RING_CAPACITY];
+  ring->reserved.store(head + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  event.name.store(name, std::memory_order_relaxed);
+  event.id.store(id, std::memory_order_relaxed);
+  event.begin.store(begin, std::memory_order_relaxed);
+  event.duration.store(duration, std::memory_order_relaxed);
+  ring->head.store(head + 1, std::memory_order_release);
+}
+
+const char* Trace::Intern(const char* name) {
+  std::lock_guard<std::mutex> lock(names_mutex);
+  return names.emplace(name).first->c_str();
+}
+
+std::string Trace::DumpChromeJson() {
+  std::string out;
+  out.append("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+  bool first = true;
+  const int pid = (int)getpid();
+  char buffer[256];
+  std::lock_guard<std::mutex> lock(rings_mutex);
+  for (TraceRing* ring : rings) {
+    if (ring->thread_name[0] != '\0') {
+      snprintf(buffer, sizeof(buffer),
+               "%s{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":%d,"
+               "\"tid\":%" PRId64 ",\"args\":{\"name\":\"",
+               first ? "" : ",", pid, ring->tid);
+      out.append(buffer);
+      AppendEscaped(out, ring->thread_name);
+      out.append("\"}}");
+      first = false;
+    }
+    uint64_t head = ring->head.load(std::memory_order_acquire);
+    uint64_t tail =
+        head > TRACE_RING_CAPACITY ? head - TRACE_RING_CAPACITY : 0;
+    for (uint64_t i = tail; i < head; i++) {
+      TraceEvent& event = ring->events[i % TRACE_RING_CAPACITY];
+      const char* name = event.name.load(std::memory_order_relaxed);
+      int64_t id = event.id.load(std::memory_order_relaxed);
+      uint64_t ts = event.begin.load(std::memory_order_relaxed);
+      uint64_t duration = event.duration.load(std::memory_order_relaxed);
+      // Discard the event if the producer wrapped around onto it meanwhile.
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (ring->reserved.load(std::memory_order_relaxed) >
+          i + TRACE_RING_CAPACITY) {
+        continue;
+      }
+      snprintf(buffer, sizeof(buffer),
+               "%s{\"ph\":\"X\",\"cat\":\"media_kit\",\"pid\":%d,"
+               "\"tid\":%" PRId64 ",\"ts\":%" PRIu64 ",\"dur\":%" PRIu64
+               ",\"args\":{\"id\":%" PRId64 "},\"name\":\"",
+               first ? "" : ",", pid, ring->tid, ts, duration, id);
+      out.append(buffer);
+      AppendEscaped(out, name);
+      out.append("\"}");
+      first = false;
+    }
+  }
+  out.append("]}");
+  return out;
+}
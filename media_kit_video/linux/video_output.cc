@@ -9,7 +9,13 @@
 #include "include/media_kit_video/video_output.h"
 #include "include/media_kit_video/texture_gl.h"
 #include "include/media_kit_video/texture_sw.h"
+#include "include/media_kit_video/texture_overlay.h"
+#include "include/media_kit_video/frame_tap.h"
 #include "include/media_kit_video/gl_render_thread.h"
+#include "include/media_kit_video/hwdec_calibration.h"
+#include "include/media_kit_video/trace.h"
+
+#include <math.h>
 
 #include <epoxy/egl.h>
 #include <epoxy/glx.h>
@@ -27,19 +33,130 @@ struct _VideoOutput {
   TextureSW* texture_sw;
   GMutex mutex; /* Only used in S/W rendering. */
   mpv_handle* handle;
+  mpv_handle* observer; /* Client of |handle| for observing properties natively. */
   mpv_render_context* render_context;
   gint64 width;
   gint64 height;
+  std::atomic<gdouble> render_scale; /* Scale of the H/W texture relative to |width|, |height| or video resolution. */
+  std::atomic<gint64> memory_limit;  /* Soft limit of the H/W texture buffers in bytes, 0 if none. */
+  std::atomic<gint64> video_out_width;  /* `video-out-params` size (rotation applied), cached by |observer|. */
+  std::atomic<gint64> video_out_height;
+  std::atomic<gboolean> render_pending; /* A render task is queued in |gl_render_thread|. */
+  std::atomic<gint> visibility;         /* |VideoOutputVisibility|; frames are skipped unless visible. */
   VideoOutputConfiguration configuration;
   TextureUpdateCallback texture_update_callback;
   gpointer texture_update_callback_context;
   FlTextureRegistrar* texture_registrar;
   GLRenderThread* gl_render_thread;
+  TextureOverlay* texture_overlay;
+  gchar* subtitle_text;
+  gchar* subtitle_ass_text;                     /* `sub-text/ass`. GL thread only. */
+  gchar* subtitle_ass_header;                   /* `sub-ass-extradata`. GL thread only. */
+  gboolean subtitle_ass;                        /* The player enabled `sub-visibility`: libass output is rendered into the overlay instead, with `sub-visibility` turned off until disposal. GL thread only. */
+  gboolean subtitle_in_frame;                   /* `sub-visibility` without libass available: mpv renders the subtitles into the video frame; the overlay stays empty. GL thread only. */
+  TextureUpdateCallback subtitle_overlay_update_callback;
+  gpointer subtitle_overlay_update_callback_context;
+  std::atomic<gboolean> suspended; /* Render context released; last frame kept as snapshot. */
+  gboolean resume_on_playback;     /* Resume on unpause or seek. */
+  gchar* suspended_vid;            /* `vid` before suspension. */
+  SuspensionCallback suspension_callback;
+  gpointer suspension_callback_context;
+  guint decode_suspension_source;           /* Pending |video_output_suspend_decoding|, 0 if none. */
+  gchar* decode_suspended_vid;              /* `vid` before decoding was suspended, NULL while decoding. */
+  std::atomic<gint64> decode_resume_time;   /* When decoding resumed, 0 once its first frame is published. */
+  std::atomic<gint64> decode_resume_latency;
+  mpv_handle* preview;                          /* Secondary player decoding keyframes while scrubbing, NULL if none. */
+  mpv_render_context* preview_render_context;   /* Render context of |preview|, freed in the GL thread. */
+  gchar* preview_path;                          /* `path` loaded in |preview|. */
+  std::atomic<gboolean> preview_loaded;         /* |preview| finished loading |preview_path|. */
+  std::atomic<gdouble> preview_target;          /* Latest scrub position in seconds, NAN once handed back. */
+  std::atomic<gboolean> previewing;             /* GL thread: frames of |preview| are rendered instead of |handle|'s. */
+  std::atomic<gboolean> preview_handoff;        /* GL thread: the first new frame of |handle| ends |previewing|. */
+  gboolean preview_active;                      /* Between |video_output_preview| & |video_output_end_preview|. */
+  gboolean preview_resume;                      /* Unpause |handle| upon |video_output_end_preview|. */
+  guint preview_handoff_source;                 /* Pending |video_output_finish_preview|, 0 if none. */
+  guint preview_destruction_source;             /* Pending |video_output_destroy_preview|, 0 if none. */
+  std::thread* preview_thread;                  /* Creates or terminates |preview|s off the main thread, NULL if none started. */
+  gboolean preview_pending;                     /* |preview_thread| is creating |preview|. */
+  gboolean preview_failed;                      /* Creation failed during the current |preview_active|. */
+  mpv_handle* preview_created;                  /* Handed over by |preview_thread| to |video_output_install_preview|. */
+  std::atomic<const HwdecCalibration*> hwdec_calibration; /* Read in the `on_preloaded` hook, NULL until calibrated. */
+  std::atomic<gboolean> trick_play;             /* `vd-lavc-skipframe=nonkey`: at most one frame per |render_interval| is rendered. */
+  gint64 render_interval;                       /* Refresh interval of the display, in microseconds. */
+  gint64 last_render_time;                      /* GL thread (S/W: main thread): last render in trick play. */
+  std::atomic<gboolean> trick_play_redraw_pending; /* A frame was skipped in trick play; its redraw is scheduled. */
+  guint trick_play_redraw_source;               /* Pending |video_output_redraw_trick_play|, 0 if none. */
+  std::atomic<FrameTap*> frame_tap;             /* Owned; rendered frames are copied into it, NULL if none. */
+  gboolean sw_upload;                           /* |render_context| is S/W, rendering into |texture_gl|'s pixel buffer objects. */
+  GMutex idle_mutex;                            /* Guards |idle_sources|. */
+  GArray* idle_sources;                         /* |VideoOutputIdle|s added by |video_output_add_idle|, some may have run. */
   gboolean destroyed;
 };
 
+// An idle source invoking |function| with the |VideoOutput|.
+typedef struct {
+  GSource* source;
+  GSourceFunc function;
+} VideoOutputIdle;
+
+// |reply_userdata| of the properties observed through |VideoOutput::observer|.
+enum {
+  OBSERVER_SUB_TEXT = 1,
+  OBSERVER_VIDEO_OUT_PARAMS,
+  OBSERVER_PAUSE,
+  OBSERVER_SEEKING,
+  OBSERVER_VD_LAVC_SKIPFRAME,
+  OBSERVER_SUB_VISIBILITY,
+  OBSERVER_HOOK_PRELOADED,
+  OBSERVER_SUB_TEXT_ASS,
+  OBSERVER_SUB_ASS_EXTRADATA,
+};
+
 G_DEFINE_TYPE(VideoOutput, video_output, G_TYPE_OBJECT)
 
+static void video_output_destroy_preview(VideoOutput* self);
+
+/**
+ * Invokes |function| with |self| from the main loop, unless removed by
+ * |video_output_remove_idles| first. Called from any thread.
+ */
+static void video_output_add_idle(VideoOutput* self, GSourceFunc function) {
+  VideoOutputIdle idle = {g_idle_source_new(), function};
+  g_source_set_callback(idle.source, function, self, NULL);
+  g_mutex_lock(&self->idle_mutex);
+  // Forgets the sources which already ran.
+  for (guint i = self->idle_sources->len; i > 0; i--) {
+    VideoOutputIdle* pending =
+        &g_array_index(self->idle_sources, VideoOutputIdle, i - 1);
+    if (g_source_is_destroyed(pending->source)) {
+      g_source_unref(pending->source);
+      g_array_remove_index_fast(self->idle_sources, i - 1);
+    }
+  }
+  g_array_append_val(self->idle_sources, idle);
+  g_source_attach(idle.source, NULL);
+  g_mutex_unlock(&self->idle_mutex);
+}
+
+/**
+ * Removes the pending sources of |video_output_add_idle| invoking |function|,
+ * or all of them if NULL.
+ */
+static void video_output_remove_idles(VideoOutput* self,
+                                      GSourceFunc function) {
+  g_mutex_lock(&self->idle_mutex);
+  for (guint i = self->idle_sources->len; i > 0; i--) {
+    VideoOutputIdle* pending =
+        &g_array_index(self->idle_sources, VideoOutputIdle, i - 1);
+    if (function == NULL || pending->function == function) {
+      g_source_destroy(pending->source);
+      g_source_unref(pending->source);
+      g_array_remove_index_fast(self->idle_sources, i - 1);
+    }
+  }
+  g_mutex_unlock(&self->idle_mutex);
+}
+
 static void video_output_dispose(GObject* object) {
   VideoOutput* self = VIDEO_OUTPUT(object);
   self->destroyed = TRUE;
@@ -48,6 +165,64 @@ static void video_output_dispose(GObject* object) {
   if (self->render_context) {
     mpv_render_context_set_update_callback(self->render_context, NULL, NULL);
   }
+  video_output_destroy_preview(self);
+  // Waits for a preview being created or terminated.
+  if (self->preview_thread != NULL) {
+    self->preview_thread->join();
+    delete self->preview_thread;
+    self->preview_thread = NULL;
+  }
+  if (self->preview_created != NULL) {
+    self->gl_render_thread->PostAndWait([self]() {
+      eglMakeCurrent(self->egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE,
+                     self->egl_context);
+      mpv_render_context_free(self->preview_render_context);
+      self->preview_render_context = NULL;
+    });
+    mpv_terminate_destroy(self->preview_created);
+    self->preview_created = NULL;
+  }
+
+  // Observer client's events are handled in the GL thread; waiting for the
+  // destruction there also flushes any pending |video_output_handle_events|.
+  if (self->observer != NULL) {
+    mpv_set_wakeup_callback(self->observer, NULL, NULL);
+    self->gl_render_thread->PostAndWait([self]() {
+      if (self->observer != NULL) {
+        // The player renders its subtitles into the frame again.
+        if (self->subtitle_ass) {
+          int visible = 1;
+          mpv_set_property(self->observer, "sub-visibility", MPV_FORMAT_FLAG,
+                           &visible);
+          self->subtitle_ass = FALSE;
+        }
+        mpv_destroy(self->observer);
+        self->observer = NULL;
+      }
+    });
+  }
+  // Resumes scheduled by the observer; renders queued by S/W rendering.
+  video_output_remove_idles(self, NULL);
+  if (self->decode_suspension_source != 0) {
+    g_source_remove(self->decode_suspension_source);
+    self->decode_suspension_source = 0;
+  }
+  if (self->trick_play_redraw_source != 0) {
+    g_source_remove(self->trick_play_redraw_source);
+    self->trick_play_redraw_source = 0;
+  }
+
+  if (self->texture_overlay) {
+    fl_texture_registrar_unregister_texture(self->texture_registrar,
+                                            FL_TEXTURE(self->texture_overlay));
+    g_object_unref(self->texture_overlay);
+    self->texture_overlay = NULL;
+  }
+  g_clear_pointer(&self->subtitle_text, g_free);
+  g_clear_pointer(&self->subtitle_ass_text, g_free);
+  g_clear_pointer(&self->subtitle_ass_header, g_free);
+  g_clear_pointer(&self->suspended_vid, mpv_free);
+  g_clear_pointer(&self->decode_suspended_vid, mpv_free);
 
   // H/W
   if (self->texture_gl) {
@@ -87,8 +262,12 @@ static void video_output_dispose(GObject* object) {
       self->render_context = NULL;
     }
   }
+  // Producers are gone: the GL thread was waited for above.
+  delete self->frame_tap.exchange(NULL, std::memory_order_acq_rel);
   
   g_mutex_clear(&self->mutex);
+  g_array_unref(self->idle_sources);
+  g_mutex_clear(&self->idle_mutex);
   G_OBJECT_CLASS(video_output_parent_class)->dispose(object);
 }
 
@@ -105,18 +284,664 @@ static void video_output_init(VideoOutput* self) {
   self->texture_sw = NULL;
   self->pixel_buffer = NULL;
   self->handle = NULL;
+  self->observer = NULL;
   self->render_context = NULL;
   self->width = 0;
   self->height = 0;
+  self->render_scale.store(1.0, std::memory_order_relaxed);
+  self->memory_limit.store(0, std::memory_order_relaxed);
+  self->video_out_width.store(0, std::memory_order_relaxed);
+  self->video_out_height.store(0, std::memory_order_relaxed);
+  self->render_pending.store(FALSE, std::memory_order_relaxed);
+  self->visibility.store(VIDEO_OUTPUT_VISIBILITY_VISIBLE,
+                         std::memory_order_relaxed);
   self->configuration = VideoOutputConfiguration{};
   self->texture_update_callback = NULL;
   self->texture_update_callback_context = NULL;
   self->texture_registrar = NULL;
   self->gl_render_thread = NULL;
+  self->texture_overlay = NULL;
+  self->subtitle_text = NULL;
+  self->subtitle_ass_text = NULL;
+  self->subtitle_ass_header = NULL;
+  self->subtitle_ass = FALSE;
+  self->subtitle_in_frame = FALSE;
+  self->subtitle_overlay_update_callback = NULL;
+  self->subtitle_overlay_update_callback_context = NULL;
+  self->suspended.store(FALSE, std::memory_order_relaxed);
+  self->resume_on_playback = FALSE;
+  self->suspended_vid = NULL;
+  self->suspension_callback = NULL;
+  self->suspension_callback_context = NULL;
+  self->decode_suspension_source = 0;
+  self->decode_suspended_vid = NULL;
+  self->decode_resume_time.store(0, std::memory_order_relaxed);
+  self->decode_resume_latency.store(0, std::memory_order_relaxed);
+  self->preview = NULL;
+  self->preview_render_context = NULL;
+  self->preview_path = NULL;
+  self->preview_loaded.store(FALSE, std::memory_order_relaxed);
+  self->preview_target.store(NAN, std::memory_order_relaxed);
+  self->previewing.store(FALSE, std::memory_order_relaxed);
+  self->preview_handoff.store(FALSE, std::memory_order_relaxed);
+  self->preview_active = FALSE;
+  self->preview_resume = FALSE;
+  self->preview_handoff_source = 0;
+  self->preview_destruction_source = 0;
+  self->preview_thread = NULL;
+  self->preview_pending = FALSE;
+  self->preview_failed = FALSE;
+  self->preview_created = NULL;
+  self->hwdec_calibration.store(NULL, std::memory_order_relaxed);
+  self->trick_play.store(FALSE, std::memory_order_relaxed);
+  self->render_interval = G_USEC_PER_SEC / 60;
+  self->last_render_time = 0;
+  self->trick_play_redraw_pending.store(FALSE, std::memory_order_relaxed);
+  self->trick_play_redraw_source = 0;
+  self->frame_tap.store(NULL, std::memory_order_relaxed);
+  self->sw_upload = FALSE;
+  self->idle_sources = g_array_new(FALSE, FALSE, sizeof(VideoOutputIdle));
   self->destroyed = FALSE;
   g_mutex_init(&self->mutex);
+  g_mutex_init(&self->idle_mutex);
+}
+
+/**
+ * Re-rasterizes the subtitle overlay for the current text & output size.
+ * Called from the dedicated GL thread.
+ */
+static void video_output_update_subtitle_overlay(VideoOutput* self) {
+  if (self->destroyed || self->texture_overlay == NULL) {
+    return;
+  }
+  gint64 width = video_output_get_width(self);
+  gint64 height = video_output_get_height(self);
+  gboolean resized =
+      self->subtitle_ass
+          ? texture_overlay_update_ass(self->texture_overlay,
+                                       self->subtitle_ass_header,
+                                       self->subtitle_ass_text, width, height)
+          : texture_overlay_update(
+                self->texture_overlay,
+                self->subtitle_in_frame ? NULL : self->subtitle_text, width,
+                height);
+  fl_texture_registrar_mark_texture_frame_available(
+      self->texture_registrar, FL_TEXTURE(self->texture_overlay));
+  if (resized && self->subtitle_overlay_update_callback != NULL) {
+    self->subtitle_overlay_update_callback(
+        video_output_get_subtitle_overlay_texture_id(self),
+        texture_overlay_get_width(self->texture_overlay),
+        texture_overlay_get_height(self->texture_overlay),
+        self->subtitle_overlay_update_callback_context);
+  }
+}
+
+/**
+ * Reads the output size from a `video-out-params` node, with rotation applied.
+ */
+static void video_output_parse_video_out_params(mpv_node* params,
+                                                gint64* width,
+                                                gint64* height) {
+  int64_t dw = 0, dh = 0, rotate = 0;
+  if (params->format == MPV_FORMAT_NODE_MAP) {
+    for (int32_t i = 0; i < params->u.list->num; i++) {
+      char* key = params->u.list->keys[i];
+      auto value = params->u.list->values[i];
+      if (value.format == MPV_FORMAT_INT64) {
+        if (strcmp(key, "dw") == 0) {
+          dw = value.u.int64;
+        }
+        if (strcmp(key, "dh") == 0) {
+          dh = value.u.int64;
+        }
+        if (strcmp(key, "rotate") == 0) {
+          rotate = value.u.int64;
+        }
+      }
+    }
+  }
+  *width = rotate == 0 || rotate == 180 ? dw : dh;
+  *height = rotate == 0 || rotate == 180 ? dh : dw;
+}
+
+/**
+ * Returns the output size from the values cached by |VideoOutput::observer|,
+ * so that no |mpv_node| is allocated per frame. Queries mpv directly if the
+ * observer could not be created.
+ */
+static void video_output_get_video_out_size(VideoOutput* self,
+                                            gint64* width,
+                                            gint64* height) {
+  if (self->observer != NULL) {
+    *width = self->video_out_width.load(std::memory_order_relaxed);
+    *height = self->video_out_height.load(std::memory_order_relaxed);
+    return;
+  }
+  *width = 0;
+  *height = 0;
+  mpv_node params;
+  if (mpv_get_property(self->handle, "video-out-params", MPV_FORMAT_NODE,
+                       &params) >= 0) {
+    video_output_parse_video_out_params(&params, width, height);
+    mpv_free_node_contents(&params);
+  }
+}
+
+#ifdef MPV_RENDER_API_TYPE_SW
+static gboolean video_output_render_sw(gpointer data);
+static gboolean video_output_create_render_context_sw(VideoOutput* self);
+#endif
+
+/**
+ * Renders the current frame of |VideoOutput::handle| again. Called from the
+ * main thread, |VideoOutput::render_interval| after a frame was skipped in
+ * trick play.
+ */
+static gboolean video_output_redraw_trick_play(gpointer data) {
+  VideoOutput* self = (VideoOutput*)data;
+  self->trick_play_redraw_source = 0;
+  self->trick_play_redraw_pending.store(FALSE, std::memory_order_release);
+  if (self->texture_gl != NULL) {
+    video_output_notify_render(self);
+  }
+#ifdef MPV_RENDER_API_TYPE_SW
+  if (self->texture_sw != NULL) {
+    video_output_add_idle(self, video_output_render_sw);
+  }
+#endif
+  return FALSE;
+}
+
+/**
+ * Whether the next frame is skipped: in trick play, at most one frame per
+ * display refresh is rendered, however fast mpv presents them. The latest
+ * frame is redrawn once the interval elapses, in case no other one follows
+ * e.g. upon pause. Called from the GL thread (S/W: main thread).
+ */
+static gboolean video_output_decimate(VideoOutput* self) {
+  if (!self->trick_play.load(std::memory_order_relaxed)) {
+    return FALSE;
+  }
+  gint64 now = g_get_monotonic_time();
+  if (now - self->last_render_time >= self->render_interval) {
+    self->last_render_time = now;
+    return FALSE;
+  }
+  if (!self->trick_play_redraw_pending.exchange(TRUE,
+                                                std::memory_order_acq_rel)) {
+    video_output_add_idle(self, [](gpointer data) -> gboolean {
+      VideoOutput* self = (VideoOutput*)data;
+      if (!self->destroyed && self->trick_play_redraw_source == 0) {
+        self->trick_play_redraw_source =
+            g_timeout_add((guint)((self->render_interval + 999) / 1000),
+                          video_output_redraw_trick_play, self);
+      }
+      return FALSE;
+    });
+  }
+  return TRUE;
+}
+
+/**
+ * Whether the next frame may be published. While video decoding resumes (see
+ * |video_output_resume_decoding|), the last frame stays on screen until the
+ * first new one is decoded.
+ */
+static gboolean video_output_is_frame_ready(VideoOutput* self) {
+  if (self->decode_resume_time.load(std::memory_order_acquire) == 0) {
+    return TRUE;
+  }
+  return (mpv_render_context_update(self->render_context) &
+          MPV_RENDER_UPDATE_FRAME) != 0;
+}
+
+/**
+ * Records the time since video decoding resumed, upon publishing its first
+ * frame.
+ */
+static void video_output_measure_decode_resume(VideoOutput* self) {
+  gint64 time = self->decode_resume_time.exchange(0, std::memory_order_acq_rel);
+  if (time == 0) {
+    return;
+  }
+  gint64 latency = g_get_monotonic_time() - time;
+  self->decode_resume_latency.store(latency, std::memory_order_relaxed);
+}
+
+static void video_output_handle_property_change(VideoOutput* self,
+                                                guint64 id,
+                                                mpv_event_property* property) {
+  switch (id) {
+    case OBSERVER_SUB_TEXT: {
+      const gchar* text = property->format == MPV_FORMAT_STRING
+                              ? *(const gchar**)property->data
+                              : NULL;
+      g_free(self->subtitle_text);
+      self->subtitle_text = g_strdup(text);
+      video_output_update_subtitle_overlay(self);
+      break;
+    }
+    case OBSERVER_SUB_TEXT_ASS:
+    case OBSERVER_SUB_ASS_EXTRADATA: {
+      gchar** field = id == OBSERVER_SUB_TEXT_ASS ? &self->subtitle_ass_text
+                                                  : &self->subtitle_ass_header;
+      g_free(*field);
+      *field = property->format == MPV_FORMAT_STRING
+                   ? g_strdup(*(const gchar**)property->data)
+                   : NULL;
+      if (self->subtitle_ass) {
+        video_output_update_subtitle_overlay(self);
+      }
+      break;
+    }
+    case OBSERVER_SUB_VISIBILITY: {
+      gboolean visible =
+          property->format == MPV_FORMAT_FLAG && *(int*)property->data;
+      if (visible && texture_overlay_is_ass_supported()) {
+        // libass output goes to the overlay instead of the video frame. The
+        // player only sets `sub-visibility` once, so it being off afterwards
+        // is this change.
+        self->subtitle_ass = TRUE;
+        int hidden = 0;
+        mpv_set_property_async(self->observer, 0, "sub-visibility",
+                               MPV_FORMAT_FLAG, &hidden);
+      } else if (!self->subtitle_ass) {
+        self->subtitle_in_frame = visible;
+      }
+      video_output_update_subtitle_overlay(self);
+      break;
+    }
+    case OBSERVER_VIDEO_OUT_PARAMS: {
+      gint64 width = 0, height = 0;
+      if (property->format == MPV_FORMAT_NODE) {
+        video_output_parse_video_out_params((mpv_node*)property->data, &width,
+                                            &height);
+      }
+      gint64 previous_width =
+          self->video_out_width.exchange(width, std::memory_order_relaxed);
+      gint64 previous_height =
+          self->video_out_height.exchange(height, std::memory_order_relaxed);
+      if (previous_width != width || previous_height != height) {
+        // The first frame may have been skipped while the size was unknown.
+        if (self->texture_gl != NULL) {
+          video_output_notify_render(self);
+        }
+#ifdef MPV_RENDER_API_TYPE_SW
+        if (self->texture_sw != NULL) {
+          video_output_add_idle(self, video_output_render_sw);
+        }
+#endif
+      }
+      // Output size may have changed; subtitles are laid out relative to it.
+      video_output_update_subtitle_overlay(self);
+      break;
+    }
+    case OBSERVER_PAUSE:
+    case OBSERVER_SEEKING: {
+      if (property->format != MPV_FORMAT_FLAG) {
+        break;
+      }
+      gboolean flag = *(int*)property->data;
+      gboolean playback = id == OBSERVER_PAUSE ? !flag : flag;
+      if (playback && self->resume_on_playback &&
+          self->suspended.load(std::memory_order_relaxed)) {
+        // |video_output_resume| waits for this thread.
+        video_output_add_idle(self, [](gpointer data) -> gboolean {
+          VideoOutput* self = (VideoOutput*)data;
+          if (!self->destroyed && self->resume_on_playback) {
+            video_output_resume(self);
+          }
+          return FALSE;
+        });
+      }
+      break;
+    }
+    case OBSERVER_VD_LAVC_SKIPFRAME: {
+      gboolean trick_play =
+          property->format == MPV_FORMAT_STRING &&
+          g_strcmp0(*(const gchar**)property->data, "nonkey") == 0;
+      self->trick_play.store(trick_play, std::memory_order_relaxed);
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+/**
+ * Applies the calibrated `hwdec` of the video track about to be decoded, to
+ * the current file only. Called from the GL thread, in the `on_preloaded`
+ * hook: the demuxer is open but no decoder is created yet.
+ */
+static void video_output_apply_hwdec_calibration(VideoOutput* self,
+                                                 mpv_event_hook* hook) {
+  const HwdecCalibration* calibration =
+      self->hwdec_calibration.load(std::memory_order_acquire);
+  mpv_node tracks;
+  if (calibration != NULL &&
+      mpv_get_property(self->observer, "track-list", MPV_FORMAT_NODE,
+                       &tracks) >= 0) {
+    // The track `vid=auto` picks: the first default one, else the first one.
+    const char* codec = NULL;
+    int64_t width = 0, height = 0;
+    bool chosen_default = false;
+    if (tracks.format == MPV_FORMAT_NODE_ARRAY) {
+      for (int32_t i = 0; i < tracks.u.list->num; i++) {
+        mpv_node* track = &tracks.u.list->values[i];
+        if (track->format != MPV_FORMAT_NODE_MAP) {
+          continue;
+        }
+        const char* type = NULL;
+        const char* track_codec = NULL;
+        int64_t w = 0, h = 0;
+        bool is_default = false, albumart = false;
+        for (int32_t j = 0; j < track->u.list->num; j++) {
+          char* key = track->u.list->keys[j];
+          auto value = track->u.list->values[j];
+          if (value.format == MPV_FORMAT_STRING) {
+            if (strcmp(key, "type") == 0) {
+              type = value.u.string;
+            }
+            if (strcmp(key, "codec") == 0) {
+              track_codec = value.u.string;
+            }
+          } else if (value.format == MPV_FORMAT_INT64) {
+            if (strcmp(key, "demux-w") == 0) {
+              w = value.u.int64;
+            }
+            if (strcmp(key, "demux-h") == 0) {
+              h = value.u.int64;
+            }
+          } else if (value.format == MPV_FORMAT_FLAG) {
+            if (strcmp(key, "default") == 0) {
+              is_default = value.u.flag;
+            }
+            if (strcmp(key, "albumart") == 0) {
+              albumart = value.u.flag;
+            }
+          }
+        }
+        if (g_strcmp0(type, "video") != 0 || albumart || track_codec == NULL) {
+          continue;
+        }
+        if (codec == NULL || (is_default && !chosen_default)) {
+          codec = track_codec;
+          width = w;
+          height = h;
+          chosen_default = is_default;
+        }
+      }
+    }
+    if (codec != NULL) {
+      // Copy-back for S/W rendering, which has no interop.
+      std::string hwdec =
+          calibration->Lookup(codec, width, height,
+                              self->texture_gl == NULL || self->sw_upload);
+      if (!hwdec.empty()) {
+        mpv_set_property_string(self->observer, "file-local-options/hwdec",
+                                hwdec.c_str());
+      }
+    }
+    mpv_free_node_contents(&tracks);
+  }
+  // Loading is blocked until then.
+  mpv_hook_continue(self->observer, hook->id);
+}
+
+/**
+ * Drains the events of |VideoOutput::observer|.
+ * Called from the dedicated GL thread, never from mpv's wakeup callback.
+ */
+static void video_output_handle_events(VideoOutput* self) {
+  TRACE_SCOPE("video_output_handle_events", video_output_get_handle(self));
+  while (!self->destroyed && self->observer != NULL) {
+    mpv_event* event = mpv_wait_event(self->observer, 0);
+    if (event->event_id == MPV_EVENT_NONE) {
+      break;
+    }
+    if (event->event_id == MPV_EVENT_SHUTDOWN) {
+      // |mpv_terminate_destroy| waits for every client to be destroyed.
+      mpv_destroy(self->observer);
+      self->observer = NULL;
+      break;
+    }
+    if (event->event_id == MPV_EVENT_PROPERTY_CHANGE) {
+      video_output_handle_property_change(
+          self, event->reply_userdata, (mpv_event_property*)event->data);
+    }
+    if (event->event_id == MPV_EVENT_HOOK &&
+        event->reply_userdata == OBSERVER_HOOK_PRELOADED) {
+      video_output_apply_hwdec_calibration(self,
+                                           (mpv_event_hook*)event->data);
+    }
+  }
+}
+
+/**
+ * Creates a separate mpv client for |VideoOutput::handle|. The Dart side owns
+ * the event queue of |handle|; a separate client has its own event queue &
+ * lets the plugin observe properties without any round trip through Dart.
+ */
+static void video_output_create_observer(VideoOutput* self) {
+  self->observer = mpv_create_client(self->handle, NULL);
+  if (self->observer == NULL) {
+    g_printerr("media_kit: VideoOutput: Failed to create mpv client.\n");
+    return;
+  }
+  if (self->texture_overlay != NULL) {
+    // `sub-visibility` is set by the player (`PlayerConfiguration.libass`):
+    // with it, libass output is rendered into the overlay instead of the
+    // video frame. Both are available regardless of `sub-visibility`.
+    mpv_observe_property(self->observer, OBSERVER_SUB_TEXT, "sub-text",
+                         MPV_FORMAT_STRING);
+    mpv_observe_property(
+        self->observer, OBSERVER_SUB_TEXT_ASS,
+        mpv_client_api_version() >= MPV_MAKE_VERSION(2, 2) ? "sub-text/ass"
+                                                           : "sub-text-ass",
+        MPV_FORMAT_STRING);
+    mpv_observe_property(self->observer, OBSERVER_SUB_ASS_EXTRADATA,
+                         "sub-ass-extradata", MPV_FORMAT_STRING);
+    mpv_observe_property(self->observer, OBSERVER_SUB_VISIBILITY,
+                         "sub-visibility", MPV_FORMAT_FLAG);
+  }
+  // Cached for |video_output_get_width| & |video_output_get_height|, which
+  // are called for every frame.
+  mpv_observe_property(self->observer, OBSERVER_VIDEO_OUT_PARAMS,
+                       "video-out-params", MPV_FORMAT_NODE);
+  // Resumes outputs suspended under memory pressure once playback continues.
+  mpv_observe_property(self->observer, OBSERVER_PAUSE, "pause",
+                       MPV_FORMAT_FLAG);
+  mpv_observe_property(self->observer, OBSERVER_SEEKING, "seeking",
+                       MPV_FORMAT_FLAG);
+  mpv_observe_property(self->observer, OBSERVER_VD_LAVC_SKIPFRAME,
+                       "vd-lavc-skipframe", MPV_FORMAT_STRING);
+  if (self->configuration.hwdec_calibration) {
+    mpv_hook_add(self->observer, OBSERVER_HOOK_PRELOADED, "on_preloaded", 0);
+  }
+  mpv_set_wakeup_callback(
+      self->observer,
+      [](void* data) {
+        VideoOutput* self = (VideoOutput*)data;
+        if (self->destroyed) {
+          return;
+        }
+        // mpv API must not be called from the wakeup callback.
+        self->gl_render_thread->Post(
+            [self]() { video_output_handle_events(self); });
+      },
+      self);
+}
+
+/**
+ * Creates a render context of |handle| for H/W rendering into |self|'s
+ * texture. Returns NULL on failure.
+ * Called from the dedicated GL thread with the isolated EGL context current.
+ */
+static mpv_render_context* video_output_create_render_context_gl_for(
+    VideoOutput* self,
+    mpv_handle* handle) {
+  mpv_opengl_init_params gl_init_params{
+      [](auto, auto name) {
+        return (void*)eglGetProcAddress(name);
+      },
+      NULL,
+  };
+  
+  mpv_render_param params[] = {
+      {MPV_RENDER_PARAM_API_TYPE, (void*)MPV_RENDER_API_TYPE_OPENGL},
+      {MPV_RENDER_PARAM_OPENGL_INIT_PARAMS, (void*)&gl_init_params},
+      {MPV_RENDER_PARAM_INVALID, (void*)0},
+      {MPV_RENDER_PARAM_INVALID, (void*)0},
+  };
+  
+  // VAAPI acceleration requires passing X11/Wayland display
+  GdkDisplay* display = gdk_display_get_default();
+  if (GDK_IS_WAYLAND_DISPLAY(display)) {
+    params[2].type = MPV_RENDER_PARAM_WL_DISPLAY;
+    params[2].data = gdk_wayland_display_get_wl_display(display);
+  } else if (GDK_IS_X11_DISPLAY(display)) {
+    params[2].type = MPV_RENDER_PARAM_X11_DISPLAY;
+    params[2].data = gdk_x11_display_get_xdisplay(display);
+  }
+  
+  mpv_render_context* render_context = NULL;
+  if (mpv_render_context_create(&render_context, handle, params) != 0) {
+    return NULL;
+  }
+  mpv_render_context_set_update_callback(
+      render_context,
+      [](void* data) {
+        VideoOutput* self = (VideoOutput*)data;
+        TRACE_SCOPE("mpv_render_update_callback",
+                    video_output_get_handle(self));
+        if (self->destroyed) {
+          return;
+        }
+        // Asynchronously notify render (don't block mpv thread)
+        video_output_notify_render(self);
+      },
+      self);
+  return render_context;
 }
 
+/**
+ * Creates |VideoOutput::render_context| for rendering into |texture_gl|: H/W
+ * or, with |sw_upload|, S/W.
+ * Called from the dedicated GL thread with the isolated EGL context current.
+ */
+static gboolean video_output_create_render_context_gl(VideoOutput* self) {
+#ifdef MPV_RENDER_API_TYPE_SW
+  if (self->sw_upload) {
+    return video_output_create_render_context_sw(self);
+  }
+#endif
+  self->render_context =
+      video_output_create_render_context_gl_for(self, self->handle);
+  return self->render_context != NULL;
+}
+
+/**
+ * Falls back to S/W rendering uploaded through |texture_gl|'s pixel buffer
+ * objects, where mpv's GL renderer is unusable.
+ * Called from the dedicated GL thread with the isolated EGL context current.
+ */
+static gboolean video_output_enable_sw_upload(VideoOutput* self) {
+#ifdef MPV_RENDER_API_TYPE_SW
+  if (texture_gl_is_sw_upload_supported()) {
+    self->sw_upload = TRUE;
+    if (video_output_create_render_context_gl(self)) {
+      return TRUE;
+    }
+    self->sw_upload = FALSE;
+  }
+#endif
+  return FALSE;
+}
+
+#ifdef MPV_RENDER_API_TYPE_SW
+/**
+ * Creates |VideoOutput::render_context| for S/W rendering.
+ * Called from the main thread (S/W upload: the dedicated GL thread).
+ */
+static gboolean video_output_create_render_context_sw(VideoOutput* self) {
+  mpv_render_param params[] = {
+      {MPV_RENDER_PARAM_API_TYPE, (void*)MPV_RENDER_API_TYPE_SW},
+      {MPV_RENDER_PARAM_INVALID, (void*)0},
+  };
+  if (mpv_render_context_create(&self->render_context, self->handle,
+                                params) != 0) {
+    self->render_context = NULL;
+    return FALSE;
+  }
+  if (self->sw_upload) {
+    mpv_render_context_set_update_callback(
+        self->render_context,
+        [](void* data) {
+          VideoOutput* self = (VideoOutput*)data;
+          if (self->destroyed) {
+            return;
+          }
+          video_output_notify_render(self);
+        },
+        self);
+    return TRUE;
+  }
+  mpv_render_context_set_update_callback(
+      self->render_context,
+      [](void* data) {
+        video_output_add_idle((VideoOutput*)data, video_output_render_sw);
+      },
+      self);
+  return TRUE;
+}
+
+/**
+ * Renders the current frame into |VideoOutput::pixel_buffer|.
+ * Called from the main thread, as an idle source.
+ */
+static gboolean video_output_render_sw(gpointer data) {
+  VideoOutput* self = (VideoOutput*)data;
+  if (self->destroyed || self->render_context == NULL) {
+    return FALSE;
+  }
+  TRACE_SCOPE("video_output_render_sw", video_output_get_handle(self));
+  g_mutex_lock(&self->mutex);
+  gint64 width = video_output_get_width(self);
+  gint64 height = video_output_get_height(self);
+  // Invisible: the frame is consumed, the pixel buffer keeps the last one.
+  int skip_rendering =
+      video_output_get_visibility(self) != VIDEO_OUTPUT_VISIBILITY_VISIBLE;
+  if (width > 0 && height > 0 &&
+      (skip_rendering || video_output_is_frame_ready(self))) {
+    skip_rendering = skip_rendering || video_output_decimate(self);
+    gint32 size[]{(gint32)width, (gint32)height};
+    gint32 pitch = 4 * (gint32)width;
+    mpv_render_param params[]{
+        {MPV_RENDER_PARAM_SW_SIZE, size},
+        {MPV_RENDER_PARAM_SW_FORMAT, (void*)"rgb0"},
+        {MPV_RENDER_PARAM_SW_STRIDE, &pitch},
+        {MPV_RENDER_PARAM_SW_POINTER, self->pixel_buffer},
+        {MPV_RENDER_PARAM_SKIP_RENDERING, &skip_rendering},
+        {MPV_RENDER_PARAM_INVALID, (void*)0},
+    };
+    mpv_render_context_render(self->render_context, params);
+    if (!skip_rendering) {
+      FrameTap* tap = self->frame_tap.load(std::memory_order_acquire);
+      gint64 now = g_get_monotonic_time();
+      if (tap != NULL && tap->IsDue(now)) {
+        tap->Deliver(self->pixel_buffer, (gint32)width, (gint32)height, pitch,
+                     now);
+      }
+      fl_texture_registrar_mark_texture_frame_available(
+          self->texture_registrar, FL_TEXTURE(self->texture_sw));
+      video_output_measure_decode_resume(self);
+    }
+  }
+  g_mutex_unlock(&self->mutex);
+  return FALSE;
+}
+#endif
+
 VideoOutput* video_output_new(FlTextureRegistrar* texture_registrar,
                               FlView* view,
                               gint64 handle,
@@ -129,6 +954,19 @@ VideoOutput* video_output_new(FlTextureRegistrar* texture_registrar,
   self->width = configuration.width;
   self->height = configuration.height;
   self->configuration = configuration;
+  // Refresh rate of the monitor showing |view|, in mHz; 60 Hz if unknown.
+  GdkWindow* window = view != NULL ? gtk_widget_get_window(GTK_WIDGET(view))
+                                   : NULL;
+  GdkMonitor* monitor =
+      window != NULL
+          ? gdk_display_get_monitor_at_window(gdk_window_get_display(window),
+                                              window)
+          : NULL;
+  gint refresh_rate = monitor != NULL ? gdk_monitor_get_refresh_rate(monitor)
+                                      : 0;
+  if (refresh_rate > 0) {
+    self->render_interval = (gint64)G_USEC_PER_SEC * 1000 / refresh_rate;
+  }
 #ifndef MPV_RENDER_API_TYPE_SW
   // MPV_RENDER_API_TYPE_SW must be available for S/W rendering.
   if (!self->configuration.enable_hardware_acceleration) {
@@ -183,7 +1021,10 @@ VideoOutput* video_output_new(FlTextureRegistrar* texture_registrar,
   
   // Initialize mpv in dedicated GL render thread
   gl_render_thread->PostAndWait([self, &hardware_acceleration_supported]() {
-    mpv_set_option_string(self->handle, "video-sync", "audio");
+    // Untimed live playback has no use for it & must not be overridden.
+    if (!self->configuration.low_latency) {
+      mpv_set_option_string(self->handle, "video-sync", "audio");
+    }
     // Causes frame drops with `pulse` audio output. (SlotSun/dart_simple_live#42)
     // mpv_set_option_string(self->handle, "video-timing-offset", "0");
     
@@ -196,13 +1037,19 @@ VideoOutput* video_output_new(FlTextureRegistrar* texture_registrar,
       
       // Create an isolated EGL context using Flutter's config
       // Using the SAME egl_display and egl_config as Flutter for maximum compatibility
-      const EGLint context_attribs[] = {
-          EGL_CONTEXT_CLIENT_VERSION, 2,
-          EGL_NONE
-      };
-      
-      self->egl_context = eglCreateContext(self->egl_display, self->egl_config, 
-                                           EGL_NO_CONTEXT, context_attribs);
+      // OpenGL ES 3 where the config allows it (S/W upload needs it), as some
+      // drivers return exactly the version requested.
+      for (EGLint version : {3, 2}) {
+        const EGLint context_attribs[] = {
+            EGL_CONTEXT_CLIENT_VERSION, version,
+            EGL_NONE
+        };
+        self->egl_context = eglCreateContext(self->egl_display, self->egl_config,
+                                             EGL_NO_CONTEXT, context_attribs);
+        if (self->egl_context != EGL_NO_CONTEXT) {
+          break;
+        }
+      }
       
       if (self->egl_context != EGL_NO_CONTEXT) {
         g_print("media_kit: VideoOutput: Created isolated EGL context: %p (display: %p, using Flutter's config)\n", 
@@ -211,44 +1058,13 @@ VideoOutput* video_output_new(FlTextureRegistrar* texture_registrar,
         // Make our isolated context current for initialization (surfaceless)
         if (eglMakeCurrent(self->egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, self->egl_context)) {
           // Initialize mpv with our isolated EGL context
-          mpv_opengl_init_params gl_init_params{
-              [](auto, auto name) {
-                return (void*)eglGetProcAddress(name);
-              },
-              NULL,
-          };
-          
-          mpv_render_param params[] = {
-              {MPV_RENDER_PARAM_API_TYPE, (void*)MPV_RENDER_API_TYPE_OPENGL},
-              {MPV_RENDER_PARAM_OPENGL_INIT_PARAMS, (void*)&gl_init_params},
-              {MPV_RENDER_PARAM_INVALID, (void*)0},
-              {MPV_RENDER_PARAM_INVALID, (void*)0},
-          };
-          
-          // VAAPI acceleration requires passing X11/Wayland display
-          GdkDisplay* display = gdk_display_get_default();
-          if (GDK_IS_WAYLAND_DISPLAY(display)) {
-            params[2].type = MPV_RENDER_PARAM_WL_DISPLAY;
-            params[2].data = gdk_wayland_display_get_wl_display(display);
-          } else if (GDK_IS_X11_DISPLAY(display)) {
-            params[2].type = MPV_RENDER_PARAM_X11_DISPLAY;
-            params[2].data = gdk_x11_display_get_xdisplay(display);
-          }
-          
-          if (mpv_render_context_create(&self->render_context, self->handle, params) == 0) {
-            mpv_render_context_set_update_callback(
-                self->render_context,
-                [](void* data) {
-                  VideoOutput* self = (VideoOutput*)data;
-                  if (self->destroyed) {
-                    return;
-                  }
-                  // Asynchronously notify render (don't block mpv thread)
-                  video_output_notify_render(self);
-                },
-                self);
+          if (!self->configuration.sw_upload &&
+              video_output_create_render_context_gl(self)) {
             hardware_acceleration_supported = TRUE;
             g_print("media_kit: VideoOutput: H/W rendering with isolated EGL context in dedicated thread.\n");
+          } else if (video_output_enable_sw_upload(self)) {
+            hardware_acceleration_supported = TRUE;
+            g_print("media_kit: VideoOutput: S/W rendering with pixel buffer object upload in dedicated thread.\n");
           } else {
             g_printerr("media_kit: VideoOutput: Failed to create mpv_render_context.\n");
             eglDestroyContext(self->egl_display, self->egl_context);
@@ -283,49 +1099,20 @@ VideoOutput* video_output_new(FlTextureRegistrar* texture_registrar,
     self->texture_sw = texture_sw_new(self);
     if (fl_texture_registrar_register_texture(texture_registrar,
                                               FL_TEXTURE(self->texture_sw))) {
-      mpv_render_param params[] = {
-          {MPV_RENDER_PARAM_API_TYPE, (void*)MPV_RENDER_API_TYPE_SW},
-          {MPV_RENDER_PARAM_INVALID, (void*)0},
-      };
-      if (mpv_render_context_create(&self->render_context, self->handle,
-                                    params) == 0) {
-        mpv_render_context_set_update_callback(
-            self->render_context,
-            [](void* data) {
-              gdk_threads_add_idle(
-                  [](gpointer data) -> gboolean {
-                    VideoOutput* self = (VideoOutput*)data;
-                    if (self->destroyed) {
-                      return FALSE;
-                    }
-                    g_mutex_lock(&self->mutex);
-                    gint64 width = video_output_get_width(self);
-                    gint64 height = video_output_get_height(self);
-                    if (width > 0 && height > 0) {
-                      gint32 size[]{(gint32)width, (gint32)height};
-                      gint32 pitch = 4 * (gint32)width;
-                      mpv_render_param params[]{
-                          {MPV_RENDER_PARAM_SW_SIZE, size},
-                          {MPV_RENDER_PARAM_SW_FORMAT, (void*)"rgb0"},
-                          {MPV_RENDER_PARAM_SW_STRIDE, &pitch},
-                          {MPV_RENDER_PARAM_SW_POINTER, self->pixel_buffer},
-                          {MPV_RENDER_PARAM_INVALID, (void*)0},
-                      };
-                      mpv_render_context_render(self->render_context, params);
-                      fl_texture_registrar_mark_texture_frame_available(
-                          self->texture_registrar,
-                          FL_TEXTURE(self->texture_sw));
-                    }
-                    g_mutex_unlock(&self->mutex);
-                    return FALSE;
-                  },
-                  data);
-            },
-            self);
-      }
+      video_output_create_render_context_sw(self);
     }
   }
 #endif
+  if (self->configuration.enable_subtitle_overlay) {
+    self->texture_overlay = texture_overlay_new();
+    if (!fl_texture_registrar_register_texture(
+            texture_registrar, FL_TEXTURE(self->texture_overlay))) {
+      g_printerr("media_kit: VideoOutput: Failed to register overlay texture.\n");
+      g_object_unref(self->texture_overlay);
+      self->texture_overlay = NULL;
+    }
+  }
+  video_output_create_observer(self);
   return self;
 }
 
@@ -351,6 +1138,30 @@ void video_output_set_texture_update_callback(
   }
 }
 
+void video_output_set_suspension_callback(
+    VideoOutput* self,
+    SuspensionCallback suspension_callback,
+    gpointer suspension_callback_context) {
+  self->suspension_callback = suspension_callback;
+  self->suspension_callback_context = suspension_callback_context;
+}
+
+void video_output_set_subtitle_overlay_update_callback(
+    VideoOutput* self,
+    TextureUpdateCallback subtitle_overlay_update_callback,
+    gpointer subtitle_overlay_update_callback_context) {
+  self->subtitle_overlay_update_callback = subtitle_overlay_update_callback;
+  self->subtitle_overlay_update_callback_context =
+      subtitle_overlay_update_callback_context;
+  if (self->texture_overlay != NULL) {
+    self->subtitle_overlay_update_callback(
+        video_output_get_subtitle_overlay_texture_id(self),
+        texture_overlay_get_width(self->texture_overlay),
+        texture_overlay_get_height(self->texture_overlay),
+        self->subtitle_overlay_update_callback_context);
+  }
+}
+
 void video_output_set_size(VideoOutput* self, gint64 width, gint64 height) {
   // Ideally, a mutex should be used here & |video_output_get_width| +
   // |video_output_get_height|. However, that is throwing everything into a
@@ -369,7 +1180,705 @@ void video_output_set_size(VideoOutput* self, gint64 width, gint64 height) {
   }
 }
 
+void video_output_set_memory_limit(VideoOutput* self, gint64 bytes) {
+  self->memory_limit.store(MAX(bytes, 0), std::memory_order_relaxed);
+  // Re-allocate the buffers at the new size right away.
+  if (self->texture_gl != NULL) {
+    video_output_notify_render(self);
+  }
+}
+
+void video_output_set_render_scale(VideoOutput* self, gdouble scale) {
+  scale = CLAMP(scale, 0.01, 1.0);
+  gdouble previous =
+      self->render_scale.exchange(scale, std::memory_order_relaxed);
+  if (previous != scale && self->texture_gl != NULL) {
+    video_output_notify_render(self);
+  }
+}
+
+gdouble video_output_get_render_scale(VideoOutput* self) {
+  return self->render_scale.load(std::memory_order_relaxed);
+}
+
+gint64 video_output_take_render_time(VideoOutput* self) {
+  if (self->texture_gl == NULL) {
+    return 0;
+  }
+  return texture_gl_take_render_time(self->texture_gl);
+}
+
+gint64 video_output_get_memory_limit(VideoOutput* self) {
+  return self->memory_limit.load(std::memory_order_relaxed);
+}
+
+void video_output_get_memory_usage(VideoOutput* self,
+                                   VideoOutputMemoryUsage* usage) {
+  *usage = VideoOutputMemoryUsage{};
+  if (self->texture_gl != NULL) {
+    usage->gpu_buffer_count = texture_gl_get_buffer_count(self->texture_gl);
+    usage->gpu_bytes = usage->gpu_buffer_count *
+                       texture_gl_get_buffer_size(self->texture_gl);
+  }
+  if (self->pixel_buffer != NULL) {
+    usage->cpu_pixel_bytes += SW_RENDERING_PIXEL_BUFFER_SIZE;
+  }
+  if (self->texture_overlay != NULL) {
+    usage->cpu_pixel_bytes +=
+        texture_overlay_get_size_in_bytes(self->texture_overlay);
+  }
+
+  mpv_node state;
+  if (mpv_get_property(self->handle, "demuxer-cache-state", MPV_FORMAT_NODE,
+                       &state) >= 0) {
+    if (state.format == MPV_FORMAT_NODE_MAP) {
+      for (int32_t i = 0; i < state.u.list->num; i++) {
+        mpv_node value = state.u.list->values[i];
+        if (strcmp(state.u.list->keys[i], "total-bytes") == 0 &&
+            value.format == MPV_FORMAT_INT64) {
+          usage->demuxer_cache_bytes = value.u.int64;
+        }
+      }
+    }
+    mpv_free_node_contents(&state);
+  }
+
+  // mpv does not expose the hwdec surface pool; estimate it from the worst
+  // case decoder pool (16 reference frames) & `hwdec-extra-frames`.
+  gchar* hwdec = mpv_get_property_string(self->handle, "hwdec-current");
+  if (hwdec != NULL && *hwdec != '\0' && g_strcmp0(hwdec, "no") != 0) {
+    gint64 width = 0, height = 0, extra_frames = 6;
+    mpv_get_property(self->handle, "video-params/w", MPV_FORMAT_INT64, &width);
+    mpv_get_property(self->handle, "video-params/h", MPV_FORMAT_INT64,
+                     &height);
+    mpv_get_property(self->handle, "hwdec-extra-frames", MPV_FORMAT_INT64,
+                     &extra_frames);
+    gchar* format =
+        mpv_get_property_string(self->handle, "video-params/hw-pixelformat");
+    // NV12 is 12 bits per pixel; P010 & other high bit depth formats are 24.
+    gint64 bits_per_pixel =
+        format != NULL && g_str_has_prefix(format, "p0") ? 24 : 12;
+    usage->hwdec_surface_bytes =
+        (16 + extra_frames) * width * height * bits_per_pixel / 8;
+    mpv_free(format);
+  }
+  mpv_free(hwdec);
+}
+
+/**
+ * Disables video decoding of an invisible |VideoOutput|.
+ * Called from the main thread, as a timeout source.
+ */
+static gboolean video_output_suspend_decoding(gpointer data) {
+  VideoOutput* self = (VideoOutput*)data;
+  self->decode_suspension_source = 0;
+  if (self->destroyed || self->decode_suspended_vid != NULL ||
+      self->suspended.load(std::memory_order_relaxed)) {
+    return FALSE;
+  }
+  gchar* vid = mpv_get_property_string(self->handle, "vid");
+  if (vid == NULL || g_strcmp0(vid, "no") == 0) {
+    mpv_free(vid);
+    return FALSE;
+  }
+  TRACE_SCOPE("video_output_suspend_decoding", video_output_get_handle(self));
+  self->decode_suspended_vid = vid;
+  self->decode_resume_time.store(0, std::memory_order_relaxed);
+  mpv_set_property_string(self->handle, "vid", "no");
+  return FALSE;
+}
+
+static void video_output_schedule_decode_suspension(VideoOutput* self) {
+  if (self->configuration.decode_suspension_delay < 0 ||
+      self->decode_suspension_source != 0 ||
+      self->decode_suspended_vid != NULL) {
+    return;
+  }
+  self->decode_suspension_source =
+      g_timeout_add((guint)self->configuration.decode_suspension_delay,
+                    video_output_suspend_decoding, self);
+}
+
+/**
+ * Undoes |video_output_suspend_decoding|. The track is re-selected & followed
+ * by a seek to the current (audio) position: to its keyframe while playing,
+ * so that only a few frames are decoded, or exact while paused.
+ * Called from the main thread.
+ */
+static void video_output_resume_decoding(VideoOutput* self) {
+  if (self->decode_suspension_source != 0) {
+    g_source_remove(self->decode_suspension_source);
+    self->decode_suspension_source = 0;
+  }
+  if (self->decode_suspended_vid == NULL) {
+    return;
+  }
+  TRACE_SCOPE("video_output_resume_decoding", video_output_get_handle(self));
+  gdouble position = 0.0;
+  gboolean seekable = mpv_get_property(self->handle, "time-pos",
+                                       MPV_FORMAT_DOUBLE, &position) >= 0;
+  int pause = 0;
+  mpv_get_property(self->handle, "pause", MPV_FORMAT_FLAG, &pause);
+  // Measured by |video_output_measure_decode_resume|.
+  self->decode_resume_time.store(g_get_monotonic_time(),
+                                 std::memory_order_release);
+  mpv_set_property_string(self->handle, "vid", self->decode_suspended_vid);
+  g_clear_pointer(&self->decode_suspended_vid, mpv_free);
+  if (seekable) {
+    gchar target[G_ASCII_DTOSTR_BUF_SIZE];
+    g_ascii_dtostr(target, sizeof(target), position);
+    const gchar* command[] = {"seek", target,
+                              pause ? "absolute+exact" : "absolute+keyframes",
+                              NULL};
+    mpv_command(self->handle, command);
+  }
+}
+
+void video_output_suspend(VideoOutput* self,
+                          gint64 demuxer_cache_bytes,
+                          gboolean resume_on_playback) {
+  if (self->destroyed || self->suspended.load(std::memory_order_relaxed)) {
+    return;
+  }
+  TRACE_SCOPE("video_output_suspend", video_output_get_handle(self));
+  video_output_destroy_preview(self);
+  self->suspended.store(TRUE, std::memory_order_relaxed);
+  self->resume_on_playback = resume_on_playback;
+
+  // Deselecting the track tears down the decoder (& its hwdec surfaces) and
+  // the VO before the render context goes away.
+  if (self->decode_suspended_vid != NULL) {
+    // Already deselected while invisible.
+    self->suspended_vid = self->decode_suspended_vid;
+    self->decode_suspended_vid = NULL;
+  } else {
+    self->suspended_vid = mpv_get_property_string(self->handle, "vid");
+    mpv_set_property_string(self->handle, "vid", "no");
+  }
+
+  // The demuxer cache sizes are owned by `DemuxerCacheGovernor`.
+  if (self->suspension_callback != NULL) {
+    self->suspension_callback(TRUE, MAX(demuxer_cache_bytes, 0),
+                              self->suspension_callback_context);
+  }
+
+  // H/W
+  if (self->texture_gl) {
+    if (self->render_context != NULL) {
+      mpv_render_context_set_update_callback(self->render_context, NULL, NULL);
+    }
+    // Also flushes renders already posted to the GL thread.
+    self->gl_render_thread->PostAndWait([self]() {
+      if (self->render_context != NULL) {
+        eglMakeCurrent(self->egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE,
+                       self->egl_context);
+        mpv_render_context_free(self->render_context);
+        self->render_context = NULL;
+      }
+    });
+    texture_gl_suspend(self->texture_gl);
+  }
+  // S/W: |pixel_buffer| itself is the snapshot.
+  if (self->texture_sw) {
+    if (self->render_context != NULL) {
+      mpv_render_context_set_update_callback(self->render_context, NULL, NULL);
+    }
+#ifdef MPV_RENDER_API_TYPE_SW
+    video_output_remove_idles(self, video_output_render_sw);
+#endif
+    g_mutex_lock(&self->mutex);
+    if (self->render_context != NULL) {
+      mpv_render_context_free(self->render_context);
+      self->render_context = NULL;
+    }
+    g_mutex_unlock(&self->mutex);
+  }
+}
+
+/**
+ * Restores an mpv property saved by |video_output_suspend| & frees |value|.
+ */
+static void video_output_restore_property(VideoOutput* self,
+                                          const gchar* name,
+                                          gchar** value) {
+  if (*value != NULL) {
+    mpv_set_property_string(self->handle, name, *value);
+    mpv_free(*value);
+    *value = NULL;
+  }
+}
+
+void video_output_resume(VideoOutput* self) {
+  if (self->destroyed || !self->suspended.load(std::memory_order_relaxed)) {
+    return;
+  }
+  TRACE_SCOPE("video_output_resume", video_output_get_handle(self));
+  // H/W
+  if (self->texture_gl) {
+    self->gl_render_thread->PostAndWait([self]() {
+      eglMakeCurrent(self->egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE,
+                     self->egl_context);
+      if (!video_output_create_render_context_gl(self)) {
+        g_printerr("media_kit: VideoOutput: Failed to create mpv_render_context.\n");
+      }
+    });
+  }
+#ifdef MPV_RENDER_API_TYPE_SW
+  // S/W
+  if (self->texture_sw) {
+    if (!video_output_create_render_context_sw(self)) {
+      g_printerr("media_kit: VideoOutput: Failed to create mpv_render_context.\n");
+    }
+  }
+#endif
+  video_output_restore_property(self, "vid", &self->suspended_vid);
+  if (self->suspension_callback != NULL) {
+    self->suspension_callback(FALSE, 0, self->suspension_callback_context);
+  }
+  self->resume_on_playback = FALSE;
+  self->suspended.store(FALSE, std::memory_order_relaxed);
+  if (video_output_get_visibility(self) != VIDEO_OUTPUT_VISIBILITY_VISIBLE) {
+    video_output_schedule_decode_suspension(self);
+  }
+  // Re-allocates the released buffers; the snapshot stays until a new frame.
+  if (self->texture_gl) {
+    video_output_notify_render(self);
+  }
+}
+
+gboolean video_output_is_suspended(VideoOutput* self) {
+  return self->suspended.load(std::memory_order_relaxed);
+}
+
+void video_output_set_visibility(VideoOutput* self,
+                                 VideoOutputVisibility visibility) {
+  if (self->destroyed) {
+    return;
+  }
+  gint previous =
+      self->visibility.exchange(visibility, std::memory_order_relaxed);
+  if (previous == visibility) {
+    return;
+  }
+  TRACE_SCOPE("video_output_set_visibility", video_output_get_handle(self));
+  if (visibility != VIDEO_OUTPUT_VISIBILITY_VISIBLE) {
+    video_output_schedule_decode_suspension(self);
+    return;
+  }
+  video_output_resume_decoding(self);
+  // Catch up: the texture still holds the last frame rendered while visible.
+  if (self->texture_gl != NULL) {
+    video_output_notify_render(self);
+  }
+#ifdef MPV_RENDER_API_TYPE_SW
+  if (self->texture_sw != NULL) {
+    video_output_add_idle(self, video_output_render_sw);
+  }
+#endif
+}
+
+VideoOutputVisibility video_output_get_visibility(VideoOutput* self) {
+  return (VideoOutputVisibility)self->visibility.load(
+      std::memory_order_relaxed);
+}
+
+gboolean video_output_is_decoding_suspended(VideoOutput* self) {
+  return self->decode_suspended_vid != NULL;
+}
+
+gint64 video_output_get_decode_resume_latency(VideoOutput* self) {
+  return self->decode_resume_latency.load(std::memory_order_relaxed);
+}
+
+/**
+ * Seeks |VideoOutput::preview| to |VideoOutput::preview_target|. mpv replaces
+ * a queued seek with a newer one, so a new position cancels the previous one
+ * if decoding of the latter did not start yet.
+ */
+static void video_output_seek_preview(VideoOutput* self) {
+  gdouble position = self->preview_target.load(std::memory_order_seq_cst);
+  if (self->preview == NULL || isnan(position) ||
+      !self->preview_loaded.load(std::memory_order_seq_cst)) {
+    return;
+  }
+  gchar target[G_ASCII_DTOSTR_BUF_SIZE];
+  g_ascii_dtostr(target, sizeof(target), position);
+  const gchar* command[] = {"seek", target, "absolute+keyframes", NULL};
+  mpv_command_async(self->preview, 0, command);
+}
+
+/**
+ * Drains the events of |VideoOutput::preview|.
+ * Called from the dedicated GL thread, never from mpv's wakeup callback.
+ */
+static void video_output_handle_preview_events(VideoOutput* self) {
+  while (!self->destroyed && self->preview != NULL) {
+    mpv_event* event = mpv_wait_event(self->preview, 0);
+    if (event->event_id == MPV_EVENT_NONE) {
+      break;
+    }
+    if (event->event_id == MPV_EVENT_FILE_LOADED) {
+      // Scrubbed before the file was loaded.
+      self->preview_loaded.store(TRUE, std::memory_order_seq_cst);
+      video_output_seek_preview(self);
+    }
+  }
+}
+
+/**
+ * Runs |task| in a new |VideoOutput::preview_thread|, after the previous one:
+ * |mpv_initialize| & |mpv_terminate_destroy| wait for the player core & must
+ * not block the main thread.
+ * Called from the main thread.
+ */
+static void video_output_run_preview_task(VideoOutput* self,
+                                          std::function<void()> task) {
+  std::thread* previous = self->preview_thread;
+  self->preview_thread = new std::thread([previous, task]() {
+    if (previous != NULL) {
+      previous->join();
+      delete previous;
+    }
+    task();
+  });
+}
+
+/**
+ * Loads |path| (owned) in |VideoOutput::preview|, unless already loaded.
+ * Called from the main thread.
+ */
+static void video_output_load_preview(VideoOutput* self, gchar* path) {
+  if (g_strcmp0(path, self->preview_path) == 0) {
+    mpv_free(path);
+    return;
+  }
+  self->preview_loaded.store(FALSE, std::memory_order_seq_cst);
+  const gchar* command[] = {"loadfile", path, NULL};
+  mpv_command_async(self->preview, 0, command);
+  g_clear_pointer(&self->preview_path, mpv_free);
+  self->preview_path = path;
+}
+
+/**
+ * Creates a paused mpv instance without audio that only decodes keyframes,
+ * skipping the loop filter, for the scrub preview, & its render context. The
+ * decoder & network options are those of |VideoOutput::handle|. Returns NULL
+ * on failure.
+ * Called from |VideoOutput::preview_thread|.
+ */
+static mpv_handle* video_output_create_preview(VideoOutput* self) {
+  mpv_handle* preview = mpv_create();
+  if (preview == NULL) {
+    return NULL;
+  }
+  const gchar* options[][2] = {
+      {"vo", "libmpv"},
+      {"ao", "null"},
+      {"aid", "no"},
+      {"sid", "no"},
+      {"pause", "yes"},
+      {"idle", "yes"},
+      {"keep-open", "always"},
+      {"terminal", "no"},
+      {"ytdl", "no"},
+      {"hr-seek", "no"},
+      {"vd-lavc-skipframe", "nonkey"},
+      {"vd-lavc-skiploopfilter", "all"},
+      {"vd-lavc-fast", "yes"},
+      // Every seek lands elsewhere; reading ahead is wasted.
+      {"demuxer-readahead-secs", "0"},
+      {"demuxer-max-back-bytes", "0"},
+  };
+  for (auto& option : options) {
+    mpv_set_option_string(preview, option[0], option[1]);
+  }
+  const gchar* inherited[] = {"hwdec", "http-header-fields", "user-agent",
+                              "referrer"};
+  for (const gchar* name : inherited) {
+    mpv_node value;
+    if (mpv_get_property(self->handle, name, MPV_FORMAT_NODE, &value) >= 0) {
+      mpv_set_option(preview, name, MPV_FORMAT_NODE, &value);
+      mpv_free_node_contents(&value);
+    }
+  }
+  if (mpv_initialize(preview) < 0) {
+    mpv_terminate_destroy(preview);
+    return NULL;
+  }
+  gboolean created = FALSE;
+  self->gl_render_thread->PostAndWait([self, preview, &created]() {
+    eglMakeCurrent(self->egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE,
+                   self->egl_context);
+    self->preview_render_context =
+        video_output_create_render_context_gl_for(self, preview);
+    created = self->preview_render_context != NULL;
+  });
+  if (!created) {
+    mpv_terminate_destroy(preview);
+    return NULL;
+  }
+  return preview;
+}
+
+static gboolean video_output_release_preview(gpointer data);
+
+/**
+ * Makes |VideoOutput::preview_created| the |VideoOutput::preview| & shows the
+ * latest scrub position, if still scrubbing.
+ * Called from the main thread, through |video_output_add_idle|.
+ */
+static gboolean video_output_install_preview(gpointer data) {
+  VideoOutput* self = (VideoOutput*)data;
+  self->preview_pending = FALSE;
+  mpv_handle* preview = self->preview_created;
+  self->preview_created = NULL;
+  if (preview == NULL) {
+    g_printerr("media_kit: VideoOutput: Failed to create scrub preview.\n");
+    // The main player is seeked instead; its frames are shown again.
+    self->preview_failed = TRUE;
+    self->gl_render_thread->Post([self]() {
+      self->previewing.store(FALSE, std::memory_order_relaxed);
+    });
+    return G_SOURCE_REMOVE;
+  }
+  self->preview = preview;
+  mpv_set_wakeup_callback(
+      preview,
+      [](void* data) {
+        VideoOutput* self = (VideoOutput*)data;
+        if (self->destroyed) {
+          return;
+        }
+        // mpv API must not be called from the wakeup callback.
+        self->gl_render_thread->Post(
+            [self]() { video_output_handle_preview_events(self); });
+      },
+      self);
+  if (self->preview_active) {
+    gchar* path = mpv_get_property_string(self->handle, "path");
+    if (path != NULL) {
+      video_output_load_preview(self, path);
+    }
+    video_output_seek_preview(self);
+  } else if (self->preview_destruction_source == 0) {
+    self->preview_destruction_source = g_timeout_add(
+        VIDEO_OUTPUT_PREVIEW_IDLE_TIMEOUT, video_output_release_preview, self);
+  }
+  return G_SOURCE_REMOVE;
+}
+
+static void video_output_destroy_preview(VideoOutput* self) {
+  if (self->preview_handoff_source != 0) {
+    g_source_remove(self->preview_handoff_source);
+    self->preview_handoff_source = 0;
+  }
+  if (self->preview_destruction_source != 0) {
+    g_source_remove(self->preview_destruction_source);
+    self->preview_destruction_source = 0;
+  }
+  self->preview_active = FALSE;
+  if (self->preview == NULL) {
+    return;
+  }
+  mpv_handle* preview = self->preview;
+  mpv_set_wakeup_callback(preview, NULL, NULL);
+  mpv_render_context_set_update_callback(self->preview_render_context, NULL,
+                                         NULL);
+  // Also flushes pending |video_output_handle_preview_events|.
+  self->gl_render_thread->PostAndWait([self]() {
+    self->previewing.store(FALSE, std::memory_order_relaxed);
+    self->preview_handoff.store(FALSE, std::memory_order_relaxed);
+    eglMakeCurrent(self->egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE,
+                   self->egl_context);
+    mpv_render_context_free(self->preview_render_context);
+    self->preview_render_context = NULL;
+    self->preview = NULL;
+  });
+  // Waits for the player core to exit.
+  video_output_run_preview_task(
+      self, [preview]() { mpv_terminate_destroy(preview); });
+  g_clear_pointer(&self->preview_path, mpv_free);
+  self->preview_loaded.store(FALSE, std::memory_order_seq_cst);
+  self->preview_target.store(NAN, std::memory_order_seq_cst);
+}
+
+/**
+ * Releases |VideoOutput::preview| once scrubbing was idle for
+ * |VIDEO_OUTPUT_PREVIEW_IDLE_TIMEOUT|.
+ * Called from the main thread, as a timeout source.
+ */
+static gboolean video_output_release_preview(gpointer data) {
+  VideoOutput* self = (VideoOutput*)data;
+  self->preview_destruction_source = 0;
+  if (!self->destroyed && !self->preview_active) {
+    video_output_destroy_preview(self);
+  }
+  return FALSE;
+}
+
+/**
+ * Hands the texture back to |VideoOutput::handle| if its first frame after
+ * |video_output_end_preview| did not arrive within
+ * |VIDEO_OUTPUT_PREVIEW_HANDOFF_TIMEOUT| e.g. because the seek failed.
+ * Called from the main thread, as a timeout source.
+ */
+static gboolean video_output_finish_preview(gpointer data) {
+  VideoOutput* self = (VideoOutput*)data;
+  self->preview_handoff_source = 0;
+  if (self->destroyed) {
+    return FALSE;
+  }
+  self->gl_render_thread->Post([self]() {
+    if (self->destroyed ||
+        !self->preview_handoff.exchange(FALSE, std::memory_order_relaxed)) {
+      return;
+    }
+    self->previewing.store(FALSE, std::memory_order_relaxed);
+    video_output_check_and_resize(self);
+    video_output_render(self);
+  });
+  return FALSE;
+}
+
+gboolean video_output_preview(VideoOutput* self, gdouble position) {
+  if (self->destroyed || self->texture_gl == NULL || self->sw_upload ||
+      self->render_context == NULL ||
+      self->suspended.load(std::memory_order_relaxed) ||
+      video_output_get_visibility(self) != VIDEO_OUTPUT_VISIBILITY_VISIBLE) {
+    return FALSE;
+  }
+  if (!self->preview_active) {
+    TRACE_SCOPE("video_output_preview", video_output_get_handle(self));
+    gchar* path = mpv_get_property_string(self->handle, "path");
+    if (path == NULL) {
+      return FALSE;
+    }
+    self->preview_failed = FALSE;
+    if (self->preview != NULL) {
+      video_output_load_preview(self, path);
+    } else {
+      // Loaded once created; the texture keeps the current frame meanwhile.
+      mpv_free(path);
+      if (!self->preview_pending) {
+        self->preview_pending = TRUE;
+        video_output_run_preview_task(self, [self]() {
+          self->preview_created = video_output_create_preview(self);
+          video_output_add_idle(self, video_output_install_preview);
+        });
+      }
+    }
+    if (self->preview_handoff_source != 0) {
+      g_source_remove(self->preview_handoff_source);
+      self->preview_handoff_source = 0;
+    }
+    if (self->preview_destruction_source != 0) {
+      g_source_remove(self->preview_destruction_source);
+      self->preview_destruction_source = 0;
+    }
+    // |handle| keeps its last frame & position until the exact seek.
+    int pause = 0;
+    mpv_get_property(self->handle, "pause", MPV_FORMAT_FLAG, &pause);
+    self->preview_resume = !pause;
+    if (!pause) {
+      mpv_set_property_string(self->handle, "pause", "yes");
+    }
+    self->preview_active = TRUE;
+    self->gl_render_thread->Post([self]() {
+      self->preview_handoff.store(FALSE, std::memory_order_relaxed);
+      self->previewing.store(TRUE, std::memory_order_relaxed);
+    });
+  } else if (self->preview_failed) {
+    return FALSE;
+  }
+  self->preview_target.store(position, std::memory_order_seq_cst);
+  video_output_seek_preview(self);
+  return TRUE;
+}
+
+void video_output_end_preview(VideoOutput* self, gdouble position) {
+  if (self->destroyed || !self->preview_active) {
+    return;
+  }
+  TRACE_SCOPE("video_output_end_preview", video_output_get_handle(self));
+  self->preview_active = FALSE;
+  self->preview_target.store(NAN, std::memory_order_seq_cst);
+  // Before the seek: its first frame hands the texture back.
+  self->gl_render_thread->Post([self]() {
+    self->preview_handoff.store(TRUE, std::memory_order_relaxed);
+  });
+  gchar target[G_ASCII_DTOSTR_BUF_SIZE];
+  g_ascii_dtostr(target, sizeof(target), position);
+  const gchar* command[] = {"seek", target, "absolute+exact", NULL};
+  gboolean seeking = mpv_command(self->handle, command) >= 0;
+  if (self->preview_resume) {
+    mpv_set_property_string(self->handle, "pause", "no");
+  }
+  self->preview_handoff_source =
+      g_timeout_add(seeking ? VIDEO_OUTPUT_PREVIEW_HANDOFF_TIMEOUT : 0,
+                    video_output_finish_preview, self);
+  self->preview_destruction_source = g_timeout_add(
+      VIDEO_OUTPUT_PREVIEW_IDLE_TIMEOUT, video_output_release_preview, self);
+}
+
+gboolean video_output_is_previewing(VideoOutput* self) {
+  return self->previewing.load(std::memory_order_relaxed);
+}
+
+/**
+ * Renders the latest keyframe decoded by |VideoOutput::preview|, if new.
+ * Called from the dedicated GL thread with the isolated EGL context current.
+ */
+static void video_output_render_preview(VideoOutput* self) {
+  TRACE_SCOPE("video_output_render_preview", video_output_get_handle(self));
+  if (self->preview_render_context == NULL ||
+      !(mpv_render_context_update(self->preview_render_context) &
+        MPV_RENDER_UPDATE_FRAME)) {
+    return;
+  }
+  // |video_output_get_render_context| returns |preview_render_context|.
+  if (texture_gl_render(self->texture_gl)) {
+    texture_gl_swap_buffers(self->texture_gl);
+    fl_texture_registrar_mark_texture_frame_available(
+        self->texture_registrar, FL_TEXTURE(self->texture_gl));
+  }
+}
+
+gint64 video_output_get_handle(VideoOutput* self) {
+  return (gint64)self->handle;
+}
+
+void video_output_set_hwdec_calibration(VideoOutput* self,
+                                        const HwdecCalibration* calibration) {
+  self->hwdec_calibration.store(calibration, std::memory_order_release);
+}
+
+void video_output_set_frame_tap(VideoOutput* self, FrameTap* tap) {
+  FrameTap* previous =
+      self->frame_tap.exchange(tap, std::memory_order_acq_rel);
+  if (previous == NULL) {
+    return;
+  }
+  // S/W rendering delivers from this (main) thread; wait for a delivery in
+  // progress on the GL thread.
+  if (self->gl_render_thread != NULL) {
+    self->gl_render_thread->PostAndWait([]() {});
+  }
+  delete previous;
+}
+
+gboolean video_output_is_low_latency(VideoOutput* self) {
+  return self->configuration.low_latency;
+}
+
+gboolean video_output_is_sw_upload(VideoOutput* self) {
+  return self->sw_upload;
+}
+
 mpv_render_context* video_output_get_render_context(VideoOutput* self) {
+  if (self->previewing.load(std::memory_order_relaxed) &&
+      self->preview_render_context != NULL) {
+    return self->preview_render_context;
+  }
   return self->render_context;
 }
 
@@ -393,43 +1902,45 @@ guint8* video_output_get_pixel_buffer(VideoOutput* self) {
   return self->pixel_buffer;
 }
 
+/**
+ * Scales |value|, a dimension of the |width| x |height| H/W texture, by
+ * |VideoOutput::render_scale|, further reduced so that all buffers fit in
+ * |VideoOutput::memory_limit|.
+ */
+static gint64 video_output_scale(VideoOutput* self,
+                                 gint64 value,
+                                 gint64 width,
+                                 gint64 height) {
+  if (self->texture_gl == NULL || width < 1 || height < 1) {
+    return value;
+  }
+  gdouble scale = self->render_scale.load(std::memory_order_relaxed);
+  gint64 memory_limit = self->memory_limit.load(std::memory_order_relaxed);
+  if (memory_limit > 0) {
+    gdouble required = (gdouble)width * height * 4 * TEXTURE_GL_BUFFER_COUNT;
+    if (required > memory_limit) {
+      scale = MIN(scale, sqrt(memory_limit / required));
+    }
+  }
+  if (scale >= 1.0) {
+    return value;
+  }
+  return MAX((gint64)(value * scale), 1);
+}
+
 gint64 video_output_get_width(VideoOutput* self) {
   // Fixed width.
   if (self->width) {
-    return self->width;
+    return video_output_scale(self, self->width, self->width, self->height);
   }
 
   // Video resolution dependent width.
   gint64 width = 0;
   gint64 height = 0;
 
-  mpv_node params;
-  mpv_get_property(self->handle, "video-out-params", MPV_FORMAT_NODE, &params);
-
-  int64_t dw = 0, dh = 0, rotate = 0;
-  if (params.format == MPV_FORMAT_NODE_MAP) {
-    for (int32_t i = 0; i < params.u.list->num; i++) {
-      char* key = params.u.list->keys[i];
-      auto value = params.u.list->values[i];
-      if (value.format == MPV_FORMAT_INT64) {
-        if (strcmp(key, "dw") == 0) {
-          dw = value.u.int64;
-        }
-        if (strcmp(key, "dh") == 0) {
-          dh = value.u.int64;
-        }
-        if (strcmp(key, "rotate") == 0) {
-          rotate = value.u.int64;
-        }
-      }
-    }
-    mpv_free_node_contents(&params);
-  }
-
-  width = rotate == 0 || rotate == 180 ? dw : dh;
-  height = rotate == 0 || rotate == 180 ? dh : dw;
+  video_output_get_video_out_size(self, &width, &height);
 
-  if (self->texture_sw != NULL) {
+  if (self->texture_sw != NULL || self->sw_upload) {
     // Make sure |width| & |height| fit between |SW_RENDERING_MAX_WIDTH| &
     // |SW_RENDERING_MAX_HEIGHT| while maintaining aspect ratio.
     if (width >= SW_RENDERING_MAX_WIDTH) {
@@ -440,46 +1951,22 @@ gint64 video_output_get_width(VideoOutput* self) {
     }
   }
 
-  return width;
+  return video_output_scale(self, width, width, height);
 }
 
 gint64 video_output_get_height(VideoOutput* self) {
   // Fixed height.
   if (self->width) {
-    return self->height;
+    return video_output_scale(self, self->height, self->width, self->height);
   }
 
   // Video resolution dependent height.
   gint64 width = 0;
   gint64 height = 0;
 
-  mpv_node params;
-  mpv_get_property(self->handle, "video-out-params", MPV_FORMAT_NODE, &params);
+  video_output_get_video_out_size(self, &width, &height);
 
-  int64_t dw = 0, dh = 0, rotate = 0;
-  if (params.format == MPV_FORMAT_NODE_MAP) {
-    for (int32_t i = 0; i < params.u.list->num; i++) {
-      char* key = params.u.list->keys[i];
-      auto value = params.u.list->values[i];
-      if (value.format == MPV_FORMAT_INT64) {
-        if (strcmp(key, "dw") == 0) {
-          dw = value.u.int64;
-        }
-        if (strcmp(key, "dh") == 0) {
-          dh = value.u.int64;
-        }
-        if (strcmp(key, "rotate") == 0) {
-          rotate = value.u.int64;
-        }
-      }
-    }
-    mpv_free_node_contents(&params);
-  }
-
-  width = rotate == 0 || rotate == 180 ? dw : dh;
-  height = rotate == 0 || rotate == 180 ? dh : dw;
-
-  if (self->texture_sw != NULL) {
+  if (self->texture_sw != NULL || self->sw_upload) {
     // Make sure |width| & |height| fit between |SW_RENDERING_MAX_WIDTH| &
     // |SW_RENDERING_MAX_HEIGHT| while maintaining aspect ratio.
     if (height >= SW_RENDERING_MAX_HEIGHT) {
@@ -490,7 +1977,7 @@ gint64 video_output_get_height(VideoOutput* self) {
     }
   }
 
-  return height;
+  return video_output_scale(self, height, width, height);
 }
 
 gint64 video_output_get_texture_id(VideoOutput* self) {
@@ -506,6 +1993,13 @@ gint64 video_output_get_texture_id(VideoOutput* self) {
   return -1;
 }
 
+gint64 video_output_get_subtitle_overlay_texture_id(VideoOutput* self) {
+  if (self->texture_overlay) {
+    return (gint64)self->texture_overlay;
+  }
+  return -1;
+}
+
 void video_output_notify_texture_update(VideoOutput* self) {
   gint64 id = video_output_get_texture_id(self);
   gint64 width = video_output_get_width(self);
@@ -517,18 +2011,30 @@ void video_output_notify_texture_update(VideoOutput* self) {
 }
 
 void video_output_notify_render(VideoOutput* self) {
-  if (self->destroyed || !self->gl_render_thread) {
+  if (self->destroyed || !self->gl_render_thread ||
+      self->suspended.load(std::memory_order_relaxed)) {
+    return;
+  }
+  // Coalesce: a queued render picks up the latest frame anyway.
+  if (self->render_pending.exchange(TRUE, std::memory_order_acq_rel)) {
     return;
   }
   // Post combined check_and_resize + render task to GL thread (asynchronously)
   self->gl_render_thread->Post([self]() {
+    TRACE_SCOPE("video_output_notify_render", video_output_get_handle(self));
+    self->render_pending.store(FALSE, std::memory_order_release);
     video_output_check_and_resize(self);
     video_output_render(self);
   });
 }
 
 void video_output_check_and_resize(VideoOutput* self) {
-  if (self->destroyed || !self->texture_gl) {
+  if (self->destroyed || !self->texture_gl ||
+      self->suspended.load(std::memory_order_relaxed)) {
+    return;
+  }
+  // Deferred until visible; the catch-up render resizes first.
+  if (video_output_get_visibility(self) != VIDEO_OUTPUT_VISIBILITY_VISIBLE) {
     return;
   }
   
@@ -551,17 +2057,60 @@ void video_output_render(VideoOutput* self) {
   
   // H/W rendering with triple buffering
   if (self->texture_gl && self->render_context) {
+    if (video_output_get_visibility(self) != VIDEO_OUTPUT_VISIBILITY_VISIBLE ||
+        video_output_decimate(self)) {
+      // Consume the frame without GPU work, so that mpv's clock & frame
+      // timing continue as if it was displayed.
+      TRACE_SCOPE("video_output_skip_render", video_output_get_handle(self));
+      eglMakeCurrent(self->egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE,
+                     self->egl_context);
+      int skip_rendering = 1;
+      mpv_render_param params[]{
+          {MPV_RENDER_PARAM_SKIP_RENDERING, &skip_rendering},
+          {MPV_RENDER_PARAM_INVALID, NULL},
+      };
+      mpv_render_context_render(self->render_context, params);
+      return;
+    }
+    if (self->previewing.load(std::memory_order_relaxed)) {
+      eglMakeCurrent(self->egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE,
+                     self->egl_context);
+      // |handle| is paused; its frames wait until the preview is handed back.
+      if (!self->preview_handoff.load(std::memory_order_relaxed) ||
+          !(mpv_render_context_update(self->render_context) &
+            MPV_RENDER_UPDATE_FRAME)) {
+        video_output_render_preview(self);
+        return;
+      }
+      // First frame of the exact seek of |video_output_end_preview|.
+      self->preview_handoff.store(FALSE, std::memory_order_relaxed);
+      self->previewing.store(FALSE, std::memory_order_relaxed);
+    }
+    if (self->decode_resume_time.load(std::memory_order_acquire) != 0) {
+      // |mpv_render_context_update| may run GL work queued by mpv's VO.
+      eglMakeCurrent(self->egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE,
+                     self->egl_context);
+      if (!video_output_is_frame_ready(self)) {
+        return;
+      }
+    }
     // Render to write buffer
     gboolean rendered = texture_gl_render(self->texture_gl);
     
     // Only swap and notify if rendering was actually performed
     if (rendered) {
+      FrameTap* tap = self->frame_tap.load(std::memory_order_acquire);
+      gint64 now = g_get_monotonic_time();
+      if (tap != NULL && tap->IsDue(now)) {
+        texture_gl_tap(self->texture_gl, tap, now);
+      }
       // Publish the rendered frame (update buffer indices)
       texture_gl_swap_buffers(self->texture_gl);
       
       // Notify Flutter that a new frame is available
       fl_texture_registrar_mark_texture_frame_available(
           self->texture_registrar, FL_TEXTURE(self->texture_gl));
+      video_output_measure_decode_resume(self);
     }
   }
 }
@@ -7,6 +7,23 @@
 // LICENSE file.
 
 #include "include/media_kit_video/video_output_manager.h"
+#include "include/media_kit_video/allocator.h"
+#include "include/media_kit_video/hwdec_calibration.h"
+#include "include/media_kit_video/memory_pressure_monitor.h"
+#include "include/media_kit_video/player_host.h"
+#include "include/media_kit_video/render_scale_controller.h"
+
+#include <glib/gstdio.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+// Size the demuxer cache of a suspended |VideoOutput| is trimmed to.
+#define DEFAULT_SUSPEND_DEMUXER_CACHE_BYTES (4 * 1024 * 1024)
+
+// Measurement window of |RenderScaleController| in milliseconds.
+#define ADAPTIVE_RESOLUTION_INTERVAL 500
 
 struct _VideoOutputManager {
   GObject parent_instance;
@@ -14,6 +31,20 @@ struct _VideoOutputManager {
   FlTextureRegistrar* texture_registrar;
   FlView* view;
   GLRenderThread* gl_render_thread;
+  GHashTable* memory_limits; /* Per-output limits set by the user. */
+  gint64 total_memory_limit;
+  MemoryPressureMonitor* memory_pressure_monitor;
+  gboolean auto_suspend; /* Suspend paused outputs under memory pressure. */
+  gint64 suspend_demuxer_cache_bytes;
+  GHashTable* priorities; /* Per-output priorities set by the user. */
+  RenderScaleController* render_scale_controller;
+  guint adaptive_resolution_source; /* 0 if adaptive resolution is disabled. */
+  gint64 adaptive_resolution_time;  /* Start of the current window. */
+  HwdecCalibration* hwdec_calibration; /* Published once loaded or measured, NULL until then. */
+  std::thread* hwdec_calibration_thread; /* Measuring, NULL if not started. */
+  HwdecCalibration* hwdec_calibration_result; /* Handed over by |hwdec_calibration_thread|. */
+  guint hwdec_calibration_source; /* Publishes |hwdec_calibration_result|. */
+  std::atomic<bool> hwdec_calibration_cancel;
 };
 
 G_DEFINE_TYPE(VideoOutputManager, video_output_manager, G_TYPE_OBJECT)
@@ -22,11 +53,49 @@ static void video_output_manager_init(VideoOutputManager* self) {
   self->video_outputs = g_hash_table_new_full(g_direct_hash, g_direct_equal,
                                               nullptr, g_object_unref);
   self->gl_render_thread = new GLRenderThread();  // Dedicated GL render thread
+  self->memory_limits =
+      g_hash_table_new_full(g_direct_hash, g_direct_equal, nullptr, nullptr);
+  self->total_memory_limit = 0;
+  self->memory_pressure_monitor = NULL;
+  self->auto_suspend = TRUE;
+  self->suspend_demuxer_cache_bytes = DEFAULT_SUSPEND_DEMUXER_CACHE_BYTES;
+  self->priorities =
+      g_hash_table_new_full(g_direct_hash, g_direct_equal, nullptr, nullptr);
+  self->render_scale_controller = new RenderScaleController();
+  self->adaptive_resolution_source = 0;
+  self->adaptive_resolution_time = 0;
+  self->hwdec_calibration = NULL;
+  self->hwdec_calibration_thread = NULL;
+  self->hwdec_calibration_result = NULL;
+  self->hwdec_calibration_source = 0;
+  self->hwdec_calibration_cancel.store(false, std::memory_order_relaxed);
 }
 
 static void video_output_manager_dispose(GObject* object) {
   VideoOutputManager* self = VIDEO_OUTPUT_MANAGER(object);
+  g_clear_object(&self->memory_pressure_monitor);
+  if (self->adaptive_resolution_source != 0) {
+    g_source_remove(self->adaptive_resolution_source);
+    self->adaptive_resolution_source = 0;
+  }
+  if (self->hwdec_calibration_thread != NULL) {
+    // Stops between two measurements.
+    self->hwdec_calibration_cancel.store(true, std::memory_order_relaxed);
+    self->hwdec_calibration_thread->join();
+    delete self->hwdec_calibration_thread;
+    self->hwdec_calibration_thread = NULL;
+    // Not published yet: the source is still pending.
+    if (self->hwdec_calibration_result != NULL) {
+      g_source_remove(self->hwdec_calibration_source);
+    }
+    delete self->hwdec_calibration_result;
+    self->hwdec_calibration_result = NULL;
+  }
   g_hash_table_unref(self->video_outputs);
+  g_hash_table_unref(self->memory_limits);
+  g_hash_table_unref(self->priorities);
+  delete self->hwdec_calibration;
+  delete self->render_scale_controller;
   delete self->gl_render_thread;
   G_OBJECT_CLASS(video_output_manager_parent_class)->dispose(object);
 }
@@ -35,6 +104,36 @@ static void video_output_manager_class_init(VideoOutputManagerClass* klass) {
   G_OBJECT_CLASS(klass)->dispose = video_output_manager_dispose;
 }
 
+/**
+ * Suspends the |VideoOutput|s whose playback is paused: their last frame is
+ * all that is visible anyway. Each resumes by itself once played or seeked.
+ */
+static void video_output_manager_on_memory_pressure(MemoryPressureLevel level,
+                                                    gpointer context) {
+  VideoOutputManager* self = VIDEO_OUTPUT_MANAGER(context);
+  // Return the free pages of the allocator to the OS, regardless of suspension.
+  gboolean force = level == MEMORY_PRESSURE_LEVEL_CRITICAL;
+  self->gl_render_thread->Post(
+      [force]() { Allocator::CollectThreadHeap(force); });
+  Allocator::Collect(force);
+  if (!self->auto_suspend) {
+    return;
+  }
+  GHashTableIter iter;
+  gpointer value;
+  g_hash_table_iter_init(&iter, self->video_outputs);
+  while (g_hash_table_iter_next(&iter, NULL, &value)) {
+    VideoOutput* video_output = VIDEO_OUTPUT(value);
+    int pause = 0;
+    mpv_get_property((mpv_handle*)video_output_get_handle(video_output),
+                     "pause", MPV_FORMAT_FLAG, &pause);
+    if (pause && !video_output_is_suspended(video_output)) {
+      video_output_suspend(video_output, self->suspend_demuxer_cache_bytes,
+                           TRUE);
+    }
+  }
+}
+
 VideoOutputManager* video_output_manager_new(
     FlTextureRegistrar* texture_registrar,
     FlView* view) {
@@ -42,9 +141,141 @@ VideoOutputManager* video_output_manager_new(
       g_object_new(video_output_manager_get_type(), nullptr));
   video_output_manager->texture_registrar = texture_registrar;
   video_output_manager->view = view;
+  video_output_manager->memory_pressure_monitor = memory_pressure_monitor_new(
+      video_output_manager_on_memory_pressure, video_output_manager);
   return video_output_manager;
 }
 
+/**
+ * Applies the lower of the per-output limit & the equal share of the total
+ * limit to every |VideoOutput|. Called whenever either or the number of
+ * |VideoOutput|s changes.
+ */
+static void video_output_manager_apply_memory_limits(VideoOutputManager* self) {
+  guint count = g_hash_table_size(self->video_outputs);
+  gint64 share = self->total_memory_limit > 0 && count > 0
+                     ? self->total_memory_limit / count
+                     : 0;
+  GHashTableIter iter;
+  gpointer key, value;
+  g_hash_table_iter_init(&iter, self->video_outputs);
+  while (g_hash_table_iter_next(&iter, &key, &value)) {
+    gint64 limit =
+        GPOINTER_TO_SIZE(g_hash_table_lookup(self->memory_limits, key));
+    if (share > 0 && (limit == 0 || share < limit)) {
+      limit = share;
+    }
+    if (video_output_get_memory_limit(VIDEO_OUTPUT(value)) != limit) {
+      video_output_set_memory_limit(VIDEO_OUTPUT(value), limit);
+    }
+  }
+}
+
+/**
+ * Feeds the render time of every |VideoOutput| in the last window to
+ * |render_scale_controller| & applies the scales it changed.
+ * Called from the main thread, as a timeout source.
+ */
+static gboolean video_output_manager_update_render_scales(gpointer data) {
+  VideoOutputManager* self = VIDEO_OUTPUT_MANAGER(data);
+  gint64 now = g_get_monotonic_time();
+  gint64 window = now - self->adaptive_resolution_time;
+  self->adaptive_resolution_time = now;
+  std::vector<RenderScaleController::Sample> samples;
+  samples.reserve(g_hash_table_size(self->video_outputs));
+  GHashTableIter iter;
+  gpointer key, value;
+  g_hash_table_iter_init(&iter, self->video_outputs);
+  while (g_hash_table_iter_next(&iter, &key, &value)) {
+    RenderScaleController::Sample sample;
+    sample.key = GPOINTER_TO_INT(key);
+    sample.priority =
+        GPOINTER_TO_INT(g_hash_table_lookup(self->priorities, key));
+    sample.render_time = video_output_take_render_time(VIDEO_OUTPUT(value));
+    samples.push_back(sample);
+  }
+  for (int64_t handle :
+       self->render_scale_controller->Update(samples, window)) {
+    gdouble scale = self->render_scale_controller->GetScale(handle);
+    video_output_set_render_scale(
+        VIDEO_OUTPUT(g_hash_table_lookup(self->video_outputs,
+                                         GINT_TO_POINTER(handle))),
+        scale);
+  }
+  return G_SOURCE_CONTINUE;
+}
+
+/**
+ * Makes |calibration| the one applied by every |VideoOutput|.
+ */
+static void video_output_manager_publish_hwdec_calibration(
+    VideoOutputManager* self,
+    HwdecCalibration* calibration) {
+  self->hwdec_calibration = calibration;
+  GHashTableIter iter;
+  gpointer value;
+  g_hash_table_iter_init(&iter, self->video_outputs);
+  while (g_hash_table_iter_next(&iter, NULL, &value)) {
+    video_output_set_hwdec_calibration(VIDEO_OUTPUT(value), calibration);
+  }
+}
+
+/**
+ * Loads the persisted |HwdecCalibration| or, on first run (or once the system
+ * changed), measures it in a background thread. |VideoOutput|s created in
+ * the meantime keep mpv's own choice until it is published. A calibration
+ * that measured nothing is persisted as well, so that it is not retried on
+ * every launch.
+ */
+static void video_output_manager_start_hwdec_calibration(
+    VideoOutputManager* self) {
+  if (self->hwdec_calibration != NULL ||
+      self->hwdec_calibration_thread != NULL) {
+    return;
+  }
+  std::string directory = HwdecCalibration::DefaultCacheDirectory();
+  HwdecCalibration* calibration = new HwdecCalibration();
+  if (calibration->Load(directory.c_str())) {
+    video_output_manager_publish_hwdec_calibration(self, calibration);
+    return;
+  }
+  self->hwdec_calibration_thread = new std::thread([self, calibration,
+                                                    directory]() {
+    std::string helper = PlayerHostPool::DefaultPath();
+    gchar* work_dir = g_dir_make_tmp("media_kit_hwdec_XXXXXX", NULL);
+    bool result =
+        work_dir != NULL && calibration->Run(work_dir, helper.c_str(),
+                                             &self->hwdec_calibration_cancel);
+    if (work_dir != NULL) {
+      g_rmdir(work_dir);
+      g_free(work_dir);
+    }
+    if (self->hwdec_calibration_cancel.load(std::memory_order_relaxed)) {
+      // Not persisted: resumed on next launch.
+      delete calibration;
+      return;
+    }
+    if (!result) {
+      g_printerr("media_kit: VideoOutputManager: hwdec calibration failed.\n");
+    }
+    if (!calibration->Save(directory.c_str())) {
+      g_printerr(
+          "media_kit: VideoOutputManager: Unable to persist hwdec "
+          "calibration.\n");
+    }
+    self->hwdec_calibration_result = calibration;
+    self->hwdec_calibration_source = g_idle_add(
+        [](gpointer data) -> gboolean {
+          VideoOutputManager* self = VIDEO_OUTPUT_MANAGER(data);
+          video_output_manager_publish_hwdec_calibration(
+              self, self->hwdec_calibration_result);
+          self->hwdec_calibration_result = NULL;
+          return G_SOURCE_REMOVE;
+        },
+        self);
+  });
+}
+
 void video_output_manager_create(VideoOutputManager* self,
                                  gint64 handle,
                                  VideoOutputConfiguration configuration,
@@ -55,8 +286,41 @@ void video_output_manager_create(VideoOutputManager* self,
         self->texture_registrar, self->view, handle, configuration, self->gl_render_thread);
     video_output_set_texture_update_callback(
         video_output, texture_update_callback, texture_update_callback_context);
+    if (configuration.hwdec_calibration) {
+      video_output_manager_start_hwdec_calibration(self);
+      video_output_set_hwdec_calibration(video_output,
+                                         self->hwdec_calibration);
+    }
     g_hash_table_insert(self->video_outputs, GINT_TO_POINTER(handle),
                         g_object_ref(video_output));
+    video_output_manager_apply_memory_limits(self);
+  }
+}
+
+void video_output_manager_set_subtitle_overlay_update_callback(
+    VideoOutputManager* self,
+    gint64 handle,
+    TextureUpdateCallback subtitle_overlay_update_callback,
+    gpointer subtitle_overlay_update_callback_context) {
+  if (g_hash_table_contains(self->video_outputs, GINT_TO_POINTER(handle))) {
+    VideoOutput* video_output = VIDEO_OUTPUT(
+        g_hash_table_lookup(self->video_outputs, GINT_TO_POINTER(handle)));
+    video_output_set_subtitle_overlay_update_callback(
+        video_output, subtitle_overlay_update_callback,
+        subtitle_overlay_update_callback_context);
+  }
+}
+
+void video_output_manager_set_suspension_callback(
+    VideoOutputManager* self,
+    gint64 handle,
+    SuspensionCallback suspension_callback,
+    gpointer suspension_callback_context) {
+  if (g_hash_table_contains(self->video_outputs, GINT_TO_POINTER(handle))) {
+    VideoOutput* video_output = VIDEO_OUTPUT(
+        g_hash_table_lookup(self->video_outputs, GINT_TO_POINTER(handle)));
+    video_output_set_suspension_callback(video_output, suspension_callback,
+                                         suspension_callback_context);
   }
 }
 
@@ -71,8 +335,215 @@ void video_output_manager_set_size(VideoOutputManager* self,
   }
 }
 
+void video_output_manager_set_memory_limit(VideoOutputManager* self,
+                                           gint64 handle,
+                                           gint64 bytes) {
+  if (g_hash_table_contains(self->video_outputs, GINT_TO_POINTER(handle))) {
+    g_hash_table_insert(self->memory_limits, GINT_TO_POINTER(handle),
+                        GSIZE_TO_POINTER(MAX(bytes, 0)));
+    video_output_manager_apply_memory_limits(self);
+  }
+}
+
+void video_output_manager_set_total_memory_limit(VideoOutputManager* self,
+                                                 gint64 bytes) {
+  self->total_memory_limit = MAX(bytes, 0);
+  video_output_manager_apply_memory_limits(self);
+}
+
+gboolean video_output_manager_get_memory_usage(VideoOutputManager* self,
+                                               gint64 handle,
+                                               VideoOutputMemoryUsage* usage) {
+  *usage = VideoOutputMemoryUsage{};
+  if (handle != 0) {
+    if (!g_hash_table_contains(self->video_outputs, GINT_TO_POINTER(handle))) {
+      return FALSE;
+    }
+    video_output_get_memory_usage(
+        VIDEO_OUTPUT(
+            g_hash_table_lookup(self->video_outputs, GINT_TO_POINTER(handle))),
+        usage);
+    return TRUE;
+  }
+  // Sum of all outputs.
+  GHashTableIter iter;
+  gpointer value;
+  g_hash_table_iter_init(&iter, self->video_outputs);
+  while (g_hash_table_iter_next(&iter, NULL, &value)) {
+    VideoOutputMemoryUsage output_usage;
+    video_output_get_memory_usage(VIDEO_OUTPUT(value), &output_usage);
+    usage->gpu_buffer_count += output_usage.gpu_buffer_count;
+    usage->gpu_bytes += output_usage.gpu_bytes;
+    usage->cpu_pixel_bytes += output_usage.cpu_pixel_bytes;
+    usage->demuxer_cache_bytes += output_usage.demuxer_cache_bytes;
+    usage->hwdec_surface_bytes += output_usage.hwdec_surface_bytes;
+  }
+  return TRUE;
+}
+
+void video_output_manager_suspend(VideoOutputManager* self,
+                                  gint64 handle,
+                                  gint64 demuxer_cache_bytes) {
+  if (g_hash_table_contains(self->video_outputs, GINT_TO_POINTER(handle))) {
+    VideoOutput* video_output = VIDEO_OUTPUT(
+        g_hash_table_lookup(self->video_outputs, GINT_TO_POINTER(handle)));
+    video_output_suspend(video_output,
+                         demuxer_cache_bytes >= 0
+                             ? demuxer_cache_bytes
+                             : self->suspend_demuxer_cache_bytes,
+                         FALSE);
+  }
+}
+
+void video_output_manager_resume(VideoOutputManager* self, gint64 handle) {
+  if (g_hash_table_contains(self->video_outputs, GINT_TO_POINTER(handle))) {
+    VideoOutput* video_output = VIDEO_OUTPUT(
+        g_hash_table_lookup(self->video_outputs, GINT_TO_POINTER(handle)));
+    video_output_resume(video_output);
+  }
+}
+
+void video_output_manager_set_visibility(VideoOutputManager* self,
+                                         gint64 handle,
+                                         VideoOutputVisibility visibility) {
+  if (g_hash_table_contains(self->video_outputs, GINT_TO_POINTER(handle))) {
+    VideoOutput* video_output = VIDEO_OUTPUT(
+        g_hash_table_lookup(self->video_outputs, GINT_TO_POINTER(handle)));
+    video_output_set_visibility(video_output, visibility);
+  }
+}
+
+gboolean video_output_manager_get_decode_resume_latency(
+    VideoOutputManager* self,
+    gint64 handle,
+    gint64* latency) {
+  if (!g_hash_table_contains(self->video_outputs, GINT_TO_POINTER(handle))) {
+    return FALSE;
+  }
+  VideoOutput* video_output = VIDEO_OUTPUT(
+      g_hash_table_lookup(self->video_outputs, GINT_TO_POINTER(handle)));
+  *latency = video_output_get_decode_resume_latency(video_output);
+  return TRUE;
+}
+
+gboolean video_output_manager_preview(VideoOutputManager* self,
+                                      gint64 handle,
+                                      gdouble position) {
+  if (!g_hash_table_contains(self->video_outputs, GINT_TO_POINTER(handle))) {
+    return FALSE;
+  }
+  VideoOutput* video_output = VIDEO_OUTPUT(
+      g_hash_table_lookup(self->video_outputs, GINT_TO_POINTER(handle)));
+  return video_output_preview(video_output, position);
+}
+
+void video_output_manager_end_preview(VideoOutputManager* self,
+                                      gint64 handle,
+                                      gdouble position) {
+  if (g_hash_table_contains(self->video_outputs, GINT_TO_POINTER(handle))) {
+    VideoOutput* video_output = VIDEO_OUTPUT(
+        g_hash_table_lookup(self->video_outputs, GINT_TO_POINTER(handle)));
+    video_output_end_preview(video_output, position);
+  }
+}
+
+FrameTap* video_output_manager_create_frame_tap(VideoOutputManager* self,
+                                                gint64 handle,
+                                                FrameTapFormat format,
+                                                gint32 width,
+                                                gint32 height,
+                                                gdouble rate,
+                                                gint32 buffer_count) {
+  if (!g_hash_table_contains(self->video_outputs, GINT_TO_POINTER(handle))) {
+    return NULL;
+  }
+  VideoOutput* video_output = VIDEO_OUTPUT(
+      g_hash_table_lookup(self->video_outputs, GINT_TO_POINTER(handle)));
+  FrameTap* tap = new FrameTap(format, width, height, rate, buffer_count);
+  video_output_set_frame_tap(video_output, tap);
+  return tap;
+}
+
+void video_output_manager_dispose_frame_tap(VideoOutputManager* self,
+                                            gint64 handle) {
+  if (g_hash_table_contains(self->video_outputs, GINT_TO_POINTER(handle))) {
+    VideoOutput* video_output = VIDEO_OUTPUT(
+        g_hash_table_lookup(self->video_outputs, GINT_TO_POINTER(handle)));
+    video_output_set_frame_tap(video_output, NULL);
+  }
+}
+
+void video_output_manager_set_adaptive_resolution(VideoOutputManager* self,
+                                                  gboolean enabled) {
+  if (enabled == (self->adaptive_resolution_source != 0)) {
+    return;
+  }
+  if (enabled) {
+    // Discard the render time accumulated so far.
+    GHashTableIter iter;
+    gpointer value;
+    g_hash_table_iter_init(&iter, self->video_outputs);
+    while (g_hash_table_iter_next(&iter, NULL, &value)) {
+      video_output_take_render_time(VIDEO_OUTPUT(value));
+    }
+    self->adaptive_resolution_time = g_get_monotonic_time();
+    self->adaptive_resolution_source =
+        g_timeout_add(ADAPTIVE_RESOLUTION_INTERVAL,
+                      video_output_manager_update_render_scales, self);
+    return;
+  }
+  g_source_remove(self->adaptive_resolution_source);
+  self->adaptive_resolution_source = 0;
+  self->render_scale_controller->Reset();
+  GHashTableIter iter;
+  gpointer value;
+  g_hash_table_iter_init(&iter, self->video_outputs);
+  while (g_hash_table_iter_next(&iter, NULL, &value)) {
+    video_output_set_render_scale(VIDEO_OUTPUT(value), 1.0);
+  }
+}
+
+void video_output_manager_set_priority(VideoOutputManager* self,
+                                       gint64 handle,
+                                       gint priority) {
+  if (g_hash_table_contains(self->video_outputs, GINT_TO_POINTER(handle))) {
+    g_hash_table_insert(self->priorities, GINT_TO_POINTER(handle),
+                        GINT_TO_POINTER(priority));
+  }
+}
+
+void video_output_manager_set_auto_suspend(VideoOutputManager* self,
+                                           gboolean enabled,
+                                           gint64 demuxer_cache_bytes) {
+  self->auto_suspend = enabled;
+  if (demuxer_cache_bytes >= 0) {
+    self->suspend_demuxer_cache_bytes = demuxer_cache_bytes;
+  }
+}
+
+void video_output_manager_notify_memory_pressure(VideoOutputManager* self,
+                                                 gint level) {
+  memory_pressure_monitor_notify(
+      self->memory_pressure_monitor,
+      (MemoryPressureLevel)CLAMP(level, MEMORY_PRESSURE_LEVEL_LOW,
+                                 MEMORY_PRESSURE_LEVEL_CRITICAL));
+}
+
 void video_output_manager_dispose(VideoOutputManager* self, gint64 handle) {
   if (g_hash_table_contains(self->video_outputs, GINT_TO_POINTER(handle))) {
     g_hash_table_remove(self->video_outputs, GINT_TO_POINTER(handle));
+    g_hash_table_remove(self->memory_limits, GINT_TO_POINTER(handle));
+    g_hash_table_remove(self->priorities, GINT_TO_POINTER(handle));
+    video_output_manager_apply_memory_limits(self);
+    // The render context & buffers of the |VideoOutput| are gone.
+    self->gl_render_thread->Post([]() { Allocator::CollectThreadHeap(false); });
   }
 }
+
+void video_output_manager_get_allocator_stats(VideoOutputManager* self,
+                                              Allocator::Stats* stats,
+                                              Allocator::HeapStats* heap) {
+  *stats = Allocator::GetStats();
+  self->gl_render_thread->PostAndWait(
+      [heap]() { Allocator::GetThreadHeapStats(heap); });
+}
@@ -8,9 +8,16 @@
 #ifndef THREAD_POOL_H_
 #define THREAD_POOL_H_
 
+#include <condition_variable>
+#include <cstddef>
 #include <functional>
 #include <future>
-#include <queue>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <vector>
 
 #ifdef _WIN32
 #include <Windows.h>
@@ -19,13 +26,187 @@
 class ThreadPool {
  public:
   explicit ThreadPool(size_t);
+  // Does not allocate: the task is stored in its queue slot & the shared state
+  // of the returned |std::future| in a preallocated block. Only falls back to
+  // the heap if either does not fit (see |Task::kCapacity| & |States|).
   template <class F, class... Args>
   decltype(auto) Post(F&& f, Args&&... args);
+  // Like |Post|, without a |std::future|; meant for the per-frame render
+  // tasks.
+  template <class F>
+  void Dispatch(F&& task);
   ~ThreadPool();
 
  private:
+  // Move-only |void()| callable, stored in place if it fits |kCapacity| bytes.
+  class Task {
+   public:
+    static constexpr size_t kCapacity = 96;
+
+    Task() = default;
+
+    template <class F,
+              class = std::enable_if_t<
+                  !std::is_same_v<std::decay_t<F>, Task>>>
+    explicit Task(F&& f) {
+      using T = std::decay_t<F>;
+      if constexpr (sizeof(T) <= kCapacity &&
+                    alignof(T) <= alignof(std::max_align_t) &&
+                    std::is_nothrow_move_constructible_v<T>) {
+        new (storage_) T(std::forward<F>(f));
+        ops_ = &kInline<T>;
+      } else {
+        *reinterpret_cast<T**>(storage_) = new T(std::forward<F>(f));
+        ops_ = &kHeap<T>;
+      }
+    }
+
+    Task(Task&& other) noexcept { MoveFrom(other); }
+
+    Task& operator=(Task&& other) noexcept {
+      if (this != &other) {
+        Reset();
+        MoveFrom(other);
+      }
+      return *this;
+    }
+
+    ~Task() { Reset(); }
+
+    void operator()() { ops_->invoke(storage_); }
+
+   private:
+    struct Ops {
+      void (*invoke)(void*);
+      void (*move)(void* from, void* to);
+      void (*destroy)(void*);
+    };
+
+    template <class T>
+    static constexpr Ops kInline = {
+        [](void* f) { (*static_cast<T*>(f))(); },
+        [](void* from, void* to) {
+          new (to) T(std::move(*static_cast<T*>(from)));
+          static_cast<T*>(from)->~T();
+        },
+        [](void* f) { static_cast<T*>(f)->~T(); },
+    };
+
+    template <class T>
+    static constexpr Ops kHeap = {
+        [](void* f) { (**static_cast<T**>(f))(); },
+        [](void* from, void* to) {
+          *static_cast<T**>(to) = *static_cast<T**>(from);
+        },
+        [](void* f) { delete *static_cast<T**>(f); },
+    };
+
+    void MoveFrom(Task& other) {
+      ops_ = other.ops_;
+      if (ops_ != nullptr) {
+        ops_->move(other.storage_, storage_);
+        other.ops_ = nullptr;
+      }
+    }
+
+    void Reset() {
+      if (ops_ != nullptr) {
+        ops_->destroy(storage_);
+        ops_ = nullptr;
+      }
+    }
+
+    alignas(std::max_align_t) unsigned char storage_[kCapacity];
+    const Ops* ops_ = nullptr;
+  };
+
+  // Preallocated blocks for the shared states of |Post|'s futures. Shared
+  // with them, as a |std::future| may outlive the pool.
+  class States {
+   public:
+    static constexpr size_t kSize = 256;
+    static constexpr size_t kCount = 16;
+
+    States() {
+      for (size_t i = 0; i < kCount; i++) {
+        blocks_[i].next = free_;
+        free_ = &blocks_[i];
+      }
+    }
+
+    void* Allocate(size_t size) {
+      if (size <= kSize) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (free_ != nullptr) {
+          Block* block = free_;
+          free_ = block->next;
+          return block;
+        }
+      }
+      return ::operator new(size);
+    }
+
+    void Deallocate(void* pointer) {
+      auto block = static_cast<Block*>(pointer);
+      if (block >= blocks_ && block < blocks_ + kCount) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        block->next = free_;
+        free_ = block;
+        return;
+      }
+      ::operator delete(pointer);
+    }
+
+   private:
+    union Block {
+      Block* next;
+      alignas(std::max_align_t) unsigned char data[kSize];
+    };
+
+    Block blocks_[kCount];
+    Block* free_ = nullptr;
+    std::mutex mutex_;
+  };
+
+  template <class T>
+  struct StateAllocator {
+    using value_type = T;
+
+    explicit StateAllocator(std::shared_ptr<States> states)
+        : states(std::move(states)) {}
+
+    template <class U>
+    StateAllocator(const StateAllocator<U>& other) : states(other.states) {}
+
+    T* allocate(size_t n) {
+      static_assert(alignof(T) <= alignof(std::max_align_t));
+      return static_cast<T*>(states->Allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* pointer, size_t) { states->Deallocate(pointer); }
+
+    template <class U>
+    bool operator==(const StateAllocator<U>& other) const {
+      return states == other.states;
+    }
+
+    template <class U>
+    bool operator!=(const StateAllocator<U>& other) const {
+      return states != other.states;
+    }
+
+    std::shared_ptr<States> states;
+  };
+
+  void Enqueue(Task task);
+
   std::vector<std::thread> workers_;
-  std::queue<std::packaged_task<void()>> tasks_;
+  // Ring buffer of pending tasks; its slots are reused. Grows (doubling) only
+  // if ever full.
+  std::vector<Task> tasks_ = std::vector<Task>(64);
+  size_t head_ = 0;
+  size_t count_ = 0;
+  std::shared_ptr<States> states_ = std::make_shared<States>();
 
   std::mutex queue_mutex_;
   std::condition_variable condition_;
@@ -37,15 +218,16 @@ inline ThreadPool::ThreadPool(size_t threads) : stop_(false) {
   for (size_t i = 0; i < threads; i++) {
     workers_.emplace_back([&] {
       for (;;) {
-        std::packaged_task<void()> task;
+        Task task;
         {
           std::unique_lock<std::mutex> lock(queue_mutex_);
-          condition_.wait(lock, [&] { return stop_ || !tasks_.empty(); });
-          if (stop_ && tasks_.empty())
+          condition_.wait(lock, [&] { return stop_ || count_ > 0; });
+          if (stop_ && count_ == 0)
             return;
-          task = std::move(tasks_.front());
-          tasks_.pop();
-          if (tasks_.empty()) {
+          task = std::move(tasks_[head_]);
+          head_ = (head_ + 1) % tasks_.size();
+          count_--;
+          if (count_ == 0) {
             condition_producers_.notify_one();
           }
         }
@@ -62,24 +244,55 @@ inline ThreadPool::ThreadPool(size_t threads) : stop_(false) {
 template <class F, class... Args>
 decltype(auto) ThreadPool::Post(F&& f, Args&&... args) {
   using return_type = std::invoke_result_t<F, Args...>;
-  std::packaged_task<return_type()> task(
-      std::bind(std::forward<F>(f), std::forward<Args>(args)...));
-  std::future<return_type> res = task.get_future();
+  std::promise<return_type> promise(std::allocator_arg,
+                                    StateAllocator<return_type>(states_));
+  std::future<return_type> res = promise.get_future();
+  Enqueue(Task([promise = std::move(promise),
+                task = std::bind(std::forward<F>(f),
+                                 std::forward<Args>(args)...)]() mutable {
+    try {
+      if constexpr (std::is_void_v<return_type>) {
+        task();
+        promise.set_value();
+      } else {
+        promise.set_value(task());
+      }
+    } catch (...) {
+      promise.set_exception(std::current_exception());
+    }
+  }));
+  return res;
+}
+
+template <class F>
+void ThreadPool::Dispatch(F&& task) {
+  Enqueue(Task(std::forward<F>(task)));
+}
+
+inline void ThreadPool::Enqueue(Task task) {
   {
     std::unique_lock<std::mutex> lock(queue_mutex_);
     if (stop_) {
       throw std::runtime_error("ThreadPool::Post");
     }
-    tasks_.emplace(std::move(task));
+    if (count_ == tasks_.size()) {
+      std::vector<Task> tasks(tasks_.size() * 2);
+      for (size_t i = 0; i < count_; i++) {
+        tasks[i] = std::move(tasks_[(head_ + i) % tasks_.size()]);
+      }
+      tasks_.swap(tasks);
+      head_ = 0;
+    }
+    tasks_[(head_ + count_) % tasks_.size()] = std::move(task);
+    count_++;
   }
   condition_.notify_one();
-  return res;
 }
 
 inline ThreadPool::~ThreadPool() {
   {
     std::unique_lock<std::mutex> lock(queue_mutex_);
-    condition_producers_.wait(lock, [this] { return tasks_.empty(); });
+    condition_producers_.wait(lock, [this] { return count_ == 0; });
     stop_ = true;
   }
   condition_.notify_all();
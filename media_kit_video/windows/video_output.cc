@@ -147,7 +147,7 @@ VideoOutput::~VideoOutput() {
   promise.get_future().wait();
   texture_id_ = 0;
 
-  thread_pool_ref_->Post([render_context = render_context_]() {
+  thread_pool_ref_->Dispatch([render_context = render_context_]() {
     mpv_render_context_free(render_context);
   });
 }
@@ -156,8 +156,15 @@ void VideoOutput::NotifyRender() {
   if (destroyed_) {
     return;
   }
-  thread_pool_ref_->Post(std::bind(&VideoOutput::CheckAndResize, this));
-  thread_pool_ref_->Post(std::bind(&VideoOutput::Render, this));
+  // Coalesce: a queued render picks up the latest frame anyway.
+  if (render_pending_.exchange(true)) {
+    return;
+  }
+  thread_pool_ref_->Dispatch([this]() {
+    render_pending_ = false;
+    CheckAndResize();
+    Render();
+  });
 }
 
 void VideoOutput::Render() {
@@ -201,7 +208,7 @@ void VideoOutput::SetTextureUpdateCallback(
 
 void VideoOutput::SetSize(std::optional<int64_t> width,
                           std::optional<int64_t> height) {
-  thread_pool_ref_->Post([&, width, height]() {
+  thread_pool_ref_->Dispatch([&, width, height]() {
     if (width.has_value()) {
       // H/W
       if (d3d11_renderer_ != nullptr) {
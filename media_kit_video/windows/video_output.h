@@ -15,6 +15,7 @@
 #include <render.h>
 #include <render_dxgi.h>
 
+#include <atomic>
 #include <future>
 #include <memory>
 
@@ -102,6 +103,8 @@ class VideoOutput {
   // deletion after unregister in |Resize|) access this object after
   // destruction.
   bool destroyed_ = false;
+  // A render task is queued in |thread_pool_ref_|.
+  std::atomic<bool> render_pending_ = false;
 
   std::mutex textures_mutex_ = std::mutex();
 